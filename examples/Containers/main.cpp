@@ -21,6 +21,10 @@
  */
 
 #include <slib/core.h>
+#include <slib/media/audio_util.h>
+#include <slib/render/engine.h>
+#include <slib/network.h>
+#include <slib/crypto/zlib.h>
 
 using namespace slib;
 
@@ -103,5 +107,288 @@ int main(int argc, const char * argv[])
 		}
 
 	}
+	
+	// Json & Binary Serialization Example
+	{
+		Json json = Json::parseJson("{\"id\": 1024, \"name\": \"slib\", \"tags\": [\"core\", \"network\", \"ui\"], \"ratio\": 0.75, \"enabled\": true}");
+		List<Json> items;
+		for (int i = 0; i < 100; i++) {
+			items.add(json);
+		}
+		Json payload = items;
+		
+		String text = payload.toJsonString();
+		Memory binary = payload.serialize();
+		Println("Json Text: %d bytes, MessagePack: %d bytes", text.getLength(), binary.getSize());
+		
+		// Compare the cost of encoding & decoding
+		const int nRepeat = 1000;
+		sl_uint32 t0 = System::getTickCount();
+		for (int i = 0; i < nRepeat; i++) {
+			Json::parseJson(payload.toJsonString());
+		}
+		sl_uint32 t1 = System::getTickCount();
+		for (int i = 0; i < nRepeat; i++) {
+			Json::deserialize(payload.serialize());
+		}
+		sl_uint32 t2 = System::getTickCount();
+		Println("Json Text: %dms, MessagePack: %dms", t1 - t0, t2 - t1);
+		
+		Json decoded = Json::deserialize(binary);
+		Println("Decoded: %s", decoded[0].toJsonString());
+	}
+	
+	// Regular Expression Example
+	{
+		// RegExFlags::Extended is not handled by the native engine, so it runs on std::regex
+		RegEx native("(a*)*b");
+		RegEx backtracking("(a*)*b", RegExFlags::Extended);
+		String input = String('a', 14);
+		sl_uint32 t0 = System::getTickCount();
+		sl_bool r1 = native.match(input);
+		sl_uint32 t1 = System::getTickCount();
+		sl_bool r2 = backtracking.match(input);
+		sl_uint32 t2 = System::getTickCount();
+		Println("Pathological (a*)*b on %d chars: Native=%d (%dms), std::regex=%d (%dms)", input.getLength(), r1, t1 - t0, r2, t2 - t1);
+		
+		StringBuffer sb;
+		for (int i = 0; i < 100000; i++) {
+			sb.addStatic("GET /index.html 200 ", 20);
+		}
+		sb.addStatic("POST /login 500 user=admin@example.com", 39);
+		String log = sb.merge();
+		RegEx filter("[a-z]+@[a-z]+\\.com");
+		RegEx filterStd("[a-z]+@[a-z]+\\.com", RegExFlags::Extended);
+		t0 = System::getTickCount();
+		r1 = filter.search(log);
+		t1 = System::getTickCount();
+		r2 = filterStd.search(log);
+		t2 = System::getTickCount();
+		Println("Search in %d bytes: Native=%d (%dms), std::regex=%d (%dms)", log.getLength(), r1, t1 - t0, r2, t2 - t1);
+	}
+	
+	// String Primitives Example
+	{
+		StringBuffer sb;
+		for (int i = 0; i < 100000; i++) {
+			sb.addStatic("key=value; \xEC\x95\x88\xEB\x85\x95 ", 18);
+		}
+		sb.addStatic("needle", 6);
+		String text = sb.merge();
+		
+		sl_uint32 t0 = System::getTickCount();
+		sl_reg index = 0;
+		for (int i = 0; i < 100; i++) {
+			index = text.indexOf("needle");
+		}
+		sl_uint32 t1 = System::getTickCount();
+		Println("indexOf x100 in %d bytes: %d (%dms)", text.getLength(), index, t1 - t0);
+		
+		t0 = System::getTickCount();
+		sl_size hash = 0;
+		for (int i = 0; i < 100; i++) {
+			hash += HashBytesFast(text.getData(), text.getLength());
+		}
+		t1 = System::getTickCount();
+		Println("Hash x100: %d (%dms)", hash != 0, t1 - t0);
+		
+		t0 = System::getTickCount();
+		sl_bool flagValid = sl_false;
+		String16 text16;
+		for (int i = 0; i < 100; i++) {
+			flagValid = Charsets::checkUtf8(text.getData(), text.getLength());
+			text16 = String16(text);
+		}
+		t1 = System::getTickCount();
+		Println("UTF-8 validation and UTF-16 transcoding x100: valid=%d, length=%d (%dms)", flagValid, text16.getLength(), t1 - t0);
+	}
+	
+	// Sort Example
+	{
+		sl_uint32 n = 5000000;
+		List<sl_uint64> list;
+		list.setCount(n);
+		sl_uint64* data = list.getData();
+		sl_uint64 seed = 88172645463325252ULL;
+		for (sl_uint32 i = 0; i < n; i++) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			data[i] = seed;
+		}
+		List<sl_uint64> list1 = list.duplicate();
+		List<sl_uint64> list2 = list.duplicate();
+		List<sl_uint64> list3 = list.duplicate();
+		
+		sl_uint32 t0 = System::getTickCount();
+		list1.sort();
+		sl_uint32 t1 = System::getTickCount();
+		RadixSort::sortAsc(list2.getData(), n);
+		sl_uint32 t2 = System::getTickCount();
+		Ref<ThreadPool> pool = ThreadPool::create();
+		ParallelSort::sortAsc(pool, list3.getData(), n);
+		sl_uint32 t3 = System::getTickCount();
+		PartialSort::sortDesc(data, n, 10);
+		sl_uint32 t4 = System::getTickCount();
+		Println("Sort %d integers: QuickSort (%dms), RadixSort (%dms), ParallelSort (%dms), Top-10 (%dms)", n, t1 - t0, t2 - t1, t3 - t2, t4 - t3);
+		Println("Sorted: %d, %d, Top: %d", Base::equalsMemory(list1.getData(), list2.getData(), n * 8), Base::equalsMemory(list1.getData(), list3.getData(), n * 8), data[0] == list1[n - 1]);
+	}
+	
+	// Audio Resampling & Mixing Example
+	{
+		// 20ms frames of 16-bit mono audio
+		sl_uint32 nFrames = 500;
+		sl_uint32 nInput = 960;
+		Array<sl_int16> input = Array<sl_int16>::create(nInput);
+		for (sl_uint32 i = 0; i < nInput; i++) {
+			input[i] = (sl_int16)(Math::sin(i * 0.1) * 10000);
+		}
+		AudioData audioInput;
+		audioInput.format = AudioFormat::Int16_Mono;
+		audioInput.count = nInput;
+		audioInput.data = input.getData();
+		
+		AudioResamplerParam paramResampler;
+		paramResampler.channelsCount = 1;
+		paramResampler.inputSamplesPerSecond = 48000;
+		paramResampler.outputSamplesPerSecond = 16000;
+		Ref<AudioResampler> resampler = AudioResampler::create(paramResampler);
+		Array<sl_int16> resampled = Array<sl_int16>::create(nInput);
+		AudioData audioResampled;
+		audioResampled.format = AudioFormat::Int16_Mono;
+		audioResampled.count = nInput;
+		audioResampled.data = resampled.getData();
+		sl_uint32 nFramesResample = 20000;
+		sl_size nResampled = 0;
+		sl_uint32 t0 = System::getTickCount();
+		for (sl_uint32 i = 0; i < nFramesResample; i++) {
+			nResampled += resampler->resample(audioInput, audioResampled);
+		}
+		sl_uint32 t1 = System::getTickCount();
+		sl_uint32 dt = t1 - t0;
+		if (!dt) {
+			dt = 1;
+		}
+		Println("Resample 48k->16k, %d frames: %d samples (%dms), %d streams per core", nFramesResample, nResampled, t1 - t0, nFramesResample * 20 / dt);
+		
+		// every participant hears all the others
+		sl_uint32 nParticipants = 50;
+		Ref<AudioMixer> mixer = AudioMixer::create(1);
+		List<AudioData> inputs;
+		for (sl_uint32 i = 0; i < nParticipants; i++) {
+			inputs.add_NoLock(audioInput);
+		}
+		Array<sl_int16> mixed = Array<sl_int16>::create(nInput);
+		AudioData audioMixed;
+		audioMixed.format = AudioFormat::Int16_Mono;
+		audioMixed.count = nInput;
+		audioMixed.data = mixed.getData();
+		t0 = System::getTickCount();
+		for (sl_uint32 i = 0; i < nFrames; i++) {
+			mixer->mix(inputs.getData(), sl_null, nParticipants, nInput);
+			for (sl_uint32 k = 0; k < nParticipants; k++) {
+				mixer->getOutputExcept(k, audioMixed);
+			}
+		}
+		t1 = System::getTickCount();
+		dt = t1 - t0;
+		if (!dt) {
+			dt = 1;
+		}
+		Println("Mix %d participants with mix-minus, %d frames (%dms), %d streams per core", nParticipants, nFrames, t1 - t0, nParticipants * nFrames * 20 / dt);
+	}
+	
+	// Software Rendering Example
+	{
+		// each engine owns a thread pool, which is released when the engine is destroyed
+		sl_uint32 nEngines = 100;
+		sl_uint32 nRendered = 0;
+		sl_uint32 t0 = System::getTickCount();
+		for (sl_uint32 i = 0; i < nEngines; i++) {
+			SoftwareRenderEngineParam param;
+			param.width = 256;
+			param.height = 256;
+			param.threadsCount = 4;
+			Ref<SoftwareRenderEngine> engine = SoftwareRenderEngine::create(param);
+			if (engine.isNull()) {
+				break;
+			}
+			engine->beginScene();
+			engine->clearColorDepth(Color::Black, 1.0f);
+			engine->drawRectangle2D(Rectangle(-1, -1, 1, 1), Color4f(1, 0, 0, 1));
+			engine->endScene();
+			Color color;
+			Ref<Bitmap> target = engine->getTarget();
+			if (target.isNotNull() && target->readPixels(128, 128, 1, 1, &color) && color == Color::Red) {
+				nRendered++;
+			}
+		}
+		sl_uint32 t1 = System::getTickCount();
+		Println("Create, render and destroy %d software engines: rendered=%d (%dms)", nEngines, nRendered, t1 - t0);
+	}
+	
+	// Compressed Streaming Response Example
+	{
+		// the file is sent after compressed output is flushed, so it is read through the encoder
+		String pathFile = System::getTempDirectory() + "/slib_example_stream.txt";
+		String content;
+		for (sl_uint32 i = 0; i < 10000; i++) {
+			content += String::fromUint32(i) + " line of the file\n";
+		}
+		File::writeAllTextUTF8(pathFile, content);
+		HttpServiceParam param;
+		param.port = 18080;
+		param.flagCompressResponse = sl_true;
+		param.onRequest = [pathFile](HttpService*, HttpServiceContext* context) {
+			context->setResponseContentType(ContentTypes::TextPlain);
+			context->write("head\n");
+			context->flushResponse();
+			context->copyFromFile(pathFile);
+			context->write("tail\n");
+			return sl_true;
+		};
+		Ref<HttpService> service = HttpService::create(param);
+		String response;
+		Ref<Socket> socket = Socket::openTcp();
+		if (service.isNotNull() && socket.isNotNull() && socket->connectAndWait(SocketAddress(IPv4Address(127, 0, 0, 1), param.port), 5000)) {
+			socket->setNonBlockingMode(sl_false);
+			socket->setOption_ReceiveTimeout(5000);
+			String request = "GET / HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\nConnection: close\r\n\r\n";
+			socket->send(request.getData(), (sl_uint32)(request.getLength()));
+			char buf[4096];
+			sl_int32 n;
+			while ((n = socket->receive(buf, sizeof(buf))) > 0) {
+				response += String(buf, n);
+			}
+		}
+		// decodes the chunked transfer coding
+		sl_reg pos = response.indexOf("\r\n\r\n");
+		sl_bool flagEncoded = pos >= 0 && response.substring(0, pos).contains("Content-Encoding: gzip");
+		sl_bool flagTerminated = sl_false;
+		MemoryQueue body;
+		if (pos >= 0) {
+			// each chunk is preceded by the CRLF of the previous line
+			pos += 2;
+		}
+		while (pos >= 0) {
+			pos += 2;
+			sl_reg posSize = response.indexOf("\r\n", pos);
+			if (posSize < 0) {
+				break;
+			}
+			sl_uint64 size = response.substring(pos, posSize).parseUint64(16);
+			if (!size) {
+				flagTerminated = sl_true;
+				break;
+			}
+			body.add(Memory::create(response.getData() + posSize + 2, (sl_size)size));
+			pos = posSize + 2 + (sl_reg)size;
+		}
+		Memory compressed = body.merge();
+		Memory decoded = Zlib::decompress(compressed.getData(), compressed.getSize());
+		sl_bool flagMatched = String::fromMemory(decoded) == "head\n" + content + "tail\n";
+		Println("Compressed streaming response: encoded=%d, terminated=%d, matched=%d (%d -> %d bytes)", flagEncoded, flagTerminated, flagMatched, compressed.getSize(), decoded.getSize());
+		File::deleteFile(pathFile);
+	}
 	return 0;
 }
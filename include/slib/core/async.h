@@ -30,6 +30,8 @@
 #include "variant.h"
 #include "ptr.h"
 #include "function.h"
+#include "memory.h"
+#include "list.h"
 
 namespace slib
 {
@@ -242,6 +244,9 @@ namespace slib
 		Ref<Referable> userObject;
 		Function<void(AsyncStreamResult*)> callback;
 		sl_bool flagRead;
+		
+		// vectored write: `data` is null, and `size` is the total size of the slices
+		List<MemoryData> slices;
 
 	protected:
 		AsyncStreamRequest(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback, sl_bool flagRead);
@@ -250,6 +255,9 @@ namespace slib
 		static Ref<AsyncStreamRequest> createRead(void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
 
 		static Ref<AsyncStreamRequest> createWrite(const void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
+		
+		// the total size of the slices should not exceed 0x40000000
+		static Ref<AsyncStreamRequest> createVectorWrite(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback);
 
 	public:
 		void runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError);
@@ -270,6 +278,9 @@ namespace slib
 		virtual sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
+		
+		// merges the slices and writes them by `write()`, when the instance does not support vectored writes
+		virtual sl_bool writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback);
 
 		virtual sl_bool isSeekable();
 
@@ -321,6 +332,13 @@ namespace slib
 		virtual sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) = 0;
 
 		virtual sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) = 0;
+		
+		/*
+			Scatter/gather write: the slices are kept by their references until the write is completed.
+			Streams without vectored I/O merge the slices and write them by `write()`.
+			The total size of the slices should not exceed 0x40000000.
+		*/
+		virtual sl_bool writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback);
 
 		virtual sl_bool isSeekable();
 
@@ -351,6 +369,8 @@ namespace slib
 		sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
 
 		sl_bool write(const void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) override;
+		
+		sl_bool writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback) override;
 
 		sl_bool isSeekable() override;
 
@@ -697,6 +717,12 @@ namespace slib
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
 		sl_uint64 getOutputLength() const;
+		
+		// merges the buffered output into `output` and clears the buffer. fails when the output contains a stream
+		sl_bool mergeOutput(Memory& output);
+		
+		// pops the front of the output in order: the memory written before the next stream (`stream` is set to null), or the stream
+		sl_bool popFront(Memory& data, Ref<AsyncStream>& stream, sl_uint64& sizeStream);
 	
 	protected:
 		sl_uint64 m_lengthOutput;
@@ -755,6 +781,8 @@ namespace slib
 		void _onComplete();
 
 		void _write(sl_bool flagCompleted);
+		
+		sl_bool _popSlices(List<MemoryData>& slices);
 
 	protected:
 		Ref<AsyncStream> m_streamOutput;
@@ -765,7 +793,6 @@ namespace slib
 
 		Ref<AsyncOutputBufferElement> m_elementWriting;
 		Ref<AsyncCopy> m_copy;
-		Memory m_bufWrite;
 		sl_bool m_flagWriting;
 		sl_bool m_flagClosed;
 
@@ -39,6 +39,8 @@ namespace slib
 	class Charsets
 	{
 	public:
+		static sl_bool checkUtf8(const sl_char8* utf8, sl_size len);
+
 		static sl_size utf8ToUtf16(const sl_char8* utf8, sl_reg lenUtf8, sl_char16* utf16, sl_reg lenUtf16Buffer);
 
 		static sl_size utf8ToUtf32(const sl_char8* utf8, sl_reg lenUtf8, sl_char32* utf32, sl_reg lenUtf32Buffer);
@@ -75,6 +75,39 @@ namespace slib
 	
 	sl_size HashBytes(const void* buf, sl_size n) noexcept;
 
+	sl_uint64 HashBytesFast64(const void* buf, sl_size n, sl_uint64 seed = 0) noexcept;
+
+	sl_size HashBytesFast(const void* buf, sl_size n) noexcept;
+	
+	// Incremental form of HashBytesFast64(), for input produced in pieces. `totalSize` passed to start() must be the sum of the sizes passed to update()
+	class SLIB_EXPORT HashBytesFastStream
+	{
+	public:
+		void start(sl_size totalSize, sl_uint64 seed = 0) noexcept;
+		
+		void update(const void* buf, sl_size n) noexcept;
+		
+		sl_uint64 finish64() noexcept;
+		
+		sl_size finish() noexcept;
+		
+	private:
+		sl_size _getBlockSize() noexcept;
+		
+		void _processBlock(const sl_uint8* p, sl_size n) noexcept;
+		
+	private:
+		sl_uint64 m_seed;
+		sl_uint64 m_see1;
+		sl_uint64 m_see2;
+		sl_size m_sizeTotal;
+		sl_size m_sizeProcessed;
+		sl_size m_sizePending;
+		sl_uint8 m_pending[48];
+		sl_uint8 m_last[16];
+		
+	};
+
 	template <>
 	class Hash<char>
 	{
@@ -272,6 +272,13 @@ namespace slib
 		static Json parseJson16Utf8(const Memory& mem, JsonParseParam& param);
 
 		static Json parseJson16Utf8(const Memory& mem);
+
+		// MessagePack, see Variant::serialize()
+		static sl_bool deserialize(MemoryReader* reader, Json& _out);
+
+		static Json deserialize(const void* data, sl_size size);
+
+		static Json deserialize(const Memory& mem);
 		
 	public:
 		sl_bool isJsonList() const;
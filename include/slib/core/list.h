@@ -323,6 +323,18 @@ namespace slib
 		template < class COMPARE = Compare<T> >
 		void sortDesc(const COMPARE& compare = COMPARE()) const noexcept;
 		
+		template < class COMPARE = Compare<T> >
+		void sortStable_NoLock(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStable(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStableDesc_NoLock(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStableDesc(const COMPARE& compare = COMPARE()) const noexcept;
+		
 		void reverse_NoLock() const noexcept;
 		
 		void reverse() const noexcept;
@@ -623,6 +635,18 @@ namespace slib
 		template < class COMPARE = Compare<T> >
 		void sortDesc(const COMPARE& compare = COMPARE()) const noexcept;
 		
+		template < class COMPARE = Compare<T> >
+		void sortStable_NoLock(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStable(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStableDesc_NoLock(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStableDesc(const COMPARE& compare = COMPARE()) const noexcept;
+		
 		void reverse_NoLock() const noexcept;
 		
 		void reverse() const noexcept;
@@ -785,6 +809,12 @@ namespace slib
 		template < class COMPARE = Compare<T> >
 		void sortDesc(const COMPARE& compare = COMPARE()) const noexcept;
 		
+		template < class COMPARE = Compare<T> >
+		void sortStable(const COMPARE& compare = COMPARE()) const noexcept;
+		
+		template < class COMPARE = Compare<T> >
+		void sortStableDesc(const COMPARE& compare = COMPARE()) const noexcept;
+		
 		void reverse() const noexcept;
 		
 		List<T> slice(sl_size index, sl_size count = SLIB_SIZE_MAX) const noexcept;
@@ -229,6 +229,53 @@ namespace slib
 		sl_size m_posCurrent;
 
 	};
+	
+	/*
+		Recycles fixed-size blocks for the buffers allocated repeatedly with the same size (frames, packets).
+		`Memory` allocated from the pool is a lease on a block: the block returns to the pool
+		when the last reference (including the sub-memories) is released.
+	*/
+	class SLIB_EXPORT MemoryPool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		MemoryPool();
+		
+		~MemoryPool();
+		
+	public:
+		// `maxFreeBlocksCount`: 0 for unlimited
+		static Ref<MemoryPool> create(sl_size sizeBlock, sl_uint32 maxFreeBlocksCount = 0);
+		
+	public:
+		sl_size getBlockSize();
+		
+		// returns null if `size` is larger than the block size
+		Memory allocate(sl_size size);
+		
+		Memory allocate();
+		
+		sl_size getFreeBlocksCount();
+		
+		sl_size getAllocatedBlocksCount();
+		
+		// frees the blocks which are not leased
+		void clear();
+		
+	public:
+		void _recycle(void* block);
+		
+	protected:
+		sl_size m_sizeBlock;
+		sl_uint32 m_maxFreeBlocks;
+		
+		// free blocks are linked through their first bytes
+		void* m_freeHead;
+		sl_size m_nFreeBlocks;
+		sl_size m_nAllocatedBlocks;
+		
+	};
 
 }
 
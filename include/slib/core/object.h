@@ -63,6 +63,8 @@ namespace slib
 		
 		void clearProperty(const String& name) noexcept;
 		
+		void clearAllProperties() noexcept;
+		
 	public:
 		Object& operator=(const Object& other) = delete;
 		
@@ -263,6 +263,39 @@ namespace slib
 
 	};
 	
+	/*
+		Lock-free access to the pointer of AtomicRef.
+		Readers are counted in the current epoch while they load and retain the object.
+		A writer exchanges the pointer, moves the readers of the current epoch to the
+		draining count and starts a new epoch, then waits only for the draining readers
+		before releasing the replaced object. Readers entering after the exchange are
+		counted in the new epoch, so a steady stream of readers can not starve the writer.
+	*/
+	class SLIB_EXPORT _priv_AtomicRef_Readers
+	{
+	public:
+		constexpr _priv_AtomicRef_Readers() noexcept: m_state(0) {}
+
+		constexpr _priv_AtomicRef_Readers(const _priv_AtomicRef_Readers& other) noexcept: m_state(0) {}
+
+	public:
+		// enters as a reader of the current epoch and loads `*ptr`
+		void* acquire(void* const* ptr, sl_uint32& epoch) const noexcept;
+
+		void release(sl_uint32 epoch) const noexcept;
+
+		// returns the replaced pointer, which is no longer referenced by the readers
+		void* exchange(void** ptr, void* value) const noexcept;
+
+	public:
+		_priv_AtomicRef_Readers& operator=(const _priv_AtomicRef_Readers& other) noexcept;
+
+	private:
+		// epoch (16 bits) | draining readers (24 bits) | current readers (24 bits)
+		mutable sl_int64 m_state;
+
+	};
+	
 	template <class T>
 	class Atomic< Ref<T> >
 	{
@@ -404,7 +437,7 @@ namespace slib
 	public:
 		T* _ptr;
 	private:
-		SpinLock m_lock;
+		_priv_AtomicRef_Readers m_readers;
 	
 	};
 
@@ -91,11 +91,16 @@ namespace slib
 	public:
 		sl_bool match(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
 		
+		// returns true if any substring of `str` matches
+		sl_bool search(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
+		
 	private:
 		static Ref<CRegEx> _create(const String& pattern, int flags) noexcept;
 		
 	private:
+		// std::regex, used for the syntax which is not supported by the native engine
 		void* m_obj;
+		Ref<Referable> m_program;
 		
 	};
 	
@@ -114,6 +119,8 @@ namespace slib
 	public:
 		sl_bool match(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
 
+		sl_bool search(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
+
 	private:
 		AtomicRef<CRegEx> ref;
 		
@@ -134,6 +141,8 @@ namespace slib
 	public:
 		sl_bool match(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
 		
+		sl_bool search(const String& str, const RegExMatchFlags& flags = RegExMatchFlags::Default) noexcept;
+		
 	public:
 		static sl_bool matchEmail(const String& str) noexcept;
 
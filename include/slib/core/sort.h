@@ -27,6 +27,7 @@
 
 #include "cpp.h"
 #include "compare.h"
+#include "new_helper.h"
 
 namespace slib
 {
@@ -59,6 +60,13 @@ namespace slib
 
 	};
 	
+	/*
+		Pattern-defeating quicksort (Orson Peters)
+		
+		Median-of-3 (ninther for large ranges) pivots, partial insertion sort on already
+		partitioned ranges, and heap sort fallback after too many unbalanced partitions.
+		O(n log n) worst case, O(n) on sorted, reversed and equal-element inputs. Not stable.
+	*/
 	class SLIB_EXPORT QuickSort
 	{
 	public:
@@ -69,6 +77,81 @@ namespace slib
 		static void sortDesc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
 
 	};
+	
+	class SLIB_EXPORT HeapSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortAsc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortDesc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+	};
+	
+	/*
+		Stable sort: elements comparing equal keep their original order.
+		Uses a temporary buffer of `size / 2` elements (falls back to insertion sort if allocation fails).
+	*/
+	class SLIB_EXPORT MergeSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortAsc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortDesc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+	};
+	
+	/*
+		LSD radix sort on integer and floating-point keys, 8 bits per pass.
+		Passes on bytes shared by every key are skipped. Stable.
+		Uses a temporary buffer of `size` elements (falls back to MergeSort if allocation fails).
+		`getKey(element)` returns the key of an element for `sortAscBy` and `sortDescBy`.
+	*/
+	class SLIB_EXPORT RadixSort
+	{
+	public:
+		template <class TYPE>
+		static void sortAsc(TYPE* list, sl_size size) noexcept;
+		
+		template <class TYPE>
+		static void sortDesc(TYPE* list, sl_size size) noexcept;
+		
+		template <class TYPE, class KEY_GETTER>
+		static void sortAscBy(TYPE* list, sl_size size, const KEY_GETTER& getKey) noexcept;
+		
+		template <class TYPE, class KEY_GETTER>
+		static void sortDescBy(TYPE* list, sl_size size, const KEY_GETTER& getKey) noexcept;
+		
+	};
+	
+	/*
+		Top-K selection
+		
+		sortAsc/sortDesc: sorts the first `k` elements of the result order into `list[0, k)` in O(n log k).
+		The order of the remaining elements is unspecified.
+		
+		selectAsc/selectDesc: places the element which would be at `nth` in the sorted order,
+		with no greater (lesser for desc) elements before it and no lesser after it. O(n) on average.
+	*/
+	class SLIB_EXPORT PartialSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortAsc(TYPE* list, sl_size size, sl_size k, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortDesc(TYPE* list, sl_size size, sl_size k, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void selectAsc(TYPE* list, sl_size size, sl_size nth, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void selectDesc(TYPE* list, sl_size size, sl_size nth, const COMPARE& compare = COMPARE()) noexcept;
+		
+	};
 
 }
 
@@ -309,6 +309,16 @@ namespace slib
 		 */
 		sl_size getHashCodeIgnoreCase() const noexcept;
 		
+		/**
+		 * @return the canonical string of `StringInterner` having the same content.
+		 */
+		String intern() const noexcept;
+		
+		/**
+		 * @return true if this string is a canonical string of `StringInterner`.
+		 */
+		sl_bool isInterned() const noexcept;
+		
 		/**
 		 * @return the character at `index` in string.
 		 */
@@ -1228,6 +1238,32 @@ namespace slib
 		
 	public:
 		friend class Atomic<String>;
+		friend class StringInterner;
+		
+	};
+	
+	/**
+	 * @class StringInterner
+	 * @brief Global table of canonical strings for hot vocabularies (header names, field names, ...).
+	 *
+	 * Interned strings are immortal: copying them does not touch the reference count,
+	 * their hash code is precomputed, and two interned strings are equal only if they are the same object.
+	 * Lookups are lock-free, and only the insertion of a new string takes a lock.
+	 * Interned strings are never freed, so don't intern untrusted input without bound.
+	 */
+	class SLIB_EXPORT StringInterner
+	{
+	public:
+		static String intern(const String& str) noexcept;
+		
+		static String intern(const sl_char8* str, sl_reg len = -1) noexcept;
+		
+		/**
+		 * @return the canonical string if it is already interned, otherwise null. Never allocates.
+		 */
+		static String find(const sl_char8* str, sl_reg len = -1) noexcept;
+		
+		static sl_size getCount() noexcept;
 		
 	};
 	
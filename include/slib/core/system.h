@@ -59,6 +59,12 @@ namespace slib
 		static sl_uint32 getProcessId();
 
 		static sl_uint32 getThreadId();
+		
+		// number of logical processors
+		static sl_uint32 getCpuCoresCount();
+		
+		// binds the calling thread to the logical processor. Returns `sl_false` when the platform doesn't support affinity
+		static sl_bool setCurrentThreadAffinity(sl_uint32 cpuIndex);
 
 		static sl_bool createProcess(const String& pathExecutable, const String* command, sl_uint32 nCommands);
 
@@ -28,6 +28,7 @@
 #include "queue.h"
 #include "thread.h"
 #include "dispatch.h"
+#include "sort.h"
 
 namespace slib
 {
@@ -54,6 +55,9 @@ namespace slib
 		sl_bool addTask(const Function<void()>& task);
 
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms = 0) override;
+		
+		// runs `task(0)` ... `task(nTasks - 1)` on the workers and the calling thread, and returns when all of them are finished
+		void runParallel(sl_uint32 nTasks, const Function<void(sl_uint32 index)>& task);
 	
 	public:
 		SLIB_PROPERTY(sl_uint32, MinimumThreadsCount)
@@ -71,7 +75,33 @@ namespace slib
 		sl_bool m_flagRunning;
 
 	};
+	
+	/*
+		Parallel sort on a ThreadPool
+		
+		Splits the list into up to 64 chunks which are sorted concurrently (QuickSort, or MergeSort for the stable variants),
+		then merges them pairwise in rounds, splitting every merge into independent parts by binary search.
+		Uses a temporary buffer of `size` elements. Small lists, null pools and allocation failures fall back to sequential sorting.
+	*/
+	class SLIB_EXPORT ParallelSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortAsc(const Ref<ThreadPool>& pool, TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortDesc(const Ref<ThreadPool>& pool, TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortStableAsc(const Ref<ThreadPool>& pool, TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void sortStableDesc(const Ref<ThreadPool>& pool, TYPE* list, sl_size size, const COMPARE& compare = COMPARE()) noexcept;
+		
+	};
 
 }
 
+#include "detail/thread_pool.inc"
+
 #endif
@@ -61,6 +61,9 @@ namespace slib
 	class Variant;
 	typedef Atomic<Variant> AtomicVariant;
 	
+	class IWriter;
+	class MemoryReader;
+	
 	class SLIB_EXPORT Variant
 	{
 	public:
@@ -452,6 +455,22 @@ namespace slib
 	
 		String toJsonString() const noexcept;
 		
+		/*
+			MessagePack binary format.
+			`Memory` is written as bin, `Time` as timestamp extension (type -1), and
+			lists/maps of variants as array/map. Other objects and pointers are written as nil.
+		*/
+		sl_bool serialize(IWriter* writer) const noexcept;
+		
+		Memory serialize() const noexcept;
+		
+		// integers are decoded to the narrowest of Int32, Uint32, Int64, Uint64, and maps to VariantHashMap
+		static sl_bool deserialize(MemoryReader* reader, Variant& _out) noexcept;
+		
+		static Variant deserialize(const void* data, sl_size size) noexcept;
+		
+		static Variant deserialize(const Memory& mem) noexcept;
+		
 	public:
 		void get(Variant& _out) const noexcept;
 		void set(const Variant& _in) noexcept;
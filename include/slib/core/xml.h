@@ -32,7 +32,7 @@
  XML 1.1 => http://www.w3.org/TR/2006/REC-xml11-20060816/
  
  
- Supports DOM & SAX parsers
+ Supports DOM, SAX & pull parsers
  
 ************************************************************/
 
@@ -40,6 +40,8 @@
 
 #include "variant.h"
 #include "function.h"
+#include "memory.h"
+#include "ptr.h"
 
 namespace slib
 {
@@ -51,7 +53,11 @@ namespace slib
 	class XmlProcessingInstruction;
 	class XmlComment;
 	class XmlParseControl;
+	class XmlAsyncParser;
 	class StringBuffer;
+	class IReader;
+	class AsyncStream;
+	struct AsyncStreamResult;
 	
 	enum class XmlNodeType
 	{
@@ -426,7 +432,7 @@ namespace slib
 	class SLIB_EXPORT XmlParseControl
 	{
 	public:
-		// read & write
+		// read & write (not available while parsing from `IReader`)
 		StringData source;
 
 		sl_uint32 characterSize;
@@ -507,6 +513,280 @@ namespace slib
 
 	};
 	
+	enum class XmlPullEventType
+	{
+		None = 0,
+		StartElement = 1,
+		EndElement = 2,
+		Text = 3,
+		CDATA = 4,
+		ProcessingInstruction = 5,
+		Comment = 6,
+		WhiteSpace = 7,
+		EndDocument = 8,
+		// Input is exhausted in the middle of a token. Feed more data and call `next()` again.
+		NeedMoreData = 9,
+		Error = 10
+	};
+	
+	class SLIB_EXPORT XmlStringSlice
+	{
+	public:
+		const sl_char8* data;
+		sl_size length;
+		
+	public:
+		XmlStringSlice();
+		
+	public:
+		String toString() const;
+		
+		sl_bool equals(const sl_char8* str, sl_size len) const;
+		
+		sl_bool equals(const String& str) const;
+		
+	};
+	
+	struct SLIB_EXPORT XmlPullAttribute
+	{
+		XmlStringSlice name;
+		XmlStringSlice value;
+		XmlStringSlice whiteSpacesBeforeName;
+	};
+	
+	/**
+	 * @class XmlPullParser
+	 * @brief resumable XML (UTF-8) tokenizer running in bounded memory.
+	 *
+	 * The input can be given at once (`setInput`, without copying), fed in chunks (`feed`),
+	 * or pulled from an `IReader` (`setReader`). Consumed input is discarded from the internal buffer,
+	 * so memory usage is bounded by the size of the largest token.
+	 *
+	 * Names, texts and attributes of the current event are slices borrowed from the internal buffers,
+	 * which are valid until the next call to `next()`, `feed()` or `setInput()`.
+	 * Entities are decoded, and whitespaces around the texts are reported as `WhiteSpace` events.
+	 * Empty-element tags are reported as `StartElement` followed by `EndElement`.
+	 */
+	class SLIB_EXPORT XmlPullParser
+	{
+	public:
+		XmlPullParser();
+		
+		~XmlPullParser();
+		
+		XmlPullParser(const XmlPullParser& other) = delete;
+		
+		XmlPullParser& operator=(const XmlPullParser& other) = delete;
+		
+	public:
+		// parses `size` bytes at `data` starting from `offset`. The memory must be kept while parsing.
+		void setInput(const void* data, sl_size size, sl_size offset = 0);
+		
+		// pulls the input from `reader` whenever the buffered input is exhausted
+		void setReader(const Ptr<IReader>& reader);
+		
+		// appends a chunk of the input
+		sl_bool feed(const void* data, sl_size size);
+		
+		// notifies that no more input will be fed
+		void finish();
+		
+		sl_size getMaximumTokenSize();
+		
+		void setMaximumTokenSize(sl_size size);
+		
+		XmlPullEventType next();
+		
+	public:
+		XmlPullEventType getEventType();
+		
+		// element name, or target of processing instruction
+		const XmlStringSlice& getName();
+		
+		// content of text, CDATA, comment, processing instruction and whitespaces
+		const XmlStringSlice& getText();
+		
+		sl_size getAttributesCount();
+		
+		const XmlPullAttribute* getAttributes();
+		
+		sl_bool getAttribute(const String& name, XmlStringSlice* _out = sl_null);
+		
+		sl_bool isEmptyElementTag();
+		
+		// count of the open elements, including the current element on `StartElement` and `EndElement`
+		sl_size getDepth();
+		
+		// position of the current event in the whole input
+		sl_uint64 getStartPosition();
+		
+		sl_uint64 getEndPosition();
+		
+		// line & column at the start of the current event
+		sl_uint64 getLineNumber();
+		
+		sl_uint64 getColumnNumber();
+		
+		String getErrorMessage();
+		
+	private:
+		XmlPullEventType _parseToken();
+		
+		XmlPullEventType _parseText(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _parseComment(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _parseCDATA(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _parsePI(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _parseStartTag(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _parseEndTag(const sl_char8* p, sl_size n);
+		
+		XmlPullEventType _emitPendingPart();
+		
+		XmlPullEventType _needMoreData(const String& errorMessage);
+		
+		XmlPullEventType _setEvent(XmlPullEventType type, sl_size start, sl_size end);
+		
+		XmlPullEventType _setError(const String& message, sl_size pos);
+		
+		sl_bool _decode(const sl_char8* s, sl_size n, XmlStringSlice& _out, sl_size& sizeScratch, sl_size& errorOffset);
+		
+		sl_bool _reserveScratch(sl_size size);
+		
+		sl_bool _reserveBuffer(sl_size size);
+		
+		void _compact();
+		
+		sl_bool _readInput();
+		
+		void _updateLineNumber(sl_size pos);
+		
+	private:
+		// input
+		const sl_char8* m_buf;
+		sl_size m_len;
+		sl_size m_pos;
+		sl_uint64 m_base;
+		sl_char8* m_bufOwned;
+		sl_size m_capacityOwned;
+		sl_bool m_flagFinished;
+		Ptr<IReader> m_reader;
+		sl_size m_maxTokenSize;
+		
+		// scanning of the incomplete token, relative to `m_pos`
+		sl_size m_scanOffset;
+		sl_char8 m_scanQuote;
+		
+		// current event
+		XmlPullEventType m_type;
+		XmlStringSlice m_name;
+		XmlStringSlice m_text;
+		List<XmlPullAttribute> m_attributes;
+		sl_bool m_flagEmptyTag;
+		sl_uint64 m_posStart;
+		sl_uint64 m_posEnd;
+		String m_errorMessage;
+		
+		// decoded texts
+		sl_char8* m_scratch;
+		sl_size m_capacityScratch;
+		
+		// names of the open elements
+		sl_char8* m_stack;
+		sl_size m_sizeStack;
+		sl_size m_capacityStack;
+		List<sl_size> m_stackOffsets;
+		sl_bool m_flagPendingEndTag;
+		sl_bool m_flagPopElement;
+		
+		// whitespaces and text remaining in the last character data (absolute positions)
+		struct PendingPart
+		{
+			XmlPullEventType type;
+			sl_uint64 start;
+			sl_uint64 end;
+		};
+		PendingPart m_pendingParts[3];
+		sl_uint32 m_nPendingParts;
+		sl_uint32 m_indexPendingPart;
+		
+		// line counting (lazily updated)
+		sl_size m_posLine;
+		sl_uint64 m_lineNumber;
+		sl_uint64 m_columnNumber;
+		sl_bool m_flagLastCR;
+		
+	};
+	
+	class SLIB_EXPORT XmlAsyncParserParam
+	{
+	public:
+		// required
+		Ref<AsyncStream> stream;
+		
+		// optional
+		sl_uint32 bufferSize; // default: 0x10000
+		sl_size maximumTokenSize; // default: 16MB
+		sl_bool flagAutoStart; // default: true
+		
+		// called for every event except `NeedMoreData`
+		Function<void(XmlAsyncParser*, XmlPullParser*)> onEvent;
+		Function<void(XmlAsyncParser*, sl_bool flagError)> onEnd;
+		
+	public:
+		XmlAsyncParserParam();
+		
+		~XmlAsyncParserParam();
+		
+	};
+	
+	class SLIB_EXPORT XmlAsyncParser : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	private:
+		XmlAsyncParser();
+		
+		~XmlAsyncParser();
+		
+	public:
+		static Ref<XmlAsyncParser> create(const XmlAsyncParserParam& param);
+		
+	public:
+		sl_bool start();
+		
+		void close();
+		
+		sl_bool isRunning();
+		
+		Ref<AsyncStream> getStream();
+		
+		// must be accessed only in the callbacks
+		XmlPullParser* getPullParser();
+		
+	private:
+		void _read();
+		
+		void _onReadStream(AsyncStreamResult* result);
+		
+		void _dispatchEvents();
+		
+		void _end(sl_bool flagError);
+		
+	private:
+		Ref<AsyncStream> m_stream;
+		Memory m_buffer;
+		XmlPullParser m_parser;
+		Function<void(XmlAsyncParser*, XmlPullParser*)> m_onEvent;
+		Function<void(XmlAsyncParser*, sl_bool flagError)> m_onEnd;
+		sl_bool m_flagStarted;
+		sl_bool m_flagRunning;
+		
+	};
+	
 	/**
 	 * @class Xml
 	 * @brief provides utilities for parsing and build XML.
@@ -560,6 +840,29 @@ namespace slib
 		 */
 		static Ref<XmlDocument> parseXml(const String& xml);
 
+		/**
+		 * parses XML text (UTF-8 encoding) read from `reader`.
+		 * The whole text is not loaded at once; it is read in chunks while parsing.
+		 *
+		 * @param[in] reader source of the XML text
+		 * @param[in] param options for XML parsing
+		 *
+		 * @return XmlDocument object on success
+		 * @return nullptr on failure
+		 */
+		static Ref<XmlDocument> parseXmlFromReader(const Ptr<IReader>& reader, XmlParseParam& param);
+
+		/**
+		 * parses XML text (UTF-8 encoding) read from `reader`.
+		 * XML parser uses default option for parsing.
+		 *
+		 * @param[in] reader source of the XML text
+		 *
+		 * @return XmlDocument object on success
+		 * @return nullptr on failure
+		 */
+		static Ref<XmlDocument> parseXmlFromReader(const Ptr<IReader>& reader);
+
 
 		/**
 		 * parses XML text (Unicode) contained in `xml`
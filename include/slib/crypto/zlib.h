@@ -28,6 +28,10 @@
 #include "../core/object.h"
 #include "../core/memory.h"
 #include "../core/string.h"
+#include "../core/io.h"
+#include "../core/ptr.h"
+#include "../core/list.h"
+#include "../core/thread_pool.h"
 
 namespace slib
 {
@@ -45,6 +49,96 @@ namespace slib
 
 	};
 
+	class SLIB_EXPORT GzipParallelParam : public GzipParam
+	{
+	public:
+		// 0 ~ 9
+		sl_int32 level;
+		
+		// uncompressed size of the blocks which are compressed concurrently (at least 32KB)
+		sl_uint32 blockSize;
+		
+		/*
+			By default, every block is primed with the last 32KB of the previous block, so the ratio is close to the sequential compression.
+			Independent blocks lose that dictionary, but the writer appends a block index (as an empty gzip member),
+			which `Zlib::decompressGzipParallel` uses to decompress the blocks concurrently.
+		*/
+		sl_bool flagIndependentBlocks;
+		
+		// created by the writer when null
+		Ref<ThreadPool> threadPool;
+		
+	public:
+		GzipParallelParam();
+		
+		~GzipParallelParam();
+		
+	};
+	
+	/*
+		Writes a standard gzip stream, compressing the blocks of the input concurrently on a ThreadPool.
+		Every block is a raw deflate stream which is byte-aligned by Z_SYNC_FLUSH, and the CRC32 values of the blocks are combined.
+		The input is buffered until a batch of blocks is filled, then the batch is compressed in parallel and written to the output in order.
+	*/
+	class SLIB_EXPORT GzipParallelWriter : public Object, public IWriter, public IClosable
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		GzipParallelWriter();
+		
+		~GzipParallelWriter();
+		
+	public:
+		static Ref<GzipParallelWriter> create(const Ptr<IWriter>& output, const GzipParallelParam& param);
+		
+		static Ref<GzipParallelWriter> create(const Ptr<IWriter>& output, sl_int32 level = 6);
+		
+	public:
+		sl_reg write(const void* buf, sl_size size) override;
+		
+		// compresses the buffered input, and writes the last block, the gzip trailer and the block index
+		sl_bool finish();
+		
+		// finishes the stream
+		void close() override;
+		
+		sl_uint64 getInputSize();
+		
+		sl_uint64 getOutputSize();
+		
+	protected:
+		sl_bool _writeHeader(const GzipParallelParam& param);
+		
+		sl_bool _writeOutput(const void* data, sl_size size);
+		
+		sl_bool _compressBatch(const sl_uint8* data, sl_size size, sl_bool flagLast);
+		
+		sl_bool _writeIndex();
+		
+	protected:
+		Ptr<IWriter> m_output;
+		Ref<ThreadPool> m_threadPool;
+		sl_int32 m_level;
+		sl_uint32 m_blockSize;
+		sl_uint32 m_nBlocksPerBatch;
+		sl_bool m_flagIndependentBlocks;
+		
+		Memory m_bufInput;
+		sl_size m_sizeBufInput;
+		sl_uint8 m_dictionary[32768];
+		sl_uint32 m_sizeDictionary;
+		
+		sl_uint32 m_crc;
+		sl_uint64 m_sizeInput;
+		sl_uint64 m_sizeOutput;
+		CList<sl_uint32> m_listBlockSizes; // compressed sizes of the blocks, recorded for the index
+		
+		sl_bool m_flagFinished;
+		sl_bool m_flagError;
+		
+	};
+	
 	class SLIB_EXPORT ZlibCompress : public Object
 	{
 	public:
@@ -88,6 +182,12 @@ namespace slib
 			sl_bool flagFinish);
 	
 		Memory compress(const void* data, sl_size size, sl_bool flagFinish);
+		
+		/*
+			compresses `data` and flushes all pending output (Z_SYNC_FLUSH),
+			so that everything compressed so far can be decompressed by the receiver
+		*/
+		Memory compressAndFlush(const void* data, sl_size size);
 	
 		void abort();
 	
@@ -170,6 +270,11 @@ namespace slib
 		static Memory compressGzip(const GzipParam& param, const void* data, sl_size size, sl_int32 level = 6);
 
 		static Memory compressGzip(const void* data, sl_size size, sl_int32 level = 6);
+		
+		// compresses the blocks concurrently (see GzipParallelWriter)
+		static Memory compressGzipParallel(const GzipParallelParam& param, const void* data, sl_size size);
+		
+		static Memory compressGzipParallel(const void* data, sl_size size, sl_int32 level = 6);
 	
 		/*
 			Decompress
@@ -179,6 +284,15 @@ namespace slib
 		static Memory decompress(const void* data, sl_size size);
 	
 		static Memory decompressRaw(const void* data, sl_size size);
+		
+		/*
+			decompresses the blocks concurrently when the gzip stream contains the block index written by GzipParallelWriter (independent blocks),
+			otherwise decompresses sequentially. `pool` is created when null.
+		*/
+		static Memory decompressGzipParallel(const void* data, sl_size size, const Ref<ThreadPool>& pool = sl_null);
+		
+		// writes the decompressed content to `output` batch by batch, so the memory usage does not depend on the content size
+		static sl_bool decompressGzipParallel(const void* data, sl_size size, const Ptr<IWriter>& output, const Ref<ThreadPool>& pool = sl_null);
 	
 	};
 
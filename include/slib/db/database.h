@@ -27,12 +27,86 @@
 
 #include "../core/object.h"
 #include "../core/variant.h"
+#include "../core/linked_list.h"
+#include "../core/pair.h"
+#include "../core/function.h"
 
 namespace slib
 {
 	
 	class Database;
 	
+	enum class DatabaseColumnType
+	{
+		Int32 = 0,
+		Uint32 = 1,
+		Int64 = 2,
+		Uint64 = 3,
+		Float = 4,
+		Double = 5,
+		Boolean = 6,
+		Time = 7,
+		Text = 8, // DatabaseDataView
+		Blob = 9 // DatabaseDataView
+	};
+	
+	// borrowed text or blob, `data` is null for NULL value
+	class SLIB_EXPORT DatabaseDataView
+	{
+	public:
+		const void* data;
+		sl_size size;
+	};
+	
+	template <class T> struct DatabaseColumnTypeOf;
+	template <> struct DatabaseColumnTypeOf<sl_int32> { static constexpr DatabaseColumnType value = DatabaseColumnType::Int32; };
+	template <> struct DatabaseColumnTypeOf<sl_uint32> { static constexpr DatabaseColumnType value = DatabaseColumnType::Uint32; };
+	template <> struct DatabaseColumnTypeOf<sl_int64> { static constexpr DatabaseColumnType value = DatabaseColumnType::Int64; };
+	template <> struct DatabaseColumnTypeOf<sl_uint64> { static constexpr DatabaseColumnType value = DatabaseColumnType::Uint64; };
+	template <> struct DatabaseColumnTypeOf<float> { static constexpr DatabaseColumnType value = DatabaseColumnType::Float; };
+	template <> struct DatabaseColumnTypeOf<double> { static constexpr DatabaseColumnType value = DatabaseColumnType::Double; };
+	template <> struct DatabaseColumnTypeOf<bool> { static constexpr DatabaseColumnType value = DatabaseColumnType::Boolean; };
+	template <> struct DatabaseColumnTypeOf<Time> { static constexpr DatabaseColumnType value = DatabaseColumnType::Time; };
+	template <> struct DatabaseColumnTypeOf<DatabaseDataView> { static constexpr DatabaseColumnType value = DatabaseColumnType::Text; };
+	
+	// output slots of a column for `DatabaseCursor::fetch()`
+	class SLIB_EXPORT DatabaseColumnBinding
+	{
+	public:
+		sl_uint32 column;
+		DatabaseColumnType type;
+		// output of the first row
+		void* data;
+		// distance in bytes between the outputs of the consecutive rows
+		sl_size stride;
+		
+	public:
+		// contiguous array of values
+		template <class T>
+		static DatabaseColumnBinding fromArray(sl_uint32 column, T* values, DatabaseColumnType type = DatabaseColumnTypeOf<T>::value)
+		{
+			DatabaseColumnBinding ret;
+			ret.column = column;
+			ret.type = type;
+			ret.data = values;
+			ret.stride = sizeof(T);
+			return ret;
+		}
+		
+		// field of an array of structures
+		template <class CLASS, class T>
+		static DatabaseColumnBinding fromField(sl_uint32 column, CLASS* rows, T CLASS::*field, DatabaseColumnType type = DatabaseColumnTypeOf<T>::value)
+		{
+			DatabaseColumnBinding ret;
+			ret.column = column;
+			ret.type = type;
+			ret.data = &(rows->*field);
+			ret.stride = sizeof(CLASS);
+			return ret;
+		}
+		
+	};
+	
 	class SLIB_EXPORT DatabaseCursor : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -111,9 +185,26 @@ namespace slib
 	
 
 		virtual sl_bool moveNext() = 0;
+		
+		
+		// borrowed text (`flagText`) or blob of the current row, valid until the cursor moves. returns `sl_false` when not supported
+		virtual sl_bool getDataView(sl_uint32 index, DatabaseDataView& outView, sl_bool flagText);
+		
+		// binds the output slots filled by `fetch()`
+		void bindColumns(const DatabaseColumnBinding* bindings, sl_uint32 count);
+		
+		// moves the cursor and fills the bound outputs for up to `nRows` rows, and returns the count of the fetched rows. Views of texts and blobs are valid until the next fetch
+		sl_uint32 fetch(sl_uint32 nRows);
+	
+	protected:
+		sl_bool _addFetchData(const void* data, sl_size size, sl_size& outOffset);
 	
 	protected:
 		Ref<Database> m_db;
+		
+		List<DatabaseColumnBinding> m_bindings;
+		Memory m_bufFetch;
+		sl_size m_sizeFetch;
 
 	};
 	
@@ -143,6 +234,9 @@ namespace slib
 			return executeBy(params, sizeof...(args));
 		}
 
+		// executes the statement for each row of `params`, which is laid out as `nRows` rows of `nColumns` values (or `nColumns` columns of `nRows` values when `flagColumnMajor` is set). returns the total count of affected rows
+		virtual sl_int64 executeBatch(const Variant* params, sl_uint32 nColumns, sl_size nRows, sl_bool flagColumnMajor = sl_false);
+
 		virtual Ref<DatabaseCursor> queryBy(const Variant* params = sl_null, sl_uint32 nParams = 0) = 0;
 	
 		SLIB_INLINE Ref<DatabaseCursor> query()
@@ -202,6 +296,8 @@ namespace slib
 	protected:
 		Ref<Database> m_db;
 
+		friend class Database;
+
 	};
 	
 	class SLIB_EXPORT Database : public Object
@@ -272,6 +368,24 @@ namespace slib
 			return getValueForQueryResultBy(sql, params, sizeof...(args));
 		}
 
+		virtual sl_bool beginTransaction();
+		
+		virtual sl_bool commitTransaction();
+		
+		virtual sl_bool rollbackTransaction();
+		
+		virtual sl_bool isInTransaction();
+		
+		// executes `sql` for each row of `params` (see `DatabaseStatement::executeBatch()`). Rows are committed by the transactions of `getBatchChunkSize()` rows, unless a transaction is already in progress
+		sl_int64 executeBatch(const String& sql, const Variant* params, sl_uint32 nColumns, sl_size nRows, sl_bool flagColumnMajor = sl_false);
+		
+		// executes `sql` for the rows filled by `onFetchRow` (`nColumns` values per row), until it returns `sl_false`
+		sl_int64 executeBulk(const String& sql, sl_uint32 nColumns, const Function<sl_bool(Variant* row)>& onFetchRow);
+		
+		sl_uint32 getBatchChunkSize();
+		
+		void setBatchChunkSize(sl_uint32 nRows);
+
 		sl_bool isLoggingSQL();
 		
 		void setLoggingSQL(sl_bool flag);
@@ -280,6 +394,17 @@ namespace slib
 		
 		void setLoggingErrors(sl_bool flag);
 		
+		// maximum count of the statements cached by `executeBy()` and `queryBy()`. 0 disables the cache
+		sl_uint32 getStatementCacheSize();
+		
+		void setStatementCacheSize(sl_uint32 size);
+		
+		void clearStatementCache();
+		
+		sl_uint64 getStatementCacheHitsCount();
+		
+		sl_uint64 getStatementCacheMissesCount();
+		
 	protected:
 		virtual sl_int64 _execute(const String& sql);
 		
@@ -296,10 +421,34 @@ namespace slib
 		void _logError(const String& sql);
 		
 		void _logError(const String& sql, const Variant* params, sl_uint32 nParams);
+		
+		// count of rows merged into one `INSERT ... VALUES (...), (...)` statement by batch execution
+		virtual sl_uint32 _getBatchRowsPerStatement(sl_uint32 nColumns);
+		
+		sl_int64 _executeBatch(const String& sql, const Variant* rows, sl_uint32 nColumns, sl_size nRows);
+		
+		sl_int64 _executeBatchChunk(const String& sql, const Variant* rows, sl_uint32 nColumns, sl_size nRows, sl_bool flagTransaction);
+		
+		void _logBatch(const String& sql, sl_size nRows, sl_uint32 elapsedMilliseconds);
+		
+		Ref<DatabaseStatement> _getCachedStatement(const String& sql);
+		
+		void _releaseCachedStatement(const String& sql, DatabaseStatement* statement, sl_bool flagError);
+		
+		void _removeCachedStatements(sl_size countRemaining, CLinkedList< Pair< String, Ref<DatabaseStatement> > >& listRemoved);
 
 	protected:
 		sl_bool m_flagLogSQL;
 		sl_bool m_flagLogErrors;
+		
+		Mutex m_lockStatementCache;
+		sl_uint32 m_sizeStatementCache;
+		CLinkedList< Pair< String, Ref<DatabaseStatement> > > m_listCachedStatements;
+		CHashMap< String, Link< Pair< String, Ref<DatabaseStatement> > >* > m_mapCachedStatements;
+		sl_uint64 m_nStatementCacheHits;
+		sl_uint64 m_nStatementCacheMisses;
+		
+		sl_uint32 m_sizeBatchChunk;
 	
 	};
 
@@ -25,6 +25,11 @@
 
 #include "database.h"
 
+#include "../core/async.h"
+#include "../core/timer.h"
+#include "../core/event.h"
+#include "../core/queue.h"
+
 #if defined(SLIB_PLATFORM_IS_DESKTOP)
 #define SLIB_DATABASE_SUPPORT_MYSQL
 #endif
@@ -45,6 +50,10 @@ namespace slib
 
 		sl_bool flagAutoReconnect;
 		sl_bool flagMultipleStatements;
+		
+		// enables `executeAsync()` and `queryAsync()`, which run on `ioLoop` (default loop when null)
+		sl_bool flagNonBlocking;
+		Ref<AsyncIoLoop> ioLoop;
 
 	public:
 		MySQL_Param();
@@ -69,11 +78,81 @@ namespace slib
 	
 	public:
 		virtual sl_bool ping() = 0;
+		
+		// runs the query on the I/O loop without blocking the calling thread. `nAffectedRows` is negative on error
+		virtual void executeAsync(const String& sql, const Function<void(MySQL_Database*, sl_int64 nAffectedRows)>& callback) = 0;
+		
+		// `cursor` is null on error. The result is stored in memory, so the cursor can be kept after the callback
+		virtual void queryAsync(const String& sql, const Function<void(MySQL_Database*, DatabaseCursor* cursor)>& callback) = 0;
 	
 	public:
 		static void initThread();
 
 	};
+	
+	class SLIB_EXPORT MySQL_PoolParam : public MySQL_Param
+	{
+	public:
+		// idle connections kept warm
+		sl_uint32 minIdleConnectionsCount;
+		sl_uint32 maxConnectionsCount;
+		// milliseconds, idle connections exceeding `minIdleConnectionsCount` are closed after this time
+		sl_uint32 idleTimeout;
+		// milliseconds, idle connections are checked by ping at this interval
+		sl_uint32 pingInterval;
+		// milliseconds, `getConnection()` waits for a released connection up to this time when all connections are in use
+		sl_uint32 waitTimeout;
+		
+	public:
+		MySQL_PoolParam();
+		
+		~MySQL_PoolParam();
+		
+	};
+	
+	class SLIB_EXPORT MySQL_Pool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		MySQL_Pool();
+		
+		~MySQL_Pool();
+		
+	public:
+		static Ref<MySQL_Pool> create(const MySQL_PoolParam& param);
+		
+	public:
+		// the connection should be returned by `releaseConnection()`
+		Ref<MySQL_Database> getConnection();
+		
+		void releaseConnection(MySQL_Database* db);
+		
+		sl_uint32 getConnectionsCount();
+		
+		sl_uint32 getIdleConnectionsCount();
+		
+		// runs the query on an idle connection. When all connections are in use, the query is queued until a connection is released. New connections are opened on a separate thread
+		void executeAsync(const String& sql, const Function<void(sl_int64 nAffectedRows)>& callback);
+		
+		void queryAsync(const String& sql, const Function<void(DatabaseCursor* cursor)>& callback);
+		
+	protected:
+		void _runAsync(const Function<void(MySQL_Database*)>& task);
+		
+		void _onTimer(Timer* timer);
+		
+	protected:
+		MySQL_PoolParam m_param;
+		
+		CLinkedList< Pair< Ref<MySQL_Database>, sl_uint32 > > m_listIdle;
+		sl_uint32 m_nConnections;
+		LinkedQueue< Function<void(MySQL_Database*)> > m_queueAsyncTasks;
+		
+		Ref<Event> m_eventReleased;
+		Ref<Timer> m_timer;
+		
+	};
 
 }
 
@@ -27,6 +27,43 @@
 
 namespace slib
 {
+	
+	enum class SQLiteSynchronousMode
+	{
+		Default = -1,
+		Off = 0,
+		Normal = 1,
+		Full = 2,
+		Extra = 3
+	};
+	
+	class SLIB_EXPORT SQLiteParam
+	{
+	public:
+		String path;
+		sl_bool flagCreate;
+		sl_bool flagReadonly;
+		
+		// opens the database in WAL journal mode
+		sl_bool flagWAL;
+		// reader connections opened besides the writer connection (used in WAL mode). Read-only statements are executed on an idle reader
+		sl_uint32 readersCount;
+		
+		// PRAGMA mmap_size, negative value keeps the default
+		sl_int64 mmapSize;
+		// PRAGMA cache_size (positive: pages, negative: KiB), 0 keeps the default
+		sl_int32 cacheSize;
+		// PRAGMA synchronous
+		SQLiteSynchronousMode synchronous;
+		// milliseconds
+		sl_uint32 busyTimeout;
+		
+	public:
+		SQLiteParam();
+		
+		~SQLiteParam();
+		
+	};
 
 	class SLIB_EXPORT SQLiteDatabase : public Database
 	{
@@ -38,6 +75,8 @@ namespace slib
 		~SQLiteDatabase();
 
 	public:
+		static Ref<SQLiteDatabase> connect(const SQLiteParam& param);
+		
 		static Ref<SQLiteDatabase> connect(const String& filePath, sl_bool flagCreate = sl_true, sl_bool flagReadonly = sl_false);
 
 	};
@@ -84,6 +84,9 @@ namespace slib
 
 	public:
 		sl_bool getChar(sl_char16 ch, FontAtlasChar& _out);
+		
+		// returns `sl_true` if getting the char may draw over the chars on the planes
+		sl_bool isReusingPlanes(sl_char16 ch);
 
 		Size getFontSize(sl_char16 ch);
 
@@ -111,6 +114,7 @@ namespace slib
 		sl_uint32 m_currentPlaneY;
 		sl_uint32 m_currentPlaneX;
 		sl_uint32 m_currentPlaneRowHeight;
+		sl_bool m_flagReusingPlane;
 
 	};
 
@@ -44,6 +44,12 @@ namespace slib
 	public:
 		virtual Memory encode(const AudioData& input) = 0;
 		
+		// encodes into `output`, and returns the size of the packet (0 on failure, or if `sizeOutput` is not enough)
+		virtual sl_uint32 encode(const AudioData& input, void* output, sl_uint32 sizeOutput);
+		
+		// the packet is written on a block leased from `pool`
+		Memory encode(const AudioData& input, MemoryPool* pool);
+		
 	public:
 		sl_uint32 getSamplesCountPerSecond() const;
 		
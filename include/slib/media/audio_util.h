@@ -25,7 +25,11 @@
 
 #include "definition.h"
 
+#include "audio_data.h"
+
 #include "../core/math.h"
+#include "../core/object.h"
+#include "../core/array.h"
 
 namespace slib
 {
@@ -175,6 +179,139 @@ namespace slib
 		
 	};
 	
+	enum class AudioResamplerQuality
+	{
+		Fast = 0, // 8 taps per phase
+		Medium = 1, // 16 taps per phase
+		High = 2 // 32 taps per phase
+	};
+	
+	class SLIB_EXPORT AudioResamplerParam
+	{
+	public:
+		sl_uint32 channelsCount;
+		sl_uint32 inputSamplesPerSecond;
+		sl_uint32 outputSamplesPerSecond;
+		
+		AudioResamplerQuality quality;
+		
+	public:
+		AudioResamplerParam();
+		
+		~AudioResamplerParam();
+		
+	};
+	
+	/*
+		Polyphase sample-rate converter for arbitrary (rational) ratios.
+		The state is kept between calls, so continuous streams can be resampled frame by frame.
+	*/
+	class SLIB_EXPORT AudioResampler : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AudioResampler();
+		
+		~AudioResampler();
+		
+	public:
+		static Ref<AudioResampler> create(const AudioResamplerParam& param);
+		
+	public:
+		sl_uint32 getChannelsCount();
+		
+		sl_uint32 getInputSamplesPerSecond();
+		
+		sl_uint32 getOutputSamplesPerSecond();
+		
+		// returns the count of samples (per channel) produced by `resample()` for `countInput` input samples
+		sl_size getOutputSamplesCount(sl_size countInput);
+		
+		// `output` should have room for `getOutputSamplesCount(input.count)` samples. Returns the count of samples (per channel) written to `output`
+		sl_size resample(const AudioData& input, const AudioData& output);
+		
+		void reset();
+		
+	protected:
+		sl_size _getPendingOutputsCount(sl_size countInput);
+		
+	protected:
+		sl_uint32 m_nChannels;
+		sl_uint32 m_nInputSamplesPerSecond;
+		sl_uint32 m_nOutputSamplesPerSecond;
+		
+		// output step is `m_down / m_up` input samples
+		sl_uint32 m_up;
+		sl_uint32 m_down;
+		sl_uint32 m_nPhases;
+		sl_uint32 m_nTaps;
+		// reversed coefficients of each phase
+		Array<float> m_coefficients;
+		
+		// history and input samples of each channel
+		Array<float> m_bufInput[2];
+		sl_size m_nInput;
+		sl_size m_posInput;
+		sl_uint32 m_posPhase;
+		
+		Array<float> m_bufOutput[2];
+		
+	};
+	
+	/*
+		Mixes N input streams sharing the sample rate. After `mix()`, the output can be read as the sum of all inputs
+		or as the sum of all inputs except one ("mix-minus", e.g. conference participant not hearing oneself)
+	*/
+	class SLIB_EXPORT AudioMixer : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AudioMixer();
+		
+		~AudioMixer();
+		
+	public:
+		static Ref<AudioMixer> create(sl_uint32 nChannels);
+		
+	public:
+		sl_uint32 getChannelsCount();
+		
+		// output samples exceeding the threshold are compressed softly to avoid hard clipping (1 disables the limiter)
+		float getLimiterThreshold();
+		
+		void setLimiterThreshold(float threshold);
+		
+		// `gains` can be null (unity gain). Inputs shorter than `count` are padded with silence
+		void mix(const AudioData* inputs, const float* gains, sl_uint32 nInputs, sl_size count);
+		
+		sl_uint32 getInputsCount();
+		
+		sl_size getSamplesCount();
+		
+		// returns the count of samples (per channel) written to `output`
+		sl_size getOutput(const AudioData& output);
+		
+		sl_size getOutputExcept(sl_uint32 indexInput, const AudioData& output);
+		
+	protected:
+		sl_size _writeOutput(sl_int32 indexExcept, const AudioData& output);
+		
+	protected:
+		sl_uint32 m_nChannels;
+		float m_thresholdLimiter;
+		
+		sl_uint32 m_nInputs;
+		sl_size m_nSamples;
+		// planar float samples: [input][channel][sample]
+		Array<float> m_bufInputs;
+		// [channel][sample]
+		Array<float> m_bufSum;
+		Array<float> m_bufOutput;
+		
+	};
+	
 }
 
 #include "detail/audio_util.inc"
@@ -26,8 +26,10 @@
 #include "definition.h"
 
 #include "video_frame.h"
+#include "audio_codec.h"
 
 #include "../core/object.h"
+#include "../core/function.h"
 
 namespace slib
 {
@@ -43,6 +45,12 @@ namespace slib
 	public:
 		virtual Memory encode(const VideoFrame& input) = 0;
 		
+		// encodes into `output`, and returns the size of the packet (0 on failure, or if `sizeOutput` is not enough)
+		virtual sl_uint32 encode(const VideoFrame& input, void* output, sl_uint32 sizeOutput);
+		
+		// the packet is written on a block leased from `pool`
+		Memory encode(const VideoFrame& input, MemoryPool* pool);
+		
 	public:
 		sl_uint32 getBitrate();
 		
@@ -66,13 +74,157 @@ namespace slib
 		~VideoDecoder();
 		
 	public:
+		/*
+			If `output.image` has no buffer, it is set to the internal planes of the decoder (no copy),
+			which are valid until the next call of `decode`. Otherwise, the pixels are copied into `output.image`.
+		*/
 		virtual sl_bool decode(const void* input, const sl_uint32& inputSize, VideoFrame& output) = 0;
 		
 	protected:
 		sl_uint32 m_nWidth;
 		sl_uint32 m_nHeight;
 		
-	};	
+	};
+	
+	enum class MediaCodecDropPolicy
+	{
+		// frames which are not started until their deadlines are dropped
+		DropLate = 0,
+		// the oldest frame is dropped when the queue of the stream is full
+		DropOldest = 1,
+		// frames are never dropped
+		Never = 2
+	};
+	
+	class SLIB_EXPORT MediaCodecSchedulerParam
+	{
+	public:
+		// 0: number of CPU cores
+		sl_uint32 workersCount;
+		// binds each worker to a CPU core
+		sl_bool flagPinWorkers;
+		// milliseconds. Workers process the frames queued in each tick as a batch (0: frames are processed as soon as pushed)
+		sl_uint32 tickInterval;
+		// queued frames per stream, exceeding frames are dropped by the drop policy
+		sl_uint32 maxQueuedFramesCount;
+		
+	public:
+		MediaCodecSchedulerParam();
+		
+		~MediaCodecSchedulerParam();
+		
+	};
+	
+	class MediaCodecScheduler;
+	
+	/*
+		A codec instance driven by a worker of `MediaCodecScheduler`.
+		Each stream is processed by one worker, so the codec state stays in the cache of the worker's core.
+		Latencies are measured in milliseconds from pushing the frame to the completion of encoding/decoding.
+	*/
+	class SLIB_EXPORT MediaCodecStream : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		MediaCodecStream();
+		
+		~MediaCodecStream();
+		
+	public:
+		// `deadline`: milliseconds from now, 0 for no deadline. Input data is copied, so it can be reused after the call
+		virtual sl_bool pushVideoFrame(const VideoFrame& frame, sl_uint32 deadline = 0) = 0;
+		
+		virtual sl_bool pushAudioFrame(const AudioData& data, sl_uint32 deadline = 0) = 0;
+		
+		// for decoder streams
+		virtual sl_bool pushPacket(const void* data, sl_uint32 size, sl_uint32 deadline = 0) = 0;
+		
+		// pending frames are dropped
+		virtual void close() = 0;
+		
+	public:
+		sl_uint32 getWorkerIndex();
+		
+		// streams with higher priority are processed first
+		sl_int32 getPriority();
+		
+		void setPriority(sl_int32 priority);
+		
+		MediaCodecDropPolicy getDropPolicy();
+		
+		void setDropPolicy(MediaCodecDropPolicy policy);
+		
+		sl_uint64 getProcessedFramesCount();
+		
+		sl_uint64 getDroppedFramesCount();
+		
+		sl_uint32 getLastLatency();
+		
+		// exponential moving average
+		sl_uint32 getAverageLatency();
+		
+		sl_uint32 getMaxLatency();
+		
+		void resetMetrics();
+		
+	protected:
+		sl_uint32 m_indexWorker;
+		sl_int32 m_priority;
+		MediaCodecDropPolicy m_dropPolicy;
+		
+		// updated by the worker and the producer threads
+		sl_int64 m_nProcessedFrames;
+		sl_int64 m_nDroppedFrames;
+		sl_uint32 m_latencyLast;
+		sl_uint32 m_latencyAverage;
+		sl_uint32 m_latencyMax;
+		
+	};
+	
+	/*
+		Runs many encoder/decoder instances on a fixed pool of (optionally pinned) worker threads.
+		Streams are assigned to the least loaded worker, and each worker processes the pending frames of its streams
+		in the order of priority and deadline.
+	*/
+	class SLIB_EXPORT MediaCodecScheduler : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		MediaCodecScheduler();
+		
+		~MediaCodecScheduler();
+		
+	public:
+		static Ref<MediaCodecScheduler> create(const MediaCodecSchedulerParam& param);
+		
+	public:
+		// callbacks are invoked on the worker thread
+		Ref<MediaCodecStream> addVideoEncoder(const Ref<VideoEncoder>& encoder, const Function<void(MediaCodecStream*, Memory& packet)>& onEncode, sl_int32 priority = 0);
+		
+		Ref<MediaCodecStream> addVideoDecoder(const Ref<VideoDecoder>& decoder, const Function<void(MediaCodecStream*, VideoFrame& frame)>& onDecode, sl_int32 priority = 0);
+		
+		Ref<MediaCodecStream> addAudioEncoder(const Ref<AudioEncoder>& encoder, const Function<void(MediaCodecStream*, Memory& packet)>& onEncode, sl_int32 priority = 0);
+		
+		Ref<MediaCodecStream> addAudioDecoder(const Ref<AudioDecoder>& decoder, const Function<void(MediaCodecStream*, AudioData& data)>& onDecode, sl_int32 priority = 0);
+		
+		void removeStream(MediaCodecStream* stream);
+		
+		sl_uint32 getWorkersCount();
+		
+		sl_uint32 getStreamsCount();
+		
+		void release();
+		
+	protected:
+		sl_uint32 _selectWorker(sl_uint32 weight);
+		
+	protected:
+		MediaCodecSchedulerParam m_param;
+		CList< Ref<Referable> > m_workers;
+		
+	};
 }
 
 #endif
@@ -73,6 +73,9 @@ namespace slib
 		
 		sl_bool connect(const SocketAddress& address);
 		
+		// resolves `hostName` by the default DnsResolver without blocking the caller
+		sl_bool connect(const String& hostName, sl_uint16 port);
+		
 		sl_bool receive(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
 		
 		sl_bool receive(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback);
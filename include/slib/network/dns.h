@@ -31,6 +31,7 @@
 #include "../core/string.h"
 #include "../core/hash_map.h"
 #include "../core/json.h"
+#include "../core/spin_lock.h"
 #include "../crypto/aes.h"
 
 /********************************************************************
@@ -405,6 +406,8 @@ namespace slib
 		
 		sl_uint16 id;
 		
+		DnsResponseCode responseCode;
+		
 		struct Question
 		{
 			String name;
@@ -416,6 +419,7 @@ namespace slib
 		{
 			String name;
 			IPAddress address;
+			sl_uint32 TTL;
 		};
 		List<Address> addresses;
 		
@@ -423,6 +427,7 @@ namespace slib
 		{
 			String name;
 			String alias;
+			sl_uint32 TTL;
 		};
 		List<Alias> aliases;
 		
@@ -443,9 +448,9 @@ namespace slib
 	public:
 		sl_bool parsePacket(const void* packet, sl_uint32 len);
 		
-		static Memory buildQuestionPacket(sl_uint16 id, const String& host);
+		static Memory buildQuestionPacket(sl_uint16 id, const String& host, DnsRecordType type = DnsRecordType::A);
 		
-		static Memory buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress);
+		static Memory buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL = 0);
 		
 	};
 	
@@ -479,9 +484,11 @@ namespace slib
 		static Ref<DnsClient> create(const DnsClientParam& param);
 		
 	public:
-		void sendQuestion(const SocketAddress& serverAddress, const String& hostName);
+		// returns the identifier of the question
+		sl_uint16 sendQuestion(const SocketAddress& serverAddress, const String& hostName, DnsRecordType type = DnsRecordType::A);
 		
-		void sendQuestion(const IPv4Address& serverIp, const String& hostName);
+		// returns the identifier of the question
+		sl_uint16 sendQuestion(const IPv4Address& serverIp, const String& hostName, DnsRecordType type = DnsRecordType::A);
 		
 	protected:
 		void _onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive);
@@ -496,6 +503,116 @@ namespace slib
 
 	};
 	
+	class SLIB_EXPORT DnsCacheParam
+	{
+	public:
+		// count of independently locked partitions
+		sl_uint32 shardsCount;
+		
+		// maximum count of entries in each shard
+		sl_uint32 maximumEntriesCountPerShard;
+		
+		// TTLs (in seconds) of the answers are clamped into this range
+		sl_uint32 minimumTTL;
+		sl_uint32 maximumTTL;
+		
+		// TTL (in seconds) of the cached failures (NXDOMAIN, no address)
+		sl_uint32 negativeTTL;
+		
+		// hot entries are prefetched when the remaining lifetime falls below this percentage of TTL
+		sl_uint32 prefetchPercent;
+		
+	public:
+		DnsCacheParam();
+		
+		~DnsCacheParam();
+		
+	};
+	
+	class SLIB_EXPORT DnsCacheItem
+	{
+	public:
+		// empty on negative entry
+		List<IPAddress> addresses;
+		
+		// remaining lifetime in seconds
+		sl_uint32 TTL;
+		
+		// set only to one of the lookups hitting an entry which is about to expire
+		sl_bool flagPrefetch;
+		
+	public:
+		DnsCacheItem();
+		
+		~DnsCacheItem();
+		
+	public:
+		sl_bool isNegative() const;
+		
+		IPv4Address getIPv4Address() const;
+		
+	};
+	
+	class _priv_DnsCacheShard;
+	
+	// TTL-respecting positive and negative cache of the resolved host addresses
+	class SLIB_EXPORT DnsCache : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		DnsCache();
+		
+		~DnsCache();
+		
+	public:
+		static Ref<DnsCache> create(const DnsCacheParam& param);
+		
+		static Ref<DnsCache> create();
+		
+	public:
+		// host names are case-insensitive
+		sl_bool get(const String& hostName, DnsCacheItem& _out);
+		
+		void put(const String& hostName, const List<IPAddress>& addresses, sl_uint32 TTL);
+		
+		void put(const String& hostName, const IPAddress& address, sl_uint32 TTL);
+		
+		void putNegative(const String& hostName);
+		
+		void remove(const String& hostName);
+		
+		void removeAll();
+		
+		sl_size removeExpiredEntries();
+		
+		sl_uint64 getHitsCount();
+		
+		sl_uint64 getMissesCount();
+		
+		sl_uint64 getPrefetchesCount();
+		
+	protected:
+		_priv_DnsCacheShard* _getShard(const String& key);
+		
+		void _put(const String& hostName, const List<IPAddress>& addresses, sl_uint32 TTL);
+		
+	protected:
+		_priv_DnsCacheShard* m_shards;
+		sl_uint32 m_nShards;
+		
+		sl_uint32 m_maximumEntriesCountPerShard;
+		sl_uint32 m_minimumTTL;
+		sl_uint32 m_maximumTTL;
+		sl_uint32 m_negativeTTL;
+		sl_uint32 m_prefetchPercent;
+		
+		sl_int64 m_nHits;
+		sl_int64 m_nMisses;
+		sl_int64 m_nPrefetches;
+		
+	};
+	
 	class DnsServer;
 	
 	class SLIB_EXPORT DnsResolveHostParam
@@ -541,6 +658,10 @@ namespace slib
 		
 		sl_bool flagAutoStart;
 		
+		// caches the answers of the default forward server, and coalesces identical questions in flight (disabled by default)
+		sl_bool flagCache;
+		DnsCacheParam cacheParam;
+		
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Function<void(DnsServer*, DnsResolveHostParam&)> onResolve;
@@ -575,6 +696,17 @@ namespace slib
 		
 		sl_bool isRunning();
 		
+		// null if the cache is disabled
+		Ref<DnsCache> getCache();
+		
+	protected:
+		struct ForwardClient
+		{
+			SocketAddress address;
+			sl_uint16 requestedId;
+			sl_bool flagEncrypted;
+		};
+		
 	protected:
 		void _processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest);
 		
@@ -584,11 +716,14 @@ namespace slib
 		
 		void _processReceivedProxyAnswer(void* data, sl_uint32 size);
 		
+		// `client` is null for the questions which are not answered to clients (prefetch, notification for `onCache`)
+		void _forwardQuestion(const SocketAddress& forwardAddress, sl_bool flagEncryptForward, const String& hostName, const ForwardClient* client, sl_bool flagCacheAnswer);
+		
 		void _sendPacket(sl_bool flagEncrypted, const SocketAddress& targetAddress, const Memory& packet);
 		
 		Memory _buildQuestionPacket(sl_uint16 id, const String& host, sl_bool flagEncrypt);
 		
-		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt);
+		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL, sl_bool flagEncrypt);
 		
 	protected:
 		void _onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive);
@@ -619,14 +754,113 @@ namespace slib
 			sl_uint16 requestedId;
 			String requestedHostName;
 			sl_bool flagEncrypted;
+			// key in `m_mapForwardQuestions`, empty when the question is not shared
+			String questionKey;
+			sl_bool flagCacheAnswer;
+			sl_uint32 timeForward;
+			// identical questions arrived while this one is in flight
+			List<ForwardClient> coalescedClients;
 		};
+		SpinLock m_lockForward;
 		CHashMap<sl_uint16, ForwardElement> m_mapForward;
+		CHashMap<String, sl_uint16> m_mapForwardQuestions;
+		
+		Ref<DnsCache> m_cache;
 		
 		Function<void(DnsServer*, DnsResolveHostParam&)> m_onResolve;
 		Function<void(DnsServer*, const String& hostName, const IPAddress& hostAddress)> m_onCache;
 
 	};
 
+
+	class SLIB_EXPORT DnsResolverParam
+	{
+	public:
+		// loaded from `/etc/resolv.conf` if empty. Only IPv4 name servers are used
+		List<SocketAddress> nameServers;
+		
+		// loads the static host table from `/etc/hosts`
+		sl_bool flagLoadHosts;
+		
+		// queries AAAA records in parallel with A records
+		sl_bool flagIPv6;
+		
+		// timeout of each attempt in milliseconds
+		sl_uint32 timeout;
+		
+		// attempts per name server
+		sl_uint32 attemptsCount;
+		
+		DnsCacheParam cacheParam;
+		
+		Ref<AsyncIoLoop> ioLoop;
+		
+	public:
+		DnsResolverParam();
+		
+		~DnsResolverParam();
+		
+	};
+	
+	class _priv_DnsResolveRequest;
+	
+	// Asynchronous caching stub resolver
+	class SLIB_EXPORT DnsResolver : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		DnsResolver();
+		
+		~DnsResolver();
+		
+	public:
+		static Ref<DnsResolver> create(const DnsResolverParam& param);
+		
+		static Ref<DnsResolver> getDefault();
+		
+	public:
+		/*
+			`callback` receives an empty list on failure, and IPv4 addresses are listed before IPv6 addresses.
+			It is called immediately for address literals, static hosts and cached answers, and otherwise on the I/O loop or timer thread.
+		*/
+		void resolve(const String& hostName, const Function<void(const List<IPAddress>& addresses)>& callback);
+		
+		List<SocketAddress> getNameServers();
+		
+		Ref<DnsCache> getCache();
+		
+		static List<SocketAddress> loadNameServers(const String& pathResolvConf);
+		
+		static HashMap< String, List<IPAddress> > loadHosts(const String& pathHosts);
+		
+	protected:
+		void _sendQuestions(_priv_DnsResolveRequest* request);
+		
+		void _onAnswer(DnsClient* client, const SocketAddress& serverAddress, const DnsPacket& packet);
+		
+		void _onTimeout(const Ref<_priv_DnsResolveRequest>& request, sl_uint32 attempt);
+		
+		void _completeRequest(_priv_DnsResolveRequest* request);
+		
+	protected:
+		Ref<DnsClient> m_client;
+		List<SocketAddress> m_nameServers;
+		HashMap< String, List<IPAddress> > m_hosts;
+		Ref<DnsCache> m_cache;
+		
+		sl_bool m_flagIPv6;
+		sl_uint32 m_timeout;
+		sl_uint32 m_attemptsCount;
+		
+		Mutex m_lockRequests;
+		// lowercased host name -> request
+		CHashMap< String, Ref<_priv_DnsResolveRequest> > m_mapRequestsByName;
+		// question identifier -> request
+		CHashMap< sl_uint16, Ref<_priv_DnsResolveRequest> > m_mapRequestsById;
+		
+	};
+
 }
     
 #endif
@@ -149,6 +149,23 @@ namespace slib
 		
 	};
 	
+	enum class HttpContentEncoding
+	{
+		Identity = 0,
+		Gzip,
+		Deflate
+	};
+	
+	class SLIB_EXPORT HttpContentEncodings
+	{
+	public:
+		static String toString(HttpContentEncoding encoding);
+		
+		// chooses gzip or deflate (in this order) from the value of `Accept-Encoding` header, ignoring the codings having q=0
+		static HttpContentEncoding negotiate(const String& acceptEncoding);
+		
+	};
+	
 	
 	class SLIB_EXPORT HttpHeaders
 	{
@@ -160,6 +177,7 @@ namespace slib
 		static const String& TransferEncoding;
 		static const String& ContentEncoding;
 		static const String& Connection;
+		static const String& Vary;
 
 		static const String& Range;
 		static const String& ContentRange;
@@ -184,6 +202,18 @@ namespace slib
 	};
 	
 	
+	class SLIB_EXPORT HttpHeaderField
+	{
+	public:
+		sl_uint32 name;
+		sl_uint32 nameLength;
+		sl_uint32 value;
+		sl_uint32 valueLength;
+		
+	};
+	
+#define SLIB_HTTP_MAX_LAZY_HEADER_FIELDS 48
+	
 	class SLIB_EXPORT HttpRequest
 	{
 	public:
@@ -321,6 +351,13 @@ namespace slib
 		 */
 		sl_reg parseRequestPacket(const void* packet, sl_size size);
 		
+		/*
+		 Same as `parseRequestPacket()`, but the header fields are kept as offsets into `packet` (which must not be modified later)
+		 and the header map is built only when it is accessed as a whole or modified.
+		 Looking up a single header does not build the map.
+		 */
+		sl_reg parseRequestPacketLazily(const Memory& packet, sl_size size);
+		
 		template <class KT, class VT, class KEY_COMPARE>
 		static String buildFormUrlEncodedFromMap(const Map<KT, VT, KEY_COMPARE>& map);
 		
@@ -335,11 +372,27 @@ namespace slib
 		String m_query;
 		String m_requestVersion;
 		
-		HttpHeaderMap m_requestHeaders;
+		mutable HttpHeaderMap m_requestHeaders;
 		HashMap<String, String> m_parameters;
 		HashMap<String, String> m_queryParameters;
 		HashMap<String, String> m_postParameters;
 		
+		Memory m_requestPacket;
+		HttpHeaderField m_requestHeaderFields[SLIB_HTTP_MAX_LAZY_HEADER_FIELDS];
+		sl_uint32 m_countRequestHeaderFields;
+		mutable sl_bool m_flagLazyRequestHeaders;
+		
+	protected:
+		sl_reg _parseRequestLine(const void* packet, sl_size size);
+		
+		void _resetRequest();
+		
+		void _buildRequestHeaders() const;
+		
+		sl_int32 _findLazyRequestHeader(const String& name, sl_uint32 indexStart = 0) const;
+		
+		String _getLazyRequestHeaderValue(const HttpHeaderField& field) const;
+		
 	};
 	
 	class SLIB_EXPORT HttpResponse
@@ -438,6 +491,9 @@ namespace slib
 		
 		HttpHeaderMap m_responseHeaders;
 		
+	protected:
+		void _resetResponse();
+		
 	};
 	
 }
@@ -29,6 +29,7 @@
 #include "../crypto/zlib.h"
 
 #include "async.h"
+#include "http_common.h"
 
 namespace slib
 {
@@ -133,6 +134,41 @@ namespace slib
 		HttpContentReaderOnComplete m_onComplete;
 
 	};
+	
+	/*
+		Encodes the content written to the source stream by gzip/deflate compression and/or chunked transfer coding.
+		Each write is flushed to the stream (as one chunk when chunked), and `finish()` writes the end of the content.
+	*/
+	class SLIB_EXPORT HttpContentEncoder : public AsyncStreamFilter
+	{
+	protected:
+		HttpContentEncoder();
+		
+		~HttpContentEncoder();
+		
+	public:
+		static Ref<HttpContentEncoder> create(const Ref<AsyncStream>& io, HttpContentEncoding encoding, sl_bool flagChunked, sl_int32 compressionLevel = 6);
+		
+	public:
+		HttpContentEncoding getEncoding();
+		
+		sl_bool isChunked();
+		
+		// encodes without writing to the source stream. `flagFinish`: ends the compressed data and appends the last chunk
+		Memory encode(const void* data, sl_size size, sl_bool flagFinish);
+		
+		sl_bool finish(const Function<void(AsyncStreamResult*)>& callback);
+		
+	protected:
+		Memory filterWrite(const void* data, sl_uint32 size, Referable* userObject) override;
+		
+	protected:
+		HttpContentEncoding m_encoding;
+		sl_bool m_flagChunked;
+		ZlibCompress m_zlib;
+		sl_bool m_flagFinished;
+		
+	};
 
 }
 
@@ -78,6 +78,15 @@ namespace slib
 		
 		void completeResponse();
 		
+		/*
+			Sends the response header with `Transfer-Encoding: chunked` at the first call, and then the buffered output as one chunk.
+			`completeResponse()` sends the rest and the last chunk. Does nothing for HTTP/1.0 requests, which are sent at completion.
+			When the response is compressed, output added by `copyFrom()` or `copyFromFile()` is read through the encoder in order, and the completion waits for it.
+		*/
+		void flushResponse();
+		
+		sl_bool isChunkedResponse();
+		
 	public:
 		SLIB_BOOLEAN_PROPERTY(ClosingConnection);
 		SLIB_BOOLEAN_PROPERTY(ProcessingByThread);
@@ -85,14 +94,31 @@ namespace slib
 	protected:
 		HttpHeaderReader m_requestHeaderReader;
 		AtomicMemory m_requestHeader;
+		sl_size m_requestHeaderSize;
+		Memory m_requestHeaderArena;
 		sl_uint64 m_requestContentLength;
 		MemoryQueue m_requestBodyBuffer;
 		AtomicMemory m_requestBody;
 		sl_bool m_flagAsynchronousResponse;
+		sl_bool m_flagChunkedResponse;
+		Ref<HttpContentEncoder> m_encoderResponse;
+		// the stream being read through `m_encoderResponse`
+		Ref<AsyncStream> m_streamEncoding;
+		sl_uint64 m_sizeEncodingRemain;
+		Memory m_bufEncoding;
+		sl_bool m_flagEncodingFinish;
+		Memory m_responseHeaderPacket;
+		sl_bool m_flagResponseCompleted;
+		sl_bool m_flagKeepAlive;
 		
 	private:
 		WeakRef<HttpServiceConnection> m_connection;
 		
+	protected:
+		void _reset();
+		
+		sl_bool _setRequestHeader(const void* data, sl_size size);
+		
 		friend class HttpServiceConnection;
 		
 	};
@@ -146,6 +172,18 @@ namespace slib
 		Ref<AsyncOutput> m_output;
 		
 		AtomicRef<HttpServiceContext> m_contextCurrent;
+		AtomicRef<HttpServiceContext> m_contextReusable;
+		
+		// requests in flight, in the order of arrival. the responses are written from the front
+		CLinkedList< Ref<HttpServiceContext> > m_queueContexts;
+		// input which is not parsed while the queue is full
+		Memory m_bufPending;
+		sl_bool m_flagPausedInput;
+		// serializes the writing of the responses. `m_output` is never called under the lock of the connection
+		Mutex m_lockWrite;
+		
+		// the response waiting for the output to be drained before reading the next block of its stream
+		Ref<HttpServiceContext> m_contextEncodingWaiting;
 		
 		sl_bool m_flagClosed;
 		Memory m_bufRead;
@@ -155,17 +193,41 @@ namespace slib
 	protected:
 		void _read();
 		
+		Ref<HttpServiceContext> _createContext();
+		
 		void _processInput(const void* data, sl_uint32 size);
 		
+		sl_reg _processRequestInput(HttpService* service, const sl_uint8* data, sl_uint32 size, sl_bool& flagCompleted);
+		
+		void _processRequestError(HttpServiceContext* context, HttpStatus status);
+		
 		void _processContext(const Ref<HttpServiceContext>& context);
 		
 		void _completeResponse(HttpServiceContext* context);
 		
+		void _setResponseCompleted(HttpServiceContext* context);
+		
+		void _writeCompletedResponses();
+		
+		void _resumeInput();
+		
+		void _flushResponse(HttpServiceContext* context);
+		
+		sl_bool _writeResponseChunk(HttpServiceContext* context, sl_bool flagFinish);
+		
+		sl_bool _writeEncodedOutput(HttpServiceContext* context, sl_bool flagFinish);
+		
+		sl_bool _readEncodingStream(HttpServiceContext* context);
+		
+		HttpContentEncoding _getResponseEncoding(HttpServiceContext* context, sl_bool flagChunked);
+		
 	protected:
 		void onReadStream(AsyncStreamResult* result);
 
 		void onAsyncOutputEnd(AsyncOutput* output, sl_bool flagError);
 		
+		void onReadEncodingStream(AsyncStreamResult* result);
+		
 		friend class HttpServiceContext;
 		
 	};
@@ -209,9 +271,20 @@ namespace slib
 		sl_uint64 maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize;
 		
+		// requests in flight per connection (HTTP/1.1 pipelining). the connection stops reading while the limit is reached
+		sl_uint32 maxPipelinedRequestsCount;
+		
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
+		// compresses the responses by gzip or deflate negotiated from `Accept-Encoding`
+		sl_bool flagCompressResponse;
+		sl_int32 compressionLevel;
+		// not applied to chunked responses
+		sl_uint64 minimumCompressionSize;
+		// "text/*" matches all text types
+		List<String> compressibleContentTypes;
+		
 		sl_bool flagLogDebug;
 		
 		Function<sl_bool(HttpService*, HttpServiceContext*)> onRequest;
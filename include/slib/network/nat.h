@@ -32,6 +32,7 @@
 
 #include "../core/object.h"
 #include "../core/hash_map.h"
+#include "../core/spin_lock.h"
 
 /*
 	If you are usiing kernel-mode NAT on linux (for example on port range 40000~60000), following configuration will avoid to conflict with kernel-networking.
@@ -48,7 +49,7 @@ namespace slib
 	public:
 		sl_bool flagActive;
 		SocketAddress addressSource;
-		Time timeLastAccess;
+		sl_uint32 timeLastAccess; // tick count
 		
 	public:
 		_priv_NatTablePort();
@@ -57,6 +58,24 @@ namespace slib
 		
 	};
 	
+	class _priv_NatTableMappingShard
+	{
+	public:
+		SpinLock lock;
+		CHashMap< SocketAddress, sl_uint16 > mapPorts;
+		
+		_priv_NatTablePort* ports;
+		sl_uint32 nPorts;
+		sl_uint32 pos;
+		sl_uint16 portBegin;
+		
+	public:
+		_priv_NatTableMappingShard();
+		
+		~_priv_NatTableMappingShard();
+		
+	};
+	
 	class _priv_NatTableMapping : public Object
 	{
 	public:
@@ -65,22 +84,27 @@ namespace slib
 		~_priv_NatTableMapping();
 		
 	public:
-		void setup(sl_uint16 portBegin, sl_uint16 portEnd);
+		void setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeout);
+		
+		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port, sl_uint32 now);
 		
-		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port);
+		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address, sl_uint32 now);
 		
-		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
+		sl_size removeExpiredPorts(sl_uint32 now);
 		
 	protected:
-		CHashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		sl_bool _isExpired(const _priv_NatTablePort& port, sl_uint32 now);
 		
-		_priv_NatTablePort* m_ports;
-		sl_uint16 m_nPorts;
-		sl_uint16 m_pos;
+	protected:
+		_priv_NatTableMappingShard* m_shards;
+		sl_uint32 m_nShards;
+		sl_uint32 m_nPortsPerShard;
 		
 		sl_uint16 m_portBegin;
 		sl_uint16 m_portEnd;
 		
+		sl_uint32 m_timeout;
+		
 	};
 	
 	class SLIB_EXPORT NatTableParam
@@ -96,6 +120,13 @@ namespace slib
 		
 		sl_uint16 icmpEchoIdentifier;
 		
+		// idle time in milliseconds after which a mapped port can be reused (0: never expires)
+		sl_uint32 tcpMappingTimeout;
+		sl_uint32 udpMappingTimeout;
+		
+		// port ranges are split into independently locked shards, so that concurrent flows rarely contend
+		sl_uint32 mappingShardsCount;
+		
 	public:
 		NatTableParam();
 		
@@ -103,6 +134,23 @@ namespace slib
 		
 	};
 	
+	class SLIB_EXPORT NatTablePacket
+	{
+	public:
+		// IPv4 packet including header
+		sl_uint8* data;
+		sl_uint32 length;
+		
+		// output
+		sl_bool flagTranslated;
+		
+	public:
+		NatTablePacket();
+		
+		~NatTablePacket();
+		
+	};
+	
 	class SLIB_EXPORT NatTable : public Object
 	{
 	public:
@@ -113,6 +161,7 @@ namespace slib
 	public:
 		const NatTableParam& getParam() const;
 		
+		// should be called before translating packets
 		void setup(const NatTableParam& param);
 		
 	public:
@@ -120,8 +169,22 @@ namespace slib
 		
 		sl_bool translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent);
 		
+		// returns the count of translated packets
+		sl_uint32 translateOutgoingPackets(NatTablePacket* packets, sl_uint32 nPackets);
+		
+		// returns the count of translated packets
+		sl_uint32 translateIncomingPackets(NatTablePacket* packets, sl_uint32 nPackets);
+		
 		sl_uint16 getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address);
 		
+		// releases the port mappings idle for longer than the timeouts, returns the count of released mappings
+		sl_size removeExpiredMappings();
+		
+	protected:
+		sl_bool _translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent, sl_uint32 now);
+		
+		sl_bool _translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent, sl_uint32 now);
+		
 	protected:
 		NatTableParam m_param;
 		
@@ -137,6 +200,7 @@ namespace slib
 			sl_uint16 sequenceNumberTarget;
 		};
 		
+		SpinLock m_lockIcmpEcho;
 		CHashMap<IcmpEchoAddress, IcmpEchoElement> m_mapIcmpEchoOutgoing;
 		CHashMap<sl_uint32, IcmpEchoElement> m_mapIcmpEchoIncoming;
 		
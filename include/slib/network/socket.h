@@ -29,6 +29,8 @@
 #include "socket_address.h"
 #include "mac_address.h"
 
+#include "../core/memory.h"
+
 typedef int sl_socket;
 #define SLIB_SOCKET_INVALID_HANDLE (-1)
 
@@ -216,6 +218,9 @@ namespace slib
 		
 		sl_int32 send(const void* buf, sl_uint32 size);
 		
+		// sends the slices after skipping `offset` bytes, by one system call (sendmsg, WSASend)
+		sl_int32 sendVector(const MemoryData* slices, sl_size nSlices, sl_size offset = 0);
+		
 		sl_int32 receive(void* buf, sl_uint32 size);
 		
 		sl_int32 sendTo(const SocketAddress& address, const void* buf, sl_uint32 size);
@@ -135,6 +135,12 @@ namespace slib
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
 
+		// incrementally updates an internet checksum when a 16-bit word of the covered data is changed (RFC 1624)
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue);
+
+		// incrementally updates an internet checksum when a 32-bit word (for example, IPv4 address) of the covered data is changed (RFC 1624)
+		static sl_uint16 adjustChecksum32(sl_uint16 checksum, sl_uint32 oldValue, sl_uint32 newValue);
+
 	};
 
 	class SLIB_EXPORT IPv4Packet
@@ -194,6 +194,12 @@ namespace slib
 		
 		void drawRectangle(const Rectangle& rect, RenderProgramState2D_Position* programState, const DrawParam& param);
 		
+		/*
+			Rectangles, textures and glyphs without shader clipping are accumulated into a batch,
+			which is drawn when the texture is changed, on other kinds of drawing, and on `getEngine()`.
+		*/
+		void flush();
+		
 		
 	protected:
 		void onDraw(const Rectangle& rectDst, const Ref<Drawable>& src, const Rectangle& rectSrc, const DrawParam& param) override;
@@ -209,6 +215,11 @@ namespace slib
 		
 		void _fillRectangle(const Rectangle& rect, const Color& color);
 		
+		sl_bool _prepareBatch();
+		
+		// `transform`: unit square to viewport, `rectSrc`: (left, top, width, height) in texture coordinates
+		sl_bool _addQuadToBatch(const Matrix3& transform, const Ref<Texture>& texture, const Vector4& rectSrc, const Color4f& color);
+		
 	protected:
 		Ref<RenderEngine> m_engine;
 		sl_real m_width;
@@ -217,6 +228,13 @@ namespace slib
 		Ref<RenderCanvasState> m_state;
 		LinkedStack< Ref<RenderCanvasState> > m_stackStates;
 		
+		Ref<VertexBuffer> m_vbBatch;
+		Ref<IndexBuffer> m_ibBatch;
+		sl_uint32 m_nMaxBatchQuads;
+		sl_uint32 m_nBatchQuads;
+		// null for solid quads
+		Ref<Texture> m_textureBatch;
+		
 	};
 
 }
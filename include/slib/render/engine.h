@@ -209,7 +209,8 @@ namespace slib
 		OpenGL = 0x01010001,
 		OpenGL_ES = 0x01020001,
 		D3D9 = 0x02010901,
-		D3D11 = 0x02010B01
+		D3D11 = 0x02010B01,
+		Software = 0x03010001
 	};
 	
 	class SLIB_EXPORT RenderEngine : public Object
@@ -364,6 +365,11 @@ namespace slib
 		
 		sl_uint32 getCountOfDrawnPrimitivesOnLastScene();
 		
+		// total count of the draw calls (`drawPrimitive`) since creation or the last reset
+		sl_uint64 getCountOfDrawCalls();
+		
+		void resetCountOfDrawCalls();
+		
 		Ref<VertexBuffer> getDefaultVertexBufferForDrawRectangle2D();
 		
 		Ref<RenderProgram2D_Position> getDefaultRenderProgramForDrawRectangle2D();
@@ -376,6 +382,11 @@ namespace slib
 		
 		Ref<RenderProgram3D_Position> getDefaultRenderProgramForDrawLine3D();
 		
+		// indices for drawing batched quads (4 vertices per quad) as triangles
+		Ref<IndexBuffer> getDefaultIndexBufferForBatchQuads2D();
+		
+		sl_uint32 getMaxQuadsCountOfBatch2D();
+		
 	protected:
 		virtual Ref<RenderProgramInstance> _createProgramInstance(RenderProgram* program) = 0;
 		
@@ -424,6 +435,7 @@ namespace slib
 		// debug
 		sl_uint32 m_nCountDrawnElementsOnLastScene;
 		sl_uint32 m_nCountDrawnPrimitivesOnLastScene;
+		sl_uint64 m_nCountDrawCalls;
 		Time m_timeLastDebugText;
 		Ref<Texture> m_textureDebug;
 		Ref<Font> m_fontDebug;
@@ -437,6 +449,60 @@ namespace slib
 		AtomicRef<RenderProgram2D_Position> m_defaultRenderProgramForDrawLine2D;
 		AtomicRef<RenderProgram3D_Position> m_defaultRenderProgramForDrawLine3D;
 		
+		AtomicRef<IndexBuffer> m_defaultIndexBufferForBatchQuads2D;
+		
+	};
+	
+	class SLIB_EXPORT SoftwareRenderEngineParam
+	{
+	public:
+		// a new `Image` of `width` x `height` is created when `target` is null
+		Ref<Bitmap> target;
+		sl_uint32 width;
+		sl_uint32 height;
+		
+		// 0: count of the CPU cores
+		sl_uint32 threadsCount;
+		
+		// size of the square tiles rasterized in parallel
+		sl_uint32 tileSize;
+		
+	public:
+		SoftwareRenderEngineParam();
+		
+		~SoftwareRenderEngineParam();
+		
+	};
+	
+	/*
+		Renders on CPU into a `Bitmap`, without any graphics device.
+	 
+		The primitives are binned into screen tiles and rasterized by a thread pool when the scene ends (or when the pending primitives are too many).
+		The built-in programs (`RenderProgram2D_*`, `RenderProgram3D_*` and the programs of `RenderCanvas`) are shaded from their uniforms and attributes,
+		GLSL sources are not interpreted.
+	*/
+	class SLIB_EXPORT SoftwareRenderEngine : public RenderEngine
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		SoftwareRenderEngine();
+		
+		~SoftwareRenderEngine();
+		
+	public:
+		static Ref<SoftwareRenderEngine> create(const SoftwareRenderEngineParam& param);
+		
+		static Ref<SoftwareRenderEngine> create(sl_uint32 width, sl_uint32 height);
+		
+	public:
+		virtual Ref<Bitmap> getTarget() = 0;
+		
+		virtual sl_bool setTarget(const Ref<Bitmap>& target) = 0;
+		
+		// rasterizes the pending primitives into the target
+		virtual void flush() = 0;
+		
 	};
 	
 	template <class StateType>
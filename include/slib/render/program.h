@@ -28,6 +28,8 @@
 #include "base.h"
 #include "texture.h"
 
+#include "../core/array.h"
+#include "../core/memory.h"
 #include "../math/matrix4.h"
 #include "../graphics/color.h"
 
@@ -38,11 +40,28 @@ namespace slib
 	class RenderEngine;
 	class GLRenderEngine;
 
+	class SLIB_EXPORT RenderUniformValue
+	{
+	public:
+		Memory data;
+		sl_uint32 size;
+		Ref<Texture> texture;
+		
+	public:
+		RenderUniformValue();
+		
+		~RenderUniformValue();
+		
+	};
+	
 	class SLIB_EXPORT RenderProgramState : public Referable
 	{
 	public:
 		GLRenderEngine* gl_engine;
 		sl_uint32 gl_program;
+		
+		// uniform values stored for the engines shading on CPU (the location is the index of the state item)
+		Array<RenderUniformValue> sw_uniforms;
 
 	public:
 		RenderProgramState();
@@ -82,6 +101,9 @@ namespace slib
 		
 		void setUniformTextureArray(sl_int32 uniformLocation, const Ref<Texture>* textures, const sl_reg* samplers, sl_uint32 n);
 		
+	protected:
+		void _setSoftwareUniform(sl_int32 uniformLocation, const void* data, sl_uint32 size);
+		
 	};
 
 	class SLIB_EXPORT RenderProgramInstance : public RenderBaseObjectInstance
@@ -335,6 +357,33 @@ namespace slib
 	};
 
 
+	struct RenderVertex2D_PositionTextureColor
+	{
+		Vector2 position;
+		Vector2 texCoord;
+		Color4f color;
+	};
+
+	SLIB_RENDER_PROGRAM_STATE_BEGIN(RenderProgramState2D_PositionTextureColor, RenderVertex2D_PositionTextureColor)
+		SLIB_RENDER_PROGRAM_STATE_UNIFORM_MATRIX3(Transform, u_Transform)
+		SLIB_RENDER_PROGRAM_STATE_UNIFORM_TEXTURE(Texture, u_Texture)
+		SLIB_RENDER_PROGRAM_STATE_UNIFORM_VECTOR4(Color, u_Color)
+
+		SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(position, a_Position)
+		SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(texCoord, a_TexCoord)
+		SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(color, a_Color)
+	SLIB_RENDER_PROGRAM_STATE_END
+
+	class SLIB_EXPORT RenderProgram2D_PositionTextureColor : public RenderProgramT<RenderProgramState2D_PositionTextureColor>
+	{
+	public:
+		String getGLSLVertexShader(RenderEngine* engine) override;
+		
+		String getGLSLFragmentShader(RenderEngine* engine) override;
+		
+	};
+
+
 	struct RenderVertex2D_Position
 	{
 		Vector2 position;
@@ -390,6 +390,31 @@ namespace slib
 
 	SLIB_DEFINE_ROOT_OBJECT(AsyncStreamRequest)
 
+	static Memory _priv_AsyncStream_mergeSlices(const List<MemoryData>& slices)
+	{
+		ListElements<MemoryData> elements(slices);
+		if (elements.count == 1) {
+			return elements[0].getMemory();
+		}
+		sl_size size = 0;
+		sl_size i;
+		for (i = 0; i < elements.count; i++) {
+			size += elements[i].size;
+		}
+		if (!size || size > 0x40000000) {
+			return sl_null;
+		}
+		Memory mem = Memory::create(size);
+		if (mem.isNotNull()) {
+			sl_uint8* buf = (sl_uint8*)(mem.getData());
+			for (i = 0; i < elements.count; i++) {
+				Base::copyMemory(buf, elements[i].data, elements[i].size);
+				buf += elements[i].size;
+			}
+		}
+		return mem;
+	}
+
 	AsyncStreamRequest::AsyncStreamRequest(
 		const void* _data,
 		sl_uint32 _size,
@@ -418,6 +443,25 @@ namespace slib
 		return new AsyncStreamRequest(data, size, userObject, callback, sl_false);
 	}
 
+	Ref<AsyncStreamRequest> AsyncStreamRequest::createVectorWrite(
+		const List<MemoryData>& slices,
+		const Function<void(AsyncStreamResult*)>& callback)
+	{
+		sl_size size = 0;
+		ListElements<MemoryData> elements(slices);
+		for (sl_size i = 0; i < elements.count; i++) {
+			size += elements[i].size;
+		}
+		if (size > 0x40000000) {
+			return sl_null;
+		}
+		Ref<AsyncStreamRequest> ret = new AsyncStreamRequest(sl_null, (sl_uint32)size, sl_null, callback, sl_false);
+		if (ret.isNotNull()) {
+			ret->slices = slices;
+		}
+		return ret;
+	}
+
 	void AsyncStreamRequest::runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError)
 	{
 		if (callback.isNotNull()) {
@@ -463,6 +507,15 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamInstance::writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Memory mem = _priv_AsyncStream_mergeSlices(slices);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		return write(mem.getData(), (sl_uint32)(mem.getSize()), callback, mem.ref.get());
+	}
+
 	sl_bool AsyncStreamInstance::isSeekable()
 	{
 		return sl_false;
@@ -581,6 +634,15 @@ namespace slib
 		return read(mem.getData(), (sl_uint32)(size), callback, mem.ref.get());
 	}
 
+	sl_bool AsyncStream::writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Memory mem = _priv_AsyncStream_mergeSlices(slices);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		return write(mem.getData(), (sl_uint32)(mem.getSize()), callback, mem.ref.get());
+	}
+
 	sl_bool AsyncStream::writeFromMemory(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback)
 	{
 		sl_size size = mem.getSize();
@@ -670,6 +732,22 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->writev(slices, callback)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamBase::isSeekable()
 	{
 		Ref<AsyncStreamInstance> instance = getIoInstance();
@@ -1624,6 +1702,64 @@ namespace slib
 		return m_lengthOutput;
 	}
 
+	sl_bool AsyncOutputBuffer::mergeOutput(Memory& output)
+	{
+		ObjectLocker lock(this);
+		sl_size n = m_queueOutput.getCount();
+		if (!n) {
+			output.setNull();
+			return sl_true;
+		}
+		if (n > 1) {
+			return sl_false;
+		}
+		AsyncOutputBufferElement* element = m_queueOutput.getFront()->value.get();
+		if (!(element->isEmptyBody())) {
+			return sl_false;
+		}
+		output = element->getHeader().merge();
+		if (output.isNull() && m_lengthOutput) {
+			return sl_false;
+		}
+		m_lengthOutput = 0;
+		m_queueOutput.removeAll();
+		return sl_true;
+	}
+
+	sl_bool AsyncOutputBuffer::popFront(Memory& data, Ref<AsyncStream>& stream, sl_uint64& sizeStream)
+	{
+		ObjectLocker lock(this);
+		for (;;) {
+			Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getFront();
+			if (!link) {
+				return sl_false;
+			}
+			AsyncOutputBufferElement* element = link->value.get();
+			MemoryQueue& header = element->getHeader();
+			if (header.getSize() > 0) {
+				data = header.merge();
+				if (data.isNull()) {
+					return sl_false;
+				}
+				header.clear();
+				m_lengthOutput -= data.getSize();
+				stream.setNull();
+				sizeStream = 0;
+				return sl_true;
+			}
+			Ref<AsyncStream> body = element->getBody();
+			sl_uint64 sizeBody = element->getBodySize();
+			m_queueOutput.pop();
+			if (body.isNotNull() && sizeBody) {
+				m_lengthOutput -= sizeBody;
+				data.setNull();
+				stream = body;
+				sizeStream = sizeBody;
+				return sl_true;
+			}
+		}
+	}
+
 /**********************************************
 				AsyncOutput
 **********************************************/
@@ -1674,17 +1810,12 @@ namespace slib
 		if (param.stream.isNull()) {
 			return sl_null;
 		}
-		Memory buffer = Memory::create(param.bufferSize);
-		if (buffer.isNull()) {
-			return sl_null;
-		}
 		Ref<AsyncOutput> ret = new AsyncOutput;
 		if (ret.isNotNull()) {
 			ret->m_streamOutput = param.stream;
 			ret->m_bufferSize = param.bufferSize;
 			ret->m_bufferCount = param.bufferCount;
 			ret->m_onEnd = param.onEnd;
-			ret->m_bufWrite = buffer;
 			return ret;
 		}
 		return sl_null;
@@ -1726,15 +1857,18 @@ namespace slib
 				return;
 			}
 		}
-		MemoryQueue& header = m_elementWriting->getHeader();
-		if (header.getSize() > 0) {
-			sl_uint32 size = (sl_uint32)(header.pop(m_bufWrite.getData(), m_bufWrite.getSize()));
-			if (size > 0) {
+		if (m_elementWriting->getHeader().getSize() > 0) {
+			List<MemoryData> slices;
+			if (_popSlices(slices)) {
 				m_flagWriting = sl_true;
-				if (!(m_streamOutput->write(m_bufWrite.getData(), size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
+				if (!(m_streamOutput->writev(slices, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this)))) {
 					m_flagWriting = sl_false;
 					_onError();
 				}
+			} else {
+				// the popped memory is lost, so the rest can not be written in order
+				close();
+				_onError();
 			}
 		} else {
 			sl_uint64 sizeBody = m_elementWriting->getBodySize();
@@ -1760,6 +1894,96 @@ namespace slib
 		}
 	}
 
+	static void _priv_AsyncOutput_addMergedSlice(List<MemoryData>& slices, const Memory& memMerge, sl_size posEnd, sl_size size)
+	{
+		MemoryData slice;
+		slice.data = (sl_uint8*)(memMerge.getData()) + posEnd - size;
+		slice.size = size;
+		slice.refer = memMerge.ref;
+		slices.add_NoLock(slice);
+	}
+
+#define PRIV_ASYNC_OUTPUT_MAX_SLICES_COUNT 64
+#define PRIV_ASYNC_OUTPUT_MAX_VECTOR_SIZE 0x40000000
+#define PRIV_ASYNC_OUTPUT_SMALL_SLICE_SIZE 1024
+#define PRIV_ASYNC_OUTPUT_MERGE_BUFFER_SIZE 0x4000
+
+	sl_bool AsyncOutput::_popSlices(List<MemoryData>& slices)
+	{
+		// gathers the memory of the writing element and the following memory-only elements, to be sent by one vectored write.
+		// neighboring small slices are copied into a merge buffer, so that they take one slot of the vector
+		sl_size sizeTotal = 0;
+		sl_size nSlices = 0;
+		Memory memMerge;
+		sl_size posMerge = 0;
+		sl_size sizeMerging = 0;
+		while (nSlices < PRIV_ASYNC_OUTPUT_MAX_SLICES_COUNT - 1 && sizeTotal < PRIV_ASYNC_OUTPUT_MAX_VECTOR_SIZE) {
+			MemoryQueue& header = m_elementWriting->getHeader();
+			if (header.getSize() > 0) {
+				MemoryData slice;
+				if (!(header.pop(slice))) {
+					continue;
+				}
+				sl_size sizeLimit = PRIV_ASYNC_OUTPUT_MAX_VECTOR_SIZE - sizeTotal;
+				if (slice.size <= PRIV_ASYNC_OUTPUT_SMALL_SLICE_SIZE && slice.size <= sizeLimit) {
+					if (memMerge.isNull() || posMerge + slice.size > PRIV_ASYNC_OUTPUT_MERGE_BUFFER_SIZE) {
+						if (sizeMerging) {
+							_priv_AsyncOutput_addMergedSlice(slices, memMerge, posMerge, sizeMerging);
+							nSlices++;
+							sizeMerging = 0;
+						}
+						memMerge = Memory::create(PRIV_ASYNC_OUTPUT_MERGE_BUFFER_SIZE);
+						posMerge = 0;
+						if (memMerge.isNull()) {
+							return sl_false;
+						}
+					}
+					Base::copyMemory((sl_uint8*)(memMerge.getData()) + posMerge, slice.data, slice.size);
+					posMerge += slice.size;
+					sizeMerging += slice.size;
+					sizeTotal += slice.size;
+					continue;
+				}
+				if (sizeMerging) {
+					_priv_AsyncOutput_addMergedSlice(slices, memMerge, posMerge, sizeMerging);
+					nSlices++;
+					sizeMerging = 0;
+				}
+				if (slice.size > sizeLimit) {
+					// the rest is written before the remaining of the element
+					Ref<AsyncOutputBufferElement> rest = new AsyncOutputBufferElement(slice.sub(sizeLimit));
+					if (rest.isNull()) {
+						return sl_false;
+					}
+					m_queueOutput.pushFront(m_elementWriting);
+					m_queueOutput.pushFront(rest);
+					m_elementWriting.setNull();
+					slice.size = sizeLimit;
+					return slices.add_NoLock(slice);
+				}
+				if (!(slices.add_NoLock(slice))) {
+					return sl_false;
+				}
+				nSlices++;
+				sizeTotal += slice.size;
+			} else {
+				if (!(m_elementWriting->isEmptyBody())) {
+					break;
+				}
+				Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getFront();
+				if (!link || link->value->getHeader().getSize() == 0) {
+					break;
+				}
+				m_queueOutput.pop(&m_elementWriting);
+			}
+		}
+		if (sizeMerging) {
+			_priv_AsyncOutput_addMergedSlice(slices, memMerge, posMerge, sizeMerging);
+			nSlices++;
+		}
+		return nSlices > 0;
+	}
+
 	void AsyncOutput::onAsyncCopyEnd(AsyncCopy* task, sl_bool flagError)
 	{
 		m_flagWriting = sl_false;
@@ -37,6 +37,10 @@
 
 #include <string>
 
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#endif
+
 #ifdef SLIB_PLATFORM_IS_WINDOWS
 #	include "slib/core/platform_windows.h"
 #endif
@@ -424,6 +428,99 @@ namespace slib
 		return std::char_traits<sl_int64>::find(m, count, pattern);
 	}
 
+	const sl_uint8* Base::findMemory(const void* _mem, sl_size size, const void* _pattern, sl_size sizePattern) noexcept
+	{
+		const sl_uint8* mem = (const sl_uint8*)_mem;
+		const sl_uint8* pattern = (const sl_uint8*)_pattern;
+		if (!sizePattern) {
+			return mem;
+		}
+		if (size < sizePattern) {
+			return sl_null;
+		}
+		if (sizePattern == 1) {
+			return findMemory(mem, pattern[0], size);
+		}
+		// candidates of the start position: [mem, last)
+		const sl_uint8* last = mem + (size - sizePattern + 1);
+#if defined(SLIB_ARCH_IS_X64)
+		{
+			// compares the first and last bytes of the pattern at 16 positions at once
+			__m128i f = _mm_set1_epi8((char)(pattern[0]));
+			__m128i l = _mm_set1_epi8((char)(pattern[sizePattern - 1]));
+			while (last - mem >= 16) {
+				__m128i a = _mm_loadu_si128((const __m128i*)mem);
+				__m128i b = _mm_loadu_si128((const __m128i*)(mem + sizePattern - 1));
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, f), _mm_cmpeq_epi8(b, l))));
+				while (mask) {
+					sl_uint32 i = Math::getLeastSignificantBits32(mask);
+					if (equalsMemory(mem + i + 1, pattern + 1, sizePattern - 2)) {
+						return mem + i;
+					}
+					mask &= mask - 1;
+				}
+				mem += 16;
+			}
+		}
+#endif
+		while (mem < last) {
+			const sl_uint8* q = findMemory(mem, pattern[0], last - mem);
+			if (!q) {
+				return sl_null;
+			}
+			if (equalsMemory(q + 1, pattern + 1, sizePattern - 1)) {
+				return q;
+			}
+			mem = q + 1;
+		}
+		return sl_null;
+	}
+
+	const sl_uint16* Base::findMemory2(const sl_uint16* mem, sl_size count, const sl_uint16* pattern, sl_size countPattern) noexcept
+	{
+		if (!countPattern) {
+			return mem;
+		}
+		if (count < countPattern) {
+			return sl_null;
+		}
+		if (countPattern == 1) {
+			return findMemory2(mem, pattern[0], count);
+		}
+		const sl_uint16* last = mem + (count - countPattern + 1);
+#if defined(SLIB_ARCH_IS_X64)
+		{
+			// 8 positions at once, each comparison sets 2 bits in the mask
+			__m128i f = _mm_set1_epi16((short)(pattern[0]));
+			__m128i l = _mm_set1_epi16((short)(pattern[countPattern - 1]));
+			while (last - mem >= 8) {
+				__m128i a = _mm_loadu_si128((const __m128i*)mem);
+				__m128i b = _mm_loadu_si128((const __m128i*)(mem + countPattern - 1));
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(a, f), _mm_cmpeq_epi16(b, l)))) & 0x5555;
+				while (mask) {
+					sl_uint32 i = Math::getLeastSignificantBits32(mask) >> 1;
+					if (equalsMemory2(mem + i + 1, pattern + 1, countPattern - 2)) {
+						return mem + i;
+					}
+					mask &= mask - 1;
+				}
+				mem += 8;
+			}
+		}
+#endif
+		while (mem < last) {
+			const sl_uint16* q = findMemory2(mem, pattern[0], last - mem);
+			if (!q) {
+				return sl_null;
+			}
+			if (equalsMemory2(q + 1, pattern + 1, countPattern - 1)) {
+				return q;
+			}
+			mem = q + 1;
+		}
+		return sl_null;
+	}
+
 	const sl_uint8* Base::findMemoryReverse(const void* mem, sl_uint8 pattern, sl_size count) noexcept
 	{
 		sl_uint8* m = (sl_uint8*)mem;
@@ -23,9 +23,68 @@
 #include "slib/core/charset.h"
 #include "slib/core/base.h"
 
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#endif
+
 namespace slib
 {
 	
+	sl_bool Charsets::checkUtf8(const sl_char8* _utf8, sl_size len)
+	{
+		const sl_uint8* utf8 = (const sl_uint8*)_utf8;
+		sl_size i = 0;
+		while (i < len) {
+#if defined(SLIB_ARCH_IS_X64)
+			// skips 16 ASCII bytes at once
+			while (i + 16 <= len && !(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(utf8 + i))))) {
+				i += 16;
+			}
+			if (i >= len) {
+				break;
+			}
+#endif
+			sl_uint32 ch = utf8[i];
+			if (ch < 0x80) {
+				i++;
+				continue;
+			}
+			sl_size k;
+			sl_uint32 min;
+			if (ch >= 0xC2 && ch < 0xE0) {
+				k = 1;
+				min = 0x80;
+				ch &= 0x1F;
+			} else if (ch >= 0xE0 && ch < 0xF0) {
+				k = 2;
+				min = 0x800;
+				ch &= 0x0F;
+			} else if (ch >= 0xF0 && ch < 0xF5) {
+				k = 3;
+				min = 0x10000;
+				ch &= 0x07;
+			} else {
+				return sl_false;
+			}
+			if (i + k >= len) {
+				return sl_false;
+			}
+			for (sl_size j = 1; j <= k; j++) {
+				sl_uint32 c = utf8[i + j];
+				if ((c & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				ch = (ch << 6) | (c & 0x3F);
+			}
+			if (ch < min || ch > 0x10FFFF || (ch >= 0xD800 && ch < 0xE000)) {
+				// overlong form, out of range or surrogate
+				return sl_false;
+			}
+			i += k + 1;
+		}
+		return sl_true;
+	}
+
 	sl_size Charsets::utf8ToUtf16(const sl_char8* utf8, sl_reg lenUtf8, sl_char16* utf16, sl_reg lenUtf16Buffer)
 	{
 		if (lenUtf8 < 0) {
@@ -35,6 +94,22 @@ namespace slib
 		for (sl_reg i = 0; i < lenUtf8 && (lenUtf16Buffer < 0 || n < lenUtf16Buffer); i++) {
 			sl_uint32 ch = (sl_uint32)((sl_uint8)utf8[i]);
 			if (ch < 0x80) {
+#if defined(SLIB_ARCH_IS_X64)
+				// widens 16 ASCII characters at once
+				if (i + 16 <= lenUtf8 && (lenUtf16Buffer < 0 || n + 16 <= lenUtf16Buffer)) {
+					__m128i v = _mm_loadu_si128((const __m128i*)(utf8 + i));
+					if (!(_mm_movemask_epi8(v))) {
+						if (utf16) {
+							__m128i zero = _mm_setzero_si128();
+							_mm_storeu_si128((__m128i*)(utf16 + n), _mm_unpacklo_epi8(v, zero));
+							_mm_storeu_si128((__m128i*)(utf16 + n + 8), _mm_unpackhi_epi8(v, zero));
+						}
+						n += 16;
+						i += 15;
+						continue;
+					}
+				}
+#endif
 				if (utf16) {
 					utf16[n++] = (sl_char16)ch;
 				} else {
@@ -165,6 +240,21 @@ namespace slib
 		for (sl_reg i = 0; i < lenUtf16 && (lenUtf8Buffer < 0 || n < lenUtf8Buffer); i++) {
 			sl_uint32 ch = (sl_uint32)(utf16[i]);
 			if (ch < 0x80) {
+#if defined(SLIB_ARCH_IS_X64)
+				// narrows 8 ASCII characters at once
+				if (i + 8 <= lenUtf16 && (lenUtf8Buffer < 0 || n + 8 <= lenUtf8Buffer)) {
+					__m128i v = _mm_loadu_si128((const __m128i*)(utf16 + i));
+					__m128i nonAscii = _mm_and_si128(v, _mm_set1_epi16((short)0xFF80));
+					if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) == 0xFFFF) {
+						if (utf8) {
+							_mm_storel_epi64((__m128i*)(utf8 + n), _mm_packus_epi16(v, v));
+						}
+						n += 8;
+						i += 7;
+						continue;
+					}
+				}
+#endif
 				if (utf8) {
 					utf8[n++] = (sl_char8)(ch);
 				} else {
@@ -24,6 +24,7 @@
 #include "slib/core/hash_table.h"
 
 #include "slib/core/math.h"
+#include "slib/core/mio.h"
 
 namespace slib
 {
@@ -69,6 +70,195 @@ namespace slib
 #endif
 	}
 
+
+	/****************************************************
+	 
+		wyhash (final version 4)
+	 
+	 https://github.com/wangyi-fudan/wyhash
+	 
+	 Reads 8 bytes per step and mixes by 64x64->128 multiplication,
+	 much faster than FNV-1a on keys longer than a few bytes.
+	 
+	****************************************************/
+	
+	#define PRIV_WYHASH_S0 SLIB_UINT64(0xa0761d6478bd642f)
+	#define PRIV_WYHASH_S1 SLIB_UINT64(0xe7037ed1a0b428db)
+	#define PRIV_WYHASH_S2 SLIB_UINT64(0x8ebc6af09c88c6e3)
+	#define PRIV_WYHASH_S3 SLIB_UINT64(0x589965cc75374cc3)
+	
+	SLIB_INLINE static sl_uint64 _priv_wyhash_mix(sl_uint64 a, sl_uint64 b) noexcept
+	{
+		sl_uint64 high, low;
+		Math::mul64(a, b, high, low);
+		return high ^ low;
+	}
+	
+	SLIB_INLINE static sl_uint64 _priv_wyhash_read4(const sl_uint8* p) noexcept
+	{
+		return MIO::readUint32LE(p);
+	}
+	
+	sl_uint64 HashBytesFast64(const void* _buf, sl_size n, sl_uint64 seed) noexcept
+	{
+		const sl_uint8* p = (const sl_uint8*)_buf;
+		seed ^= _priv_wyhash_mix(seed ^ PRIV_WYHASH_S0, PRIV_WYHASH_S1);
+		sl_uint64 a, b;
+		if (n <= 16) {
+			if (n >= 4) {
+				sl_size k = (n >> 3) << 2;
+				a = (_priv_wyhash_read4(p) << 32) | _priv_wyhash_read4(p + k);
+				b = (_priv_wyhash_read4(p + n - 4) << 32) | _priv_wyhash_read4(p + n - 4 - k);
+			} else if (n > 0) {
+				a = ((sl_uint64)(p[0]) << 16) | ((sl_uint64)(p[n >> 1]) << 8) | p[n - 1];
+				b = 0;
+			} else {
+				a = b = 0;
+			}
+		} else {
+			sl_size i = n;
+			if (i > 48) {
+				sl_uint64 see1 = seed, see2 = seed;
+				do {
+					seed = _priv_wyhash_mix(MIO::readUint64LE(p) ^ PRIV_WYHASH_S1, MIO::readUint64LE(p + 8) ^ seed);
+					see1 = _priv_wyhash_mix(MIO::readUint64LE(p + 16) ^ PRIV_WYHASH_S2, MIO::readUint64LE(p + 24) ^ see1);
+					see2 = _priv_wyhash_mix(MIO::readUint64LE(p + 32) ^ PRIV_WYHASH_S3, MIO::readUint64LE(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i > 48);
+				seed ^= see1 ^ see2;
+			}
+			while (i > 16) {
+				seed = _priv_wyhash_mix(MIO::readUint64LE(p) ^ PRIV_WYHASH_S1, MIO::readUint64LE(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = MIO::readUint64LE(p + i - 16);
+			b = MIO::readUint64LE(p + i - 8);
+		}
+		Math::mul64(a ^ PRIV_WYHASH_S1, b ^ seed, b, a);
+		return _priv_wyhash_mix(a ^ PRIV_WYHASH_S0 ^ (sl_uint64)n, b ^ PRIV_WYHASH_S1);
+	}
+	
+	sl_size HashBytesFast(const void* buf, sl_size n) noexcept
+	{
+#ifdef SLIB_ARCH_IS_64BIT
+		return (sl_size)(HashBytesFast64(buf, n));
+#else
+		sl_uint64 h = HashBytesFast64(buf, n);
+		return (sl_size)((sl_uint32)(h >> 32) ^ (sl_uint32)h);
+#endif
+	}
+	
+	void HashBytesFastStream::start(sl_size totalSize, sl_uint64 seed) noexcept
+	{
+		m_seed = seed ^ _priv_wyhash_mix(seed ^ PRIV_WYHASH_S0, PRIV_WYHASH_S1);
+		m_see1 = m_seed;
+		m_see2 = m_seed;
+		m_sizeTotal = totalSize;
+		m_sizeProcessed = 0;
+		m_sizePending = 0;
+	}
+	
+	// follows the block schedule of HashBytesFast64(), which depends on the total size
+	sl_size HashBytesFastStream::_getBlockSize() noexcept
+	{
+		sl_size remain = m_sizeTotal - m_sizeProcessed;
+		if (m_sizeTotal > 48 && remain > 48) {
+			return 48;
+		}
+		if (m_sizeTotal > 16 && remain > 16) {
+			return 16;
+		}
+		return 0;
+	}
+	
+	void HashBytesFastStream::_processBlock(const sl_uint8* p, sl_size n) noexcept
+	{
+		if (n == 48) {
+			m_seed = _priv_wyhash_mix(MIO::readUint64LE(p) ^ PRIV_WYHASH_S1, MIO::readUint64LE(p + 8) ^ m_seed);
+			m_see1 = _priv_wyhash_mix(MIO::readUint64LE(p + 16) ^ PRIV_WYHASH_S2, MIO::readUint64LE(p + 24) ^ m_see1);
+			m_see2 = _priv_wyhash_mix(MIO::readUint64LE(p + 32) ^ PRIV_WYHASH_S3, MIO::readUint64LE(p + 40) ^ m_see2);
+			m_sizeProcessed += 48;
+			if (m_sizeTotal - m_sizeProcessed <= 48) {
+				m_seed ^= m_see1 ^ m_see2;
+			}
+		} else {
+			m_seed = _priv_wyhash_mix(MIO::readUint64LE(p) ^ PRIV_WYHASH_S1, MIO::readUint64LE(p + 8) ^ m_seed);
+			m_sizeProcessed += 16;
+		}
+		// the final step reads the last 16 bytes, which may overlap the last block
+		Base::copyMemory(m_last, p + n - 16, 16);
+	}
+	
+	void HashBytesFastStream::update(const void* _buf, sl_size n) noexcept
+	{
+		const sl_uint8* p = (const sl_uint8*)_buf;
+		while (n) {
+			sl_size sizeBlock = _getBlockSize();
+			if (!sizeBlock) {
+				// tail of 16 bytes at most
+				sl_size m = Math::min(n, (sl_size)(16 - m_sizePending));
+				Base::copyMemory(m_pending + m_sizePending, p, m);
+				m_sizePending += m;
+				return;
+			}
+			if (!m_sizePending && n >= sizeBlock) {
+				_processBlock(p, sizeBlock);
+				p += sizeBlock;
+				n -= sizeBlock;
+			} else {
+				sl_size m = Math::min(n, sizeBlock - m_sizePending);
+				Base::copyMemory(m_pending + m_sizePending, p, m);
+				m_sizePending += m;
+				p += m;
+				n -= m;
+				if (m_sizePending == sizeBlock) {
+					m_sizePending = 0;
+					_processBlock(m_pending, sizeBlock);
+				}
+			}
+		}
+	}
+	
+	sl_uint64 HashBytesFastStream::finish64() noexcept
+	{
+		sl_size n = m_sizeTotal;
+		sl_uint64 a, b;
+		if (n <= 16) {
+			const sl_uint8* p = m_pending;
+			if (n >= 4) {
+				sl_size k = (n >> 3) << 2;
+				a = (_priv_wyhash_read4(p) << 32) | _priv_wyhash_read4(p + k);
+				b = (_priv_wyhash_read4(p + n - 4) << 32) | _priv_wyhash_read4(p + n - 4 - k);
+			} else if (n > 0) {
+				a = ((sl_uint64)(p[0]) << 16) | ((sl_uint64)(p[n >> 1]) << 8) | p[n - 1];
+				b = 0;
+			} else {
+				a = b = 0;
+			}
+		} else {
+			sl_uint8 tail[16];
+			sl_size r = m_sizePending;
+			Base::copyMemory(tail, m_last + r, 16 - r);
+			Base::copyMemory(tail + 16 - r, m_pending, r);
+			a = MIO::readUint64LE(tail);
+			b = MIO::readUint64LE(tail + 8);
+		}
+		Math::mul64(a ^ PRIV_WYHASH_S1, b ^ m_seed, b, a);
+		return _priv_wyhash_mix(a ^ PRIV_WYHASH_S0 ^ (sl_uint64)n, b ^ PRIV_WYHASH_S1);
+	}
+	
+	sl_size HashBytesFastStream::finish() noexcept
+	{
+#ifdef SLIB_ARCH_IS_64BIT
+		return (sl_size)(finish64());
+#else
+		sl_uint64 h = finish64();
+		return (sl_size)((sl_uint32)(h >> 32) ^ (sl_uint32)h);
+#endif
+	}
+
 	
 	#define PRIV_SLIB_HASHTABLE_MIN_CAPACITY 16
 	#define PRIV_SLIB_HASHTABLE_LOAD_FACTOR_UP 0.75f
@@ -739,6 +739,21 @@ namespace slib
 		return parseJson(String16((sl_char8*)(mem.getData()), mem.getSize()));
 	}
 
+	sl_bool Json::deserialize(MemoryReader* reader, Json& _out)
+	{
+		return Variant::deserialize(reader, _out);
+	}
+
+	Json Json::deserialize(const void* data, sl_size size)
+	{
+		return Variant::deserialize(data, size);
+	}
+
+	Json Json::deserialize(const Memory& mem)
+	{
+		return Variant::deserialize(mem);
+	}
+
 
 	String Json::toString() const
 	{
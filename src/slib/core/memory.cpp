@@ -662,4 +662,140 @@ namespace slib
 		return merge_NoLock();
 	}
 
+/*******************************************
+			MemoryPool
+*******************************************/
+
+	// referred by the memory objects sharing the block (including sub-memories)
+	class _priv_MemoryPoolLease : public Referable
+	{
+	public:
+		Ref<MemoryPool> m_pool;
+		void* m_block;
+		
+	public:
+		_priv_MemoryPoolLease(MemoryPool* pool, void* block) : m_pool(pool), m_block(block)
+		{
+		}
+		
+		~_priv_MemoryPoolLease()
+		{
+			m_pool->_recycle(m_block);
+		}
+		
+	};
+
+	SLIB_DEFINE_OBJECT(MemoryPool, Object)
+	
+	MemoryPool::MemoryPool()
+	{
+		m_sizeBlock = 0;
+		m_maxFreeBlocks = 0;
+		m_freeHead = sl_null;
+		m_nFreeBlocks = 0;
+		m_nAllocatedBlocks = 0;
+	}
+	
+	MemoryPool::~MemoryPool()
+	{
+		clear();
+	}
+	
+	Ref<MemoryPool> MemoryPool::create(sl_size sizeBlock, sl_uint32 maxFreeBlocksCount)
+	{
+		if (!sizeBlock) {
+			return sl_null;
+		}
+		if (sizeBlock < sizeof(void*)) {
+			sizeBlock = sizeof(void*);
+		}
+		Ref<MemoryPool> ret = new MemoryPool;
+		if (ret.isNotNull()) {
+			ret->m_sizeBlock = sizeBlock;
+			ret->m_maxFreeBlocks = maxFreeBlocksCount;
+		}
+		return ret;
+	}
+	
+	sl_size MemoryPool::getBlockSize()
+	{
+		return m_sizeBlock;
+	}
+	
+	Memory MemoryPool::allocate(sl_size size)
+	{
+		if (!size || size > m_sizeBlock) {
+			return sl_null;
+		}
+		void* block;
+		{
+			ObjectLocker lock(this);
+			block = m_freeHead;
+			if (block) {
+				m_freeHead = *((void**)block);
+				m_nFreeBlocks--;
+			}
+			m_nAllocatedBlocks++;
+		}
+		if (!block) {
+			block = Base::createMemory(m_sizeBlock);
+		}
+		if (block) {
+			Ref<_priv_MemoryPoolLease> lease = new _priv_MemoryPoolLease(this, block);
+			if (lease.isNotNull()) {
+				// if failed, the block is recycled by the lease
+				return Memory::createStatic(block, size, lease.get());
+			}
+			Base::freeMemory(block);
+		}
+		ObjectLocker lock(this);
+		m_nAllocatedBlocks--;
+		return sl_null;
+	}
+	
+	Memory MemoryPool::allocate()
+	{
+		return allocate(m_sizeBlock);
+	}
+	
+	sl_size MemoryPool::getFreeBlocksCount()
+	{
+		return m_nFreeBlocks;
+	}
+	
+	sl_size MemoryPool::getAllocatedBlocksCount()
+	{
+		return m_nAllocatedBlocks;
+	}
+	
+	void MemoryPool::clear()
+	{
+		void* block;
+		{
+			ObjectLocker lock(this);
+			block = m_freeHead;
+			m_freeHead = sl_null;
+			m_nFreeBlocks = 0;
+		}
+		while (block) {
+			void* next = *((void**)block);
+			Base::freeMemory(block);
+			block = next;
+		}
+	}
+	
+	void MemoryPool::_recycle(void* block)
+	{
+		ObjectLocker lock(this);
+		m_nAllocatedBlocks--;
+		if (!m_maxFreeBlocks || m_nFreeBlocks < m_maxFreeBlocks) {
+			*((void**)block) = m_freeHead;
+			m_freeHead = block;
+			m_nFreeBlocks++;
+			return;
+		}
+		lock.unlock();
+		Base::freeMemory(block);
+	}
+	
 }
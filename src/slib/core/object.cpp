@@ -98,6 +98,15 @@ namespace slib
 			map->remove_NoLock(name);
 		}
 	}
+	
+	void Object::clearAllProperties() noexcept
+	{
+		SpinLocker lock(m_locker.getSpinLock());
+		if (m_properties) {
+			CHashMap<String, Variant>* map = static_cast<CHashMap<String, Variant>*>(m_properties);
+			map->removeAll_NoLock();
+		}
+	}
 
 	
 	ObjectLocker::ObjectLocker() noexcept
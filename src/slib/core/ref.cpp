@@ -22,6 +22,12 @@
 
 #include "slib/core/ref.h"
 
+#include "slib/core/system.h"
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#include <windows.h>
+#endif
+
 #define PRIV_SIGNATURE 0x15181289
 
 namespace slib
@@ -30,11 +36,126 @@ namespace slib
 	struct _priv_Ref_Const
 	{
 		void* ptr;
-		sl_int32 lock;
+		sl_int64 lock;
 	};
 
 	const _priv_Ref_Const _priv_Ref_Null = {0, 0};
 
+#define PRIV_ATOMIC_REF_READER 1
+#define PRIV_ATOMIC_REF_DRAINING ((sl_int64)1 << 24)
+#define PRIV_ATOMIC_REF_COUNT_MASK 0xFFFFFF
+
+	SLIB_INLINE static sl_int64 _priv_AtomicRef_FetchAdd(sl_int64* p, sl_int64 n) noexcept
+	{
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		return (sl_int64)(InterlockedExchangeAdd64((LONGLONG*)p, (LONGLONG)n));
+#else
+		return __atomic_fetch_add(p, n, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static sl_int64 _priv_AtomicRef_Load(sl_int64* p) noexcept
+	{
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		return (sl_int64)(InterlockedCompareExchange64((LONGLONG*)p, 0, 0));
+#else
+		return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	// on failure, `expected` is updated to the current value
+	SLIB_INLINE static sl_bool _priv_AtomicRef_CompareExchange(sl_int64* p, sl_int64& expected, sl_int64 value) noexcept
+	{
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		sl_int64 before = (sl_int64)(InterlockedCompareExchange64((LONGLONG*)p, (LONGLONG)value, (LONGLONG)expected));
+		if (before == expected) {
+			return sl_true;
+		}
+		expected = before;
+		return sl_false;
+#else
+		return __atomic_compare_exchange_n(p, &expected, value, sl_false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _priv_AtomicRef_GetEpoch(sl_int64 state) noexcept
+	{
+		return (sl_uint32)((sl_uint64)state >> 48);
+	}
+
+	SLIB_INLINE static sl_int64 _priv_AtomicRef_GetCurrentCount(sl_int64 state) noexcept
+	{
+		return state & PRIV_ATOMIC_REF_COUNT_MASK;
+	}
+
+	SLIB_INLINE static sl_int64 _priv_AtomicRef_GetDrainingCount(sl_int64 state) noexcept
+	{
+		return (state >> 24) & PRIV_ATOMIC_REF_COUNT_MASK;
+	}
+
+	void* _priv_AtomicRef_Readers::acquire(void* const* ptr, sl_uint32& epoch) const noexcept
+	{
+		// sequentially consistent with `exchange()`: the writer sees this reader if it loads the replaced pointer
+		sl_int64 state = _priv_AtomicRef_FetchAdd(&m_state, PRIV_ATOMIC_REF_READER);
+		epoch = _priv_AtomicRef_GetEpoch(state);
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		return InterlockedCompareExchangePointer((PVOID*)ptr, sl_null, sl_null);
+#else
+		return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	void _priv_AtomicRef_Readers::release(sl_uint32 epoch) const noexcept
+	{
+		sl_int64 state = _priv_AtomicRef_Load(&m_state);
+		for (;;) {
+			// a writer has moved this reader to the draining count if the epoch has changed since `acquire()`
+			sl_int64 n = _priv_AtomicRef_GetEpoch(state) == epoch ? PRIV_ATOMIC_REF_READER : PRIV_ATOMIC_REF_DRAINING;
+			if (_priv_AtomicRef_CompareExchange(&m_state, state, state - n)) {
+				return;
+			}
+		}
+	}
+
+	void* _priv_AtomicRef_Readers::exchange(void** ptr, void* value) const noexcept
+	{
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+		void* before = InterlockedExchangePointer((PVOID*)ptr, value);
+#else
+		void* before = __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+		if (!before) {
+			return before;
+		}
+		sl_int64 state = _priv_AtomicRef_Load(&m_state);
+		for (;;) {
+			sl_int64 nCurrent = _priv_AtomicRef_GetCurrentCount(state);
+			if (!nCurrent) {
+				break;
+			}
+			// starts a new epoch; readers entering from now on have loaded the new pointer
+			sl_int64 nDraining = _priv_AtomicRef_GetDrainingCount(state) + nCurrent;
+			sl_int64 next = (sl_int64)(((sl_uint64)((_priv_AtomicRef_GetEpoch(state) + 1) & 0xFFFF) << 48) | ((sl_uint64)nDraining << 24));
+			if (_priv_AtomicRef_CompareExchange(&m_state, state, next)) {
+				state = next;
+				break;
+			}
+		}
+		// only the readers which entered before the exchange are drained, so this wait is bounded
+		sl_uint32 count = 0;
+		while (_priv_AtomicRef_GetDrainingCount(state)) {
+			System::yield(count);
+			count++;
+			state = _priv_AtomicRef_Load(&m_state);
+		}
+		return before;
+	}
+
+	_priv_AtomicRef_Readers& _priv_AtomicRef_Readers::operator=(const _priv_AtomicRef_Readers& other) noexcept
+	{
+		return *this;
+	}
+
 	Referable::Referable() noexcept
 	{
 #ifdef SLIB_DEBUG_REFERENCE
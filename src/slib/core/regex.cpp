@@ -23,73 +23,1508 @@
 #include "slib/core/regex.h"
 
 #include "slib/core/safe_static.h"
+#include "slib/core/hash_map.h"
+#include "slib/core/scoped.h"
+#include "slib/core/sort.h"
+#include "slib/core/math.h"
 
 #include <regex>
 
+#define PRIV_REGEX_MAX_PROGRAM_SIZE 100000
+#define PRIV_REGEX_MAX_NESTING 250
+#define PRIV_REGEX_MAX_REPEAT 100000
+#define PRIV_REGEX_MAX_DFA_STATES 4096
+#define PRIV_REGEX_CACHE_SIZE 256
+
+#define PRIV_REGEX_DFA_MATCH 1
+#define PRIV_REGEX_DFA_MATCH_AT_END 2
+
 namespace slib
 {
-	SLIB_DEFINE_OBJECT(CRegEx, Object)
+
+/*************************************************************
+				Native engine
+
+	Patterns in ECMAScript grammar are compiled to a Thompson NFA,
+	which is executed by a lazily built DFA, or by simulating all
+	the NFA threads in lock step when the DFA is not usable.
+	Both take time linear to the input length.
+	Back-references, look-ahead assertions and other grammars
+	are delegated to std::regex.
+*************************************************************/
+
+	enum class _priv_RegExOp
+	{
+		Byte,
+		Set,
+		Split,
+		Jump,
+		Bol,
+		Eol,
+		WordBoundary,
+		NotWordBoundary,
+		Match
+	};
 	
-	CRegEx::CRegEx() noexcept
+	struct _priv_RegExInst
+	{
+		_priv_RegExOp op;
+		// byte, index of set, jump target, first target of split
+		sl_uint32 x;
+		// second target of split
+		sl_uint32 y;
+	};
+	
+	class _priv_RegExSet
+	{
+	public:
+		sl_uint32 bits[8];
+	
+	public:
+		_priv_RegExSet()
+		{
+			Base::zeroMemory(bits, sizeof(bits));
+		}
+	
+	public:
+		SLIB_INLINE sl_bool contains(sl_uint8 c) const
+		{
+			return (bits[c >> 5] >> (c & 31)) & 1;
+		}
+		
+		SLIB_INLINE void add(sl_uint8 c)
+		{
+			bits[c >> 5] |= (1u << (c & 31));
+		}
+		
+		void addRange(sl_uint32 first, sl_uint32 last)
+		{
+			for (sl_uint32 c = first; c <= last; c++) {
+				add((sl_uint8)c);
+			}
+		}
+		
+		void addSet(const _priv_RegExSet& other)
+		{
+			for (int i = 0; i < 8; i++) {
+				bits[i] |= other.bits[i];
+			}
+		}
+		
+		void invert()
+		{
+			for (int i = 0; i < 8; i++) {
+				bits[i] = ~(bits[i]);
+			}
+		}
+		
+		void addOtherCases()
+		{
+			for (sl_uint32 c = 'a'; c <= 'z'; c++) {
+				if (contains((sl_uint8)c)) {
+					add((sl_uint8)(c - 32));
+				} else if (contains((sl_uint8)(c - 32))) {
+					add((sl_uint8)c);
+				}
+			}
+		}
+	
+	};
+	
+	SLIB_INLINE static sl_bool _priv_RegEx_isWordChar(sl_uint8 c)
 	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
 	}
 	
-	CRegEx::~CRegEx() noexcept
+	// `type`: one of 'd', 'w', 's', 'D', 'W', 'S'
+	static void _priv_RegEx_makeClassSet(_priv_RegExSet& set, sl_uint8 type)
 	{
-		delete ((std::regex*)m_obj);
+		switch (type | 0x20) {
+			case 'd':
+				set.addRange('0', '9');
+				break;
+			case 'w':
+				for (sl_uint32 c = 0; c < 128; c++) {
+					if (_priv_RegEx_isWordChar((sl_uint8)c)) {
+						set.add((sl_uint8)c);
+					}
+				}
+				break;
+			case 's':
+				set.add(' ');
+				set.addRange('\t', '\r');
+				break;
+		}
+		if (type < 'a') {
+			set.invert();
+		}
 	}
 	
-	Ref<CRegEx> CRegEx::_create(const String& pattern, int _flags) noexcept
+	static sl_bool _priv_RegEx_makePosixClassSet(_priv_RegExSet& set, const sl_uint8* name, sl_size len)
 	{
-		std::regex* obj = (std::regex*)(Base::createMemory(sizeof(std::regex)));
-		if (obj) {
-			int flags = 0;
-			if (_flags & RegExFlags::Icase) {
-				flags |= std::regex_constants::icase;
+		String s((const sl_char8*)name, len);
+		for (sl_uint32 c = 0; c < 128; c++) {
+			sl_bool flagAlpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+			sl_bool flagDigit = c >= '0' && c <= '9';
+			sl_bool flagPrint = c >= 0x20 && c < 0x7f;
+			sl_bool f;
+			if (s == "alpha") {
+				f = flagAlpha;
+			} else if (s == "digit" || s == "d") {
+				f = flagDigit;
+			} else if (s == "alnum") {
+				f = flagAlpha || flagDigit;
+			} else if (s == "w") {
+				f = flagAlpha || flagDigit || c == '_';
+			} else if (s == "space" || s == "s") {
+				f = c == ' ' || (c >= '\t' && c <= '\r');
+			} else if (s == "blank") {
+				f = c == ' ' || c == '\t';
+			} else if (s == "upper") {
+				f = c >= 'A' && c <= 'Z';
+			} else if (s == "lower") {
+				f = c >= 'a' && c <= 'z';
+			} else if (s == "xdigit") {
+				f = flagDigit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+			} else if (s == "punct") {
+				f = flagPrint && c != ' ' && !flagAlpha && !flagDigit;
+			} else if (s == "cntrl") {
+				f = c < 0x20 || c == 0x7f;
+			} else if (s == "print") {
+				f = flagPrint;
+			} else if (s == "graph") {
+				f = flagPrint && c != ' ';
+			} else {
+				return sl_false;
 			}
-			if (_flags & RegExFlags::Nosubs) {
-				flags |= std::regex_constants::nosubs;
+			if (f) {
+				set.add((sl_uint8)c);
 			}
-			if (_flags & RegExFlags::Optimize) {
-				flags |= std::regex_constants::optimize;
+		}
+		return sl_true;
+	}
+	
+	enum class _priv_RegExNodeType
+	{
+		Empty,
+		Byte,
+		Set,
+		Concat,
+		Alternate,
+		Repeat,
+		Bol,
+		Eol,
+		WordBoundary,
+		NotWordBoundary
+	};
+	
+	struct _priv_RegExNode
+	{
+		_priv_RegExNodeType type;
+		// byte, index of set
+		sl_uint32 value;
+		sl_int32 min;
+		// negative for infinite
+		sl_int32 max;
+		List<sl_uint32> children;
+	};
+	
+	class _priv_RegExProgram;
+	
+	class _priv_RegExCompiler
+	{
+	public:
+		const sl_uint8* pattern;
+		sl_size len;
+		sl_size pos;
+		sl_bool flagIcase;
+		// the pattern may still be valid for std::regex
+		sl_bool flagUnsupported;
+		
+		List<_priv_RegExNode> nodes;
+		List<_priv_RegExSet> sets;
+		List<_priv_RegExInst> code;
+	
+	public:
+		_priv_RegExCompiler(const String& _pattern, sl_bool _flagIcase)
+		{
+			pattern = (const sl_uint8*)(_pattern.getData());
+			len = _pattern.getLength();
+			pos = 0;
+			flagIcase = _flagIcase;
+			flagUnsupported = sl_false;
+		}
+	
+	public:
+		sl_uint32 addNode(_priv_RegExNodeType type, sl_uint32 value = 0)
+		{
+			_priv_RegExNode node;
+			node.type = type;
+			node.value = value;
+			node.min = 0;
+			node.max = 0;
+			nodes.add_NoLock(node);
+			return (sl_uint32)(nodes.getCount() - 1);
+		}
+		
+		sl_uint32 addSetNode(const _priv_RegExSet& set)
+		{
+			sets.add_NoLock(set);
+			return addNode(_priv_RegExNodeType::Set, (sl_uint32)(sets.getCount() - 1));
+		}
+		
+		sl_uint32 addByteNode(sl_uint8 c)
+		{
+			if (flagIcase && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+				_priv_RegExSet set;
+				set.add(c);
+				set.addOtherCases();
+				return addSetNode(set);
 			}
-			if (_flags & RegExFlags::Collate) {
-				flags |= std::regex_constants::collate;
+			return addNode(_priv_RegExNodeType::Byte, c);
+		}
+		
+		sl_uint32 addListNode(_priv_RegExNodeType type, const List<sl_uint32>& children)
+		{
+			sl_uint32 index = addNode(type);
+			nodes.getData()[index].children = children;
+			return index;
+		}
+		
+		sl_bool parseAlternate(sl_uint32 depth, sl_uint32& _out)
+		{
+			if (depth > PRIV_REGEX_MAX_NESTING) {
+				return sl_false;
 			}
-			if (_flags & RegExFlags::ECMAScript) {
-				flags |= std::regex_constants::ECMAScript;
+			List<sl_uint32> alternates;
+			for (;;) {
+				sl_uint32 item;
+				if (!(parseConcat(depth, item))) {
+					return sl_false;
+				}
+				alternates.add_NoLock(item);
+				if (pos < len && pattern[pos] == '|') {
+					pos++;
+				} else {
+					break;
+				}
 			}
-			if (_flags & RegExFlags::Basic) {
-				flags |= std::regex_constants::basic;
+			if (alternates.getCount() == 1) {
+				_out = alternates.getValueAt_NoLock(0);
+			} else {
+				_out = addListNode(_priv_RegExNodeType::Alternate, alternates);
 			}
-			if (_flags & RegExFlags::Extended) {
-				flags |= std::regex_constants::extended;
+			return sl_true;
+		}
+		
+		sl_bool parseConcat(sl_uint32 depth, sl_uint32& _out)
+		{
+			List<sl_uint32> items;
+			while (pos < len) {
+				sl_uint8 c = pattern[pos];
+				if (c == '|' || c == ')') {
+					break;
+				}
+				sl_uint32 item;
+				if (!(parseTerm(depth, item))) {
+					return sl_false;
+				}
+				items.add_NoLock(item);
+			}
+			sl_size n = items.getCount();
+			if (!n) {
+				_out = addNode(_priv_RegExNodeType::Empty);
+			} else if (n == 1) {
+				_out = items.getValueAt_NoLock(0);
+			} else {
+				_out = addListNode(_priv_RegExNodeType::Concat, items);
+			}
+			return sl_true;
+		}
+		
+		sl_bool parseTerm(sl_uint32 depth, sl_uint32& _out)
+		{
+			sl_uint8 c = pattern[pos];
+			if (c == '^') {
+				pos++;
+				_out = addNode(_priv_RegExNodeType::Bol);
+				return sl_true;
+			}
+			if (c == '$') {
+				pos++;
+				_out = addNode(_priv_RegExNodeType::Eol);
+				return sl_true;
+			}
+			if (c == '\\' && pos + 1 < len) {
+				if (pattern[pos + 1] == 'b') {
+					pos += 2;
+					_out = addNode(_priv_RegExNodeType::WordBoundary);
+					return sl_true;
+				}
+				if (pattern[pos + 1] == 'B') {
+					pos += 2;
+					_out = addNode(_priv_RegExNodeType::NotWordBoundary);
+					return sl_true;
+				}
+			}
+			sl_uint32 atom;
+			if (!(parseAtom(depth, atom))) {
+				return sl_false;
+			}
+			return parseQuantifier(atom, _out);
+		}
+		
+		sl_bool parseNumber(sl_int32& _out)
+		{
+			sl_size start = pos;
+			sl_int64 n = 0;
+			while (pos < len && pattern[pos] >= '0' && pattern[pos] <= '9') {
+				n = n * 10 + (pattern[pos] - '0');
+				if (n > PRIV_REGEX_MAX_REPEAT) {
+					return sl_false;
+				}
+				pos++;
+			}
+			_out = (sl_int32)n;
+			return pos > start;
+		}
+		
+		sl_bool parseQuantifier(sl_uint32 atom, sl_uint32& _out)
+		{
+			if (pos >= len) {
+				_out = atom;
+				return sl_true;
 			}
-			if (_flags & RegExFlags::Awk) {
-				flags |= std::regex_constants::awk;
+			sl_int32 min, max;
+			switch (pattern[pos]) {
+				case '*':
+					min = 0;
+					max = -1;
+					pos++;
+					break;
+				case '+':
+					min = 1;
+					max = -1;
+					pos++;
+					break;
+				case '?':
+					min = 0;
+					max = 1;
+					pos++;
+					break;
+				case '{':
+					pos++;
+					if (!(parseNumber(min))) {
+						return sl_false;
+					}
+					max = min;
+					if (pos < len && pattern[pos] == ',') {
+						pos++;
+						if (pos < len && pattern[pos] == '}') {
+							max = -1;
+						} else {
+							if (!(parseNumber(max))) {
+								return sl_false;
+							}
+							if (max < min) {
+								return sl_false;
+							}
+						}
+					}
+					if (pos >= len || pattern[pos] != '}') {
+						return sl_false;
+					}
+					pos++;
+					break;
+				default:
+					_out = atom;
+					return sl_true;
 			}
-			if (_flags & RegExFlags::Grep) {
-				flags |= std::regex_constants::grep;
+			// lazy quantifier does not change whether the pattern matches
+			if (pos < len && pattern[pos] == '?') {
+				pos++;
 			}
-			if (_flags & RegExFlags::Egrep) {
-				flags |= std::regex_constants::egrep;
+			_out = addNode(_priv_RegExNodeType::Repeat);
+			_priv_RegExNode& node = nodes.getData()[_out];
+			node.min = min;
+			node.max = max;
+			node.children.add_NoLock(atom);
+			return sl_true;
+		}
+		
+		sl_bool parseHex(sl_uint32 nDigits, sl_uint32& _out)
+		{
+			if (pos + nDigits > len) {
+				return sl_false;
 			}
-			try {
-				if (flags) {
-					new (obj) std::regex((char*)(pattern.getData()), (std::size_t)(pattern.getLength()), (std::regex_constants::syntax_option_type)flags);
+			sl_uint32 v = 0;
+			for (sl_uint32 i = 0; i < nDigits; i++) {
+				sl_uint32 h = SLIB_CHAR_HEX_TO_INT(pattern[pos + i]);
+				if (h >= 16) {
+					return sl_false;
+				}
+				v = (v << 4) | h;
+			}
+			pos += nDigits;
+			_out = v;
+			return sl_true;
+		}
+		
+		// parses after backslash; returns a set when `set` is filled
+		sl_bool parseEscape(sl_bool flagInSet, sl_uint32& ch, _priv_RegExSet& set, sl_bool& flagSet)
+		{
+			flagSet = sl_false;
+			if (pos >= len) {
+				return sl_false;
+			}
+			sl_uint8 c = pattern[pos++];
+			switch (c) {
+				case 'd':
+				case 'D':
+				case 'w':
+				case 'W':
+				case 's':
+				case 'S':
+					_priv_RegEx_makeClassSet(set, c);
+					flagSet = sl_true;
+					return sl_true;
+				case 't':
+					ch = '\t';
+					return sl_true;
+				case 'n':
+					ch = '\n';
+					return sl_true;
+				case 'v':
+					ch = '\v';
+					return sl_true;
+				case 'f':
+					ch = '\f';
+					return sl_true;
+				case 'r':
+					ch = '\r';
+					return sl_true;
+				case '0':
+					if (pos < len && pattern[pos] >= '0' && pattern[pos] <= '9') {
+						flagUnsupported = sl_true;
+						return sl_false;
+					}
+					ch = 0;
+					return sl_true;
+				case 'c':
+					if (pos < len && ((pattern[pos] >= 'a' && pattern[pos] <= 'z') || (pattern[pos] >= 'A' && pattern[pos] <= 'Z'))) {
+						ch = pattern[pos++] % 32;
+						return sl_true;
+					}
+					break;
+				case 'x':
+					if (parseHex(2, ch)) {
+						return sl_true;
+					}
+					break;
+				case 'u':
+					if (parseHex(4, ch)) {
+						if (ch < 0x100) {
+							return sl_true;
+						}
+					}
+					break;
+				case 'b':
+					if (flagInSet) {
+						ch = '\b';
+						return sl_true;
+					}
+					break;
+				default:
+					if (!(_priv_RegEx_isWordChar(c))) {
+						ch = c;
+						return sl_true;
+					}
+					break;
+			}
+			// back-references and other escapes
+			flagUnsupported = sl_true;
+			return sl_false;
+		}
+		
+		sl_bool parseSet(sl_uint32& _out)
+		{
+			// after '['
+			sl_bool flagNegative = sl_false;
+			if (pos < len && pattern[pos] == '^') {
+				flagNegative = sl_true;
+				pos++;
+			}
+			_priv_RegExSet set;
+			for (;;) {
+				if (pos >= len) {
+					return sl_false;
+				}
+				sl_uint8 c = pattern[pos];
+				if (c == ']') {
+					pos++;
+					break;
+				}
+				if (c == '[' && pos + 1 < len) {
+					sl_uint8 t = pattern[pos + 1];
+					if (t == ':') {
+						sl_size start = pos + 2;
+						sl_size end = start;
+						while (end + 1 < len && !(pattern[end] == ':' && pattern[end + 1] == ']')) {
+							end++;
+						}
+						if (end + 1 >= len) {
+							return sl_false;
+						}
+						if (!(_priv_RegEx_makePosixClassSet(set, pattern + start, end - start))) {
+							flagUnsupported = sl_true;
+							return sl_false;
+						}
+						pos = end + 2;
+						continue;
+					}
+					if (t == '.' || t == '=') {
+						flagUnsupported = sl_true;
+						return sl_false;
+					}
+				}
+				sl_uint32 first;
+				if (!(parseSetAtom(set, first))) {
+					return sl_false;
+				}
+				if (first > 0xFF) {
+					// class escape
+					continue;
+				}
+				if (pos + 1 < len && pattern[pos] == '-' && pattern[pos + 1] != ']') {
+					pos++;
+					sl_uint32 last;
+					_priv_RegExSet dummy;
+					if (!(parseSetAtom(dummy, last))) {
+						return sl_false;
+					}
+					if (last > 0xFF || last < first) {
+						return sl_false;
+					}
+					set.addRange(first, last);
 				} else {
-					new (obj) std::regex((char*)(pattern.getData()), (std::size_t)(pattern.getLength()));
+					set.add((sl_uint8)first);
 				}
-			} catch (std::regex_error&) {
-				Base::freeMemory(obj);
-				return sl_null;
 			}
-			Ref<CRegEx> ret = new CRegEx;
-			if (ret.isNotNull()) {
-				ret->m_obj = obj;
+			if (flagIcase) {
+				set.addOtherCases();
+			}
+			if (flagNegative) {
+				set.invert();
+			}
+			_out = addSetNode(set);
+			return sl_true;
+		}
+		
+		// returns 0x100 for class escapes, which are added to `set`
+		sl_bool parseSetAtom(_priv_RegExSet& set, sl_uint32& _out)
+		{
+			sl_uint8 c = pattern[pos];
+			if (c == '\\') {
+				pos++;
+				sl_uint32 ch = 0;
+				_priv_RegExSet setEscape;
+				sl_bool flagSet;
+				if (!(parseEscape(sl_true, ch, setEscape, flagSet))) {
+					return sl_false;
+				}
+				if (flagSet) {
+					set.addSet(setEscape);
+					_out = 0x100;
+				} else {
+					_out = ch;
+				}
+				return sl_true;
+			}
+			pos++;
+			_out = c;
+			return sl_true;
+		}
+		
+		sl_bool parseAtom(sl_uint32 depth, sl_uint32& _out)
+		{
+			sl_uint8 c = pattern[pos++];
+			switch (c) {
+				case '.':
+					{
+						_priv_RegExSet set;
+						set.add('\n');
+						set.add('\r');
+						set.invert();
+						_out = addSetNode(set);
+						return sl_true;
+					}
+				case '(':
+					if (pos < len && pattern[pos] == '?') {
+						if (pos + 1 < len && pattern[pos + 1] == ':') {
+							pos += 2;
+						} else {
+							// look-ahead assertions
+							flagUnsupported = sl_true;
+							return sl_false;
+						}
+					}
+					if (!(parseAlternate(depth + 1, _out))) {
+						return sl_false;
+					}
+					if (pos >= len || pattern[pos] != ')') {
+						return sl_false;
+					}
+					pos++;
+					return sl_true;
+				case '[':
+					return parseSet(_out);
+				case '\\':
+					{
+						sl_uint32 ch = 0;
+						_priv_RegExSet set;
+						sl_bool flagSet;
+						if (!(parseEscape(sl_false, ch, set, flagSet))) {
+							return sl_false;
+						}
+						if (flagSet) {
+							_out = addSetNode(set);
+						} else {
+							_out = addByteNode((sl_uint8)ch);
+						}
+						return sl_true;
+					}
+				case '*':
+				case '+':
+				case '?':
+				case '{':
+					return sl_false;
+				default:
+					_out = addByteNode(c);
+					return sl_true;
+			}
+		}
+		
+		sl_uint32 addInst(_priv_RegExOp op, sl_uint32 x = 0, sl_uint32 y = 0)
+		{
+			_priv_RegExInst inst;
+			inst.op = op;
+			inst.x = x;
+			inst.y = y;
+			code.add_NoLock(inst);
+			return (sl_uint32)(code.getCount() - 1);
+		}
+		
+		SLIB_INLINE _priv_RegExInst& getInst(sl_uint32 index)
+		{
+			return code.getData()[index];
+		}
+		
+		sl_bool emit(sl_uint32 index)
+		{
+			if (code.getCount() > PRIV_REGEX_MAX_PROGRAM_SIZE) {
+				return sl_false;
+			}
+			_priv_RegExNode& node = nodes.getData()[index];
+			switch (node.type) {
+				case _priv_RegExNodeType::Empty:
+					break;
+				case _priv_RegExNodeType::Byte:
+					addInst(_priv_RegExOp::Byte, node.value);
+					break;
+				case _priv_RegExNodeType::Set:
+					addInst(_priv_RegExOp::Set, node.value);
+					break;
+				case _priv_RegExNodeType::Bol:
+					addInst(_priv_RegExOp::Bol);
+					break;
+				case _priv_RegExNodeType::Eol:
+					addInst(_priv_RegExOp::Eol);
+					break;
+				case _priv_RegExNodeType::WordBoundary:
+					addInst(_priv_RegExOp::WordBoundary);
+					break;
+				case _priv_RegExNodeType::NotWordBoundary:
+					addInst(_priv_RegExOp::NotWordBoundary);
+					break;
+				case _priv_RegExNodeType::Concat:
+					{
+						ListElements<sl_uint32> children(node.children);
+						for (sl_size i = 0; i < children.count; i++) {
+							if (!(emit(children[i]))) {
+								return sl_false;
+							}
+						}
+						break;
+					}
+				case _priv_RegExNodeType::Alternate:
+					{
+						// split L1, L2; L1: A; jump End; L2: B; End:
+						ListElements<sl_uint32> children(node.children);
+						List<sl_uint32> jumps;
+						for (sl_size i = 0; i < children.count; i++) {
+							if (i + 1 < children.count) {
+								sl_uint32 split = addInst(_priv_RegExOp::Split, (sl_uint32)(code.getCount() + 1));
+								if (!(emit(children[i]))) {
+									return sl_false;
+								}
+								jumps.add_NoLock(addInst(_priv_RegExOp::Jump));
+								getInst(split).y = (sl_uint32)(code.getCount());
+							} else {
+								if (!(emit(children[i]))) {
+									return sl_false;
+								}
+							}
+						}
+						sl_uint32 end = (sl_uint32)(code.getCount());
+						ListElements<sl_uint32> listJumps(jumps);
+						for (sl_size i = 0; i < listJumps.count; i++) {
+							getInst(listJumps[i]).x = end;
+						}
+						break;
+					}
+				case _priv_RegExNodeType::Repeat:
+					{
+						sl_uint32 child = node.children.getValueAt_NoLock(0);
+						sl_int32 min = node.min;
+						sl_int32 max = node.max;
+						for (sl_int32 i = 0; i < min; i++) {
+							if (!(emit(child))) {
+								return sl_false;
+							}
+						}
+						if (max < 0) {
+							// L: split L1, End; L1: A; jump L; End:
+							sl_uint32 split = addInst(_priv_RegExOp::Split, (sl_uint32)(code.getCount() + 1));
+							if (!(emit(child))) {
+								return sl_false;
+							}
+							addInst(_priv_RegExOp::Jump, split);
+							getInst(split).y = (sl_uint32)(code.getCount());
+						} else {
+							List<sl_uint32> splits;
+							for (sl_int32 i = min; i < max; i++) {
+								splits.add_NoLock(addInst(_priv_RegExOp::Split, (sl_uint32)(code.getCount() + 1)));
+								if (!(emit(child))) {
+									return sl_false;
+								}
+							}
+							sl_uint32 end = (sl_uint32)(code.getCount());
+							ListElements<sl_uint32> listSplits(splits);
+							for (sl_size i = 0; i < listSplits.count; i++) {
+								getInst(listSplits[i]).y = end;
+							}
+						}
+						break;
+					}
+			}
+			return sl_true;
+		}
+		
+		// bytes which any match must start with
+		sl_bool collectPrefix(sl_uint32 index, List<sl_uint8>& prefix)
+		{
+			_priv_RegExNode& node = nodes.getData()[index];
+			switch (node.type) {
+				case _priv_RegExNodeType::Empty:
+				case _priv_RegExNodeType::Bol:
+					return sl_true;
+				case _priv_RegExNodeType::Byte:
+					prefix.add_NoLock((sl_uint8)(node.value));
+					return sl_true;
+				case _priv_RegExNodeType::Concat:
+					{
+						ListElements<sl_uint32> children(node.children);
+						for (sl_size i = 0; i < children.count; i++) {
+							if (!(collectPrefix(children[i], prefix))) {
+								return sl_false;
+							}
+						}
+						return sl_true;
+					}
+				default:
+					return sl_false;
+			}
+		}
+		
+		Ref<_priv_RegExProgram> compile();
+	
+	};
+	
+	class _priv_RegExSparseSet
+	{
+	public:
+		sl_uint32* dense;
+		sl_uint32* sparse;
+		sl_uint32 count;
+	
+	public:
+		SLIB_INLINE sl_bool contains(sl_uint32 i) const
+		{
+			sl_uint32 k = sparse[i];
+			return k < count && dense[k] == i;
+		}
+		
+		SLIB_INLINE void add(sl_uint32 i)
+		{
+			sparse[i] = count;
+			dense[count] = i;
+			count++;
+		}
+	
+	};
+	
+	struct _priv_RegExAssertions
+	{
+		sl_bool flagBol;
+		sl_bool flagEol;
+		sl_bool flagWordBoundary;
+	};
+	
+	class _priv_RegExDfa
+	{
+	public:
+		// sorted indices of the instructions -> state
+		CHashMap<String, sl_uint32> mapStates;
+		List<String> states;
+		List<sl_uint8> flags;
+		List<sl_int32> table;
+		sl_int32 start[2];
+		sl_int32 startMiddle;
+		sl_bool flagFailed;
+	
+	public:
+		_priv_RegExDfa()
+		{
+			start[0] = -1;
+			start[1] = -1;
+			startMiddle = -1;
+			flagFailed = sl_false;
+		}
+	
+	};
+	
+	// checked out by one matcher at a time, so concurrent matchers never share the states being built
+	class _priv_RegExDfaCache
+	{
+	public:
+		_priv_RegExDfa dfaAnchored;
+		_priv_RegExDfa dfaSearch;
+		_priv_RegExDfaCache* next;
+	
+	public:
+		_priv_RegExDfaCache()
+		{
+			next = sl_null;
+		}
+	
+	};
+	
+	class _priv_RegExProgram : public Referable
+	{
+	public:
+		List<_priv_RegExInst> listCode;
+		_priv_RegExInst* code;
+		sl_uint32 nCode;
+		List<_priv_RegExSet> listSets;
+		_priv_RegExSet* sets;
+		sl_bool flagWordBoundary;
+		List<sl_uint8> prefix;
+		
+		sl_uint8 classOfByte[256];
+		sl_uint8 byteOfClass[256];
+		sl_uint32 nClasses;
+		
+		SpinLock lockDfaCaches;
+		_priv_RegExDfaCache* dfaCaches;
+	
+	public:
+		_priv_RegExProgram()
+		{
+			code = sl_null;
+			nCode = 0;
+			sets = sl_null;
+			flagWordBoundary = sl_false;
+			nClasses = 0;
+			dfaCaches = sl_null;
+		}
+		
+		~_priv_RegExProgram()
+		{
+			_priv_RegExDfaCache* cache = dfaCaches;
+			while (cache) {
+				_priv_RegExDfaCache* next = cache->next;
+				delete cache;
+				cache = next;
+			}
+		}
+	
+	public:
+		void prepare()
+		{
+			code = listCode.getData();
+			nCode = (sl_uint32)(listCode.getCount());
+			sets = listSets.getData();
+			flagWordBoundary = sl_false;
+			// partitions the bytes into the classes which no instruction distinguishes
+			Base::zeroMemory(classOfByte, sizeof(classOfByte));
+			nClasses = 1;
+			sl_bool flagBytes[256] = {0};
+			for (sl_uint32 i = 0; i < nCode; i++) {
+				_priv_RegExInst& inst = code[i];
+				if (inst.op == _priv_RegExOp::Byte) {
+					if (!(flagBytes[inst.x])) {
+						flagBytes[inst.x] = sl_true;
+						_priv_RegExSet set;
+						set.add((sl_uint8)(inst.x));
+						refineClasses(set);
+					}
+				} else if (inst.op == _priv_RegExOp::Set) {
+					refineClasses(sets[inst.x]);
+				} else if (inst.op == _priv_RegExOp::WordBoundary || inst.op == _priv_RegExOp::NotWordBoundary) {
+					flagWordBoundary = sl_true;
+				}
+			}
+			for (sl_uint32 c = 256; c > 0; c--) {
+				byteOfClass[classOfByte[c - 1]] = (sl_uint8)(c - 1);
+			}
+		}
+		
+		void refineClasses(const _priv_RegExSet& set)
+		{
+			sl_int32 newClasses[512];
+			for (sl_uint32 i = 0; i < 512; i++) {
+				newClasses[i] = -1;
+			}
+			sl_uint32 n = 0;
+			for (sl_uint32 c = 0; c < 256; c++) {
+				sl_uint32 k = (classOfByte[c] << 1) | (set.contains((sl_uint8)c) ? 1 : 0);
+				if (newClasses[k] < 0) {
+					newClasses[k] = n++;
+				}
+				classOfByte[c] = (sl_uint8)(newClasses[k]);
+			}
+			nClasses = n;
+		}
+		
+		// adds the instructions reachable from `pc` without consuming input
+		void addClosure(_priv_RegExSparseSet& list, sl_uint32* stack, sl_uint32 pc, sl_uint32 shift, sl_uint32 tag, const _priv_RegExAssertions& assertions)
+		{
+			sl_uint32 nStack = 0;
+			stack[nStack++] = pc;
+			while (nStack) {
+				pc = stack[--nStack];
+				sl_uint32 id = (pc << shift) | tag;
+				if (list.contains(id)) {
+					continue;
+				}
+				list.add(id);
+				_priv_RegExInst& inst = code[pc];
+				switch (inst.op) {
+					case _priv_RegExOp::Jump:
+						stack[nStack++] = inst.x;
+						break;
+					case _priv_RegExOp::Split:
+						stack[nStack++] = inst.y;
+						stack[nStack++] = inst.x;
+						break;
+					case _priv_RegExOp::Bol:
+						if (assertions.flagBol) {
+							stack[nStack++] = pc + 1;
+						}
+						break;
+					case _priv_RegExOp::Eol:
+						if (assertions.flagEol) {
+							stack[nStack++] = pc + 1;
+						}
+						break;
+					case _priv_RegExOp::WordBoundary:
+						if (assertions.flagWordBoundary) {
+							stack[nStack++] = pc + 1;
+						}
+						break;
+					case _priv_RegExOp::NotWordBoundary:
+						if (!(assertions.flagWordBoundary)) {
+							stack[nStack++] = pc + 1;
+						}
+						break;
+					default:
+						break;
+				}
+			}
+		}
+		
+		SLIB_INLINE sl_bool step(const _priv_RegExInst& inst, sl_uint8 c)
+		{
+			if (inst.op == _priv_RegExOp::Byte) {
+				return inst.x == c;
+			} else if (inst.op == _priv_RegExOp::Set) {
+				return sets[inst.x].contains(c);
+			}
+			return sl_false;
+		}
+		
+		const sl_uint8* findPrefix(const sl_uint8* s, const sl_uint8* end)
+		{
+			return Base::findMemory(s, end - s, prefix.getData(), prefix.getCount());
+		}
+		
+		SLIB_INLINE sl_bool isWordBoundary(const sl_uint8* s, sl_size n, sl_size pos, int flags)
+		{
+			if (pos == 0 && (flags & RegExMatchFlags::NotBow)) {
+				return sl_false;
+			}
+			if (pos == n && (flags & RegExMatchFlags::NotEow)) {
+				return sl_false;
+			}
+			sl_bool flagBefore = pos > 0 && _priv_RegEx_isWordChar(s[pos - 1]);
+			sl_bool flagAfter = pos < n && _priv_RegEx_isWordChar(s[pos]);
+			return flagBefore != flagAfter;
+		}
+		
+		// simulates the NFA threads in lock step
+		sl_bool runNfa(const sl_uint8* s, sl_size n, int flags, sl_bool flagSearch)
+		{
+			// tracks whether the thread has consumed input, to reject empty matches
+			sl_bool flagNotNull = flagSearch && (flags & RegExMatchFlags::NotNull);
+			sl_uint32 shift = flagNotNull ? 1 : 0;
+			sl_uint32 nIds = nCode << shift;
+			SLIB_SCOPED_BUFFER(sl_uint32, 1024, buf, nIds * 6 + 2)
+			if (!buf) {
+				return sl_false;
+			}
+			Base::zeroMemory(buf, nIds * 6 * sizeof(sl_uint32));
+			_priv_RegExSparseSet list1 = {buf, buf + nIds, 0};
+			_priv_RegExSparseSet list2 = {buf + nIds * 2, buf + nIds * 3, 0};
+			sl_uint32* stack = buf + nIds * 4;
+			_priv_RegExSparseSet* current = &list1;
+			_priv_RegExSparseSet* next = &list2;
+			sl_bool flagContinuous = (flags & RegExMatchFlags::Continuous) != 0;
+			sl_bool flagPrefix = flagSearch && prefix.isNotEmpty();
+			
+			_priv_RegExAssertions assertions;
+			sl_size pos = 0;
+			for (;;) {
+				assertions.flagBol = pos == 0 && !(flags & RegExMatchFlags::NotBol);
+				assertions.flagEol = pos == n && !(flags & RegExMatchFlags::NotEol);
+				assertions.flagWordBoundary = flagWordBoundary && isWordBoundary(s, n, pos, flags);
+				if (!pos || (flagSearch && !flagContinuous)) {
+					if (flagPrefix && !(current->count)) {
+						const sl_uint8* p = findPrefix(s + pos, s + n);
+						if (!p) {
+							return sl_false;
+						}
+						if (p != s + pos) {
+							pos = p - s;
+							continue;
+						}
+					}
+					addClosure(*current, stack, 0, shift, 0, assertions);
+				}
+				for (sl_uint32 i = 0; i < current->count; i++) {
+					sl_uint32 id = current->dense[i];
+					if (code[id >> shift].op == _priv_RegExOp::Match) {
+						if (flagSearch) {
+							if (!flagNotNull || (id & 1)) {
+								return sl_true;
+							}
+						} else if (pos == n) {
+							return sl_true;
+						}
+					}
+				}
+				if (pos >= n) {
+					return sl_false;
+				}
+				sl_uint8 c = s[pos];
+				pos++;
+				assertions.flagBol = sl_false;
+				assertions.flagEol = pos == n && !(flags & RegExMatchFlags::NotEol);
+				assertions.flagWordBoundary = flagWordBoundary && isWordBoundary(s, n, pos, flags);
+				next->count = 0;
+				for (sl_uint32 i = 0; i < current->count; i++) {
+					sl_uint32 id = current->dense[i];
+					sl_uint32 pc = id >> shift;
+					if (step(code[pc], c)) {
+						addClosure(*next, stack, pc + 1, shift, shift, assertions);
+					}
+				}
+				Swap(current, next);
+				if (!(current->count) && (!flagSearch || flagContinuous)) {
+					return sl_false;
+				}
+			}
+		}
+		
+		sl_int32 addDfaState(_priv_RegExDfa& dfa, _priv_RegExSparseSet& list, sl_uint32* stack)
+		{
+			// keeps the instructions that consume input or need the end of input
+			SLIB_SCOPED_BUFFER(sl_uint32, 256, pcs, list.count + 1)
+			if (!pcs) {
+				return -1;
+			}
+			sl_uint32 n = 0;
+			sl_uint8 flags = 0;
+			for (sl_uint32 i = 0; i < list.count; i++) {
+				sl_uint32 pc = list.dense[i];
+				_priv_RegExOp op = code[pc].op;
+				if (op == _priv_RegExOp::Byte || op == _priv_RegExOp::Set || op == _priv_RegExOp::Eol) {
+					pcs[n++] = pc;
+				} else if (op == _priv_RegExOp::Match) {
+					pcs[n++] = pc;
+					flags |= PRIV_REGEX_DFA_MATCH | PRIV_REGEX_DFA_MATCH_AT_END;
+				}
+			}
+			QuickSort::sortAsc(pcs, n);
+			String key((const sl_char8*)pcs, n * sizeof(sl_uint32));
+			sl_uint32 state;
+			if (dfa.mapStates.get_NoLock(key, &state)) {
+				return (sl_int32)state;
+			}
+			if (dfa.states.getCount() >= PRIV_REGEX_MAX_DFA_STATES) {
+				dfa.flagFailed = sl_true;
+				return -1;
+			}
+			if (!(flags & PRIV_REGEX_DFA_MATCH)) {
+				// resolves `$` at the end of input
+				_priv_RegExAssertions assertions;
+				assertions.flagBol = sl_false;
+				assertions.flagEol = sl_true;
+				assertions.flagWordBoundary = sl_false;
+				list.count = 0;
+				for (sl_uint32 i = 0; i < n; i++) {
+					if (code[pcs[i]].op == _priv_RegExOp::Eol) {
+						addClosure(list, stack, pcs[i], 0, 0, assertions);
+					}
+				}
+				for (sl_uint32 i = 0; i < list.count; i++) {
+					if (code[list.dense[i]].op == _priv_RegExOp::Match) {
+						flags |= PRIV_REGEX_DFA_MATCH_AT_END;
+						break;
+					}
+				}
+			}
+			state = (sl_uint32)(dfa.states.getCount());
+			if (!(dfa.table.setCount_NoLock((state + 1) * nClasses))) {
+				dfa.flagFailed = sl_true;
+				return -1;
+			}
+			sl_int32* row = dfa.table.getData() + state * nClasses;
+			for (sl_uint32 i = 0; i < nClasses; i++) {
+				row[i] = -1;
+			}
+			dfa.states.add_NoLock(key);
+			dfa.flags.add_NoLock(flags);
+			dfa.mapStates.put_NoLock(key, state);
+			return (sl_int32)state;
+		}
+		
+		sl_int32 getDfaStartState(_priv_RegExDfa& dfa, sl_bool flagBol, _priv_RegExSparseSet& list, sl_uint32* stack)
+		{
+			_priv_RegExAssertions assertions;
+			assertions.flagBol = flagBol;
+			assertions.flagEol = sl_false;
+			assertions.flagWordBoundary = sl_false;
+			list.count = 0;
+			addClosure(list, stack, 0, 0, 0, assertions);
+			return addDfaState(dfa, list, stack);
+		}
+		
+		sl_int32 getDfaNextState(_priv_RegExDfa& dfa, sl_bool flagSearch, sl_uint32 state, sl_uint32 cls, _priv_RegExSparseSet& list, sl_uint32* stack)
+		{
+			_priv_RegExAssertions assertions;
+			assertions.flagBol = sl_false;
+			assertions.flagEol = sl_false;
+			assertions.flagWordBoundary = sl_false;
+			sl_uint8 c = byteOfClass[cls];
+			String key = dfa.states.getValueAt_NoLock(state);
+			const sl_uint32* pcs = (const sl_uint32*)(key.getData());
+			sl_uint32 n = (sl_uint32)(key.getLength() / sizeof(sl_uint32));
+			list.count = 0;
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (step(code[pcs[i]], c)) {
+					addClosure(list, stack, pcs[i] + 1, 0, 0, assertions);
+				}
+			}
+			if (flagSearch) {
+				addClosure(list, stack, 0, 0, 0, assertions);
+			}
+			sl_int32 next = addDfaState(dfa, list, stack);
+			if (next >= 0) {
+				dfa.table.getData()[state * nClasses + cls] = next;
+			}
+			return next;
+		}
+		
+		// returns -1 when the DFA is not usable
+		sl_int32 runDfa(_priv_RegExDfaCache& cache, const sl_uint8* s, sl_size n, int flags, sl_bool flagSearch)
+		{
+			sl_bool flagContinuous = (flags & RegExMatchFlags::Continuous) != 0;
+			sl_bool flagEarlyMatch = flagSearch;
+			if (flagContinuous) {
+				flagSearch = sl_false;
+			}
+			_priv_RegExDfa& dfa = flagSearch ? cache.dfaSearch : cache.dfaAnchored;
+			if (dfa.flagFailed) {
+				return -1;
+			}
+			SLIB_SCOPED_BUFFER(sl_uint32, 1024, buf, nCode * 4 + 2)
+			if (!buf) {
+				return -1;
+			}
+			Base::zeroMemory(buf, nCode * 2 * sizeof(sl_uint32));
+			_priv_RegExSparseSet list = {buf, buf + nCode, 0};
+			sl_uint32* stack = buf + nCode * 2;
+			
+			sl_bool flagBol = !(flags & RegExMatchFlags::NotBol);
+			sl_int32 state = dfa.start[flagBol];
+			if (state < 0) {
+				state = getDfaStartState(dfa, flagBol, list, stack);
+				if (state < 0) {
+					return -1;
+				}
+				dfa.start[flagBol] = state;
+			}
+			sl_int32 stateMiddle = -1;
+			sl_bool flagPrefix = sl_false;
+			if (flagSearch) {
+				stateMiddle = dfa.startMiddle;
+				if (stateMiddle < 0) {
+					stateMiddle = getDfaStartState(dfa, sl_false, list, stack);
+					if (stateMiddle < 0) {
+						return -1;
+					}
+					dfa.startMiddle = stateMiddle;
+				}
+				flagPrefix = prefix.isNotEmpty();
+			}
+			const sl_uint8* flagsOfState = dfa.flags.getData();
+			sl_int32* table = dfa.table.getData();
+			const sl_uint8* p = s;
+			const sl_uint8* end = s + n;
+			while (p < end) {
+				if (state == stateMiddle) {
+					// no match is in progress
+					if (dfa.states.getValueAt_NoLock(state).isEmpty()) {
+						return 0;
+					}
+					if (flagPrefix) {
+						p = findPrefix(p, end);
+						if (!p) {
+							return 0;
+						}
+					}
+				}
+				sl_uint8 f = flagsOfState[state];
+				if (flagEarlyMatch && (f & PRIV_REGEX_DFA_MATCH)) {
+					return 1;
+				}
+				sl_uint32 cls = classOfByte[*p];
+				sl_int32 next = table[state * nClasses + cls];
+				if (next < 0) {
+					next = getDfaNextState(dfa, flagSearch, state, cls, list, stack);
+					if (next < 0) {
+						return -1;
+					}
+					flagsOfState = dfa.flags.getData();
+					table = dfa.table.getData();
+				}
+				state = next;
+				if (!flagSearch && dfa.states.getValueAt_NoLock(state).isEmpty()) {
+					return 0;
+				}
+				p++;
+			}
+			sl_uint8 f = flagsOfState[state];
+			if (f & PRIV_REGEX_DFA_MATCH) {
+				return 1;
+			}
+			if ((f & PRIV_REGEX_DFA_MATCH_AT_END) && !(flags & RegExMatchFlags::NotEol)) {
+				return 1;
+			}
+			return 0;
+		}
+		
+		sl_bool run(const sl_uint8* s, sl_size n, int flags, sl_bool flagSearch)
+		{
+			if (!flagSearch) {
+				if ((flags & RegExMatchFlags::NotNull) && !n) {
+					return sl_false;
+				}
+				sl_size k = prefix.getCount();
+				if (k) {
+					if (n < k || !(Base::equalsMemory(s, prefix.getData(), k))) {
+						return sl_false;
+					}
+				}
+			}
+			// the states of the DFA can not express `^` following `$` on empty input
+			if (n && !flagWordBoundary && !(flagSearch && (flags & RegExMatchFlags::NotNull))) {
+				// each concurrent matcher builds on its own DFA cache, and returns it for the next matcher
+				_priv_RegExDfaCache* cache;
+				{
+					SpinLocker lock(&lockDfaCaches);
+					cache = dfaCaches;
+					if (cache) {
+						dfaCaches = cache->next;
+					}
+				}
+				if (!cache) {
+					cache = new _priv_RegExDfaCache;
+				}
+				if (cache) {
+					sl_int32 ret = runDfa(*cache, s, n, flags, flagSearch);
+					{
+						SpinLocker lock(&lockDfaCaches);
+						cache->next = dfaCaches;
+						dfaCaches = cache;
+					}
+					if (ret >= 0) {
+						return ret > 0;
+					}
+				}
+			}
+			return runNfa(s, n, flags, flagSearch);
+		}
+	
+	};
+	
+	Ref<_priv_RegExProgram> _priv_RegExCompiler::compile()
+	{
+		sl_uint32 root;
+		if (!(parseAlternate(0, root))) {
+			return sl_null;
+		}
+		if (pos != len) {
+			return sl_null;
+		}
+		if (!(emit(root))) {
+			flagUnsupported = sl_true;
+			return sl_null;
+		}
+		addInst(_priv_RegExOp::Match);
+		Ref<_priv_RegExProgram> program = new _priv_RegExProgram;
+		if (program.isNull()) {
+			return sl_null;
+		}
+		program->listCode = code;
+		program->listSets = sets;
+		collectPrefix(root, program->prefix);
+		program->prepare();
+		return program;
+	}
+
+
+/*************************************************************
+					CRegEx
+*************************************************************/
+
+	SLIB_DEFINE_OBJECT(CRegEx, Object)
+	
+	CRegEx::CRegEx() noexcept
+	{
+		m_obj = sl_null;
+	}
+	
+	CRegEx::~CRegEx() noexcept
+	{
+		if (m_obj) {
+			delete ((std::regex*)m_obj);
+		}
+	}
+	
+	static std::regex* _priv_RegEx_createStd(const String& pattern, int _flags) noexcept;
+	
+	typedef CHashMap< String, Ref<CRegEx> > _priv_RegExCache;
+	SLIB_SAFE_STATIC_GETTER(_priv_RegExCache, _priv_RegEx_getCache)
+	
+	Ref<CRegEx> CRegEx::_create(const String& pattern, int flags) noexcept
+	{
+		_priv_RegExCache* cache = _priv_RegEx_getCache();
+		String key;
+		if (cache) {
+			key = String::fromInt32(flags) + ":" + pattern;
+			Ref<CRegEx> ret;
+			if (cache->get(key, &ret)) {
 				return ret;
 			}
-			delete obj;
+		}
+		Ref<CRegEx> ret;
+		sl_bool flagNative = !(flags & (RegExFlags::Collate | RegExFlags::Basic | RegExFlags::Extended | RegExFlags::Awk | RegExFlags::Grep | RegExFlags::Egrep));
+		if (flagNative) {
+			_priv_RegExCompiler compiler(pattern, (flags & RegExFlags::Icase) != 0);
+			Ref<_priv_RegExProgram> program = compiler.compile();
+			if (program.isNotNull()) {
+				ret = new CRegEx;
+				if (ret.isNotNull()) {
+					ret->m_program = program;
+				}
+			} else if (!(compiler.flagUnsupported)) {
+				return sl_null;
+			}
+		}
+		if (ret.isNull()) {
+			std::regex* obj = _priv_RegEx_createStd(pattern, flags);
+			if (!obj) {
+				return sl_null;
+			}
+			ret = new CRegEx;
+			if (ret.isNull()) {
+				delete obj;
+				return sl_null;
+			}
+			ret->m_obj = obj;
+		}
+		if (ret.isNotNull() && cache) {
+			ObjectLocker lock(cache);
+			if (cache->getCount() >= PRIV_REGEX_CACHE_SIZE) {
+				cache->removeAll_NoLock();
+			}
+			cache->put_NoLock(key, ret);
+		}
+		return ret;
+	}
+	
+	static std::regex* _priv_RegEx_createStd(const String& pattern, int _flags) noexcept
+	{
+		int flags = 0;
+		if (_flags & RegExFlags::Icase) {
+			flags |= std::regex_constants::icase;
+		}
+		if (_flags & RegExFlags::Nosubs) {
+			flags |= std::regex_constants::nosubs;
+		}
+		if (_flags & RegExFlags::Optimize) {
+			flags |= std::regex_constants::optimize;
+		}
+		if (_flags & RegExFlags::Collate) {
+			flags |= std::regex_constants::collate;
+		}
+		if (_flags & RegExFlags::ECMAScript) {
+			flags |= std::regex_constants::ECMAScript;
+		}
+		if (_flags & RegExFlags::Basic) {
+			flags |= std::regex_constants::basic;
+		}
+		if (_flags & RegExFlags::Extended) {
+			flags |= std::regex_constants::extended;
+		}
+		if (_flags & RegExFlags::Awk) {
+			flags |= std::regex_constants::awk;
+		}
+		if (_flags & RegExFlags::Grep) {
+			flags |= std::regex_constants::grep;
+		}
+		if (_flags & RegExFlags::Egrep) {
+			flags |= std::regex_constants::egrep;
+		}
+		try {
+			if (flags) {
+				return new std::regex((char*)(pattern.getData()), (std::size_t)(pattern.getLength()), (std::regex_constants::syntax_option_type)flags);
+			} else {
+				return new std::regex((char*)(pattern.getData()), (std::size_t)(pattern.getLength()));
+			}
+		} catch (std::regex_error&) {
+		} catch (std::bad_alloc&) {
 		}
 		return sl_null;
 	}
@@ -104,10 +1539,9 @@ namespace slib
 		return _create(pattern, flags);
 	}
 	
-	sl_bool CRegEx::match(const String& str, const RegExMatchFlags& _flags) noexcept
+	static int _priv_RegEx_getStdMatchFlags(int v) noexcept
 	{
 		int flags = 0;
-		int v = _flags.value;
 		if (v) {
 			if (v & RegExMatchFlags::NotBol) {
 				flags |= std::regex_constants::match_not_bol;
@@ -143,10 +1577,31 @@ namespace slib
 				flags |= std::regex_constants::format_first_only;
 			}
 		}
+		return flags;
+	}
+	
+	sl_bool CRegEx::match(const String& str, const RegExMatchFlags& flags) noexcept
+	{
+		const char* start = (char*)(str.getData());
+		sl_size len = str.getLength();
+		_priv_RegExProgram* program = (_priv_RegExProgram*)(m_program.get());
+		if (program) {
+			return program->run((const sl_uint8*)start, len, flags.value, sl_false);
+		}
 		std::regex* obj = (std::regex*)m_obj;
+		return std::regex_match(start, start + len, *obj, (std::regex_constants::match_flag_type)(_priv_RegEx_getStdMatchFlags(flags.value)));
+	}
+	
+	sl_bool CRegEx::search(const String& str, const RegExMatchFlags& flags) noexcept
+	{
 		const char* start = (char*)(str.getData());
-		const char* end = start + str.getLength();
-		return std::regex_match(start, end, *obj, (std::regex_constants::match_flag_type)flags);
+		sl_size len = str.getLength();
+		_priv_RegExProgram* program = (_priv_RegExProgram*)(m_program.get());
+		if (program) {
+			return program->run((const sl_uint8*)start, len, flags.value, sl_true);
+		}
+		std::regex* obj = (std::regex*)m_obj;
+		return std::regex_search(start, start + len, *obj, (std::regex_constants::match_flag_type)(_priv_RegEx_getStdMatchFlags(flags.value)));
 	}
 	
 	RegEx::RegEx(const String& pattern) noexcept
@@ -167,6 +1622,14 @@ namespace slib
 		return sl_false;
 	}
 	
+	sl_bool RegEx::search(const String& str, const RegExMatchFlags& flags) noexcept
+	{
+		if (ref.isNotNull()) {
+			return ref->search(str, flags);
+		}
+		return sl_false;
+	}
+	
 	Atomic<RegEx>::Atomic(const String& pattern) noexcept
 	 : ref(CRegEx::create(pattern, 0))
 	{
@@ -185,6 +1648,15 @@ namespace slib
 		}
 		return sl_false;
 	}
+	
+	sl_bool Atomic<RegEx>::search(const String& str, const RegExMatchFlags& flags) noexcept
+	{
+		Ref<CRegEx> ref(this->ref);
+		if (ref.isNotNull()) {
+			return ref->search(str, flags);
+		}
+		return sl_false;
+	}
 
 	
 	sl_bool RegEx::matchEmail(const String& str) noexcept
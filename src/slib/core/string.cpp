@@ -33,6 +33,8 @@
 #include "slib/core/json.h"
 #include "slib/core/cast.h"
 #include "slib/core/math.h"
+#include "slib/core/safe_static.h"
+#include "slib/core/spin_lock.h"
 
 namespace slib
 {
@@ -45,6 +47,11 @@ namespace slib
 			return Base::findMemory(mem, pattern, count);
 		}
 		
+		SLIB_INLINE static const void* findMemory(const sl_char8* mem, sl_size count, const sl_char8* pattern, sl_size countPattern) noexcept
+		{
+			return Base::findMemory(mem, count, pattern, countPattern);
+		}
+		
 		SLIB_INLINE static const void* findMemoryReverse(const sl_char8* mem, sl_char8 pattern, sl_size count) noexcept
 		{
 			return Base::findMemoryReverse(mem, pattern, count);
@@ -69,6 +76,11 @@ namespace slib
 			return Base::findMemory2((sl_uint16*)mem, pattern, count);
 		}
 		
+		SLIB_INLINE static const void* findMemory(const sl_char16* mem, sl_size count, const sl_char16* pattern, sl_size countPattern) noexcept
+		{
+			return Base::findMemory2((sl_uint16*)mem, count, (sl_uint16*)pattern, countPattern);
+		}
+		
 		SLIB_INLINE static const void* findMemoryReverse(const sl_char16* mem, sl_char16 pattern, sl_size count) noexcept
 		{
 			return Base::findMemoryReverse2((sl_uint16*)mem, pattern, count);
@@ -88,7 +100,8 @@ namespace slib
 	enum STRING_CONTAINER_TYPES {
 		STRING_CONTAINER_TYPE_NORMAL = 0,
 		STRING_CONTAINER_TYPE_STD = 10,
-		STRING_CONTAINER_TYPE_REF = 11
+		STRING_CONTAINER_TYPE_REF = 11,
+		STRING_CONTAINER_TYPE_INTERNED = 12
 	};
 
 	const _priv_String_Const _priv_String_Null = {sl_null, 0};
@@ -1861,8 +1874,17 @@ namespace slib
 	}
 
 
+	// interned containers are shared by every holder and looked up by their content, so they are copied before any change
+	SLIB_INLINE static void _priv_String_copyIfInterned(String& str) noexcept
+	{
+		if (str.isInterned()) {
+			str = str.duplicate();
+		}
+	}
+
 	void String::setLength(sl_size len) noexcept
 	{
+		_priv_String_copyIfInterned(*this);
 		if (m_container && m_container != &_g_string8_empty_container) {
 			m_container->len = len;
 		}
@@ -1876,16 +1898,36 @@ namespace slib
 	}
 	
 	
-	template <class CT>
-	SLIB_INLINE static sl_size _priv_String_calcHash(const CT* buf, sl_size len) noexcept
+	SLIB_INLINE static sl_size _priv_String_calcHash(const sl_char8* buf, sl_size len) noexcept
 	{
-		sl_size hash = 0;
-		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			hash = hash * 31 + ch;
+		return HashBytesFast(buf, len);
+	}
+	
+	// hashes the UTF-8 form, so that String and String16 of the same text have the same hash code.
+	// each code unit is encoded on its own, so the text is converted and hashed in small chunks
+	static sl_size _priv_String_calcHashUtf8(const sl_char16* buf, sl_size len, sl_bool flagUpper) noexcept
+	{
+		HashBytesFastStream hash;
+		hash.start(Charsets::utf16ToUtf8(buf, len, sl_null, -1));
+		sl_char8 utf8[192];
+		while (len) {
+			sl_size m = Math::min(len, (sl_size)64);
+			sl_size n = Charsets::utf16ToUtf8(buf, m, utf8, sizeof(utf8));
+			if (flagUpper) {
+				for (sl_size i = 0; i < n; i++) {
+					utf8[i] = SLIB_CHAR_LOWER_TO_UPPER(utf8[i]);
+				}
+			}
+			hash.update(utf8, n);
+			buf += m;
+			len -= m;
 		}
-		hash = Rehash(hash);
-		return hash;
+		return hash.finish();
+	}
+	
+	static sl_size _priv_String_calcHash(const sl_char16* buf, sl_size len) noexcept
+	{
+		return _priv_String_calcHashUtf8(buf, len, sl_false);
 	}
 	
 	sl_size String::getHashCode() const noexcept
@@ -1933,9 +1975,212 @@ namespace slib
 	}
 
 	
+	template <class T>
+	SLIB_INLINE static T* _priv_StringInterner_load(T* const* ptr) noexcept
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		return *((T* const volatile*)ptr);
+#else
+		return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+	}
+	
+	template <class T>
+	SLIB_INLINE static void _priv_StringInterner_store(T** ptr, T* value) noexcept
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		*((T* volatile*)ptr) = value;
+#else
+		__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+	}
+	
+#define PRIV_STRING_INTERNER_MIN_CAPACITY 256
+	
+	struct _priv_StringInterner_Table
+	{
+		sl_size capacity;
+		StringContainer* entries[1];
+	};
+	
+	class _priv_StringInterner
+	{
+	public:
+		_priv_StringInterner_Table* table;
+		sl_size count;
+		SpinLock lock;
+		
+	public:
+		_priv_StringInterner()
+		{
+			table = createTable(PRIV_STRING_INTERNER_MIN_CAPACITY);
+			count = 0;
+		}
+		
+		// Tables and entries are never freed: lock-free readers may still be probing a replaced table
+		
+	public:
+		static _priv_StringInterner_Table* createTable(sl_size capacity) noexcept
+		{
+			sl_size size = sizeof(_priv_StringInterner_Table) + sizeof(StringContainer*) * (capacity - 1);
+			_priv_StringInterner_Table* table = (_priv_StringInterner_Table*)(Base::createMemory(size));
+			if (table) {
+				Base::zeroMemory(table, size);
+				table->capacity = capacity;
+			}
+			return table;
+		}
+		
+		static StringContainer* find(_priv_StringInterner_Table* table, const sl_char8* sz, sl_size len, sl_size hash) noexcept
+		{
+			if (!table) {
+				return sl_null;
+			}
+			sl_size mask = table->capacity - 1;
+			sl_size index = hash & mask;
+			for (;;) {
+				StringContainer* container = _priv_StringInterner_load(table->entries + index);
+				if (!container) {
+					return sl_null;
+				}
+				if (container->hash == hash && container->len == len && Base::equalsMemory(container->sz, sz, len)) {
+					return container;
+				}
+				index = (index + 1) & mask;
+			}
+		}
+		
+		static void insert(_priv_StringInterner_Table* table, StringContainer* container) noexcept
+		{
+			sl_size mask = table->capacity - 1;
+			sl_size index = container->hash & mask;
+			while (table->entries[index]) {
+				index = (index + 1) & mask;
+			}
+			_priv_StringInterner_store(table->entries + index, container);
+		}
+		
+		StringContainer* intern(const sl_char8* sz, sl_size len, sl_size hash) noexcept
+		{
+			StringContainer* container = find(_priv_StringInterner_load(&table), sz, len, hash);
+			if (container) {
+				return container;
+			}
+			SpinLocker locker(&lock);
+			_priv_StringInterner_Table* current = table;
+			if (!current) {
+				return sl_null;
+			}
+			container = find(current, sz, len, hash);
+			if (container) {
+				return container;
+			}
+			if ((count + 1) * 2 > current->capacity) {
+				_priv_StringInterner_Table* expanded = createTable(current->capacity * 2);
+				if (!expanded) {
+					return sl_null;
+				}
+				for (sl_size i = 0; i < current->capacity; i++) {
+					StringContainer* entry = current->entries[i];
+					if (entry) {
+						insert(expanded, entry);
+					}
+				}
+				_priv_StringInterner_store(&table, expanded);
+				current = expanded;
+			}
+			sl_char8* buf = (sl_char8*)(Base::createMemory(sizeof(StringContainer) + len + 1));
+			if (!buf) {
+				return sl_null;
+			}
+			container = reinterpret_cast<StringContainer*>(buf);
+			container->sz = buf + sizeof(StringContainer);
+			container->len = len;
+			container->hash = hash;
+			container->type = STRING_CONTAINER_TYPE_INTERNED;
+			container->ref = -1;
+			Base::copyMemory(container->sz, sz, len);
+			container->sz[len] = 0;
+			insert(current, container);
+			count++;
+			return container;
+		}
+		
+	};
+	
+	SLIB_SAFE_STATIC_GETTER(_priv_StringInterner, _priv_StringInterner_get)
+	
+	String StringInterner::intern(const sl_char8* sz, sl_reg _len) noexcept
+	{
+		if (!sz) {
+			return sl_null;
+		}
+		sl_size len = _len < 0 ? Base::getStringLength(sz) : (sl_size)_len;
+		if (!len) {
+			return String::getEmpty();
+		}
+		_priv_StringInterner* interner = _priv_StringInterner_get();
+		if (interner) {
+			StringContainer* container = interner->intern(sz, len, _priv_String_calcHash(sz, len));
+			if (container) {
+				return String(container);
+			}
+		}
+		return String(sz, len);
+	}
+	
+	String StringInterner::intern(const String& str) noexcept
+	{
+		if (str.isNull() || str.isInterned()) {
+			return str;
+		}
+		return intern(str.getData(), str.getLength());
+	}
+	
+	String StringInterner::find(const sl_char8* sz, sl_reg _len) noexcept
+	{
+		if (!sz) {
+			return sl_null;
+		}
+		sl_size len = _len < 0 ? Base::getStringLength(sz) : (sl_size)_len;
+		if (!len) {
+			return String::getEmpty();
+		}
+		_priv_StringInterner* interner = _priv_StringInterner_get();
+		if (interner) {
+			StringContainer* container = _priv_StringInterner::find(_priv_StringInterner_load(&(interner->table)), sz, len, _priv_String_calcHash(sz, len));
+			if (container) {
+				return String(container);
+			}
+		}
+		return sl_null;
+	}
+	
+	sl_size StringInterner::getCount() noexcept
+	{
+		_priv_StringInterner* interner = _priv_StringInterner_get();
+		if (interner) {
+			SpinLocker locker(&(interner->lock));
+			return interner->count;
+		}
+		return 0;
+	}
+	
+	String String::intern() const noexcept
+	{
+		return StringInterner::intern(*this);
+	}
+	
+	sl_bool String::isInterned() const noexcept
+	{
+		return m_container && m_container->type == STRING_CONTAINER_TYPE_INTERNED;
+	}
+	
+	
 	void String::setHashCode(sl_size hash) noexcept
 	{
-		if (m_container && m_container != &_g_string8_empty_container) {
+		// interned containers always keep the hash code of their content
+		if (m_container && m_container != &_g_string8_empty_container && m_container->type != STRING_CONTAINER_TYPE_INTERNED) {
 			m_container->hash = hash;
 		}
 	}
@@ -1948,17 +2193,22 @@ namespace slib
 	}
 
 
-	template <class CT>
-	SLIB_INLINE static sl_size _priv_String_calcHashIgnoreCase(const CT* buf, sl_size len) noexcept
+	// same as the hash code of the string converted to upper case
+	static sl_size _priv_String_calcHashIgnoreCase(const sl_char8* buf, sl_size len) noexcept
 	{
-		sl_size hash = 0;
+		SLIB_SCOPED_BUFFER(sl_char8, 1024, upper, len)
+		if (!upper) {
+			return 0;
+		}
 		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			ch = SLIB_CHAR_LOWER_TO_UPPER(ch);
-			hash = hash * 31 + ch;
+			upper[i] = SLIB_CHAR_LOWER_TO_UPPER(buf[i]);
 		}
-		hash = Rehash(hash);
-		return hash;
+		return HashBytesFast(upper, len);
+	}
+	
+	static sl_size _priv_String_calcHashIgnoreCase(const sl_char16* buf, sl_size len) noexcept
+	{
+		return _priv_String_calcHashUtf8(buf, len, sl_true);
 	}
 	
 	sl_size String::getHashCodeIgnoreCase() const noexcept
@@ -2023,6 +2273,7 @@ namespace slib
 	{
 		if (m_container) {
 			if (index >= 0 && index < (sl_reg)(m_container->len)) {
+				_priv_String_copyIfInterned(*this);
 				m_container->sz[index] = ch;
 				return sl_true;
 			}
@@ -3809,6 +4060,10 @@ namespace slib
 		if (len == 0) {
 			return sl_true;
 		}
+		if (m_container->type == STRING_CONTAINER_TYPE_INTERNED && other.m_container->type == STRING_CONTAINER_TYPE_INTERNED) {
+			// different canonical strings
+			return sl_false;
+		}
 		sl_size h1 = m_container->hash;
 		if (h1) {
 			sl_size h2 = other.m_container->hash;
@@ -4994,16 +5249,9 @@ namespace slib
 				return -1;
 			}
 		}
-		while (start <= count - countPat) {
-			const CT* pt = (const CT*)(TT::findMemory(buf + start, bufPat[0], count - start - countPat + 1));
-			if (pt == sl_null) {
-				return -1;
-			}
-			if (TT::compareMemory(pt + 1, bufPat + 1, countPat - 1) == 0) {
-				return (sl_reg)(pt - buf);
-			} else {
-				start = (sl_size)(pt - buf + 1);
-			}
+		const CT* pt = (const CT*)(TT::findMemory(buf + start, count - start, bufPat, countPat));
+		if (pt) {
+			return (sl_reg)(pt - buf);
 		}
 		return -1;
 	}
@@ -5511,6 +5759,7 @@ namespace slib
 
 	void String::makeUpper() noexcept
 	{
+		_priv_String_copyIfInterned(*this);
 		_priv_String_copyMakingUpper(getData(), getData(), getLength());
 	}
 
@@ -5522,6 +5771,10 @@ namespace slib
 	void Atomic<String>::makeUpper() noexcept
 	{
 		String s(*this);
+		if (s.isInterned()) {
+			s = s.duplicate();
+			*this = s;
+		}
 		_priv_String_copyMakingUpper(s.getData(), s.getData(), s.getLength());
 	}
 
@@ -5533,6 +5786,7 @@ namespace slib
 
 	void String::makeLower() noexcept
 	{
+		_priv_String_copyIfInterned(*this);
 		_priv_String_copyMakingLower(getData(), getData(), getLength());
 	}
 
@@ -5544,6 +5798,10 @@ namespace slib
 	void Atomic<String>::makeLower() noexcept
 	{
 		String s(*this);
+		if (s.isInterned()) {
+			s = s.duplicate();
+			*this = s;
+		}
 		_priv_String_copyMakingLower(s.getData(), s.getData(), s.getLength());
 	}
 
@@ -5704,7 +5962,7 @@ namespace slib
 		sl_reg len;
 	};
 
-	template <class ST, class CT>
+	template <class ST, class CT, class TT>
 	SLIB_INLINE static ST _priv_String_replaceAll(const ST& str, const CT* pattern, sl_reg countPat, const CT* bufReplace, sl_reg countReplace) noexcept
 	{
 		if (countPat == 0) {
@@ -5720,7 +5978,7 @@ namespace slib
 		sl_reg size = 0;
 		sl_reg start = 0;
 		while (start <= count + countPat - 1) {
-			sl_reg index = str.indexOf(pattern, start);
+			sl_reg index = _priv_String_indexOf<ST, CT, TT>(str, pattern, countPat, start);
 			if (index < 0) {
 				index = count;
 			} else {
@@ -5750,12 +6008,12 @@ namespace slib
 
 	String String::replaceAll(const String& pattern, const String& replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String, sl_char8>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
+		return _priv_String_replaceAll<String, sl_char8, _priv_TemplateFunc8>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
 	}
 
 	String16 String16::replaceAll(const String16& pattern, const String16& replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String16, sl_char16>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
+		return _priv_String_replaceAll<String16, sl_char16, _priv_TemplateFunc16>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
 	}
 
 	String Atomic<String>::replaceAll(const String& pattern, const String& replacement) const noexcept
@@ -5772,12 +6030,12 @@ namespace slib
 
 	String String::replaceAll(const String& pattern, const sl_char8* replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String, sl_char8>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength(replacement));
+		return _priv_String_replaceAll<String, sl_char8, _priv_TemplateFunc8>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength(replacement));
 	}
 
 	String16 String16::replaceAll(const String16& pattern, const sl_char16* replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String16, sl_char16>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength2(replacement));
+		return _priv_String_replaceAll<String16, sl_char16, _priv_TemplateFunc16>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength2(replacement));
 	}
 
 	String Atomic<String>::replaceAll(const String& pattern, const sl_char8* replacement) const noexcept
@@ -5794,12 +6052,12 @@ namespace slib
 
 	String String::replaceAll(const sl_char8* pattern, const String& replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String, sl_char8>(*this, pattern, Base::getStringLength(pattern), replacement.getData(), replacement.getLength());
+		return _priv_String_replaceAll<String, sl_char8, _priv_TemplateFunc8>(*this, pattern, Base::getStringLength(pattern), replacement.getData(), replacement.getLength());
 	}
 
 	String16 String16::replaceAll(const sl_char16* pattern, const String16& replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String16, sl_char16>(*this, pattern, Base::getStringLength2(pattern), replacement.getData(), replacement.getLength());
+		return _priv_String_replaceAll<String16, sl_char16, _priv_TemplateFunc16>(*this, pattern, Base::getStringLength2(pattern), replacement.getData(), replacement.getLength());
 	}
 
 	String Atomic<String>::replaceAll(const sl_char8* pattern, const String& replacement) const noexcept
@@ -5816,12 +6074,12 @@ namespace slib
 
 	String String::replaceAll(const sl_char8* pattern, const sl_char8* replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String, sl_char8>(*this, pattern, Base::getStringLength(pattern), replacement, Base::getStringLength(replacement));
+		return _priv_String_replaceAll<String, sl_char8, _priv_TemplateFunc8>(*this, pattern, Base::getStringLength(pattern), replacement, Base::getStringLength(replacement));
 	}
 
 	String16 String16::replaceAll(const sl_char16* pattern, const sl_char16* replacement) const noexcept
 	{
-		return _priv_String_replaceAll<String16, sl_char16>(*this, pattern, Base::getStringLength2(pattern), replacement, Base::getStringLength2(replacement));
+		return _priv_String_replaceAll<String16, sl_char16, _priv_TemplateFunc16>(*this, pattern, Base::getStringLength2(pattern), replacement, Base::getStringLength2(replacement));
 	}
 
 	String Atomic<String>::replaceAll(const sl_char8* pattern, const sl_char8* replacement) const noexcept
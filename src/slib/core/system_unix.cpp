@@ -147,6 +147,31 @@ namespace slib
 #endif
 	}
 
+	sl_uint32 System::getCpuCoresCount()
+	{
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		if (n > 0) {
+			return (sl_uint32)n;
+		}
+		return 1;
+	}
+
+	sl_bool System::setCurrentThreadAffinity(sl_uint32 cpuIndex)
+	{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		if (cpuIndex >= CPU_SETSIZE) {
+			return sl_false;
+		}
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpuIndex, &set);
+		// pid 0 means the calling thread
+		return 0 == sched_setaffinity(0, sizeof(set), &set);
+#else
+		return sl_false;
+#endif
+	}
+
 #if !defined(SLIB_PLATFORM_IS_MOBILE)
 	sl_bool System::createProcess(const String& pathExecutable, const String* cmds, sl_uint32 nCmds)
 	{
@@ -114,6 +114,24 @@ namespace slib
 		return ::GetCurrentThreadId();
 	}
 
+	sl_uint32 System::getCpuCoresCount()
+	{
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		if (si.dwNumberOfProcessors > 0) {
+			return (sl_uint32)(si.dwNumberOfProcessors);
+		}
+		return 1;
+	}
+
+	sl_bool System::setCurrentThreadAffinity(sl_uint32 cpuIndex)
+	{
+		if (cpuIndex >= sizeof(DWORD_PTR) * 8) {
+			return sl_false;
+		}
+		return ::SetThreadAffinityMask(::GetCurrentThread(), ((DWORD_PTR)1) << cpuIndex) != 0;
+	}
+
 #if defined (SLIB_PLATFORM_IS_WIN32)
 	sl_bool System::createProcess(const String& _pathExecutable, const String* cmds, sl_uint32 nCmds)
 	{
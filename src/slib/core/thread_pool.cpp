@@ -22,9 +22,38 @@
 
 #include "slib/core/thread_pool.h"
 
+#include "slib/core/event.h"
+
 namespace slib
 {
 
+	class _priv_ThreadPool_ParallelContext : public Referable
+	{
+	public:
+		Function<void(sl_uint32)> task;
+		sl_reg nTasks;
+		sl_reg indexNext;
+		sl_reg nRemaining;
+		Ref<Event> eventFinish;
+		
+	public:
+		// workers and the caller take the task indices from the shared counter, so the caller never waits for queued tasks
+		void run()
+		{
+			for (;;) {
+				sl_reg index = Base::interlockedIncrement(&indexNext) - 1;
+				if (index >= nTasks) {
+					return;
+				}
+				task((sl_uint32)index);
+				if (!(Base::interlockedDecrement(&nRemaining))) {
+					eventFinish->set();
+				}
+			}
+		}
+		
+	};
+
 	SLIB_DEFINE_OBJECT(ThreadPool, Dispatcher)
 
 	ThreadPool::ThreadPool()
@@ -56,7 +85,11 @@ namespace slib
 		}
 		m_flagRunning = sl_false;
 		
-		ListElements< Ref<Thread> > threads(m_threadWorkers);
+		// the workers take the lock when they leave `onRunWorker()`, so they are joined without it
+		List< Ref<Thread> > listThreads = m_threadWorkers.duplicate_NoLock();
+		lock.unlock();
+		
+		ListElements< Ref<Thread> > threads(listThreads);
 		sl_size i;
 		for (i = 0; i < threads.count; i++) {
 			threads[i]->finish();
@@ -117,6 +150,45 @@ namespace slib
 		return addTask(callback);
 	}
 
+	void ThreadPool::runParallel(sl_uint32 nTasks, const Function<void(sl_uint32 index)>& task)
+	{
+		if (!nTasks || task.isNull()) {
+			return;
+		}
+		if (nTasks == 1) {
+			task(0);
+			return;
+		}
+		Ref<_priv_ThreadPool_ParallelContext> context = new _priv_ThreadPool_ParallelContext;
+		Ref<Event> event = Event::create();
+		if (context.isNull() || event.isNull()) {
+			for (sl_uint32 i = 0; i < nTasks; i++) {
+				task(i);
+			}
+			return;
+		}
+		context->task = task;
+		context->nTasks = nTasks;
+		context->indexNext = 0;
+		context->nRemaining = nTasks;
+		context->eventFinish = event;
+		sl_uint32 nWorkers = nTasks - 1;
+		sl_uint32 nMaxWorkers = getMaximumThreadsCount();
+		if (nWorkers > nMaxWorkers) {
+			nWorkers = nMaxWorkers;
+		}
+		for (sl_uint32 i = 0; i < nWorkers; i++) {
+			if (!(addTask([context]() {
+				context->run();
+			}))) {
+				break;
+			}
+		}
+		context->run();
+		// the last finished task sets the event exactly once
+		event->wait();
+	}
+
 	void ThreadPool::onRunWorker()
 	{
 		Ref<Thread> thread = Thread::getCurrent();
@@ -26,6 +26,8 @@
 
 #include "slib/core/string_buffer.h"
 #include "slib/core/math.h"
+#include "slib/core/io.h"
+#include "slib/core/mio.h"
 
 #define PTR_VAR(TYPE, x) (reinterpret_cast<TYPE*>(&(x)))
 #define REF_VAR(TYPE, x) (*PTR_VAR(TYPE, x))
@@ -4683,4 +4685,785 @@ namespace slib
 		return !(v1 == v2);
 	}
 
+
+#define PRIV_VARIANT_SERIALIZE_BUFFER_SIZE 4096
+#define PRIV_VARIANT_SERIALIZE_MAX_DEPTH 256
+
+	class _priv_VariantSerializer
+	{
+	public:
+		IWriter* writer;
+		sl_size pos;
+		sl_uint8 buf[PRIV_VARIANT_SERIALIZE_BUFFER_SIZE];
+		
+	public:
+		_priv_VariantSerializer(IWriter* _writer) noexcept: writer(_writer), pos(0)
+		{
+		}
+		
+	public:
+		sl_bool flush() noexcept
+		{
+			if (pos) {
+				if (writer->writeFully(buf, pos) != (sl_reg)pos) {
+					return sl_false;
+				}
+				pos = 0;
+			}
+			return sl_true;
+		}
+		
+		// `size` <= 9
+		SLIB_INLINE sl_uint8* reserve(sl_size size) noexcept
+		{
+			if (pos + size > PRIV_VARIANT_SERIALIZE_BUFFER_SIZE) {
+				if (!(flush())) {
+					return sl_null;
+				}
+			}
+			sl_uint8* p = buf + pos;
+			pos += size;
+			return p;
+		}
+		
+		sl_bool write(const void* data, sl_size size) noexcept
+		{
+			if (pos + size <= PRIV_VARIANT_SERIALIZE_BUFFER_SIZE) {
+				Base::copyMemory(buf + pos, data, size);
+				pos += size;
+				return sl_true;
+			}
+			if (!(flush())) {
+				return sl_false;
+			}
+			if (size < PRIV_VARIANT_SERIALIZE_BUFFER_SIZE) {
+				Base::copyMemory(buf, data, size);
+				pos = size;
+				return sl_true;
+			}
+			return writer->writeFully(data, size) == (sl_reg)size;
+		}
+		
+		sl_bool writeByte(sl_uint8 v) noexcept
+		{
+			sl_uint8* p = reserve(1);
+			if (p) {
+				*p = v;
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+		// writes the shortest of 8, 16, 32 bits length following `code8`, `code8 + 1`, `code8 + 2`
+		sl_bool writeLength(sl_uint8 code8, sl_size len) noexcept
+		{
+			if (len < 0x100) {
+				sl_uint8* p = reserve(2);
+				if (p) {
+					p[0] = code8;
+					p[1] = (sl_uint8)len;
+					return sl_true;
+				}
+			} else if (len < 0x10000) {
+				sl_uint8* p = reserve(3);
+				if (p) {
+					p[0] = code8 + 1;
+					MIO::writeUint16BE(p + 1, (sl_uint16)len);
+					return sl_true;
+				}
+			} else if ((sl_uint64)len <= 0xFFFFFFFF) {
+				sl_uint8* p = reserve(5);
+				if (p) {
+					p[0] = code8 + 2;
+					MIO::writeUint32BE(p + 1, (sl_uint32)len);
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+		
+		// array and map headers have no 8 bits length
+		sl_bool writeLength16or32(sl_uint8 code16, sl_size len) noexcept
+		{
+			if (len < 0x10000) {
+				sl_uint8* p = reserve(3);
+				if (p) {
+					p[0] = code16;
+					MIO::writeUint16BE(p + 1, (sl_uint16)len);
+					return sl_true;
+				}
+			} else if ((sl_uint64)len <= 0xFFFFFFFF) {
+				sl_uint8* p = reserve(5);
+				if (p) {
+					p[0] = code16 + 1;
+					MIO::writeUint32BE(p + 1, (sl_uint32)len);
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeUint(sl_uint64 v) noexcept
+		{
+			if (v < 0x80) {
+				return writeByte((sl_uint8)v);
+			} else if (v < 0x100) {
+				sl_uint8* p = reserve(2);
+				if (p) {
+					p[0] = 0xcc;
+					p[1] = (sl_uint8)v;
+					return sl_true;
+				}
+			} else if (v < 0x10000) {
+				sl_uint8* p = reserve(3);
+				if (p) {
+					p[0] = 0xcd;
+					MIO::writeUint16BE(p + 1, (sl_uint16)v);
+					return sl_true;
+				}
+			} else if (v <= 0xFFFFFFFF) {
+				sl_uint8* p = reserve(5);
+				if (p) {
+					p[0] = 0xce;
+					MIO::writeUint32BE(p + 1, (sl_uint32)v);
+					return sl_true;
+				}
+			} else {
+				sl_uint8* p = reserve(9);
+				if (p) {
+					p[0] = 0xcf;
+					MIO::writeUint64BE(p + 1, v);
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeInt(sl_int64 v) noexcept
+		{
+			if (v >= 0) {
+				return writeUint(v);
+			}
+			if (v >= -32) {
+				return writeByte((sl_uint8)(sl_int8)v);
+			} else if (v >= -128) {
+				sl_uint8* p = reserve(2);
+				if (p) {
+					p[0] = 0xd0;
+					p[1] = (sl_uint8)(sl_int8)v;
+					return sl_true;
+				}
+			} else if (v >= -32768) {
+				sl_uint8* p = reserve(3);
+				if (p) {
+					p[0] = 0xd1;
+					MIO::writeInt16BE(p + 1, (sl_int16)v);
+					return sl_true;
+				}
+			} else if (v >= -2147483647 - 1) {
+				sl_uint8* p = reserve(5);
+				if (p) {
+					p[0] = 0xd2;
+					MIO::writeInt32BE(p + 1, (sl_int32)v);
+					return sl_true;
+				}
+			} else {
+				sl_uint8* p = reserve(9);
+				if (p) {
+					p[0] = 0xd3;
+					MIO::writeInt64BE(p + 1, v);
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeFloat(float v) noexcept
+		{
+			sl_uint8* p = reserve(5);
+			if (p) {
+				p[0] = 0xca;
+				MIO::writeFloatBE(p + 1, v);
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeDouble(double v) noexcept
+		{
+			sl_uint8* p = reserve(9);
+			if (p) {
+				p[0] = 0xcb;
+				MIO::writeDoubleBE(p + 1, v);
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeString(const sl_char8* sz, sl_size len) noexcept
+		{
+			if (len < 32) {
+				if (!(writeByte((sl_uint8)(0xa0 | len)))) {
+					return sl_false;
+				}
+			} else {
+				if (!(writeLength(0xd9, len))) {
+					return sl_false;
+				}
+			}
+			return write(sz, len);
+		}
+		
+		sl_bool writeBinary(const void* data, sl_size size) noexcept
+		{
+			if (!(writeLength(0xc4, size))) {
+				return sl_false;
+			}
+			return write(data, size);
+		}
+		
+		sl_bool writeTime(const Time& time) noexcept
+		{
+			sl_int64 t = time.toInt();
+			sl_int64 seconds = t / 1000000;
+			sl_int64 us = t % 1000000;
+			if (us < 0) {
+				us += 1000000;
+				seconds--;
+			}
+			sl_uint32 ns = (sl_uint32)(us * 1000);
+			if (seconds >= 0 && (seconds >> 34) == 0) {
+				if (!ns && (seconds >> 32) == 0) {
+					// timestamp 32
+					sl_uint8* p = reserve(6);
+					if (p) {
+						p[0] = 0xd6;
+						p[1] = 0xff;
+						MIO::writeUint32BE(p + 2, (sl_uint32)seconds);
+						return sl_true;
+					}
+				} else {
+					// timestamp 64
+					sl_uint8* p = reserve(2);
+					if (p) {
+						p[0] = 0xd7;
+						p[1] = 0xff;
+						p = reserve(8);
+						if (p) {
+							MIO::writeUint64BE(p, ((sl_uint64)ns << 34) | (sl_uint64)seconds);
+							return sl_true;
+						}
+					}
+				}
+			} else {
+				// timestamp 96
+				sl_uint8* p = reserve(3);
+				if (p) {
+					p[0] = 0xc7;
+					p[1] = 12;
+					p[2] = 0xff;
+					p = reserve(4);
+					if (p) {
+						MIO::writeUint32BE(p, ns);
+						p = reserve(8);
+						if (p) {
+							MIO::writeInt64BE(p, seconds);
+							return sl_true;
+						}
+					}
+				}
+			}
+			return sl_false;
+		}
+		
+		sl_bool writeArrayHeader(sl_size n) noexcept
+		{
+			if (n < 16) {
+				return writeByte((sl_uint8)(0x90 | n));
+			}
+			return writeLength16or32(0xdc, n);
+		}
+		
+		sl_bool writeMapHeader(sl_size n) noexcept
+		{
+			if (n < 16) {
+				return writeByte((sl_uint8)(0x80 | n));
+			}
+			return writeLength16or32(0xde, n);
+		}
+		
+		sl_bool writeVariantList(const List<Variant>& list, sl_uint32 depth) noexcept
+		{
+			ListLocker<Variant> l(list);
+			if (!(writeArrayHeader(l.count))) {
+				return sl_false;
+			}
+			for (sl_size i = 0; i < l.count; i++) {
+				if (!(writeVariant(l.data[i], depth))) {
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+		
+		template <class MAP>
+		sl_bool writeVariantMap(const MAP& map, sl_uint32 depth) noexcept
+		{
+			MutexLocker lock(map.getLocker());
+			if (!(writeMapHeader(map.getCount()))) {
+				return sl_false;
+			}
+			for (auto& pair : map) {
+				if (!(writeString(pair.key.getData(), pair.key.getLength()))) {
+					return sl_false;
+				}
+				if (!(writeVariant(pair.value, depth))) {
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+		
+		template <class MAP>
+		sl_bool writeVariantMapList(const List<MAP>& list, sl_uint32 depth) noexcept
+		{
+			ListLocker<MAP> l(list);
+			if (!(writeArrayHeader(l.count))) {
+				return sl_false;
+			}
+			for (sl_size i = 0; i < l.count; i++) {
+				if (!(writeVariantMap(l.data[i], depth))) {
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+		
+		sl_bool writeVariant(const Variant& v, sl_uint32 depth) noexcept
+		{
+			switch (v._type) {
+				case VariantType::Int32:
+					return writeInt(REF_VAR(sl_int32 const, v._value));
+				case VariantType::Uint32:
+					return writeUint(REF_VAR(sl_uint32 const, v._value));
+				case VariantType::Int64:
+					return writeInt(REF_VAR(sl_int64 const, v._value));
+				case VariantType::Uint64:
+					return writeUint(REF_VAR(sl_uint64 const, v._value));
+				case VariantType::Float:
+					return writeFloat(REF_VAR(float const, v._value));
+				case VariantType::Double:
+					return writeDouble(REF_VAR(double const, v._value));
+				case VariantType::Boolean:
+					return writeByte(REF_VAR(sl_bool const, v._value) ? 0xc3 : 0xc2);
+				case VariantType::Time:
+					return writeTime(REF_VAR(Time const, v._value));
+				case VariantType::String8:
+					{
+						String const& str = REF_VAR(String const, v._value);
+						return writeString(str.getData(), str.getLength());
+					}
+				case VariantType::Sz8:
+					{
+						sl_char8 const* sz = REF_VAR(sl_char8 const* const, v._value);
+						return writeString(sz, Base::getStringLength(sz));
+					}
+				case VariantType::String16:
+				case VariantType::Sz16:
+					{
+						String str = v.getString();
+						return writeString(str.getData(), str.getLength());
+					}
+				case VariantType::Object:
+				case VariantType::Weak:
+					{
+						if (depth >= PRIV_VARIANT_SERIALIZE_MAX_DEPTH) {
+							return sl_false;
+						}
+						depth++;
+						Ref<Referable> obj(v.getObject());
+						if (obj.isNotNull()) {
+							if (CMemory* p0 = CastInstance<CMemory>(obj._ptr)) {
+								return writeBinary(p0->getData(), p0->getCount());
+							} else if (CList<Variant>* p1 = CastInstance< CList<Variant> >(obj._ptr)) {
+								return writeVariantList(p1, depth);
+							} else if (CMap<String, Variant>* p2 = CastInstance< CMap<String, Variant> >(obj._ptr)) {
+								return writeVariantMap(Map<String, Variant>(p2), depth);
+							} else if (CHashMap<String, Variant>* p3 = CastInstance< CHashMap<String, Variant> >(obj._ptr)) {
+								return writeVariantMap(HashMap<String, Variant>(p3), depth);
+							} else if (CList< Map<String, Variant> >* p4 = CastInstance< CList< Map<String, Variant> > >(obj._ptr)) {
+								return writeVariantMapList< Map<String, Variant> >(p4, depth);
+							} else if (CList< HashMap<String, Variant> >* p5 = CastInstance< CList< HashMap<String, Variant> > >(obj._ptr)) {
+								return writeVariantMapList< HashMap<String, Variant> >(p5, depth);
+							}
+						}
+						break;
+					}
+				default:
+					break;
+			}
+			return writeByte(0xc0);
+		}
+		
+	};
+	
+	class _priv_VariantDeserializer
+	{
+	public:
+		const sl_uint8* data;
+		sl_size size;
+		sl_size pos;
+		
+	public:
+		_priv_VariantDeserializer(const void* _data, sl_size _size) noexcept: data((const sl_uint8*)_data), size(_size), pos(0)
+		{
+		}
+		
+	public:
+		SLIB_INLINE const sl_uint8* read(sl_size n) noexcept
+		{
+			if (n > size - pos) {
+				return sl_null;
+			}
+			const sl_uint8* p = data + pos;
+			pos += n;
+			return p;
+		}
+		
+		// reads 8, 16, 32 bits big-endian length
+		SLIB_INLINE sl_bool readLength(sl_uint32 nBytes, sl_size& len) noexcept
+		{
+			const sl_uint8* p = read(nBytes);
+			if (!p) {
+				return sl_false;
+			}
+			if (nBytes == 1) {
+				len = *p;
+			} else if (nBytes == 2) {
+				len = MIO::readUint16BE(p);
+			} else {
+				len = MIO::readUint32BE(p);
+			}
+			return sl_true;
+		}
+		
+		SLIB_INLINE static void setUint(Variant& _out, sl_uint64 v) noexcept
+		{
+			if (v <= 0x7FFFFFFF) {
+				_out = (sl_int32)v;
+			} else if (v <= 0xFFFFFFFF) {
+				_out = (sl_uint32)v;
+			} else if (v <= 0x7FFFFFFFFFFFFFFF) {
+				_out = (sl_int64)v;
+			} else {
+				_out = v;
+			}
+		}
+		
+		SLIB_INLINE static void setInt(Variant& _out, sl_int64 v) noexcept
+		{
+			if (v >= -2147483647 - 1 && v <= 2147483647) {
+				_out = (sl_int32)v;
+			} else {
+				_out = v;
+			}
+		}
+		
+		sl_bool readString(sl_size len, Variant& _out) noexcept
+		{
+			const sl_uint8* p = read(len);
+			if (!p) {
+				return sl_false;
+			}
+			_out = String((const sl_char8*)p, len);
+			return sl_true;
+		}
+		
+		sl_bool readBinary(sl_size len, Variant& _out) noexcept
+		{
+			const sl_uint8* p = read(len);
+			if (!p) {
+				return sl_false;
+			}
+			_out = Memory::create(p, len);
+			return sl_true;
+		}
+		
+		sl_bool readExtension(sl_size len, Variant& _out) noexcept
+		{
+			const sl_uint8* p = read(1);
+			if (!p) {
+				return sl_false;
+			}
+			sl_int8 type = (sl_int8)(*p);
+			p = read(len);
+			if (!p) {
+				return sl_false;
+			}
+			if (type == -1) {
+				// timestamp
+				sl_int64 seconds;
+				sl_uint32 ns;
+				if (len == 4) {
+					seconds = MIO::readUint32BE(p);
+					ns = 0;
+				} else if (len == 8) {
+					sl_uint64 v = MIO::readUint64BE(p);
+					ns = (sl_uint32)(v >> 34);
+					seconds = (sl_int64)(v & SLIB_UINT64(0x3FFFFFFFF));
+				} else if (len == 12) {
+					ns = MIO::readUint32BE(p);
+					seconds = MIO::readInt64BE(p + 4);
+				} else {
+					return sl_false;
+				}
+				_out = Time::fromInt(seconds * 1000000 + ns / 1000);
+			} else {
+				// unknown extensions are not supported
+				_out.setNull();
+			}
+			return sl_true;
+		}
+		
+		sl_bool readArray(sl_size n, Variant& _out, sl_uint32 depth) noexcept
+		{
+			// each element takes one byte at least
+			if (n > size - pos) {
+				return sl_false;
+			}
+			List<Variant> list = List<Variant>::create(n);
+			if (list.isNull()) {
+				return sl_false;
+			}
+			Variant* p = list.getData();
+			for (sl_size i = 0; i < n; i++) {
+				if (!(readVariant(p[i], depth))) {
+					return sl_false;
+				}
+			}
+			_out.setVariantList(list);
+			return sl_true;
+		}
+		
+		sl_bool readMap(sl_size n, Variant& _out, sl_uint32 depth) noexcept
+		{
+			if (n > (size - pos) / 2) {
+				return sl_false;
+			}
+			HashMap<String, Variant> map = HashMap<String, Variant>::create();
+			if (map.isNull()) {
+				return sl_false;
+			}
+			for (sl_size i = 0; i < n; i++) {
+				Variant key;
+				if (!(readVariant(key, depth))) {
+					return sl_false;
+				}
+				Variant value;
+				if (!(readVariant(value, depth))) {
+					return sl_false;
+				}
+				map.put_NoLock(key.getString(), Move(value));
+			}
+			_out.setVariantHashMap(map);
+			return sl_true;
+		}
+		
+		sl_bool readVariant(Variant& _out, sl_uint32 depth) noexcept
+		{
+			const sl_uint8* p = read(1);
+			if (!p) {
+				return sl_false;
+			}
+			sl_uint8 code = *p;
+			if (code < 0x80) {
+				_out = (sl_int32)code;
+				return sl_true;
+			}
+			if (code >= 0xe0) {
+				_out = (sl_int32)(sl_int8)code;
+				return sl_true;
+			}
+			if (code >= 0xa0 && code < 0xc0) {
+				return readString(code & 0x1f, _out);
+			}
+			sl_size len;
+			if (code < 0xa0 || code == 0xdc || code == 0xdd || code == 0xde || code == 0xdf) {
+				if (depth >= PRIV_VARIANT_SERIALIZE_MAX_DEPTH) {
+					return sl_false;
+				}
+				depth++;
+				if (code < 0x90) {
+					return readMap(code & 0x0f, _out, depth);
+				} else if (code < 0xa0) {
+					return readArray(code & 0x0f, _out, depth);
+				}
+				if (!(readLength((code & 1) ? 4 : 2, len))) {
+					return sl_false;
+				}
+				if (code < 0xde) {
+					return readArray(len, _out, depth);
+				} else {
+					return readMap(len, _out, depth);
+				}
+			}
+			switch (code) {
+				case 0xc0:
+					_out.setNull();
+					return sl_true;
+				case 0xc2:
+					_out = sl_false;
+					return sl_true;
+				case 0xc3:
+					_out = sl_true;
+					return sl_true;
+				case 0xc4:
+				case 0xc5:
+				case 0xc6:
+					if (!(readLength(1 << (code - 0xc4), len))) {
+						return sl_false;
+					}
+					return readBinary(len, _out);
+				case 0xc7:
+				case 0xc8:
+				case 0xc9:
+					if (!(readLength(1 << (code - 0xc7), len))) {
+						return sl_false;
+					}
+					return readExtension(len, _out);
+				case 0xca:
+					if ((p = read(4))) {
+						_out = MIO::readFloatBE(p);
+						return sl_true;
+					}
+					break;
+				case 0xcb:
+					if ((p = read(8))) {
+						_out = MIO::readDoubleBE(p);
+						return sl_true;
+					}
+					break;
+				case 0xcc:
+					if ((p = read(1))) {
+						_out = (sl_int32)(*p);
+						return sl_true;
+					}
+					break;
+				case 0xcd:
+					if ((p = read(2))) {
+						_out = (sl_int32)(MIO::readUint16BE(p));
+						return sl_true;
+					}
+					break;
+				case 0xce:
+					if ((p = read(4))) {
+						setUint(_out, MIO::readUint32BE(p));
+						return sl_true;
+					}
+					break;
+				case 0xcf:
+					if ((p = read(8))) {
+						setUint(_out, MIO::readUint64BE(p));
+						return sl_true;
+					}
+					break;
+				case 0xd0:
+					if ((p = read(1))) {
+						_out = (sl_int32)(sl_int8)(*p);
+						return sl_true;
+					}
+					break;
+				case 0xd1:
+					if ((p = read(2))) {
+						_out = (sl_int32)(MIO::readInt16BE(p));
+						return sl_true;
+					}
+					break;
+				case 0xd2:
+					if ((p = read(4))) {
+						_out = MIO::readInt32BE(p);
+						return sl_true;
+					}
+					break;
+				case 0xd3:
+					if ((p = read(8))) {
+						setInt(_out, MIO::readInt64BE(p));
+						return sl_true;
+					}
+					break;
+				case 0xd4:
+				case 0xd5:
+				case 0xd6:
+				case 0xd7:
+				case 0xd8:
+					return readExtension((sl_size)1 << (code - 0xd4), _out);
+				case 0xd9:
+				case 0xda:
+				case 0xdb:
+					if (!(readLength(1 << (code - 0xd9), len))) {
+						return sl_false;
+					}
+					return readString(len, _out);
+				default:
+					break;
+			}
+			return sl_false;
+		}
+		
+	};
+	
+	sl_bool Variant::serialize(IWriter* writer) const noexcept
+	{
+		if (!writer) {
+			return sl_false;
+		}
+		_priv_VariantSerializer serializer(writer);
+		if (serializer.writeVariant(*this, 0)) {
+			return serializer.flush();
+		}
+		return sl_false;
+	}
+	
+	Memory Variant::serialize() const noexcept
+	{
+		MemoryWriter writer;
+		if (serialize(&writer)) {
+			return writer.getData();
+		}
+		return sl_null;
+	}
+	
+	sl_bool Variant::deserialize(MemoryReader* reader, Variant& _out) noexcept
+	{
+		if (!reader) {
+			return sl_false;
+		}
+		sl_size offset = reader->getOffset();
+		sl_size length = reader->getLength();
+		if (offset >= length) {
+			return sl_false;
+		}
+		_priv_VariantDeserializer deserializer(reader->getBuffer() + offset, length - offset);
+		if (deserializer.readVariant(_out, 0)) {
+			reader->seek(deserializer.pos, SeekPosition::Current);
+			return sl_true;
+		}
+		return sl_false;
+	}
+	
+	Variant Variant::deserialize(const void* data, sl_size size) noexcept
+	{
+		_priv_VariantDeserializer deserializer(data, size);
+		Variant ret;
+		if (deserializer.readVariant(ret, 0)) {
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	Variant Variant::deserialize(const Memory& mem) noexcept
+	{
+		return deserialize(mem.getData(), mem.getSize());
+	}
+
 }
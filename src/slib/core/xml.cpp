@@ -25,6 +25,8 @@
 #include "slib/core/file.h"
 #include "slib/core/log.h"
 #include "slib/core/string_buffer.h"
+#include "slib/core/io.h"
+#include "slib/core/async.h"
 
 namespace slib
 {
@@ -1316,6 +1318,19 @@ namespace slib
 		currentNode = sl_null;
 	}
 
+	static void _priv_Xml_processPrefix(const String& name, const String& defNamespace, const HashMap<String, String>& namespaces, String& prefix, String& uri, String& localName)
+	{
+		sl_reg index = name.indexOf(':');
+		if (index >= 0) {
+			prefix = name.substring(0, index);
+			localName = name.substring(index+1);
+			namespaces.get(prefix, &uri);
+		} else {
+			localName = name;
+			uri = defNamespace;
+		}
+	}
+
 	template <class ST, class CT, class BT>
 	class _priv_Xml_Parser
 	{
@@ -1801,15 +1816,7 @@ namespace slib
 	template <class ST, class CT, class BT>
 	SLIB_INLINE void _priv_Xml_Parser<ST, CT, BT>::processPrefix(const String& name, const String& defNamespace, const HashMap<String, String>& namespaces, String& prefix, String& uri, String& localName)
 	{
-		sl_reg index = name.indexOf(':');
-		if (index >= 0) {
-			prefix = name.substring(0, index);
-			localName = name.substring(index+1);
-			namespaces.get(prefix, &uri);
-		} else {
-			localName = name;
-			uri = defNamespace;
-		}
+		_priv_Xml_processPrefix(name, defNamespace, namespaces, prefix, uri, localName);
 	}
 
 	template <class ST, class CT, class BT>
@@ -2267,26 +2274,1486 @@ namespace slib
 		
 	}
 
-	Ref<XmlDocument> Xml::parseXml(const sl_char8* sz, sl_size len, XmlParseParam& param)
+	SLIB_STATIC_STRING(_g_xml_error_msg_token_too_long, "Token is longer than the maximum token size")
+
+#define PRIV_XML_PULL_READ_SIZE 0x10000
+#define PRIV_XML_PULL_MAX_TOKEN_SIZE 0x1000000
+
+	XmlStringSlice::XmlStringSlice()
 	{
-		return _priv_Xml_Parser<String, sl_char8, StringBuffer>::parseXml(String::null(), sz, len, param);
+		data = sl_null;
+		length = 0;
 	}
 
-	Ref<XmlDocument> Xml::parseXml(const sl_char8* sz, sl_size len)
+	String XmlStringSlice::toString() const
 	{
-		XmlParseParam param;
-		return parseXml(sz, len, param);
+		return String(data, length);
 	}
 
-	Ref<XmlDocument> Xml::parseXml(const String& xml, XmlParseParam& param)
+	sl_bool XmlStringSlice::equals(const sl_char8* str, sl_size len) const
 	{
-		return _priv_Xml_Parser<String, sl_char8, StringBuffer>::parseXml(String::null(), xml.getData(), xml.getLength(), param);
+		return length == len && Base::equalsMemory(data, str, len);
 	}
 
-	Ref<XmlDocument> Xml::parseXml(const String& xml)
+	sl_bool XmlStringSlice::equals(const String& str) const
 	{
-		XmlParseParam param;
-		return parseXml(xml, param);
+		return equals(str.getData(), str.getLength());
+	}
+
+	static sl_bool _priv_XmlPull_reserve(sl_char8*& buf, sl_size& capacity, sl_size size)
+	{
+		if (size <= capacity) {
+			return sl_true;
+		}
+		sl_size n = capacity ? capacity : 256;
+		while (n < size) {
+			n <<= 1;
+		}
+		sl_char8* p = (sl_char8*)(Base::reallocMemory(buf, n));
+		if (!p) {
+			return sl_false;
+		}
+		buf = p;
+		capacity = n;
+		return sl_true;
+	}
+
+	// 1: valid, 0: needs more input, -1: invalid starting character
+	static sl_int32 _priv_XmlPull_scanName(const sl_char8* p, sl_size n, sl_size start, sl_size& end)
+	{
+		if (start >= n) {
+			return 0;
+		}
+		sl_uint32 ch = (sl_uint8)(p[start]);
+		if (ch < 128 && _g_XML_check_name_pattern[ch] != 1) {
+			return -1;
+		}
+		sl_size i = start + 1;
+		while (i < n) {
+			ch = (sl_uint8)(p[i]);
+			if (ch < 128 && _g_XML_check_name_pattern[ch] == 0) {
+				end = i;
+				return 1;
+			}
+			i++;
+		}
+		return 0;
+	}
+
+	XmlPullParser::XmlPullParser()
+	{
+		m_buf = sl_null;
+		m_len = 0;
+		m_pos = 0;
+		m_base = 0;
+		m_bufOwned = sl_null;
+		m_capacityOwned = 0;
+		m_flagFinished = sl_false;
+		m_maxTokenSize = PRIV_XML_PULL_MAX_TOKEN_SIZE;
+
+		m_scanOffset = 0;
+		m_scanQuote = 0;
+
+		m_type = XmlPullEventType::None;
+		m_flagEmptyTag = sl_false;
+		m_posStart = 0;
+		m_posEnd = 0;
+
+		m_scratch = sl_null;
+		m_capacityScratch = 0;
+
+		m_stack = sl_null;
+		m_sizeStack = 0;
+		m_capacityStack = 0;
+		m_flagPendingEndTag = sl_false;
+		m_flagPopElement = sl_false;
+
+		m_nPendingParts = 0;
+		m_indexPendingPart = 0;
+
+		m_posLine = 0;
+		m_lineNumber = 1;
+		m_columnNumber = 1;
+		m_flagLastCR = sl_false;
+	}
+
+	XmlPullParser::~XmlPullParser()
+	{
+		if (m_bufOwned) {
+			Base::freeMemory(m_bufOwned);
+		}
+		if (m_scratch) {
+			Base::freeMemory(m_scratch);
+		}
+		if (m_stack) {
+			Base::freeMemory(m_stack);
+		}
+	}
+
+	void XmlPullParser::setInput(const void* data, sl_size size, sl_size offset)
+	{
+		m_buf = (const sl_char8*)data;
+		m_len = size;
+		m_pos = offset < size ? offset : size;
+		m_base = 0;
+		m_flagFinished = sl_true;
+		m_reader.setNull();
+		m_scanOffset = 0;
+		m_scanQuote = 0;
+		m_nPendingParts = 0;
+		m_indexPendingPart = 0;
+		m_posLine = 0;
+		m_lineNumber = 1;
+		m_columnNumber = 1;
+		m_flagLastCR = sl_false;
+		if (m_type != XmlPullEventType::Error && m_type != XmlPullEventType::EndDocument) {
+			m_type = XmlPullEventType::None;
+		}
+	}
+
+	void XmlPullParser::setReader(const Ptr<IReader>& reader)
+	{
+		m_reader = reader;
+		m_buf = m_bufOwned;
+		m_len = 0;
+		m_pos = 0;
+		m_base = 0;
+		m_flagFinished = sl_false;
+		m_posLine = 0;
+		m_lineNumber = 1;
+		m_columnNumber = 1;
+		m_flagLastCR = sl_false;
+	}
+
+	sl_bool XmlPullParser::feed(const void* data, sl_size size)
+	{
+		if (m_flagFinished) {
+			return sl_false;
+		}
+		if (m_buf != m_bufOwned) {
+			// keeps the remaining of the borrowed input
+			_updateLineNumber(m_pos);
+			sl_size n = m_len - m_pos;
+			if (!(_reserveBuffer(n + size))) {
+				return sl_false;
+			}
+			Base::copyMemory(m_bufOwned, m_buf + m_pos, n);
+			m_base += m_pos;
+			m_posLine = 0;
+			m_len = n;
+			m_pos = 0;
+		} else {
+			_compact();
+			if (!(_reserveBuffer(m_len + size))) {
+				return sl_false;
+			}
+		}
+		m_buf = m_bufOwned;
+		Base::copyMemory(m_bufOwned + m_len, data, size);
+		m_len += size;
+		return sl_true;
+	}
+
+	void XmlPullParser::finish()
+	{
+		m_flagFinished = sl_true;
+	}
+
+	sl_size XmlPullParser::getMaximumTokenSize()
+	{
+		return m_maxTokenSize;
+	}
+
+	void XmlPullParser::setMaximumTokenSize(sl_size size)
+	{
+		m_maxTokenSize = size;
+	}
+
+	XmlPullEventType XmlPullParser::next()
+	{
+		if (m_type == XmlPullEventType::Error || m_type == XmlPullEventType::EndDocument) {
+			return m_type;
+		}
+		m_name = XmlStringSlice();
+		m_text = XmlStringSlice();
+		m_attributes.setCount_NoLock(0);
+		m_flagEmptyTag = sl_false;
+		if (m_flagPopElement) {
+			m_flagPopElement = sl_false;
+			sl_size offset = 0;
+			if (m_stackOffsets.popBack_NoLock(&offset)) {
+				m_sizeStack = offset;
+			}
+		}
+		if (m_flagPendingEndTag) {
+			m_flagPendingEndTag = sl_false;
+			m_flagPopElement = sl_true;
+			sl_size offset = m_stackOffsets.getValueAt_NoLock(m_stackOffsets.getCount() - 1);
+			m_name.data = m_stack + offset;
+			m_name.length = m_sizeStack - offset;
+			m_posStart = m_posEnd;
+			m_type = XmlPullEventType::EndElement;
+			return m_type;
+		}
+		if (m_indexPendingPart < m_nPendingParts) {
+			return _emitPendingPart();
+		}
+		m_nPendingParts = 0;
+		m_indexPendingPart = 0;
+		for (;;) {
+			XmlPullEventType type = _parseToken();
+			if (type == XmlPullEventType::NeedMoreData && m_reader.isNotNull() && !m_flagFinished) {
+				if (!(_readInput())) {
+					m_flagFinished = sl_true;
+				}
+				continue;
+			}
+			return type;
+		}
+	}
+
+	XmlPullEventType XmlPullParser::getEventType()
+	{
+		return m_type;
+	}
+
+	const XmlStringSlice& XmlPullParser::getName()
+	{
+		return m_name;
+	}
+
+	const XmlStringSlice& XmlPullParser::getText()
+	{
+		return m_text;
+	}
+
+	sl_size XmlPullParser::getAttributesCount()
+	{
+		return m_attributes.getCount();
+	}
+
+	const XmlPullAttribute* XmlPullParser::getAttributes()
+	{
+		return m_attributes.getData();
+	}
+
+	sl_bool XmlPullParser::getAttribute(const String& name, XmlStringSlice* _out)
+	{
+		ListElements<XmlPullAttribute> attrs(m_attributes);
+		for (sl_size i = 0; i < attrs.count; i++) {
+			if (attrs[i].name.equals(name)) {
+				if (_out) {
+					*_out = attrs[i].value;
+				}
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	sl_bool XmlPullParser::isEmptyElementTag()
+	{
+		return m_flagEmptyTag;
+	}
+
+	sl_size XmlPullParser::getDepth()
+	{
+		return m_stackOffsets.getCount();
+	}
+
+	sl_uint64 XmlPullParser::getStartPosition()
+	{
+		return m_posStart;
+	}
+
+	sl_uint64 XmlPullParser::getEndPosition()
+	{
+		return m_posEnd;
+	}
+
+	sl_uint64 XmlPullParser::getLineNumber()
+	{
+		if (m_posStart >= m_base) {
+			_updateLineNumber((sl_size)(m_posStart - m_base));
+		}
+		return m_lineNumber;
+	}
+
+	sl_uint64 XmlPullParser::getColumnNumber()
+	{
+		if (m_posStart >= m_base) {
+			_updateLineNumber((sl_size)(m_posStart - m_base));
+		}
+		return m_columnNumber;
+	}
+
+	String XmlPullParser::getErrorMessage()
+	{
+		return m_errorMessage;
+	}
+
+	XmlPullEventType XmlPullParser::_parseToken()
+	{
+		sl_size n = m_len - m_pos;
+		const sl_char8* p = m_buf + m_pos;
+		if (!n) {
+			if (!m_flagFinished) {
+				m_type = XmlPullEventType::NeedMoreData;
+				return m_type;
+			}
+			if (m_stackOffsets.isNotEmpty()) {
+				return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, m_pos);
+			}
+			return _setEvent(XmlPullEventType::EndDocument, m_pos, m_pos);
+		}
+		if (p[0] != '<') {
+			return _parseText(p, n);
+		}
+		if (n < 2) {
+			return _needMoreData(_g_xml_error_msg_name_missing);
+		}
+		sl_char8 ch = p[1];
+		if (ch == '!') { // Comment, CDATA
+			if (n >= 4 && p[2] == '-' && p[3] == '-') {
+				return _parseComment(p, n);
+			}
+			sl_size k = n < 9 ? n : 9;
+			if (Base::equalsMemory(p, "<![CDATA[", k)) {
+				if (k == 9) {
+					return _parseCDATA(p, n);
+				}
+				return _needMoreData(_g_xml_error_msg_invalid_markup);
+			}
+			if (n == 3 && p[2] == '-') {
+				return _needMoreData(_g_xml_error_msg_invalid_markup);
+			}
+			return _setError(_g_xml_error_msg_invalid_markup, m_pos);
+		} else if (ch == '?') {
+			return _parsePI(p, n);
+		} else if (ch == '/') {
+			return _parseEndTag(p, n);
+		} else {
+			return _parseStartTag(p, n);
+		}
+	}
+
+	XmlPullEventType XmlPullParser::_parseText(const sl_char8* p, sl_size n)
+	{
+		sl_size k;
+		const sl_uint8* q = Base::findMemory(p + m_scanOffset, '<', n - m_scanOffset);
+		if (q) {
+			k = q - (const sl_uint8*)p;
+		} else {
+			if (!m_flagFinished) {
+				m_scanOffset = n;
+				return _needMoreData(String::null());
+			}
+			k = n;
+		}
+		// leading whitespaces, text, trailing whitespaces
+		sl_size a = 0;
+		while (a < k && SLIB_CHAR_IS_WHITE_SPACE(p[a])) {
+			a++;
+		}
+		sl_size b = k;
+		while (b > a && SLIB_CHAR_IS_WHITE_SPACE(p[b - 1])) {
+			b--;
+		}
+		sl_uint64 start = m_base + m_pos;
+		m_nPendingParts = 0;
+		m_indexPendingPart = 0;
+		if (a > 0) {
+			PendingPart& part = m_pendingParts[m_nPendingParts++];
+			part.type = XmlPullEventType::WhiteSpace;
+			part.start = start;
+			part.end = start + a;
+		}
+		if (b > a) {
+			PendingPart& part = m_pendingParts[m_nPendingParts++];
+			part.type = XmlPullEventType::Text;
+			part.start = start + a;
+			part.end = start + b;
+		}
+		if (k > b) {
+			PendingPart& part = m_pendingParts[m_nPendingParts++];
+			part.type = XmlPullEventType::WhiteSpace;
+			part.start = start + b;
+			part.end = start + k;
+		}
+		return _emitPendingPart();
+	}
+
+	XmlPullEventType XmlPullParser::_emitPendingPart()
+	{
+		PendingPart& part = m_pendingParts[m_indexPendingPart++];
+		sl_size start = (sl_size)(part.start - m_base);
+		sl_size end = (sl_size)(part.end - m_base);
+		if (part.type == XmlPullEventType::Text) {
+			if (!(_reserveScratch(end - start))) {
+				return _setError(_g_xml_error_msg_memory_lack, start);
+			}
+			sl_size sizeScratch = 0;
+			sl_size errorOffset = 0;
+			if (!(_decode(m_buf + start, end - start, m_text, sizeScratch, errorOffset))) {
+				return _setError(m_errorMessage, start + errorOffset);
+			}
+		} else {
+			m_text.data = m_buf + start;
+			m_text.length = end - start;
+		}
+		return _setEvent(part.type, start, end);
+	}
+
+	XmlPullEventType XmlPullParser::_parseComment(const sl_char8* p, sl_size n)
+	{
+		sl_size i = m_scanOffset > 4 ? m_scanOffset : 4;
+		for (;;) {
+			const sl_uint8* q = i < n ? Base::findMemory(p + i, '-', n - i) : sl_null;
+			if (!q) {
+				m_scanOffset = n;
+				return _needMoreData(_g_xml_error_msg_comment_not_end);
+			}
+			sl_size k = q - (const sl_uint8*)p;
+			if (k + 1 >= n) {
+				m_scanOffset = k;
+				return _needMoreData(_g_xml_error_msg_comment_not_end);
+			}
+			if (p[k + 1] == '-') {
+				if (k + 2 >= n) {
+					m_scanOffset = k;
+					return _needMoreData(_g_xml_error_msg_comment_not_end);
+				}
+				if (p[k + 2] != '>') {
+					return _setError(_g_xml_error_msg_comment_double_hyphen, m_pos + k);
+				}
+				m_text.data = p + 4;
+				m_text.length = k - 4;
+				return _setEvent(XmlPullEventType::Comment, m_pos, m_pos + k + 3);
+			}
+			i = k + 1;
+		}
+	}
+
+	XmlPullEventType XmlPullParser::_parseCDATA(const sl_char8* p, sl_size n)
+	{
+		sl_size i = m_scanOffset > 9 ? m_scanOffset : 9;
+		for (;;) {
+			const sl_uint8* q = i < n ? Base::findMemory(p + i, ']', n - i) : sl_null;
+			if (!q) {
+				m_scanOffset = n;
+				return _needMoreData(_g_xml_error_msg_CDATA_not_end);
+			}
+			sl_size k = q - (const sl_uint8*)p;
+			if (k + 2 >= n) {
+				m_scanOffset = k;
+				return _needMoreData(_g_xml_error_msg_CDATA_not_end);
+			}
+			if (p[k + 1] == ']' && p[k + 2] == '>') {
+				m_text.data = p + 9;
+				m_text.length = k - 9;
+				return _setEvent(XmlPullEventType::CDATA, m_pos, m_pos + k + 3);
+			}
+			i = k + 1;
+		}
+	}
+
+	XmlPullEventType XmlPullParser::_parsePI(const sl_char8* p, sl_size n)
+	{
+		sl_size end = 0;
+		sl_int32 iRet = _priv_XmlPull_scanName(p, n, 2, end);
+		if (iRet < 0) {
+			return _setError(_g_xml_error_msg_name_invalid_start, m_pos + 2);
+		}
+		if (!iRet) {
+			return _needMoreData(_g_xml_error_msg_PI_not_end);
+		}
+		sl_size i = end;
+		if (p[i] != '?') {
+			if (SLIB_CHAR_IS_WHITE_SPACE(p[i])) {
+				while (i < n && SLIB_CHAR_IS_WHITE_SPACE(p[i])) {
+					i++;
+				}
+				if (i >= n) {
+					return _needMoreData(_g_xml_error_msg_PI_not_end);
+				}
+			} else {
+				return _setError(_g_xml_error_msg_name_invalid_char, m_pos + i);
+			}
+		}
+		sl_size startContent = i;
+		if (m_scanOffset > i) {
+			i = m_scanOffset;
+		}
+		for (;;) {
+			const sl_uint8* q = i < n ? Base::findMemory(p + i, '?', n - i) : sl_null;
+			if (!q) {
+				m_scanOffset = n;
+				return _needMoreData(_g_xml_error_msg_PI_not_end);
+			}
+			sl_size k = q - (const sl_uint8*)p;
+			if (k + 1 >= n) {
+				m_scanOffset = k;
+				return _needMoreData(_g_xml_error_msg_PI_not_end);
+			}
+			if (p[k + 1] == '>') {
+				m_name.data = p + 2;
+				m_name.length = end - 2;
+				m_text.data = p + startContent;
+				m_text.length = k - startContent;
+				return _setEvent(XmlPullEventType::ProcessingInstruction, m_pos, m_pos + k + 2);
+			}
+			i = k + 1;
+		}
+	}
+
+	XmlPullEventType XmlPullParser::_parseStartTag(const sl_char8* p, sl_size n)
+	{
+		// finds the end of the tag, skipping quoted values
+		sl_size i = m_scanOffset > 1 ? m_scanOffset : 1;
+		sl_char8 quote = m_scanQuote;
+		for (; i < n; i++) {
+			sl_char8 ch = p[i];
+			if (quote) {
+				if (ch == quote) {
+					quote = 0;
+				}
+			} else if (ch == '\"' || ch == '\'') {
+				quote = ch;
+			} else if (ch == '>') {
+				break;
+			}
+		}
+		if (i >= n) {
+			m_scanOffset = n;
+			m_scanQuote = quote;
+			return _needMoreData(_g_xml_error_msg_element_tag_not_end);
+		}
+		sl_size lenTag = i + 1;
+		
+		sl_size end = 0;
+		if (_priv_XmlPull_scanName(p, lenTag, 1, end) <= 0) {
+			return _setError(_g_xml_error_msg_name_invalid_start, m_pos + 1);
+		}
+		XmlStringSlice name;
+		name.data = p + 1;
+		name.length = end - 1;
+		
+		if (!(_reserveScratch(lenTag))) {
+			return _setError(_g_xml_error_msg_memory_lack, m_pos);
+		}
+		sl_size sizeScratch = 0;
+		m_attributes.setCount_NoLock(0);
+		
+		sl_size pos = end;
+		sl_size indexAttr = 0;
+		for (;;) {
+			sl_size startWhiteSpace = pos;
+			sl_char8 ch = p[pos];
+			if (ch != '>' && ch != '/') {
+				if (SLIB_CHAR_IS_WHITE_SPACE(ch)) {
+					pos++;
+					while (SLIB_CHAR_IS_WHITE_SPACE(p[pos])) {
+						pos++;
+					}
+				} else {
+					if (indexAttr == 0) {
+						return _setError(_g_xml_error_msg_name_invalid_char, m_pos + pos);
+					} else {
+						return _setError(_g_xml_error_msg_element_attr_end_with_invalid_char, m_pos + pos);
+					}
+				}
+			}
+			sl_size endWhiteSpace = pos;
+			ch = p[pos];
+			if (ch == '>' || ch == '/') {
+				break;
+			}
+			XmlPullAttribute attr;
+			attr.whiteSpacesBeforeName.data = p + startWhiteSpace;
+			attr.whiteSpacesBeforeName.length = endWhiteSpace - startWhiteSpace;
+			if (_priv_XmlPull_scanName(p, lenTag, pos, end) <= 0) {
+				return _setError(_g_xml_error_msg_name_invalid_start, m_pos + pos);
+			}
+			attr.name.data = p + pos;
+			attr.name.length = end - pos;
+			pos = end;
+			ch = p[pos];
+			if (ch != '=') {
+				if (SLIB_CHAR_IS_WHITE_SPACE(ch)) {
+					while (SLIB_CHAR_IS_WHITE_SPACE(p[pos])) {
+						pos++;
+					}
+				} else {
+					return _setError(_g_xml_error_msg_name_invalid_char, m_pos + pos);
+				}
+			}
+			if (p[pos] != '=') {
+				return _setError(_g_xml_error_msg_element_attr_required_assign, m_pos + pos);
+			}
+			pos++;
+			while (SLIB_CHAR_IS_WHITE_SPACE(p[pos])) {
+				pos++;
+			}
+			sl_char8 chQuot = p[pos];
+			if (chQuot != '\"' && chQuot != '\'') {
+				return _setError(_g_xml_error_msg_element_attr_required_quot, m_pos + pos);
+			}
+			pos++;
+			sl_size startValue = pos;
+			while (pos < i && p[pos] != chQuot) {
+				if (p[pos] == '<') {
+					return _setError(_g_xml_error_msg_content_include_lt, m_pos + pos);
+				}
+				pos++;
+			}
+			if (pos >= i) {
+				return _setError(_g_xml_error_msg_element_attr_not_end, m_pos + pos);
+			}
+			sl_size errorOffset = 0;
+			if (!(_decode(p + startValue, pos - startValue, attr.value, sizeScratch, errorOffset))) {
+				return _setError(m_errorMessage, m_pos + startValue + errorOffset);
+			}
+			pos++;
+			ListElements<XmlPullAttribute> attrs(m_attributes);
+			for (sl_size k = 0; k < attrs.count; k++) {
+				if (attrs[k].name.equals(attr.name.data, attr.name.length)) {
+					return _setError(_g_xml_error_msg_element_attr_duplicate, m_pos + pos);
+				}
+			}
+			if (!(m_attributes.add_NoLock(attr))) {
+				return _setError(_g_xml_error_msg_memory_lack, m_pos);
+			}
+			indexAttr++;
+		}
+		if (p[pos] == '/') {
+			if (pos + 1 != i) {
+				return _setError(_g_xml_error_msg_element_tag_not_end, m_pos + pos);
+			}
+			m_flagEmptyTag = sl_true;
+		}
+		
+		if (!(_priv_XmlPull_reserve(m_stack, m_capacityStack, m_sizeStack + name.length))) {
+			return _setError(_g_xml_error_msg_memory_lack, m_pos);
+		}
+		if (!(m_stackOffsets.add_NoLock(m_sizeStack))) {
+			return _setError(_g_xml_error_msg_memory_lack, m_pos);
+		}
+		Base::copyMemory(m_stack + m_sizeStack, name.data, name.length);
+		m_sizeStack += name.length;
+		
+		m_name = name;
+		m_flagPendingEndTag = m_flagEmptyTag;
+		return _setEvent(XmlPullEventType::StartElement, m_pos, m_pos + lenTag);
+	}
+
+	XmlPullEventType XmlPullParser::_parseEndTag(const sl_char8* p, sl_size n)
+	{
+		sl_size end = 0;
+		sl_int32 iRet = _priv_XmlPull_scanName(p, n, 2, end);
+		if (iRet < 0) {
+			return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, m_pos);
+		}
+		if (!iRet) {
+			return _needMoreData(_g_xml_error_msg_element_tag_not_end);
+		}
+		sl_size i = end;
+		if (p[i] != '>') {
+			if (SLIB_CHAR_IS_WHITE_SPACE(p[i])) {
+				while (i < n && SLIB_CHAR_IS_WHITE_SPACE(p[i])) {
+					i++;
+				}
+				if (i >= n) {
+					return _needMoreData(_g_xml_error_msg_element_tag_not_end);
+				}
+				if (p[i] != '>') {
+					return _setError(_g_xml_error_msg_element_tag_not_end, m_pos + i);
+				}
+			} else {
+				return _setError(_g_xml_error_msg_name_invalid_char, m_pos + i);
+			}
+		}
+		sl_size nOpen = m_stackOffsets.getCount();
+		if (!nOpen) {
+			return _setError(_g_xml_error_msg_document_not_wellformed, m_pos);
+		}
+		sl_size offset = m_stackOffsets.getValueAt_NoLock(nOpen - 1);
+		sl_size lenName = m_sizeStack - offset;
+		if (lenName != end - 2 || !(Base::equalsMemory(m_stack + offset, p + 2, lenName))) {
+			return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, m_pos + 2);
+		}
+		m_name.data = m_stack + offset;
+		m_name.length = lenName;
+		m_flagPopElement = sl_true;
+		return _setEvent(XmlPullEventType::EndElement, m_pos, m_pos + i + 1);
+	}
+
+	XmlPullEventType XmlPullParser::_needMoreData(const String& errorMessage)
+	{
+		if (m_flagFinished) {
+			if (errorMessage.isNull()) {
+				return _setError(_g_xml_error_msg_unknown, m_len);
+			}
+			return _setError(errorMessage, m_len);
+		}
+		if (m_len - m_pos > m_maxTokenSize) {
+			return _setError(_g_xml_error_msg_token_too_long, m_pos);
+		}
+		m_type = XmlPullEventType::NeedMoreData;
+		return m_type;
+	}
+
+	XmlPullEventType XmlPullParser::_setEvent(XmlPullEventType type, sl_size start, sl_size end)
+	{
+		m_type = type;
+		m_posStart = m_base + start;
+		m_posEnd = m_base + end;
+		m_pos = end;
+		m_scanOffset = 0;
+		m_scanQuote = 0;
+		return type;
+	}
+
+	XmlPullEventType XmlPullParser::_setError(const String& message, sl_size pos)
+	{
+		m_type = XmlPullEventType::Error;
+		m_errorMessage = message;
+		m_posStart = m_base + pos;
+		m_posEnd = m_posStart;
+		m_name = XmlStringSlice();
+		m_text = XmlStringSlice();
+		m_attributes.setCount_NoLock(0);
+		return m_type;
+	}
+
+	sl_bool XmlPullParser::_decode(const sl_char8* s, sl_size n, XmlStringSlice& _out, sl_size& sizeScratch, sl_size& errorOffset)
+	{
+		if (!(Base::findMemory(s, '&', n))) {
+			_out.data = s;
+			_out.length = n;
+			return sl_true;
+		}
+		// decoded text is never longer than the source, and the caller reserved the scratch
+		sl_char8* start = m_scratch + sizeScratch;
+		sl_char8* d = start;
+		sl_size i = 0;
+		while (i < n) {
+			sl_char8 ch = s[i];
+			if (ch != '&') {
+				*(d++) = ch;
+				i++;
+				continue;
+			}
+			i++;
+			errorOffset = i;
+			const sl_char8* e = s + i;
+			sl_size r = n - i;
+			if (r >= 3 && e[0] == 'l' && e[1] == 't' && e[2] == ';') {
+				*(d++) = '<';
+				i += 3;
+			} else if (r >= 3 && e[0] == 'g' && e[1] == 't' && e[2] == ';') {
+				*(d++) = '>';
+				i += 3;
+			} else if (r >= 4 && e[0] == 'a' && e[1] == 'm' && e[2] == 'p' && e[3] == ';') {
+				*(d++) = '&';
+				i += 4;
+			} else if (r >= 5 && e[0] == 'a' && e[1] == 'p' && e[2] == 'o' && e[3] == 's' && e[4] == ';') {
+				*(d++) = '\'';
+				i += 5;
+			} else if (r >= 5 && e[0] == 'q' && e[1] == 'u' && e[2] == 'o' && e[3] == 't' && e[4] == ';') {
+				*(d++) = '\"';
+				i += 5;
+			} else if (r >= 3 && e[0] == '#') {
+				i++;
+				sl_uint32 radix = 10;
+				if (s[i] == 'x') {
+					radix = 16;
+					i++;
+				}
+				sl_size startDigits = i;
+				sl_uint32 code = 0;
+				while (i < n) {
+					sl_uint32 v = SLIB_CHAR_HEX_TO_INT(s[i]);
+					if (v >= radix) {
+						break;
+					}
+					code = code * radix + v;
+					if (code > 0x10FFFF) {
+						m_errorMessage = _g_xml_error_msg_invalid_escape;
+						return sl_false;
+					}
+					i++;
+				}
+				if (i == startDigits) {
+					m_errorMessage = _g_xml_error_msg_invalid_escape;
+					return sl_false;
+				}
+				if (i >= n || s[i] != ';') {
+					m_errorMessage = _g_xml_error_msg_escape_not_end;
+					return sl_false;
+				}
+				i++;
+				if (code < 0x80) {
+					*(d++) = (sl_char8)code;
+				} else if (code < 0x800) {
+					*(d++) = (sl_char8)(0xC0 | (code >> 6));
+					*(d++) = (sl_char8)(0x80 | (code & 0x3F));
+				} else if (code < 0x10000) {
+					*(d++) = (sl_char8)(0xE0 | (code >> 12));
+					*(d++) = (sl_char8)(0x80 | ((code >> 6) & 0x3F));
+					*(d++) = (sl_char8)(0x80 | (code & 0x3F));
+				} else {
+					*(d++) = (sl_char8)(0xF0 | (code >> 18));
+					*(d++) = (sl_char8)(0x80 | ((code >> 12) & 0x3F));
+					*(d++) = (sl_char8)(0x80 | ((code >> 6) & 0x3F));
+					*(d++) = (sl_char8)(0x80 | (code & 0x3F));
+				}
+			} else {
+				m_errorMessage = _g_xml_error_msg_invalid_escape;
+				return sl_false;
+			}
+		}
+		_out.data = start;
+		_out.length = d - start;
+		sizeScratch += _out.length;
+		return sl_true;
+	}
+
+	sl_bool XmlPullParser::_reserveScratch(sl_size size)
+	{
+		return _priv_XmlPull_reserve(m_scratch, m_capacityScratch, size);
+	}
+
+	sl_bool XmlPullParser::_reserveBuffer(sl_size size)
+	{
+		sl_bool flagOwned = m_buf == m_bufOwned;
+		if (!(_priv_XmlPull_reserve(m_bufOwned, m_capacityOwned, size))) {
+			return sl_false;
+		}
+		if (flagOwned) {
+			m_buf = m_bufOwned;
+		}
+		return sl_true;
+	}
+
+	void XmlPullParser::_compact()
+	{
+		if (m_buf != m_bufOwned || !m_pos) {
+			return;
+		}
+		_updateLineNumber(m_pos);
+		sl_size n = m_len - m_pos;
+		if (n) {
+			Base::moveMemory(m_bufOwned, m_bufOwned + m_pos, n);
+		}
+		m_base += m_pos;
+		m_posLine -= m_pos;
+		m_len = n;
+		m_pos = 0;
+	}
+
+	sl_bool XmlPullParser::_readInput()
+	{
+		_compact();
+		if (!(_reserveBuffer(m_len + PRIV_XML_PULL_READ_SIZE))) {
+			return sl_false;
+		}
+		sl_reg n = m_reader->read(m_bufOwned + m_len, PRIV_XML_PULL_READ_SIZE);
+		if (n <= 0) {
+			return sl_false;
+		}
+		m_len += n;
+		return sl_true;
+	}
+
+	void XmlPullParser::_updateLineNumber(sl_size pos)
+	{
+		if (pos > m_len) {
+			pos = m_len;
+		}
+		for (sl_size i = m_posLine; i < pos; i++) {
+			sl_char8 ch = m_buf[i];
+			if (ch == '\r') {
+				m_lineNumber++;
+				m_columnNumber = 1;
+				m_flagLastCR = sl_true;
+			} else if (ch == '\n') {
+				if (!m_flagLastCR) {
+					m_lineNumber++;
+					m_columnNumber = 1;
+				}
+				m_flagLastCR = sl_false;
+			} else {
+				m_columnNumber++;
+				m_flagLastCR = sl_false;
+			}
+		}
+		if (pos > m_posLine) {
+			m_posLine = pos;
+		}
+	}
+
+
+	class _priv_Xml_DomLevel
+	{
+	public:
+		Ref<XmlElement> element;
+		String defNamespace;
+		HashMap<String, String> namespaces;
+		List<String> prefixMappings;
+	};
+
+	class _priv_Xml_DomBuilder
+	{
+	public:
+		XmlPullParser* parser;
+		String sourceFilePath;
+		Ref<XmlDocument> document;
+		XmlParseControl control;
+		XmlParseParam param;
+		List<_priv_Xml_DomLevel> levels;
+
+		sl_bool flagError;
+		String errorMessage;
+
+	public:
+		_priv_Xml_DomBuilder()
+		{
+			parser = sl_null;
+			flagError = sl_false;
+		}
+
+	public:
+		XmlNodeGroup* getParent()
+		{
+			if (document.isNull()) {
+				return sl_null;
+			}
+			sl_size n = levels.getCount();
+			if (n) {
+				return levels.getData()[n - 1].element.get();
+			}
+			return document.get();
+		}
+
+		void setSource(XmlNode* node)
+		{
+			node->setSourceFilePath(sourceFilePath);
+			node->setStartPositionInSource((sl_size)(parser->getStartPosition()));
+			node->setEndPositionInSource((sl_size)(parser->getEndPosition()));
+			node->setLineNumberInSource((sl_size)(parser->getLineNumber()));
+			node->setColumnNumberInSource((sl_size)(parser->getColumnNumber()));
+		}
+
+		void processStartElement();
+
+		void processEndElement();
+
+		void processText(sl_bool flagCDATA);
+
+		void processComment();
+
+		void processPI();
+
+		void processWhiteSpace();
+
+		void build();
+
+		static Ref<XmlDocument> parse(XmlPullParser& parser, const String& sourceFilePath, const sl_char8* source, sl_size len, XmlParseParam& param);
+
+	};
+
+#define CALL_DOM_CALLBACK(NAME, NODE, ...) \
+	{ \
+		auto _callback = param.NAME; \
+		if (_callback.isNotNull()) { \
+			sl_size _pos = (sl_size)(parser->getEndPosition()); \
+			control.parsingPosition = _pos; \
+			control.flagChangeSource = sl_false; \
+			control.currentNode = NODE; \
+			_callback(&control, __VA_ARGS__); \
+			if (control.flagStopParsing) { \
+				flagError = sl_true; \
+				errorMessage = _g_xml_error_msg_user_stop; \
+				return; \
+			} \
+			if (control.source.sz8 && (control.flagChangeSource || control.parsingPosition != _pos)) { \
+				parser->setInput(control.source.sz8, control.source.len, control.parsingPosition); \
+			} \
+		} \
+	}
+
+	void _priv_Xml_DomBuilder::processStartElement()
+	{
+		Ref<XmlElement> element = new XmlElement;
+		if (element.isNull()) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		setSource(element.get());
+		// element positions start at the name, like the DOM parser
+		element->setStartPositionInSource((sl_size)(parser->getStartPosition()) + 1);
+		element->setColumnNumberInSource((sl_size)(parser->getColumnNumber()) + 1);
+		
+		_priv_Xml_DomLevel level;
+		level.element = element;
+		sl_size nLevels = levels.getCount();
+		if (nLevels) {
+			_priv_Xml_DomLevel& parentLevel = levels.getData()[nLevels - 1];
+			level.defNamespace = parentLevel.defNamespace;
+			level.namespaces = parentLevel.namespaces;
+		}
+		HashMap<String, String> namespacesParent = level.namespaces;
+		
+		// copies the event, because the callbacks may change the source
+		String name = parser->getName().toString();
+		if (name.isNull()) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		List<XmlAttribute> attrs;
+		{
+			sl_size n = parser->getAttributesCount();
+			const XmlPullAttribute* src = parser->getAttributes();
+			for (sl_size i = 0; i < n; i++) {
+				XmlAttribute attr;
+				attr.name = src[i].name.toString();
+				attr.value = src[i].value.toString();
+				if (attr.name.isNull() || attr.value.isNull()) {
+					REPORT_ERROR(_g_xml_error_msg_memory_lack)
+				}
+				if (param.flagCreateWhiteSpaces) {
+					attr.whiteSpacesBeforeName = src[i].whiteSpacesBeforeName.toString();
+				}
+				if (!(attrs.add_NoLock(attr))) {
+					REPORT_ERROR(_g_xml_error_msg_memory_lack)
+				}
+			}
+		}
+		
+		ListElements<XmlAttribute> listAttrs(attrs);
+		for (sl_size i = 0; i < listAttrs.count; i++) {
+			XmlAttribute& attr = listAttrs[i];
+			String prefix;
+			_priv_Xml_processPrefix(attr.name, level.defNamespace, level.namespaces, prefix, attr.uri, attr.localName);
+			if (!(element->setAttribute(attr))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			if (param.flagProcessNamespaces) {
+				if (attr.name == "xmlns") {
+					level.defNamespace = attr.value;
+					if (!(level.prefixMappings.add_NoLock(String::null()))) {
+						REPORT_ERROR(_g_xml_error_msg_memory_lack)
+					}
+					CALL_DOM_CALLBACK(onStartPrefixMapping, element.get(), String::null(), level.defNamespace);
+				} else if (prefix == "xmlns" && attr.localName.isNotEmpty() && attr.value.isNotEmpty()) {
+					if (level.namespaces == namespacesParent) {
+						level.namespaces = namespacesParent.duplicate();
+					}
+					if (!(level.namespaces.put(attr.localName, attr.value))) {
+						REPORT_ERROR(_g_xml_error_msg_memory_lack)
+					}
+					if (!(level.prefixMappings.add_NoLock(attr.localName))) {
+						REPORT_ERROR(_g_xml_error_msg_memory_lack)
+					}
+					CALL_DOM_CALLBACK(onStartPrefixMapping, element.get(), attr.localName, attr.value)
+				}
+			}
+		}
+		
+		String prefix, uri, localName;
+		_priv_Xml_processPrefix(name, level.defNamespace, level.namespaces, prefix, uri, localName);
+		if (!(element->setName(name, uri, localName))) {
+			REPORT_ERROR(_g_xml_error_msg_unknown)
+		}
+		
+		XmlNodeGroup* parent = getParent();
+		if (parent) {
+			if (!(parent->addChild(element))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+		}
+		if (!(levels.add_NoLock(level))) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		CALL_DOM_CALLBACK(onStartElement, element.get(), element.get())
+	}
+
+	void _priv_Xml_DomBuilder::processEndElement()
+	{
+		_priv_Xml_DomLevel level;
+		if (!(levels.popBack_NoLock(&level))) {
+			REPORT_ERROR(_g_xml_error_msg_unknown)
+		}
+		XmlElement* element = level.element.get();
+		element->setEndPositionInSource((sl_size)(parser->getEndPosition()));
+		CALL_DOM_CALLBACK(onEndElement, element, element)
+		if (param.flagProcessNamespaces) {
+			ListElements<String> prefixes(level.prefixMappings);
+			for (sl_size i = 0; i < prefixes.count; i++) {
+				CALL_DOM_CALLBACK(onEndPrefixMapping, element, prefixes[i]);
+			}
+		}
+	}
+
+	void _priv_Xml_DomBuilder::processText(sl_bool flagCDATA)
+	{
+		if (!(param.flagCreateTextNodes)) {
+			return;
+		}
+		String text = parser->getText().toString();
+		if (text.isNull()) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		XmlNodeGroup* parent = getParent();
+		Ref<XmlText> node;
+		if (parent) {
+			node = XmlText::create(text, flagCDATA);
+			if (node.isNull()) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			setSource(node.get());
+			if (!(parent->addChild(node))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+		}
+		if (flagCDATA) {
+			CALL_DOM_CALLBACK(onCDATA, node.get(), text)
+		} else {
+			CALL_DOM_CALLBACK(onText, node.get(), text)
+		}
+	}
+
+	void _priv_Xml_DomBuilder::processComment()
+	{
+		if (!(param.flagCreateCommentNodes)) {
+			return;
+		}
+		String str = parser->getText().toString();
+		if (str.isNull()) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		XmlNodeGroup* parent = getParent();
+		Ref<XmlComment> comment;
+		if (parent) {
+			comment = XmlComment::create(str);
+			if (comment.isNull()) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			setSource(comment.get());
+			if (!(parent->addChild(comment))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+		}
+		CALL_DOM_CALLBACK(onComment, comment.get(), str)
+	}
+
+	void _priv_Xml_DomBuilder::processPI()
+	{
+		if (!(param.flagCreateProcessingInstructionNodes)) {
+			return;
+		}
+		String target = parser->getName().toString();
+		String str = parser->getText().toString();
+		if (target.isNull() || str.isNull()) {
+			REPORT_ERROR(_g_xml_error_msg_memory_lack)
+		}
+		XmlNodeGroup* parent = getParent();
+		Ref<XmlProcessingInstruction> PI;
+		if (parent) {
+			PI = XmlProcessingInstruction::create(target, str);
+			if (PI.isNull()) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			setSource(PI.get());
+			if (!(parent->addChild(PI))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+		}
+		CALL_DOM_CALLBACK(onProcessingInstruction, PI.get(), target, str)
+	}
+
+	void _priv_Xml_DomBuilder::processWhiteSpace()
+	{
+		if (!(param.flagCreateWhiteSpaces)) {
+			return;
+		}
+		XmlNodeGroup* parent = getParent();
+		if (parent) {
+			String content = parser->getText().toString();
+			if (content.isNull()) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			Ref<XmlWhiteSpace> node = XmlWhiteSpace::create(content);
+			if (node.isNull()) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+			setSource(node.get());
+			if (!(parent->addChild(node))) {
+				REPORT_ERROR(_g_xml_error_msg_memory_lack)
+			}
+		}
+	}
+
+	void _priv_Xml_DomBuilder::build()
+	{
+		CALL_DOM_CALLBACK(onStartDocument, document.get(), document.get())
+		for (;;) {
+			switch (parser->next()) {
+				case XmlPullEventType::StartElement:
+					processStartElement();
+					break;
+				case XmlPullEventType::EndElement:
+					processEndElement();
+					break;
+				case XmlPullEventType::Text:
+					processText(sl_false);
+					break;
+				case XmlPullEventType::CDATA:
+					processText(sl_true);
+					break;
+				case XmlPullEventType::Comment:
+					processComment();
+					break;
+				case XmlPullEventType::ProcessingInstruction:
+					processPI();
+					break;
+				case XmlPullEventType::WhiteSpace:
+					processWhiteSpace();
+					break;
+				case XmlPullEventType::EndDocument:
+					if (document.isNotNull() && param.flagCheckWellFormed) {
+						if (!(document->checkWellFormed())) {
+							REPORT_ERROR(_g_xml_error_msg_document_not_wellformed);
+						}
+					}
+					CALL_DOM_CALLBACK(onEndDocument, document.get(), document.get())
+					return;
+				case XmlPullEventType::Error:
+					REPORT_ERROR(parser->getErrorMessage())
+				default:
+					REPORT_ERROR(_g_xml_error_msg_unknown)
+			}
+			if (flagError) {
+				return;
+			}
+		}
+	}
+
+	Ref<XmlDocument> _priv_Xml_DomBuilder::parse(XmlPullParser& parser, const String& sourceFilePath, const sl_char8* source, sl_size len, XmlParseParam& param)
+	{
+		param.flagError = sl_false;
+		
+		_priv_Xml_DomBuilder builder;
+		builder.parser = &parser;
+		builder.sourceFilePath = sourceFilePath;
+		
+		if (param.flagCreateDocument) {
+			builder.document = XmlDocument::create();
+			if (builder.document.isNull()) {
+				param.flagError = sl_true;
+				param.errorMessage = _g_xml_error_msg_memory_lack;
+				return sl_null;
+			}
+		}
+		builder.param = param;
+		builder.control.source.sz8 = source;
+		builder.control.source.len = len;
+		builder.control.characterSize = 1;
+		
+		builder.build();
+		
+		if (!(builder.flagError)) {
+			return builder.document;
+		}
+		
+		param.flagError = sl_true;
+		param.errorPosition = (sl_size)(parser.getStartPosition());
+		param.errorMessage = builder.errorMessage;
+		param.errorLine = (sl_size)(parser.getLineNumber());
+		param.errorColumn = (sl_size)(parser.getColumnNumber());
+		
+		if (param.flagLogError) {
+			LogError("Xml", param.getErrorText());
+		}
+		
+		return sl_null;
+	}
+
+
+	SLIB_DEFINE_OBJECT(XmlAsyncParser, Object)
+
+	XmlAsyncParserParam::XmlAsyncParserParam()
+	{
+		bufferSize = PRIV_XML_PULL_READ_SIZE;
+		maximumTokenSize = PRIV_XML_PULL_MAX_TOKEN_SIZE;
+		flagAutoStart = sl_true;
+	}
+
+	XmlAsyncParserParam::~XmlAsyncParserParam()
+	{
+	}
+
+	XmlAsyncParser::XmlAsyncParser()
+	{
+		m_flagStarted = sl_false;
+		m_flagRunning = sl_false;
+	}
+
+	XmlAsyncParser::~XmlAsyncParser()
+	{
+	}
+
+	Ref<XmlAsyncParser> XmlAsyncParser::create(const XmlAsyncParserParam& param)
+	{
+		if (param.stream.isNull()) {
+			return sl_null;
+		}
+		if (!(param.bufferSize)) {
+			return sl_null;
+		}
+		Memory buffer = Memory::create(param.bufferSize);
+		if (buffer.isNull()) {
+			return sl_null;
+		}
+		Ref<XmlAsyncParser> ret = new XmlAsyncParser;
+		if (ret.isNotNull()) {
+			ret->m_stream = param.stream;
+			ret->m_buffer = buffer;
+			ret->m_parser.setMaximumTokenSize(param.maximumTokenSize);
+			ret->m_onEvent = param.onEvent;
+			ret->m_onEnd = param.onEnd;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_bool XmlAsyncParser::start()
+	{
+		ObjectLocker lock(this);
+		if (m_flagStarted) {
+			return sl_false;
+		}
+		m_flagStarted = sl_true;
+		m_flagRunning = sl_true;
+		_read();
+		return sl_true;
+	}
+
+	void XmlAsyncParser::close()
+	{
+		ObjectLocker lock(this);
+		m_flagRunning = sl_false;
+	}
+
+	sl_bool XmlAsyncParser::isRunning()
+	{
+		return m_flagRunning;
+	}
+
+	Ref<AsyncStream> XmlAsyncParser::getStream()
+	{
+		return m_stream;
+	}
+
+	XmlPullParser* XmlAsyncParser::getPullParser()
+	{
+		return &m_parser;
+	}
+
+	void XmlAsyncParser::_read()
+	{
+		if (!m_flagRunning) {
+			return;
+		}
+		if (!(m_stream->read(m_buffer.getData(), (sl_uint32)(m_buffer.getSize()), SLIB_FUNCTION_WEAKREF(XmlAsyncParser, _onReadStream, this)))) {
+			m_parser.finish();
+			_dispatchEvents();
+		}
+	}
+
+	void XmlAsyncParser::_onReadStream(AsyncStreamResult* result)
+	{
+		ObjectLocker lock(this);
+		if (!m_flagRunning) {
+			return;
+		}
+		if (result->size) {
+			if (!(m_parser.feed(result->data, result->size))) {
+				_end(sl_true);
+				return;
+			}
+		}
+		if (result->flagError || !(result->size)) {
+			m_parser.finish();
+		}
+		_dispatchEvents();
+	}
+
+	void XmlAsyncParser::_dispatchEvents()
+	{
+		for (;;) {
+			XmlPullEventType type = m_parser.next();
+			if (type == XmlPullEventType::NeedMoreData) {
+				_read();
+				return;
+			}
+			m_onEvent(this, &m_parser);
+			if (!m_flagRunning) {
+				return;
+			}
+			if (type == XmlPullEventType::EndDocument) {
+				_end(sl_false);
+				return;
+			}
+			if (type == XmlPullEventType::Error) {
+				_end(sl_true);
+				return;
+			}
+		}
+	}
+
+	void XmlAsyncParser::_end(sl_bool flagError)
+	{
+		m_flagRunning = sl_false;
+		m_onEnd(this, flagError);
+	}
+
+	Ref<XmlDocument> Xml::parseXml(const sl_char8* sz, sl_size len, XmlParseParam& param)
+	{
+		XmlPullParser parser;
+		parser.setInput(sz, len);
+		return _priv_Xml_DomBuilder::parse(parser, String::null(), sz, len, param);
+	}
+
+	Ref<XmlDocument> Xml::parseXml(const sl_char8* sz, sl_size len)
+	{
+		XmlParseParam param;
+		return parseXml(sz, len, param);
+	}
+
+	Ref<XmlDocument> Xml::parseXml(const String& xml, XmlParseParam& param)
+	{
+		return parseXml(xml.getData(), xml.getLength(), param);
+	}
+
+	Ref<XmlDocument> Xml::parseXml(const String& xml)
+	{
+		XmlParseParam param;
+		return parseXml(xml, param);
+	}
+
+	Ref<XmlDocument> Xml::parseXmlFromReader(const Ptr<IReader>& reader, XmlParseParam& param)
+	{
+		XmlPullParser parser;
+		parser.setReader(reader);
+		return _priv_Xml_DomBuilder::parse(parser, String::null(), sl_null, 0, param);
+	}
+
+	Ref<XmlDocument> Xml::parseXmlFromReader(const Ptr<IReader>& reader)
+	{
+		XmlParseParam param;
+		return parseXmlFromReader(reader, param);
 	}
 
 	Ref<XmlDocument> Xml::parseXml16(const sl_char16* sz, sl_size len, XmlParseParam& param)
@@ -22,11 +22,22 @@
 
 #include "slib/crypto/zlib.h"
 
+#include "slib/core/mio.h"
+#include "slib/core/new_helper.h"
+
 #include "zlib/zlib.h"
 
 #define STREAM ((z_stream*)(this->m_stream))
 #define GZIP_HEADER ((gz_header*)(this->m_gzipHeader))
 
+#define PRIV_GZIP_PARALLEL_DEFAULT_BLOCK_SIZE 131072
+#define PRIV_GZIP_PARALLEL_DICTIONARY_SIZE 32768
+#define PRIV_GZIP_PARALLEL_MAX_BLOCKS_PER_BATCH 64
+// "SLGI" : the last 4 bytes of the index sub-field
+#define PRIV_GZIP_PARALLEL_INDEX_MAGIC 0x49474c53
+// (65535 - sub-field header - count - magic) / entry size
+#define PRIV_GZIP_PARALLEL_INDEX_MAX_ENTRIES 8000
+
 namespace slib
 {
 
@@ -38,6 +49,17 @@ namespace slib
 	{
 	}
 
+	GzipParallelParam::GzipParallelParam()
+	{
+		level = 6;
+		blockSize = PRIV_GZIP_PARALLEL_DEFAULT_BLOCK_SIZE;
+		flagIndependentBlocks = sl_false;
+	}
+
+	GzipParallelParam::~GzipParallelParam()
+	{
+	}
+
 
 	ZlibCompress::ZlibCompress()
 	{
@@ -186,6 +208,51 @@ namespace slib
 		return ret;
 	}
 
+	Memory ZlibCompress::compressAndFlush(const void* data, sl_size size)
+	{
+		if (!m_flagStarted) {
+			return sl_null;
+		}
+		sl_uint32 sizeChunk;
+		if (size > 16384) {
+			sizeChunk = 262144;
+		} else {
+			sizeChunk = 4096;
+		}
+		Memory memChunk = Memory::create(sizeChunk);
+		if (memChunk.isNull()) {
+			return sl_null;
+		}
+		sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
+		
+		z_stream* stream = STREAM;
+		stream->next_in = (Bytef*)data;
+		MemoryBuffer buffer;
+		while (1) {
+			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, 0x40000000));
+			stream->avail_in = sizeInput;
+			stream->next_out = (Bytef*)chunk;
+			stream->avail_out = sizeChunk;
+			int iRet = deflate(stream, sizeInput == size ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+			if (iRet < 0 && iRet != Z_BUF_ERROR) {
+				abort();
+				return sl_null;
+			}
+			size -= sizeInput - stream->avail_in;
+			sl_uint32 sizeOutputUsed = sizeChunk - stream->avail_out;
+			if (sizeOutputUsed > 0) {
+				if (!(buffer.add(Memory::create(chunk, sizeOutputUsed)))) {
+					return sl_null;
+				}
+			}
+			// all input is consumed and the output is flushed when the output space is not full
+			if (size == 0 && stream->avail_out != 0) {
+				break;
+			}
+		}
+		return buffer.merge();
+	}
+
 	void ZlibCompress::abort()
 	{
 		if (m_flagStarted) {
@@ -316,6 +383,502 @@ namespace slib
 		}
 	}
 
+	class _priv_GzipParallel_Block
+	{
+	public:
+		const sl_uint8* data;
+		sl_uint32 size;
+		const sl_uint8* dictionary;
+		sl_uint32 sizeDictionary;
+		sl_bool flagLast;
+		
+		Memory output;
+		sl_uint32 crc;
+		
+	public:
+		// raw deflate, ended by Z_SYNC_FLUSH (byte-aligned) or by Z_FINISH for the last block
+		void compress(sl_int32 level)
+		{
+			crc = (sl_uint32)(::crc32(0, (const Bytef*)data, size));
+			z_stream stream;
+			Base::zeroMemory(&stream, sizeof(stream));
+			if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				return;
+			}
+			if (sizeDictionary) {
+				deflateSetDictionary(&stream, (const Bytef*)dictionary, sizeDictionary);
+			}
+			// the sync marker and the pending bits are not counted by deflateBound()
+			sl_size sizeOutput = (sl_size)(deflateBound(&stream, size)) + 64;
+			Memory mem = Memory::create(sizeOutput);
+			if (mem.isNotNull()) {
+				stream.next_in = (Bytef*)data;
+				stream.avail_in = size;
+				stream.next_out = (Bytef*)(mem.getData());
+				stream.avail_out = (uInt)sizeOutput;
+				int iRet = deflate(&stream, flagLast ? Z_FINISH : Z_SYNC_FLUSH);
+				if (stream.avail_in == 0 && stream.avail_out != 0 && (flagLast ? iRet == Z_STREAM_END : iRet == Z_OK)) {
+					output = mem.sub(0, sizeOutput - stream.avail_out);
+				}
+			}
+			deflateEnd(&stream);
+		}
+		
+	};
+	
+	class _priv_GzipParallel_Group
+	{
+	public:
+		const sl_uint8* input;
+		sl_uint32 sizeInput;
+		sl_uint8* output;
+		sl_uint32 sizeOutput;
+		
+		sl_uint32 crc;
+		sl_bool flagSuccess;
+		
+	public:
+		// independent blocks are decoded by a fresh raw inflate; the CRC of the whole stream is checked by the caller
+		void decompress()
+		{
+			flagSuccess = sl_false;
+			z_stream stream;
+			Base::zeroMemory(&stream, sizeof(stream));
+			if (inflateInit2(&stream, -15) != Z_OK) {
+				return;
+			}
+			stream.next_in = (Bytef*)input;
+			stream.avail_in = sizeInput;
+			stream.next_out = (Bytef*)output;
+			stream.avail_out = sizeOutput;
+			int iRet = inflate(&stream, Z_SYNC_FLUSH);
+			if ((iRet == Z_OK || iRet == Z_STREAM_END || iRet == Z_BUF_ERROR) && stream.avail_out == 0) {
+				crc = (sl_uint32)(::crc32(0, (const Bytef*)output, sizeOutput));
+				flagSuccess = sl_true;
+			}
+			inflateEnd(&stream);
+		}
+		
+	};
+	
+	static sl_uint32 _priv_GzipParallel_getBatchCount(const Ref<ThreadPool>& pool)
+	{
+		sl_uint32 n = pool->getMaximumThreadsCount() + 1;
+		if (n < 2) {
+			n = 2;
+		}
+		if (n > PRIV_GZIP_PARALLEL_MAX_BLOCKS_PER_BATCH) {
+			n = PRIV_GZIP_PARALLEL_MAX_BLOCKS_PER_BATCH;
+		}
+		return n;
+	}
+	
+	// returns 0 on invalid header
+	static sl_size _priv_GzipParallel_getHeaderSize(const sl_uint8* data, sl_size size)
+	{
+		if (size < 10 || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8) {
+			return 0;
+		}
+		sl_uint8 flags = data[3];
+		sl_size pos = 10;
+		if (flags & 4) {
+			// FEXTRA
+			if (pos + 2 > size) {
+				return 0;
+			}
+			pos += 2 + MIO::readUint16LE(data + pos);
+		}
+		for (sl_uint8 flag = 8; flag <= 16; flag <<= 1) {
+			// FNAME, FCOMMENT
+			if (flags & flag) {
+				if (pos >= size) {
+					return 0;
+				}
+				const sl_uint8* end = (const sl_uint8*)(Base::findMemory(data + pos, 0, size - pos));
+				if (!end) {
+					return 0;
+				}
+				pos = (sl_size)(end - data) + 1;
+			}
+		}
+		if (flags & 2) {
+			// FHCRC
+			pos += 2;
+		}
+		if (pos > size) {
+			return 0;
+		}
+		return pos;
+	}
+	
+	/*
+		Index member, appended after the first member by GzipParallelWriter:
+			gzip header (FEXTRA), XLEN, sub-field 'S' 'L' LEN
+			entries: { compressed size (32 bits), uncompressed size (32 bits) } x count, count (32 bits), magic (32 bits)
+			empty final deflate block (0x03 0x00), CRC32 (0), ISIZE (0)
+		Every entry describes a group of independent blocks in the first member.
+	*/
+	static sl_bool _priv_GzipParallel_findIndex(const sl_uint8* data, sl_size size, const sl_uint8*& entries, sl_uint32& nEntries, sl_size& sizeHeader, sl_size& sizeContent)
+	{
+		if (size < 64) {
+			return sl_false;
+		}
+		const sl_uint8* end = data + size;
+		for (sl_uint32 i = 1; i <= 8; i++) {
+			if (end[-(sl_reg)i]) {
+				return sl_false;
+			}
+		}
+		if (end[-10] != 3 || end[-9] != 0) {
+			return sl_false;
+		}
+		if (MIO::readUint32LE(end - 14) != PRIV_GZIP_PARALLEL_INDEX_MAGIC) {
+			return sl_false;
+		}
+		sl_uint32 n = MIO::readUint32LE(end - 18);
+		if (!n || n > PRIV_GZIP_PARALLEL_INDEX_MAX_ENTRIES) {
+			return sl_false;
+		}
+		sl_size sizeField = (sl_size)n * 8 + 8;
+		sl_size sizeMember = 16 + sizeField + 10;
+		if (sizeMember + 18 > size) {
+			return sl_false;
+		}
+		const sl_uint8* member = end - sizeMember;
+		if (member[0] != 0x1f || member[1] != 0x8b || member[2] != 8 || member[3] != 4) {
+			return sl_false;
+		}
+		if (MIO::readUint16LE(member + 10) != sizeField + 4 || member[12] != 'S' || member[13] != 'L' || MIO::readUint16LE(member + 14) != sizeField) {
+			return sl_false;
+		}
+		sl_size _sizeHeader = _priv_GzipParallel_getHeaderSize(data, size - sizeMember - 8);
+		if (!_sizeHeader) {
+			return sl_false;
+		}
+		const sl_uint8* _entries = member + 16;
+		sl_uint64 sizeCompressed = 0;
+		sl_uint64 _sizeContent = 0;
+		for (sl_uint32 i = 0; i < n; i++) {
+			sizeCompressed += MIO::readUint32LE(_entries + (i << 3));
+			_sizeContent += MIO::readUint32LE(_entries + (i << 3) + 4);
+		}
+		if (sizeCompressed != size - sizeMember - 8 - _sizeHeader) {
+			return sl_false;
+		}
+		if (_sizeContent != (sl_size)_sizeContent) {
+			return sl_false;
+		}
+		entries = _entries;
+		nEntries = n;
+		sizeHeader = _sizeHeader;
+		sizeContent = (sl_size)_sizeContent;
+		return sl_true;
+	}
+	
+	static sl_bool _priv_GzipParallel_decompressGroups(const Ref<ThreadPool>& pool, _priv_GzipParallel_Group* groups, sl_uint32 n, sl_uint32& crc)
+	{
+		pool->runParallel(n, [groups](sl_uint32 index) {
+			groups[index].decompress();
+		});
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (!(groups[i].flagSuccess)) {
+				return sl_false;
+			}
+			crc = (sl_uint32)(crc32_combine(crc, groups[i].crc, (z_off_t)(groups[i].sizeOutput)));
+		}
+		return sl_true;
+	}
+	
+	
+	SLIB_DEFINE_OBJECT(GzipParallelWriter, Object)
+
+	GzipParallelWriter::GzipParallelWriter()
+	{
+		m_level = 6;
+		m_blockSize = PRIV_GZIP_PARALLEL_DEFAULT_BLOCK_SIZE;
+		m_nBlocksPerBatch = 2;
+		m_flagIndependentBlocks = sl_false;
+		m_sizeBufInput = 0;
+		m_sizeDictionary = 0;
+		m_crc = 0;
+		m_sizeInput = 0;
+		m_sizeOutput = 0;
+		m_flagFinished = sl_false;
+		m_flagError = sl_false;
+	}
+
+	GzipParallelWriter::~GzipParallelWriter()
+	{
+	}
+
+	Ref<GzipParallelWriter> GzipParallelWriter::create(const Ptr<IWriter>& output, const GzipParallelParam& param)
+	{
+		if (output.isNull()) {
+			return sl_null;
+		}
+		Ref<ThreadPool> pool = param.threadPool;
+		if (pool.isNull()) {
+			pool = ThreadPool::create();
+			if (pool.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<GzipParallelWriter> ret = new GzipParallelWriter;
+		if (ret.isNotNull()) {
+			ret->m_output = output;
+			ret->m_threadPool = pool;
+			ret->m_level = param.level;
+			ret->m_blockSize = SLIB_MAX(param.blockSize, PRIV_GZIP_PARALLEL_DICTIONARY_SIZE);
+			ret->m_nBlocksPerBatch = _priv_GzipParallel_getBatchCount(pool);
+			ret->m_flagIndependentBlocks = param.flagIndependentBlocks;
+			if (ret->_writeHeader(param)) {
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<GzipParallelWriter> GzipParallelWriter::create(const Ptr<IWriter>& output, sl_int32 level)
+	{
+		GzipParallelParam param;
+		param.level = level;
+		return create(output, param);
+	}
+
+	sl_reg GzipParallelWriter::write(const void* _buf, sl_size size)
+	{
+		ObjectLocker lock(this);
+		if (m_flagFinished || m_flagError) {
+			return -1;
+		}
+		const sl_uint8* buf = (const sl_uint8*)_buf;
+		sl_size sizeBatch = (sl_size)m_blockSize * m_nBlocksPerBatch;
+		sl_size sizeRemain = size;
+		while (sizeRemain) {
+			if (!m_sizeBufInput && sizeRemain >= sizeBatch) {
+				// compresses directly from the caller's buffer
+				if (!(_compressBatch(buf, sizeBatch, sl_false))) {
+					return -1;
+				}
+				buf += sizeBatch;
+				sizeRemain -= sizeBatch;
+			} else {
+				if (m_bufInput.isNull()) {
+					m_bufInput = Memory::create(sizeBatch);
+					if (m_bufInput.isNull()) {
+						m_flagError = sl_true;
+						return -1;
+					}
+				}
+				sl_size n = SLIB_MIN(sizeBatch - m_sizeBufInput, sizeRemain);
+				Base::copyMemory((sl_uint8*)(m_bufInput.getData()) + m_sizeBufInput, buf, n);
+				m_sizeBufInput += n;
+				buf += n;
+				sizeRemain -= n;
+				if (m_sizeBufInput == sizeBatch) {
+					m_sizeBufInput = 0;
+					if (!(_compressBatch((sl_uint8*)(m_bufInput.getData()), sizeBatch, sl_false))) {
+						return -1;
+					}
+				}
+			}
+		}
+		return size;
+	}
+
+	sl_bool GzipParallelWriter::finish()
+	{
+		ObjectLocker lock(this);
+		if (m_flagFinished) {
+			return !m_flagError;
+		}
+		m_flagFinished = sl_true;
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (!(_compressBatch((sl_uint8*)(m_bufInput.getData()), m_sizeBufInput, sl_true))) {
+			return sl_false;
+		}
+		m_bufInput.setNull();
+		m_sizeBufInput = 0;
+		sl_uint8 trailer[8];
+		MIO::writeUint32LE(trailer, m_crc);
+		MIO::writeUint32LE(trailer + 4, (sl_uint32)m_sizeInput);
+		if (!(_writeOutput(trailer, 8))) {
+			return sl_false;
+		}
+		if (m_flagIndependentBlocks) {
+			return _writeIndex();
+		}
+		return sl_true;
+	}
+
+	void GzipParallelWriter::close()
+	{
+		finish();
+	}
+
+	sl_uint64 GzipParallelWriter::getInputSize()
+	{
+		return m_sizeInput;
+	}
+
+	sl_uint64 GzipParallelWriter::getOutputSize()
+	{
+		return m_sizeOutput;
+	}
+
+	sl_bool GzipParallelWriter::_writeHeader(const GzipParallelParam& param)
+	{
+		MemoryBuffer buf;
+		sl_uint8 header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 255};
+		if (param.fileName.isNotEmpty()) {
+			header[3] |= 8;
+		}
+		if (param.comment.isNotEmpty()) {
+			header[3] |= 16;
+		}
+		if (param.level >= 9) {
+			header[8] = 2;
+		} else if (param.level == 1) {
+			header[8] = 4;
+		}
+		buf.addStatic(header, 10);
+		if (param.fileName.isNotEmpty()) {
+			buf.addStatic(param.fileName.getData(), param.fileName.getLength() + 1);
+		}
+		if (param.comment.isNotEmpty()) {
+			buf.addStatic(param.comment.getData(), param.comment.getLength() + 1);
+		}
+		Memory mem = buf.merge();
+		return _writeOutput(mem.getData(), mem.getSize());
+	}
+
+	sl_bool GzipParallelWriter::_writeOutput(const void* data, sl_size size)
+	{
+		PtrLocker<IWriter> output(m_output);
+		if (output.isNotNull()) {
+			if (output->writeFully(data, size) == (sl_reg)size) {
+				m_sizeOutput += size;
+				return sl_true;
+			}
+		}
+		m_flagError = sl_true;
+		return sl_false;
+	}
+
+	sl_bool GzipParallelWriter::_compressBatch(const sl_uint8* data, sl_size size, sl_bool flagLast)
+	{
+		sl_uint32 blockSize = m_blockSize;
+		sl_uint32 nBlocks = (sl_uint32)((size + blockSize - 1) / blockSize);
+		if (!nBlocks) {
+			// empty final block
+			nBlocks = 1;
+		}
+		_priv_GzipParallel_Block blocks[PRIV_GZIP_PARALLEL_MAX_BLOCKS_PER_BATCH];
+		sl_uint32 i;
+		for (i = 0; i < nBlocks; i++) {
+			_priv_GzipParallel_Block& block = blocks[i];
+			sl_size offset = (sl_size)i * blockSize;
+			block.data = data + offset;
+			block.size = (sl_uint32)(SLIB_MIN(size - offset, blockSize));
+			if (m_flagIndependentBlocks) {
+				block.dictionary = sl_null;
+				block.sizeDictionary = 0;
+			} else if (i) {
+				block.dictionary = block.data - PRIV_GZIP_PARALLEL_DICTIONARY_SIZE;
+				block.sizeDictionary = PRIV_GZIP_PARALLEL_DICTIONARY_SIZE;
+			} else {
+				block.dictionary = m_dictionary;
+				block.sizeDictionary = m_sizeDictionary;
+			}
+			block.flagLast = flagLast && i == nBlocks - 1;
+		}
+		sl_int32 level = m_level;
+		_priv_GzipParallel_Block* pBlocks = blocks;
+		m_threadPool->runParallel(nBlocks, [pBlocks, level](sl_uint32 index) {
+			pBlocks[index].compress(level);
+		});
+		for (i = 0; i < nBlocks; i++) {
+			_priv_GzipParallel_Block& block = blocks[i];
+			if (block.output.isNull()) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			if (!(_writeOutput(block.output.getData(), block.output.getSize()))) {
+				return sl_false;
+			}
+			m_crc = (sl_uint32)(crc32_combine(m_crc, block.crc, (z_off_t)(block.size)));
+			m_sizeInput += block.size;
+			if (m_flagIndependentBlocks) {
+				if (!(m_listBlockSizes.add_NoLock((sl_uint32)(block.output.getSize())))) {
+					m_flagError = sl_true;
+					return sl_false;
+				}
+			}
+		}
+		if (!flagLast && !m_flagIndependentBlocks) {
+			// non-last batches consist of full blocks
+			Base::copyMemory(m_dictionary, data + size - PRIV_GZIP_PARALLEL_DICTIONARY_SIZE, PRIV_GZIP_PARALLEL_DICTIONARY_SIZE);
+			m_sizeDictionary = PRIV_GZIP_PARALLEL_DICTIONARY_SIZE;
+		}
+		return sl_true;
+	}
+
+	sl_bool GzipParallelWriter::_writeIndex()
+	{
+		ListElements<sl_uint32> blockSizes(m_listBlockSizes);
+		sl_size nBlocks = blockSizes.count;
+		if (!nBlocks) {
+			return sl_true;
+		}
+		// merges the neighbor blocks into the groups to fit the index in the extra field
+		sl_size nBlocksPerGroup = (nBlocks + PRIV_GZIP_PARALLEL_INDEX_MAX_ENTRIES - 1) / PRIV_GZIP_PARALLEL_INDEX_MAX_ENTRIES;
+		sl_uint32 nGroups = (sl_uint32)((nBlocks + nBlocksPerGroup - 1) / nBlocksPerGroup);
+		sl_size sizeField = (sl_size)nGroups * 8 + 8;
+		sl_size sizeMember = 16 + sizeField + 10;
+		Memory mem = Memory::create(sizeMember);
+		if (mem.isNull()) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		sl_uint8* member = (sl_uint8*)(mem.getData());
+		Base::zeroMemory(member, sizeMember);
+		member[0] = 0x1f;
+		member[1] = 0x8b;
+		member[2] = 8;
+		member[3] = 4;
+		member[9] = 255;
+		MIO::writeUint16LE(member + 10, (sl_uint16)(sizeField + 4));
+		member[12] = 'S';
+		member[13] = 'L';
+		MIO::writeUint16LE(member + 14, (sl_uint16)sizeField);
+		sl_uint8* entry = member + 16;
+		sl_uint64 sizeRemain = m_sizeInput;
+		for (sl_size i = 0; i < nBlocks; i += nBlocksPerGroup) {
+			sl_uint64 sizeCompressed = 0;
+			sl_uint64 sizeContent = 0;
+			for (sl_size k = i; k < nBlocks && k < i + nBlocksPerGroup; k++) {
+				sizeCompressed += blockSizes[k];
+				sl_uint64 n = SLIB_MIN(sizeRemain, (sl_uint64)m_blockSize);
+				sizeContent += n;
+				sizeRemain -= n;
+			}
+			if (sizeCompressed > 0xFFFFFFFF || sizeContent > 0xFFFFFFFF) {
+				// too large groups: the stream is complete without the index
+				return sl_true;
+			}
+			MIO::writeUint32LE(entry, (sl_uint32)sizeCompressed);
+			MIO::writeUint32LE(entry + 4, (sl_uint32)sizeContent);
+			entry += 8;
+		}
+		MIO::writeUint32LE(entry, nGroups);
+		MIO::writeUint32LE(entry + 4, PRIV_GZIP_PARALLEL_INDEX_MAGIC);
+		entry += 8;
+		entry[0] = 3;
+		return _writeOutput(member, sizeMember);
+	}
+
 	sl_uint32 Zlib::adler32(sl_uint32 adler, const void* _data, sl_size size)
 	{
 		const char* data = (const char*)_data;
@@ -410,6 +973,32 @@ namespace slib
 		return compressGzip(param, data, size, level);
 	}
 
+	Memory Zlib::compressGzipParallel(const GzipParallelParam& param, const void* data, sl_size size)
+	{
+		Ref<MemoryWriter> output = new MemoryWriter;
+		if (output.isNull()) {
+			return sl_null;
+		}
+		Ref<GzipParallelWriter> writer = GzipParallelWriter::create(output, param);
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		if (writer->write(data, size) != (sl_reg)size) {
+			return sl_null;
+		}
+		if (!(writer->finish())) {
+			return sl_null;
+		}
+		return output->getData();
+	}
+
+	Memory Zlib::compressGzipParallel(const void* data, sl_size size, sl_int32 level)
+	{
+		GzipParallelParam param;
+		param.level = level;
+		return compressGzipParallel(param, data, size);
+	}
+
 	Memory Zlib::decompress(const void* data, sl_size size)
 	{
 		ZlibDecompress zlib;
@@ -428,4 +1017,133 @@ namespace slib
 		return sl_null;
 	}
 
+	Memory Zlib::decompressGzipParallel(const void* _data, sl_size size, const Ref<ThreadPool>& _pool)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		const sl_uint8* entries;
+		sl_uint32 nEntries;
+		sl_size sizeHeader, sizeContent;
+		if (!(_priv_GzipParallel_findIndex(data, size, entries, nEntries, sizeHeader, sizeContent))) {
+			return decompress(data, size);
+		}
+		Ref<ThreadPool> pool = _pool;
+		if (pool.isNull()) {
+			pool = ThreadPool::create();
+			if (pool.isNull()) {
+				return sl_null;
+			}
+		}
+		Memory ret = Memory::create(sizeContent);
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		_priv_GzipParallel_Group* groups = NewHelper<_priv_GzipParallel_Group>::create(nEntries);
+		if (!groups) {
+			return sl_null;
+		}
+		const sl_uint8* input = data + sizeHeader;
+		sl_uint8* output = (sl_uint8*)(ret.getData());
+		for (sl_uint32 i = 0; i < nEntries; i++) {
+			_priv_GzipParallel_Group& group = groups[i];
+			group.input = input;
+			group.sizeInput = MIO::readUint32LE(entries + (i << 3));
+			group.output = output;
+			group.sizeOutput = MIO::readUint32LE(entries + (i << 3) + 4);
+			input += group.sizeInput;
+			output += group.sizeOutput;
+		}
+		sl_uint32 crc = 0;
+		sl_bool flagSuccess = _priv_GzipParallel_decompressGroups(pool, groups, nEntries, crc);
+		NewHelper<_priv_GzipParallel_Group>::free(groups, nEntries);
+		if (flagSuccess && crc == MIO::readUint32LE(input) && (sl_uint32)sizeContent == MIO::readUint32LE(input + 4)) {
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_bool Zlib::decompressGzipParallel(const void* _data, sl_size size, const Ptr<IWriter>& _output, const Ref<ThreadPool>& _pool)
+	{
+		PtrLocker<IWriter> output(_output);
+		if (output.isNull()) {
+			return sl_false;
+		}
+		const sl_uint8* data = (const sl_uint8*)_data;
+		const sl_uint8* entries;
+		sl_uint32 nEntries;
+		sl_size sizeHeader, sizeContent;
+		if (!(_priv_GzipParallel_findIndex(data, size, entries, nEntries, sizeHeader, sizeContent))) {
+			ZlibDecompress zlib;
+			if (!(zlib.start())) {
+				return sl_false;
+			}
+			Memory memChunk = Memory::create(262144);
+			if (memChunk.isNull()) {
+				return sl_false;
+			}
+			sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
+			for (;;) {
+				sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, 0x40000000));
+				sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+				sl_int32 iRet = zlib.decompress(data, sizeInput, sizeInputPassed, chunk, 262144, sizeOutputUsed);
+				if (iRet < 0) {
+					return sl_false;
+				}
+				if (sizeOutputUsed) {
+					if (output->writeFully(chunk, sizeOutputUsed) != (sl_reg)sizeOutputUsed) {
+						return sl_false;
+					}
+				}
+				data += sizeInputPassed;
+				size -= sizeInputPassed;
+				if (iRet == 0) {
+					return sl_true;
+				}
+				if (!size && !sizeOutputUsed) {
+					// truncated stream
+					return sl_false;
+				}
+			}
+		}
+		Ref<ThreadPool> pool = _pool;
+		if (pool.isNull()) {
+			pool = ThreadPool::create();
+			if (pool.isNull()) {
+				return sl_false;
+			}
+		}
+		sl_uint32 nBatch = _priv_GzipParallel_getBatchCount(pool);
+		_priv_GzipParallel_Group groups[PRIV_GZIP_PARALLEL_MAX_BLOCKS_PER_BATCH];
+		const sl_uint8* input = data + sizeHeader;
+		sl_uint32 crc = 0;
+		for (sl_uint32 iStart = 0; iStart < nEntries; iStart += nBatch) {
+			sl_uint32 n = SLIB_MIN(nEntries - iStart, nBatch);
+			sl_size sizeBatch = 0;
+			sl_uint32 i;
+			for (i = 0; i < n; i++) {
+				sizeBatch += MIO::readUint32LE(entries + ((iStart + i) << 3) + 4);
+			}
+			Memory mem = Memory::create(sizeBatch);
+			if (mem.isNull()) {
+				return sl_false;
+			}
+			sl_uint8* buf = (sl_uint8*)(mem.getData());
+			for (i = 0; i < n; i++) {
+				_priv_GzipParallel_Group& group = groups[i];
+				group.input = input;
+				group.sizeInput = MIO::readUint32LE(entries + ((iStart + i) << 3));
+				group.output = buf;
+				group.sizeOutput = MIO::readUint32LE(entries + ((iStart + i) << 3) + 4);
+				input += group.sizeInput;
+				buf += group.sizeOutput;
+			}
+			if (!(_priv_GzipParallel_decompressGroups(pool, groups, n, crc))) {
+				return sl_false;
+			}
+			if (output->writeFully(mem.getData(), sizeBatch) != (sl_reg)sizeBatch) {
+				return sl_false;
+			}
+		}
+		return crc == MIO::readUint32LE(input) && (sl_uint32)sizeContent == MIO::readUint32LE(input + 4);
+	}
+
 }
@@ -23,6 +23,11 @@
 #include "slib/db/database.h"
 
 #include "slib/core/log.h"
+#include "slib/core/system.h"
+#include "slib/core/string_buffer.h"
+
+#define PRIV_DATABASE_DEFAULT_STATEMENT_CACHE_SIZE 128
+#define PRIV_DATABASE_DEFAULT_BATCH_CHUNK_SIZE 10000
 
 namespace slib
 {
@@ -33,12 +38,34 @@ namespace slib
 	{
 		m_flagLogSQL = sl_false;
 		m_flagLogErrors = sl_true;
+		
+		m_sizeStatementCache = PRIV_DATABASE_DEFAULT_STATEMENT_CACHE_SIZE;
+		m_nStatementCacheHits = 0;
+		m_nStatementCacheMisses = 0;
+		
+		m_sizeBatchChunk = PRIV_DATABASE_DEFAULT_BATCH_CHUNK_SIZE;
 	}
 
 	Database::~Database()
 	{
 	}
 	
+	static sl_bool _priv_Database_isSchemaChange(const String& sql)
+	{
+		sl_char8* s = sql.getData();
+		sl_size n = sql.getLength();
+		sl_size i = 0;
+		while (i < n && SLIB_CHAR_IS_WHITE_SPACE(s[i])) {
+			i++;
+		}
+		sl_size k = i;
+		while (k < n && SLIB_CHAR_IS_ALPHA(s[k])) {
+			k++;
+		}
+		String command = String::toUpper(s + i, k - i);
+		return command == "CREATE" || command == "ALTER" || command == "DROP" || command == "RENAME";
+	}
+	
 	sl_int64 Database::_execute(const String& sql)
 	{
 		return executeBy(sql, sl_null, 0);
@@ -47,6 +74,9 @@ namespace slib
 	sl_int64 Database::execute(const String& sql)
 	{
 		sl_int64 ret = _execute(sql);
+		if (_priv_Database_isSchemaChange(sql)) {
+			clearStatementCache();
+		}
 		if (ret < 0) {
 			_logError(sql);
 		} else {
@@ -73,9 +103,11 @@ namespace slib
 	
 	sl_int64 Database::_executeBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = _getCachedStatement(sql);
 		if (statement.isNotNull()) {
-			return statement->executeBy(params, nParams);
+			sl_int64 ret = statement->executeBy(params, nParams);
+			_releaseCachedStatement(sql, statement.get(), ret < 0);
+			return ret;
 		}
 		return -1;
 	}
@@ -93,9 +125,11 @@ namespace slib
 	
 	Ref<DatabaseCursor> Database::_queryBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = _getCachedStatement(sql);
 		if (statement.isNotNull()) {
-			return statement->queryBy(params, nParams);
+			Ref<DatabaseCursor> ret = statement->queryBy(params, nParams);
+			_releaseCachedStatement(sql, statement.get(), ret.isNull());
+			return ret;
 		}
 		return sl_null;
 	}
@@ -181,6 +215,297 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool Database::beginTransaction()
+	{
+		return execute("BEGIN") >= 0;
+	}
+	
+	sl_bool Database::commitTransaction()
+	{
+		return execute("COMMIT") >= 0;
+	}
+	
+	sl_bool Database::rollbackTransaction()
+	{
+		return execute("ROLLBACK") >= 0;
+	}
+	
+	sl_bool Database::isInTransaction()
+	{
+		return sl_false;
+	}
+	
+	sl_int64 Database::executeBatch(const String& sql, const Variant* params, sl_uint32 nColumns, sl_size nRows, sl_bool flagColumnMajor)
+	{
+		if (!nRows) {
+			return 0;
+		}
+		if (!nColumns) {
+			return -1;
+		}
+		sl_uint32 tickStart = System::getTickCount();
+		ObjectLocker lock(this);
+		sl_bool flagTransaction = !(isInTransaction());
+		sl_size sizeChunk = m_sizeBatchChunk;
+		if (!sizeChunk || sizeChunk > nRows) {
+			sizeChunk = nRows;
+		}
+		Array<Variant> bufChunk;
+		if (flagColumnMajor && nColumns > 1 && nRows > 1) {
+			bufChunk = Array<Variant>::create(sizeChunk * nColumns);
+			if (bufChunk.isNull()) {
+				return -1;
+			}
+		}
+		sl_int64 total = 0;
+		for (sl_size start = 0; start < nRows; start += sizeChunk) {
+			sl_size n = nRows - start;
+			if (n > sizeChunk) {
+				n = sizeChunk;
+			}
+			const Variant* rows;
+			if (bufChunk.isNotNull()) {
+				Variant* buf = bufChunk.getData();
+				for (sl_size i = 0; i < n; i++) {
+					for (sl_uint32 k = 0; k < nColumns; k++) {
+						buf[i * nColumns + k] = params[k * nRows + start + i];
+					}
+				}
+				rows = buf;
+			} else {
+				rows = params + start * nColumns;
+			}
+			sl_int64 ret = _executeBatchChunk(sql, rows, nColumns, n, flagTransaction);
+			if (ret < 0) {
+				_logError(sql);
+				return -1;
+			}
+			total += ret;
+		}
+		_logBatch(sql, nRows, System::getTickCount() - tickStart);
+		return total;
+	}
+	
+	sl_int64 Database::executeBulk(const String& sql, sl_uint32 nColumns, const Function<sl_bool(Variant* row)>& onFetchRow)
+	{
+		if (!nColumns) {
+			return -1;
+		}
+		sl_uint32 tickStart = System::getTickCount();
+		ObjectLocker lock(this);
+		sl_bool flagTransaction = !(isInTransaction());
+		sl_size sizeChunk = m_sizeBatchChunk;
+		if (!sizeChunk) {
+			sizeChunk = PRIV_DATABASE_DEFAULT_BATCH_CHUNK_SIZE;
+		}
+		Array<Variant> bufChunk = Array<Variant>::create(sizeChunk * nColumns);
+		if (bufChunk.isNull()) {
+			return -1;
+		}
+		Variant* buf = bufChunk.getData();
+		sl_int64 total = 0;
+		sl_size nRowsTotal = 0;
+		sl_bool flagEnd = sl_false;
+		while (!flagEnd) {
+			sl_size n = 0;
+			while (n < sizeChunk) {
+				Variant* row = buf + n * nColumns;
+				for (sl_uint32 k = 0; k < nColumns; k++) {
+					row[k].setNull();
+				}
+				if (!(onFetchRow(row))) {
+					flagEnd = sl_true;
+					break;
+				}
+				n++;
+			}
+			if (n) {
+				sl_int64 ret = _executeBatchChunk(sql, buf, nColumns, n, flagTransaction);
+				if (ret < 0) {
+					_logError(sql);
+					return -1;
+				}
+				total += ret;
+				nRowsTotal += n;
+			}
+		}
+		_logBatch(sql, nRowsTotal, System::getTickCount() - tickStart);
+		return total;
+	}
+	
+	sl_uint32 Database::getBatchChunkSize()
+	{
+		return m_sizeBatchChunk;
+	}
+	
+	void Database::setBatchChunkSize(sl_uint32 nRows)
+	{
+		m_sizeBatchChunk = nRows;
+	}
+	
+	sl_uint32 Database::_getBatchRowsPerStatement(sl_uint32 nColumns)
+	{
+		return 1;
+	}
+	
+	static sl_bool _priv_Database_containsPlaceholder(const sl_char8* s, sl_size start, sl_size end)
+	{
+		sl_char8 chQuote = 0;
+		for (sl_size i = start; i < end; i++) {
+			sl_char8 ch = s[i];
+			if (chQuote) {
+				if (ch == chQuote) {
+					chQuote = 0;
+				}
+			} else if (ch == '\'' || ch == '"' || ch == '`') {
+				chQuote = ch;
+			} else if (ch == '?') {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+	
+	static String _priv_Database_getMultipleRowsSQL(const String& sql, sl_uint32 nRows)
+	{
+		// "INSERT ... VALUES (?, ...) [suffix]" -> "INSERT ... VALUES (?, ...), (?, ...), ... [suffix]"
+		sl_char8* s = sql.getData();
+		sl_size len = sql.getLength();
+		sl_size posValues = 0;
+		sl_char8 chQuote = 0;
+		for (sl_size i = 0; i < len; i++) {
+			sl_char8 ch = s[i];
+			if (chQuote) {
+				if (ch == chQuote) {
+					chQuote = 0;
+				}
+			} else if (ch == '\'' || ch == '"' || ch == '`') {
+				chQuote = ch;
+			} else if (i + 6 <= len && (i == 0 || !SLIB_CHAR_IS_ALNUM(s[i - 1])) && String::toUpper(s + i, 6) == "VALUES") {
+				if (i + 6 == len || !SLIB_CHAR_IS_ALNUM(s[i + 6])) {
+					posValues = i + 6;
+					break;
+				}
+			}
+		}
+		if (!posValues) {
+			return sl_null;
+		}
+		sl_size posStart = posValues;
+		while (posStart < len && SLIB_CHAR_IS_WHITE_SPACE(s[posStart])) {
+			posStart++;
+		}
+		if (posStart >= len || s[posStart] != '(') {
+			return sl_null;
+		}
+		sl_size posEnd = 0;
+		sl_uint32 depth = 0;
+		chQuote = 0;
+		for (sl_size i = posStart; i < len; i++) {
+			sl_char8 ch = s[i];
+			if (chQuote) {
+				if (ch == chQuote) {
+					chQuote = 0;
+				}
+			} else if (ch == '\'' || ch == '"' || ch == '`') {
+				chQuote = ch;
+			} else if (ch == '(') {
+				depth++;
+			} else if (ch == ')') {
+				depth--;
+				if (!depth) {
+					posEnd = i + 1;
+					break;
+				}
+			}
+		}
+		if (!posEnd) {
+			return sl_null;
+		}
+		// single row only
+		sl_size posSuffix = posEnd;
+		while (posSuffix < len && SLIB_CHAR_IS_WHITE_SPACE(s[posSuffix])) {
+			posSuffix++;
+		}
+		if (posSuffix < len && s[posSuffix] == ',') {
+			return sl_null;
+		}
+		// the parameters of each row must be bound only in the repeated group (e.g. not in `ON DUPLICATE KEY UPDATE x = ?`)
+		if (_priv_Database_containsPlaceholder(s, 0, posStart) || _priv_Database_containsPlaceholder(s, posEnd, len)) {
+			return sl_null;
+		}
+		String group = sql.substring(posStart, posEnd);
+		StringBuffer buf;
+		buf.add(sql.substring(0, posEnd));
+		for (sl_uint32 i = 1; i < nRows; i++) {
+			buf.addStatic(", ", 2);
+			buf.add(group);
+		}
+		buf.add(sql.substring(posEnd));
+		return buf.merge();
+	}
+	
+	sl_int64 Database::_executeBatch(const String& sql, const Variant* rows, sl_uint32 nColumns, sl_size nRows)
+	{
+		sl_int64 total = 0;
+		sl_size i = 0;
+		sl_uint32 nRowsPerStatement = _getBatchRowsPerStatement(nColumns);
+		if (nRowsPerStatement > 1) {
+			while (nRows - i > 1) {
+				sl_uint32 n = nRowsPerStatement;
+				if (n > nRows - i) {
+					n = (sl_uint32)(nRows - i);
+				}
+				String sqlMultiple = _priv_Database_getMultipleRowsSQL(sql, n);
+				if (sqlMultiple.isNull()) {
+					break;
+				}
+				Ref<DatabaseStatement> statement = _getCachedStatement(sqlMultiple);
+				if (statement.isNull()) {
+					return -1;
+				}
+				sl_int64 ret = statement->executeBy(rows + i * nColumns, n * nColumns);
+				_releaseCachedStatement(sqlMultiple, statement.get(), ret < 0);
+				if (ret < 0) {
+					return -1;
+				}
+				total += ret;
+				i += n;
+			}
+		}
+		if (i < nRows) {
+			Ref<DatabaseStatement> statement = _getCachedStatement(sql);
+			if (statement.isNull()) {
+				return -1;
+			}
+			sl_int64 ret = statement->executeBatch(rows + i * nColumns, nColumns, nRows - i);
+			_releaseCachedStatement(sql, statement.get(), ret < 0);
+			if (ret < 0) {
+				return -1;
+			}
+			total += ret;
+		}
+		return total;
+	}
+	
+	sl_int64 Database::_executeBatchChunk(const String& sql, const Variant* rows, sl_uint32 nColumns, sl_size nRows, sl_bool flagTransaction)
+	{
+		if (flagTransaction) {
+			if (!(beginTransaction())) {
+				return -1;
+			}
+		}
+		sl_int64 ret = _executeBatch(sql, rows, nColumns, nRows);
+		if (flagTransaction) {
+			if (ret < 0) {
+				rollbackTransaction();
+			} else if (!(commitTransaction())) {
+				return -1;
+			}
+		}
+		return ret;
+	}
+
 	sl_bool Database::isLoggingSQL()
 	{
 		return m_flagLogSQL;
@@ -201,6 +526,122 @@ namespace slib
 		m_flagLogErrors = flag;
 	}
 	
+	sl_uint32 Database::getStatementCacheSize()
+	{
+		return m_sizeStatementCache;
+	}
+	
+	void Database::setStatementCacheSize(sl_uint32 size)
+	{
+		CLinkedList< Pair< String, Ref<DatabaseStatement> > > listRemoved;
+		{
+			MutexLocker lock(&m_lockStatementCache);
+			m_sizeStatementCache = size;
+			_removeCachedStatements(size, listRemoved);
+		}
+		// statements are finalized out of the cache lock
+		ObjectLocker lock(this);
+		listRemoved.removeAll_NoLock();
+	}
+	
+	void Database::clearStatementCache()
+	{
+		CLinkedList< Pair< String, Ref<DatabaseStatement> > > listRemoved;
+		{
+			MutexLocker lock(&m_lockStatementCache);
+			_removeCachedStatements(0, listRemoved);
+		}
+		ObjectLocker lock(this);
+		listRemoved.removeAll_NoLock();
+	}
+	
+	sl_uint64 Database::getStatementCacheHitsCount()
+	{
+		return m_nStatementCacheHits;
+	}
+	
+	sl_uint64 Database::getStatementCacheMissesCount()
+	{
+		return m_nStatementCacheMisses;
+	}
+	
+	Ref<DatabaseStatement> Database::_getCachedStatement(const String& sql)
+	{
+		if (!m_sizeStatementCache) {
+			return prepareStatement(sql);
+		}
+		{
+			MutexLocker lock(&m_lockStatementCache);
+			Link< Pair< String, Ref<DatabaseStatement> > >* link = m_mapCachedStatements.getValue_NoLock(sql, sl_null);
+			if (link) {
+				// a statement being executed or referenced by a living cursor is not shared
+				Ref<DatabaseStatement> statement = link->value.second;
+				if (statement->m_db.isNull() && statement->getReferenceCount() == 2) {
+					m_nStatementCacheHits++;
+					if (link != m_listCachedStatements.getFront()) {
+						m_listCachedStatements.removeAt(link);
+						link = m_listCachedStatements.pushFront_NoLock(Pair< String, Ref<DatabaseStatement> >(sql, statement));
+						if (link) {
+							m_mapCachedStatements.put_NoLock(sql, link);
+						} else {
+							m_mapCachedStatements.remove_NoLock(sql);
+						}
+					}
+					statement->m_db = this;
+					return statement;
+				}
+			}
+			m_nStatementCacheMisses++;
+		}
+		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		if (statement.isNull()) {
+			return sl_null;
+		}
+		CLinkedList< Pair< String, Ref<DatabaseStatement> > > listRemoved;
+		{
+			MutexLocker lock(&m_lockStatementCache);
+			if (m_sizeStatementCache && !(m_mapCachedStatements.find_NoLock(sql))) {
+				Link< Pair< String, Ref<DatabaseStatement> > >* link = m_listCachedStatements.pushFront_NoLock(Pair< String, Ref<DatabaseStatement> >(sql, statement));
+				if (link) {
+					m_mapCachedStatements.put_NoLock(sql, link);
+					_removeCachedStatements(m_sizeStatementCache, listRemoved);
+				}
+			}
+		}
+		if (listRemoved.getCount()) {
+			ObjectLocker lock(this);
+			listRemoved.removeAll_NoLock();
+		}
+		return statement;
+	}
+	
+	void Database::_releaseCachedStatement(const String& sql, DatabaseStatement* statement, sl_bool flagError)
+	{
+		MutexLocker lock(&m_lockStatementCache);
+		Link< Pair< String, Ref<DatabaseStatement> > >* link = m_mapCachedStatements.getValue_NoLock(sql, sl_null);
+		if (link && link->value.second == statement) {
+			if (flagError) {
+				// the statement may be invalidated by schema change or reconnection, so it is prepared again on next use
+				m_mapCachedStatements.remove_NoLock(sql);
+				m_listCachedStatements.removeAt(link);
+			} else {
+				// cached statements do not keep the database alive.
+				// the cache and the cursors holding the statement release it under the lock of the database, so it is never closed without the lock
+				statement->m_db.setNull();
+			}
+		}
+	}
+	
+	void Database::_removeCachedStatements(sl_size countRemaining, CLinkedList< Pair< String, Ref<DatabaseStatement> > >& listRemoved)
+	{
+		while (m_listCachedStatements.getCount() > countRemaining) {
+			Link< Pair< String, Ref<DatabaseStatement> > >* link = m_listCachedStatements.getBack();
+			m_mapCachedStatements.remove_NoLock(link->value.first);
+			listRemoved.pushBack_NoLock(link->value);
+			m_listCachedStatements.removeAt(link);
+		}
+	}
+	
 	void Database::_logSQL(const String& sql)
 	{
 		if (m_flagLogSQL) {
@@ -215,6 +656,14 @@ namespace slib
 		}
 	}
 	
+	void Database::_logBatch(const String& sql, sl_size nRows, sl_uint32 elapsedMilliseconds)
+	{
+		if (m_flagLogSQL) {
+			sl_uint64 speed = elapsedMilliseconds ? (sl_uint64)nRows * 1000 / elapsedMilliseconds : (sl_uint64)nRows * 1000;
+			Log((char*)(getObjectType()), "SQL: %s Rows=%s Elapsed=%sms Speed=%s rows/s", sql, (sl_uint64)nRows, elapsedMilliseconds, speed);
+		}
+	}
+	
 	void Database::_logError(const String& sql)
 	{
 		if (m_flagLogErrors) {
@@ -29,6 +29,7 @@ namespace slib
 
 	DatabaseCursor::DatabaseCursor()
 	{
+		m_sizeFetch = 0;
 	}
 
 	DatabaseCursor::~DatabaseCursor()
@@ -184,4 +185,129 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool DatabaseCursor::getDataView(sl_uint32 index, DatabaseDataView& outView, sl_bool flagText)
+	{
+		return sl_false;
+	}
+
+	void DatabaseCursor::bindColumns(const DatabaseColumnBinding* bindings, sl_uint32 count)
+	{
+		m_bindings = List<DatabaseColumnBinding>(bindings, count);
+	}
+
+	sl_uint32 DatabaseCursor::fetch(sl_uint32 nRows)
+	{
+		sl_uint32 nBindings = (sl_uint32)(m_bindings.getCount());
+		DatabaseColumnBinding* bindings = m_bindings.getData();
+		m_sizeFetch = 0;
+		sl_uint32 iRow = 0;
+		for (; iRow < nRows; iRow++) {
+			if (!(moveNext())) {
+				break;
+			}
+			for (sl_uint32 k = 0; k < nBindings; k++) {
+				DatabaseColumnBinding& binding = bindings[k];
+				void* out = (sl_uint8*)(binding.data) + iRow * binding.stride;
+				switch (binding.type) {
+					case DatabaseColumnType::Int32:
+						*((sl_int32*)out) = getInt32(binding.column);
+						break;
+					case DatabaseColumnType::Uint32:
+						*((sl_uint32*)out) = getUint32(binding.column);
+						break;
+					case DatabaseColumnType::Int64:
+						*((sl_int64*)out) = getInt64(binding.column);
+						break;
+					case DatabaseColumnType::Uint64:
+						*((sl_uint64*)out) = getUint64(binding.column);
+						break;
+					case DatabaseColumnType::Float:
+						*((float*)out) = getFloat(binding.column);
+						break;
+					case DatabaseColumnType::Double:
+						*((double*)out) = getDouble(binding.column);
+						break;
+					case DatabaseColumnType::Boolean:
+						*((bool*)out) = getInt32(binding.column) != 0;
+						break;
+					case DatabaseColumnType::Time:
+						*((Time*)out) = getTime(binding.column);
+						break;
+					case DatabaseColumnType::Text:
+					case DatabaseColumnType::Blob:
+						{
+							DatabaseDataView* view = (DatabaseDataView*)out;
+							sl_bool flagText = binding.type == DatabaseColumnType::Text;
+							DatabaseDataView src;
+							String str;
+							Memory mem;
+							if (!(getDataView(binding.column, src, flagText))) {
+								if (flagText) {
+									str = getString(binding.column);
+									src.data = str.getData();
+									src.size = str.getLength();
+								} else {
+									mem = getBlob(binding.column);
+									src.data = mem.getData();
+									src.size = mem.getSize();
+								}
+							}
+							sl_size offset;
+							if (src.data && _addFetchData(src.data, src.size, offset)) {
+								// offset is resolved after all the rows are fetched, because the buffer may be reallocated
+								view->data = (void*)(offset + 1);
+								view->size = src.size;
+							} else {
+								view->data = sl_null;
+								view->size = 0;
+							}
+						}
+						break;
+				}
+			}
+		}
+		sl_uint8* base = (sl_uint8*)(m_bufFetch.getData());
+		for (sl_uint32 k = 0; k < nBindings; k++) {
+			DatabaseColumnBinding& binding = bindings[k];
+			if (binding.type == DatabaseColumnType::Text || binding.type == DatabaseColumnType::Blob) {
+				sl_uint8* out = (sl_uint8*)(binding.data);
+				for (sl_uint32 i = 0; i < iRow; i++) {
+					DatabaseDataView* view = (DatabaseDataView*)out;
+					if (view->data) {
+						view->data = base + ((sl_size)(view->data) - 1);
+					}
+					out += binding.stride;
+				}
+			}
+		}
+		return iRow;
+	}
+
+	sl_bool DatabaseCursor::_addFetchData(const void* data, sl_size size, sl_size& outOffset)
+	{
+		// texts are null-terminated
+		sl_size sizeRequired = m_sizeFetch + size + 1;
+		sl_size sizeBuf = m_bufFetch.getSize();
+		if (sizeRequired > sizeBuf) {
+			sl_size sizeNew = sizeBuf ? sizeBuf * 2 : 4096;
+			if (sizeNew < sizeRequired) {
+				sizeNew = sizeRequired;
+			}
+			Memory bufNew = Memory::create(sizeNew);
+			if (bufNew.isNull()) {
+				return sl_false;
+			}
+			if (m_sizeFetch) {
+				Base::copyMemory(bufNew.getData(), m_bufFetch.getData(), m_sizeFetch);
+			}
+			m_bufFetch = bufNew;
+		}
+		sl_uint8* p = (sl_uint8*)(m_bufFetch.getData()) + m_sizeFetch;
+		Base::copyMemory(p, data, size);
+		p[size] = 0;
+		outOffset = m_sizeFetch;
+		m_sizeFetch = sizeRequired;
+		return sl_true;
+	}
+
 }
@@ -22,6 +22,8 @@
 
 #include "slib/db/database.h"
 
+#include "slib/core/scoped.h"
+
 namespace slib
 {
 
@@ -40,6 +42,36 @@ namespace slib
 		return m_db;
 	}
 
+	sl_int64 DatabaseStatement::executeBatch(const Variant* params, sl_uint32 nColumns, sl_size nRows, sl_bool flagColumnMajor)
+	{
+		sl_int64 total = 0;
+		if (flagColumnMajor && nColumns > 1 && nRows > 1) {
+			SLIB_SCOPED_BUFFER(Variant, 64, row, nColumns);
+			if (!row) {
+				return -1;
+			}
+			for (sl_size i = 0; i < nRows; i++) {
+				for (sl_uint32 k = 0; k < nColumns; k++) {
+					row[k] = params[k * nRows + i];
+				}
+				sl_int64 ret = executeBy(row, nColumns);
+				if (ret < 0) {
+					return -1;
+				}
+				total += ret;
+			}
+		} else {
+			for (sl_size i = 0; i < nRows; i++) {
+				sl_int64 ret = executeBy(params + i * nColumns, nColumns);
+				if (ret < 0) {
+					return -1;
+				}
+				total += ret;
+			}
+		}
+		return total;
+	}
+
 	List< HashMap<String, Variant> > DatabaseStatement::getListForQueryResultBy(const Variant* params, sl_uint32 nParams)
 	{
 		List< HashMap<String, Variant> > ret;
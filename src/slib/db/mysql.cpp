@@ -31,8 +31,15 @@
 #include "slib/core/scoped.h"
 #include "slib/core/log.h"
 #include "slib/core/safe_static.h"
+#include "slib/core/system.h"
 
 #define TAG "MySQL_Database"
+#define PRIV_MYSQL_BATCH_ROWS_PER_STATEMENT 1000
+
+#if defined(SLIB_PLATFORM_IS_UNIX)
+// The client library reports the socket to wait for, which can be polled by `AsyncIoLoop` only in readiness (non-IOCP) mode
+#define PRIV_MYSQL_SUPPORT_ASYNC
+#endif
 
 namespace slib
 {
@@ -42,6 +49,7 @@ namespace slib
 		port = 0;
 		flagAutoReconnect = sl_true;
 		flagMultipleStatements = sl_true;
+		flagNonBlocking = sl_false;
 	}
 
 	MySQL_Param::~MySQL_Param()
@@ -113,6 +121,13 @@ namespace slib
 	{
 	public:
 		MYSQL* m_mysql;
+		
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+		class _priv_AsyncObject;
+		class _priv_AsyncInstance;
+		Ref<_priv_AsyncObject> m_asyncObject;
+		Ref<_priv_AsyncInstance> m_asyncInstance;
+#endif
 
 	public:
 		_priv_MySQL_Database()
@@ -122,6 +137,15 @@ namespace slib
 
 		~_priv_MySQL_Database()
 		{
+			clearStatementCache();
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+			if (m_asyncInstance.isNotNull()) {
+				// the socket should be closed after the instance is detached from the loop
+				m_asyncInstance->m_mysqlClosing = m_mysql;
+				m_asyncObject->closeIoInstance();
+				return;
+			}
+#endif
 			::mysql_close(m_mysql);
 		}
 
@@ -145,13 +169,23 @@ namespace slib
 				if (param.flagMultipleStatements) {
 					flags |= CLIENT_MULTI_STATEMENTS;
 				}
+				
+				sl_bool flagNonBlocking = sl_false;
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+				if (param.flagNonBlocking) {
+					if (0 == ::mysql_options(mysql, MYSQL_OPT_NONBLOCK, 0)) {
+						flagNonBlocking = sl_true;
+					}
+				}
+#endif
 
 				if (::mysql_real_connect(mysql, host.getData(), user.getData(), password.getData(), db.getData(), param.port, sl_null, flags)) {
 
 					::mysql_set_character_set(mysql, "utf8");
 					::mysql_autocommit(mysql, 1);
 
-					my_bool flagReconnect = param.flagAutoReconnect ? 1 : 0;
+					// reconnection replaces the socket attached to the I/O loop, so broken non-blocking connections should be replaced by the owner (e.g. `MySQL_Pool`)
+					my_bool flagReconnect = (param.flagAutoReconnect && !flagNonBlocking) ? 1 : 0;
 					::mysql_options(mysql, MYSQL_OPT_RECONNECT, &flagReconnect);
 					my_bool flagReportTruncation = 1;
 					::mysql_options(mysql, MYSQL_REPORT_DATA_TRUNCATION, &flagReportTruncation);
@@ -159,6 +193,16 @@ namespace slib
 					ret = new _priv_MySQL_Database;
 					if (ret.isNotNull()) {
 						ret->m_mysql = mysql;
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+						if (flagNonBlocking) {
+							if (!(ret->_attachIoLoop(param.ioLoop))) {
+								outErrorMessage = "Failed to attach the connection to I/O loop";
+								LogError(TAG, outErrorMessage);
+								// the connection is closed by the destructor
+								return sl_null;
+							}
+						}
+#endif
 						return ret;
 					}
 
@@ -181,6 +225,21 @@ namespace slib
 			return sl_false;
 		}
 
+		sl_bool isInTransaction() override
+		{
+			return (m_mysql->server_status & SERVER_STATUS_IN_TRANS) != 0;
+		}
+		
+		sl_uint32 _getBatchRowsPerStatement(sl_uint32 nColumns) override
+		{
+			// placeholders of a statement are limited to 65535
+			sl_uint32 n = 65535 / nColumns;
+			if (n > PRIV_MYSQL_BATCH_ROWS_PER_STATEMENT) {
+				n = PRIV_MYSQL_BATCH_ROWS_PER_STATEMENT;
+			}
+			return n ? n : 1;
+		}
+
 		sl_int64 _execute(const String& sql) override
 		{
 			initThread();
@@ -205,7 +264,9 @@ namespace slib
 			String* m_columnNames;
 			CHashMap<String, sl_int32> m_mapColumnIndexes;
 
-			_priv_DatabaseCursor(MySQL_Database* db, MYSQL_RES* result)
+			sl_bool m_flagLocked;
+
+			_priv_DatabaseCursor(MySQL_Database* db, MYSQL_RES* result, sl_bool flagLock = sl_true)
 			{
 				m_db = db;
 				m_result = result;
@@ -222,13 +283,19 @@ namespace slib
 				m_row = sl_null;
 				m_lengths = sl_null;
 
-				db->lock();
+				// stored results are fetched from memory without accessing the connection
+				m_flagLocked = flagLock;
+				if (flagLock) {
+					db->lock();
+				}
 			}
 
 			~_priv_DatabaseCursor()
 			{
 				::mysql_free_result(m_result);
-				m_db->unlock();
+				if (m_flagLocked) {
+					m_db->unlock();
+				}
 			}
 
 			sl_uint32 getColumnsCount() override
@@ -301,6 +368,82 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_int64 getInt64(sl_uint32 index, sl_int64 defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					sl_int64 value;
+					if (String::parseInt64(10, &value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			sl_uint64 getUint64(sl_uint32 index, sl_uint64 defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					sl_uint64 value;
+					if (String::parseUint64(10, &value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			sl_int32 getInt32(sl_uint32 index, sl_int32 defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					sl_int32 value;
+					if (String::parseInt32(10, &value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			sl_uint32 getUint32(sl_uint32 index, sl_uint32 defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					sl_uint32 value;
+					if (String::parseUint32(10, &value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			float getFloat(sl_uint32 index, float defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					float value;
+					if (String::parseFloat(&value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			double getDouble(sl_uint32 index, double defaultValue) override
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					double value;
+					if (String::parseDouble(&value, m_row[index], 0, m_lengths[index]) == (sl_reg)(m_lengths[index])) {
+						return value;
+					}
+				}
+				return defaultValue;
+			}
+
+			sl_bool getDataView(sl_uint32 index, DatabaseDataView& outView, sl_bool flagText) override
+			{
+				if (m_row && index < m_nColumnNames) {
+					outView.data = m_row[index];
+					outView.size = m_row[index] ? (sl_size)(m_lengths[index]) : 0;
+					return sl_true;
+				}
+				return sl_false;
+			}
+
 			sl_bool moveNext() override
 			{
 				m_row = ::mysql_fetch_row(m_result);
@@ -329,6 +472,353 @@ namespace slib
 			return sl_null;
 		}
 
+		void executeAsync(const String& sql, const Function<void(MySQL_Database*, sl_int64)>& callback) override
+		{
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+			if (_addAsyncTask(sql, sl_false, callback, sl_null)) {
+				return;
+			}
+#endif
+			// runs synchronously when the connection is not opened in non-blocking mode
+			sl_int64 n = execute(sql);
+			callback(this, n);
+		}
+
+		void queryAsync(const String& sql, const Function<void(MySQL_Database*, DatabaseCursor*)>& callback) override
+		{
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+			if (_addAsyncTask(sql, sl_true, sl_null, callback)) {
+				return;
+			}
+#endif
+			Ref<DatabaseCursor> cursor = query(sql);
+			callback(this, cursor.get());
+		}
+
+#if defined(PRIV_MYSQL_SUPPORT_ASYNC)
+		class _priv_AsyncTask : public Referable
+		{
+		public:
+			Ref<_priv_MySQL_Database> db;
+			String sql;
+			sl_bool flagQuery;
+			Function<void(MySQL_Database*, sl_int64)> onExecute;
+			Function<void(MySQL_Database*, DatabaseCursor*)> onQuery;
+		};
+
+		class _priv_AsyncObject : public AsyncIoObject
+		{
+		public:
+			_priv_AsyncObject(const Ref<AsyncIoLoop>& loop, AsyncIoInstance* instance)
+			{
+				setIoLoop(loop);
+				setIoInstance(instance);
+			}
+		};
+
+		class _priv_AsyncInstance : public AsyncIoInstance
+		{
+		public:
+			MYSQL* m_mysql;
+			MYSQL* m_mysqlClosing;
+			WeakRef<_priv_MySQL_Database> m_db;
+
+			LinkedQueue< Ref<_priv_AsyncTask> > m_queueTasks;
+			
+			// accessed only in the loop thread
+			Ref<_priv_AsyncTask> m_task;
+			sl_uint32 m_step;
+			int m_status;
+			int m_retQuery;
+			MYSQL_RES* m_result;
+			
+			// a thread waits for the lock of the connection on behalf of the tasks, and holds it until the task is finished
+			sl_bool m_flagWaitingLock;
+			sl_bool m_flagLockHandedOver;
+			sl_bool m_flagTaskLockedByWaiter;
+			Ref<Event> m_eventUnlock;
+
+		public:
+			_priv_AsyncInstance(_priv_MySQL_Database* db)
+			{
+				m_mysql = db->m_mysql;
+				m_mysqlClosing = sl_null;
+				m_db = db;
+				m_step = 0;
+				m_status = 0;
+				m_retQuery = 0;
+				m_result = sl_null;
+				m_flagWaitingLock = sl_false;
+				m_flagLockHandedOver = sl_false;
+				m_flagTaskLockedByWaiter = sl_false;
+				setHandle((sl_file)(::mysql_get_socket(m_mysql)));
+			}
+
+			~_priv_AsyncInstance()
+			{
+				close();
+			}
+
+		public:
+			void close() override
+			{
+				if (m_mysqlClosing) {
+					initThread();
+					::mysql_close(m_mysqlClosing);
+					m_mysqlClosing = sl_null;
+				}
+				setHandle(SLIB_FILE_INVALID_HANDLE);
+				if (m_eventUnlock.isNotNull()) {
+					// releases the waiting thread
+					m_eventUnlock->set();
+				}
+			}
+
+			void onOrder() override
+			{
+				if (m_task.isNull()) {
+					_startTask();
+				}
+			}
+
+			void onEvent(EventDesc* pev) override
+			{
+				if (m_task.isNull()) {
+					return;
+				}
+				int ready = 0;
+				if (pev->flagError) {
+					// lets the client library detect the error by reading the socket
+					ready = MYSQL_WAIT_READ | MYSQL_WAIT_WRITE | MYSQL_WAIT_EXCEPT;
+				} else {
+					if (pev->flagIn) {
+						ready |= MYSQL_WAIT_READ;
+					}
+					if (pev->flagOut) {
+						ready |= MYSQL_WAIT_WRITE;
+					}
+				}
+				ready &= m_status;
+				if (ready) {
+					_process(_continue(ready));
+				}
+			}
+
+			// blocking calls on another thread own the connection. The lock is waited on another thread instead of the I/O loop, and handed over to the loop when it is released
+			sl_bool _waitLock(_priv_MySQL_Database* db)
+			{
+				if (m_eventUnlock.isNull()) {
+					m_eventUnlock = Event::create();
+					if (m_eventUnlock.isNull()) {
+						return sl_false;
+					}
+				}
+				Ref<_priv_MySQL_Database> refDb = db;
+				WeakRef<_priv_AsyncInstance> weakThis = this;
+				Ref<Event> ev = m_eventUnlock;
+				m_flagWaitingLock = sl_true;
+				Ref<Thread> thread = Thread::start([refDb, weakThis, ev]() {
+					refDb->lock();
+					Ref<_priv_AsyncInstance> instance = weakThis;
+					if (instance.isNotNull() && instance->isOpened()) {
+						instance->m_flagLockHandedOver = sl_true;
+						instance->m_flagWaitingLock = sl_false;
+						instance->requestOrder();
+						instance.setNull();
+						ev->wait();
+					}
+					refDb->unlock();
+				});
+				if (thread.isNull()) {
+					m_flagWaitingLock = sl_false;
+					return sl_false;
+				}
+				return sl_true;
+			}
+			
+			void _unlock(_priv_MySQL_Database* db, sl_bool flagLockedByWaiter)
+			{
+				if (flagLockedByWaiter) {
+					m_eventUnlock->set();
+				} else {
+					db->unlock();
+				}
+			}
+
+			void _startTask()
+			{
+				while (m_task.isNull() && m_queueTasks.getCount() > 0) {
+					Ref<_priv_MySQL_Database> db(m_db);
+					if (db.isNull()) {
+						return;
+					}
+					sl_bool flagLockedByWaiter = sl_false;
+					if (m_flagLockHandedOver) {
+						m_flagLockHandedOver = sl_false;
+						flagLockedByWaiter = sl_true;
+					} else {
+						if (m_flagWaitingLock) {
+							// resumed when the waiting thread gets the lock
+							return;
+						}
+						if (!(db->tryLock())) {
+							if (!(_waitLock(db.get()))) {
+								_finishAllTasks(db.get());
+							}
+							return;
+						}
+					}
+					Ref<_priv_AsyncTask> task;
+					if (!(m_queueTasks.pop(&task)) || task.isNull()) {
+						_unlock(db.get(), flagLockedByWaiter);
+						return;
+					}
+					initThread();
+					m_flagTaskLockedByWaiter = flagLockedByWaiter;
+					m_task = task;
+					m_step = 1;
+					m_retQuery = 0;
+					m_result = sl_null;
+					_process(::mysql_real_query_start(&m_retQuery, m_mysql, task->sql.getData(), (unsigned long)(task->sql.getLength())));
+				}
+			}
+
+			int _continue(int ready)
+			{
+				if (m_step == 1) {
+					return ::mysql_real_query_cont(&m_retQuery, m_mysql, ready);
+				} else {
+					return ::mysql_store_result_cont(&m_result, m_mysql, ready);
+				}
+			}
+
+			void _process(int status)
+			{
+				for (;;) {
+					if (status & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE | MYSQL_WAIT_EXCEPT)) {
+						m_status = status;
+						return;
+					}
+					if (status & MYSQL_WAIT_TIMEOUT) {
+						status = _continue(MYSQL_WAIT_TIMEOUT);
+						continue;
+					}
+					m_status = 0;
+					if (m_step == 1) {
+						if (m_retQuery) {
+							_finish(-1);
+							return;
+						}
+						if (!(m_task->flagQuery)) {
+							_finish((sl_int64)(::mysql_affected_rows(m_mysql)));
+							return;
+						}
+						m_step = 2;
+						status = ::mysql_store_result_start(&m_result, m_mysql);
+					} else {
+						_finish(m_result ? 0 : -1);
+						return;
+					}
+				}
+			}
+
+			void _finish(sl_int64 result)
+			{
+				Ref<_priv_AsyncTask> task = m_task;
+				Ref<_priv_MySQL_Database> db = task->db;
+				MYSQL_RES* res = m_result;
+				m_result = sl_null;
+				m_step = 0;
+				
+				Ref<DatabaseCursor> cursor;
+				if (res) {
+					cursor = new _priv_DatabaseCursor(db.get(), res, sl_false);
+					if (cursor.isNull()) {
+						::mysql_free_result(res);
+						result = -1;
+					}
+				}
+				if (result < 0) {
+					db->_logError(task->sql);
+				} else {
+					db->_logSQL(task->sql);
+				}
+				_unlock(db.get(), m_flagTaskLockedByWaiter);
+				m_flagTaskLockedByWaiter = sl_false;
+				
+				m_task.setNull();
+				if (task->flagQuery) {
+					task->onQuery(db.get(), cursor.get());
+				} else {
+					task->onExecute(db.get(), result);
+				}
+				
+				_startTask();
+			}
+			
+			// fails the queued tasks when the lock can not be waited
+			void _finishAllTasks(_priv_MySQL_Database* db)
+			{
+				LogError(TAG, "Failed to wait for the connection");
+				Ref<_priv_AsyncTask> task;
+				while (m_queueTasks.pop(&task)) {
+					if (task.isNotNull()) {
+						if (task->flagQuery) {
+							task->onQuery(db, sl_null);
+						} else {
+							task->onExecute(db, -1);
+						}
+					}
+				}
+			}
+
+		};
+
+		sl_bool _attachIoLoop(const Ref<AsyncIoLoop>& _loop)
+		{
+			Ref<AsyncIoLoop> loop = _loop;
+			if (loop.isNull()) {
+				loop = AsyncIoLoop::getDefault();
+				if (loop.isNull()) {
+					return sl_false;
+				}
+			}
+			Ref<_priv_AsyncInstance> instance = new _priv_AsyncInstance(this);
+			if (instance.isNotNull() && instance->isOpened()) {
+				Ref<_priv_AsyncObject> object = new _priv_AsyncObject(loop, instance.get());
+				if (object.isNotNull()) {
+					instance->setObject(object.get());
+					if (loop->attachInstance(instance.get(), AsyncIoMode::InOut)) {
+						m_asyncObject = object;
+						m_asyncInstance = instance;
+						return sl_true;
+					}
+				}
+			}
+			return sl_false;
+		}
+
+		sl_bool _addAsyncTask(const String& sql, sl_bool flagQuery, const Function<void(MySQL_Database*, sl_int64)>& onExecute, const Function<void(MySQL_Database*, DatabaseCursor*)>& onQuery)
+		{
+			Ref<_priv_AsyncInstance> instance = m_asyncInstance;
+			if (instance.isNull()) {
+				return sl_false;
+			}
+			Ref<_priv_AsyncTask> task = new _priv_AsyncTask;
+			if (task.isNull()) {
+				return sl_false;
+			}
+			task->db = this;
+			task->sql = sql;
+			task->flagQuery = flagQuery;
+			task->onExecute = onExecute;
+			task->onQuery = onQuery;
+			instance->m_queueTasks.push(task);
+			instance->requestOrder();
+			return sl_true;
+		}
+#endif
+
 #define PRIV_FIELD_DESC_BUFFER_SIZE 64
 		struct _priv_FieldDesc
 		{
@@ -419,6 +909,8 @@ namespace slib
 				::mysql_stmt_free_result(m_statement);
 				Base::freeMemory(m_fds);
 				Base::freeMemory(m_bind);
+				// a statement evicted from the cache of the database is closed here, so it should be released under the lock
+				m_statementObj.setNull();
 				m_db->unlock();
 			}
 
@@ -920,6 +1412,7 @@ namespace slib
 				return sl_false;
 			}
 
+			// `m_db` is null for a statement kept in the statement cache, which is closed by the owner holding the lock of the database
 			void close()
 			{
 				ObjectLocker lock(m_db.get());
@@ -1210,6 +1703,247 @@ namespace slib
 		return connect(param, err);
 	}
 
+
+	MySQL_PoolParam::MySQL_PoolParam()
+	{
+		minIdleConnectionsCount = 1;
+		maxConnectionsCount = 16;
+		idleTimeout = 60000;
+		pingInterval = 30000;
+		waitTimeout = 10000;
+	}
+
+	MySQL_PoolParam::~MySQL_PoolParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(MySQL_Pool, Object)
+
+	MySQL_Pool::MySQL_Pool()
+	{
+		m_nConnections = 0;
+	}
+
+	MySQL_Pool::~MySQL_Pool()
+	{
+		if (m_timer.isNotNull()) {
+			m_timer->stopAndWait();
+		}
+	}
+
+	Ref<MySQL_Pool> MySQL_Pool::create(const MySQL_PoolParam& param)
+	{
+		Ref<Event> ev = Event::create(sl_true);
+		if (ev.isNull()) {
+			return sl_null;
+		}
+		Ref<MySQL_Pool> ret = new MySQL_Pool;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (ret->m_param.maxConnectionsCount < 1) {
+				ret->m_param.maxConnectionsCount = 1;
+			}
+			if (ret->m_param.minIdleConnectionsCount > ret->m_param.maxConnectionsCount) {
+				ret->m_param.minIdleConnectionsCount = ret->m_param.maxConnectionsCount;
+			}
+			ret->m_eventReleased = ev;
+			sl_uint32 interval = param.pingInterval;
+			if (param.idleTimeout && (!interval || param.idleTimeout < interval)) {
+				interval = param.idleTimeout;
+			}
+			if (interval) {
+				ret->m_timer = Timer::start(SLIB_FUNCTION_WEAKREF(MySQL_Pool, _onTimer, ret.get()), interval);
+			}
+			ret->_onTimer(sl_null);
+			return ret;
+		}
+		return sl_null;
+	}
+
+	Ref<MySQL_Database> MySQL_Pool::getConnection()
+	{
+		MySQL_Database::initThread();
+		sl_uint32 tickStart = System::getTickCount();
+		for (;;) {
+			ObjectLocker lock(this);
+			Pair< Ref<MySQL_Database>, sl_uint32 > item;
+			if (m_listIdle.popBack_NoLock(&item)) {
+				return item.first;
+			}
+			if (m_nConnections < m_param.maxConnectionsCount) {
+				m_nConnections++;
+				lock.unlock();
+				Ref<MySQL_Database> db = MySQL_Database::connect(m_param);
+				if (db.isNull()) {
+					lock.lock(this);
+					m_nConnections--;
+				}
+				return db;
+			}
+			lock.unlock();
+			sl_uint32 elapsed = System::getTickCount() - tickStart;
+			if (elapsed >= m_param.waitTimeout) {
+				LogError(TAG, "Timeout while waiting for an idle connection in the pool");
+				return sl_null;
+			}
+			m_eventReleased->wait(m_param.waitTimeout - elapsed);
+		}
+	}
+
+	void MySQL_Pool::releaseConnection(MySQL_Database* db)
+	{
+		if (!db) {
+			return;
+		}
+		ObjectLocker lock(this);
+		Function<void(MySQL_Database*)> task;
+		if (m_queueAsyncTasks.pop_NoLock(&task)) {
+			lock.unlock();
+			task(db);
+			return;
+		}
+		m_listIdle.pushBack_NoLock(Pair< Ref<MySQL_Database>, sl_uint32 >(db, System::getTickCount()));
+		lock.unlock();
+		m_eventReleased->set();
+	}
+
+	sl_uint32 MySQL_Pool::getConnectionsCount()
+	{
+		return m_nConnections;
+	}
+
+	sl_uint32 MySQL_Pool::getIdleConnectionsCount()
+	{
+		return (sl_uint32)(m_listIdle.getCount());
+	}
+
+	void MySQL_Pool::executeAsync(const String& sql, const Function<void(sl_int64)>& callback)
+	{
+		Ref<MySQL_Pool> pool = this;
+		_runAsync([pool, sql, callback](MySQL_Database* db) {
+			if (db) {
+				db->executeAsync(sql, [pool, callback](MySQL_Database* db, sl_int64 nAffectedRows) {
+					callback(nAffectedRows);
+					pool->releaseConnection(db);
+				});
+			} else {
+				callback(-1);
+			}
+		});
+	}
+
+	void MySQL_Pool::queryAsync(const String& sql, const Function<void(DatabaseCursor*)>& callback)
+	{
+		Ref<MySQL_Pool> pool = this;
+		_runAsync([pool, sql, callback](MySQL_Database* db) {
+			if (db) {
+				db->queryAsync(sql, [pool, callback](MySQL_Database* db, DatabaseCursor* cursor) {
+					callback(cursor);
+					pool->releaseConnection(db);
+				});
+			} else {
+				callback(sl_null);
+			}
+		});
+	}
+
+	void MySQL_Pool::_runAsync(const Function<void(MySQL_Database*)>& task)
+	{
+		ObjectLocker lock(this);
+		Pair< Ref<MySQL_Database>, sl_uint32 > item;
+		if (m_listIdle.popBack_NoLock(&item)) {
+			lock.unlock();
+			task(item.first.get());
+			return;
+		}
+		if (m_nConnections < m_param.maxConnectionsCount) {
+			m_nConnections++;
+			lock.unlock();
+			// connecting blocks, so it runs on its own thread instead of the caller, which may be the thread of an I/O loop
+			Ref<MySQL_Pool> pool = this;
+			Ref<Thread> thread = Thread::start([pool, task]() {
+				MySQL_Database::initThread();
+				Ref<MySQL_Database> db = MySQL_Database::connect(pool->m_param);
+				if (db.isNull()) {
+					ObjectLocker lock(pool.get());
+					pool->m_nConnections--;
+				}
+				task(db.get());
+			});
+			if (thread.isNull()) {
+				lock.lock(this);
+				m_nConnections--;
+				lock.unlock();
+				task(sl_null);
+			}
+			return;
+		}
+		// runs when a connection is released
+		m_queueAsyncTasks.push_NoLock(task);
+	}
+
+	void MySQL_Pool::_onTimer(Timer* timer)
+	{
+		MySQL_Database::initThread();
+		
+		sl_uint32 now = System::getTickCount();
+		CLinkedList< Pair< Ref<MySQL_Database>, sl_uint32 > > listChecking;
+		List< Ref<MySQL_Database> > listClosing;
+		
+		ObjectLocker lock(this);
+		// oldest connections are placed at front
+		sl_size nIdle = m_listIdle.getCount();
+		Pair< Ref<MySQL_Database>, sl_uint32 > item;
+		while (m_listIdle.popFront_NoLock(&item)) {
+			if (m_param.idleTimeout && nIdle > m_param.minIdleConnectionsCount && now - item.second >= m_param.idleTimeout) {
+				listClosing.add_NoLock(item.first);
+				nIdle--;
+				m_nConnections--;
+			} else {
+				listChecking.pushBack_NoLock(item);
+			}
+		}
+		lock.unlock();
+		
+		listClosing.setNull();
+		item.first.setNull();
+		
+		// health check
+		Link< Pair< Ref<MySQL_Database>, sl_uint32 > >* link = listChecking.getBack();
+		while (link) {
+			Link< Pair< Ref<MySQL_Database>, sl_uint32 > >* prev = link->before;
+			if (m_param.pingInterval && !(link->value.first->ping())) {
+				listChecking.removeAt(link);
+				lock.lock(this);
+				m_nConnections--;
+				lock.unlock();
+			}
+			link = prev;
+		}
+		
+		lock.lock(this);
+		link = listChecking.getBack();
+		while (link) {
+			m_listIdle.pushFront_NoLock(link->value);
+			link = link->before;
+		}
+		
+		// warm up
+		while (m_listIdle.getCount() < m_param.minIdleConnectionsCount && m_nConnections < m_param.maxConnectionsCount && m_queueAsyncTasks.getCount() == 0) {
+			m_nConnections++;
+			lock.unlock();
+			Ref<MySQL_Database> db = MySQL_Database::connect(m_param);
+			if (db.isNull()) {
+				lock.lock(this);
+				m_nConnections--;
+				return;
+			}
+			releaseConnection(db.get());
+			lock.lock(this);
+		}
+	}
+
 }
 
 #endif
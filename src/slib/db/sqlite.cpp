@@ -30,7 +30,26 @@
 #define TAG "SQLiteDatabase"
 
 namespace slib
-{	
+{
+
+	SQLiteParam::SQLiteParam()
+	{
+		flagCreate = sl_true;
+		flagReadonly = sl_false;
+		
+		flagWAL = sl_false;
+		readersCount = 0;
+		
+		mmapSize = -1;
+		cacheSize = 0;
+		synchronous = SQLiteSynchronousMode::Default;
+		busyTimeout = 5000;
+	}
+
+	SQLiteParam::~SQLiteParam()
+	{
+	}
+
 
 	SLIB_DEFINE_OBJECT(SQLiteDatabase, Database)
 
@@ -41,78 +60,177 @@ namespace slib
 	SQLiteDatabase::~SQLiteDatabase()
 	{
 	}
+	
+	class _priv_Sqlite3Connection : public Referable
+	{
+	public:
+		sqlite3* handle;
+		// the writer connection is locked by the database object
+		const Mutex* lock;
+		Mutex lockReader;
+		
+	public:
+		_priv_Sqlite3Connection(sqlite3* _handle)
+		{
+			handle = _handle;
+			lock = &lockReader;
+		}
+		
+		~_priv_Sqlite3Connection()
+		{
+			::sqlite3_close(handle);
+		}
+		
+	public:
+		static Ref<_priv_Sqlite3Connection> open(const SQLiteParam& param, sl_bool flagReader)
+		{
+			sqlite3* db = sl_null;
+			int flags;
+			if (flagReader) {
+				flags = SQLITE_OPEN_READONLY;
+			} else if (param.flagCreate) {
+				flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+			} else {
+				flags = param.flagReadonly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+			}
+			sl_int32 iResult = ::sqlite3_open_v2(param.path.getData(), &db, flags, sl_null);
+			if (SQLITE_OK != iResult) {
+				::sqlite3_close(db);
+				return sl_null;
+			}
+			Ref<_priv_Sqlite3Connection> ret = new _priv_Sqlite3Connection(db);
+			if (ret.isNull()) {
+				::sqlite3_close(db);
+				return sl_null;
+			}
+			if (param.busyTimeout) {
+				::sqlite3_busy_timeout(db, (int)(param.busyTimeout));
+			}
+			if (param.flagWAL && !flagReader && !(param.flagReadonly)) {
+				if (!(ret->execute("PRAGMA journal_mode=WAL"))) {
+					LogError(TAG, "Failed to enable WAL mode: %s", ::sqlite3_errmsg(db));
+					return sl_null;
+				}
+			}
+			if (param.synchronous != SQLiteSynchronousMode::Default) {
+				ret->execute(String::format("PRAGMA synchronous=%d", (int)(param.synchronous)));
+			}
+			if (param.mmapSize >= 0) {
+				ret->execute(String::format("PRAGMA mmap_size=%d", param.mmapSize));
+			}
+			if (param.cacheSize) {
+				ret->execute(String::format("PRAGMA cache_size=%d", param.cacheSize));
+			}
+			return ret;
+		}
+		
+		sl_bool execute(const String& sql)
+		{
+			return SQLITE_OK == ::sqlite3_exec(handle, sql.getData(), 0, 0, sl_null);
+		}
+		
+	};
 
 	class _priv_Sqlite3Database : public SQLiteDatabase
 	{
 	public:
-		sqlite3* m_db;
+		Ref<_priv_Sqlite3Connection> m_writer;
+		List< Ref<_priv_Sqlite3Connection> > m_readers;
+		sl_int32 m_indexReader;
+		AtomicString m_errorMessage;
 
 		_priv_Sqlite3Database()
 		{
-			m_db = sl_null;
+			m_indexReader = 0;
 		}
 
 		~_priv_Sqlite3Database()
 		{
-			::sqlite3_close(m_db);
+			clearStatementCache();
 		}
 
-		static Ref<_priv_Sqlite3Database> connect(const String& filePath, sl_bool flagCreate, sl_bool flagReadonly)
+		static Ref<_priv_Sqlite3Database> connect(const SQLiteParam& param)
 		{
-			Ref<_priv_Sqlite3Database> ret;
-			sqlite3* db = sl_null;
-			int flags;
-			if (flagCreate) {
-				flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
-			} else {
-				flags = flagReadonly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+			Ref<_priv_Sqlite3Connection> writer = _priv_Sqlite3Connection::open(param, sl_false);
+			if (writer.isNull()) {
+				return sl_null;
 			}
-			sl_int32 iResult = ::sqlite3_open_v2(filePath.getData(), &db, flags, sl_null);
-			if (SQLITE_OK == iResult) {
-				ret = new _priv_Sqlite3Database();
-				if (ret.isNotNull()) {
-					ret->m_db = db;
-					return ret;
+			Ref<_priv_Sqlite3Database> ret = new _priv_Sqlite3Database();
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			writer->lock = ret->getLocker();
+			ret->m_writer = writer;
+			if (param.flagWAL) {
+				for (sl_uint32 i = 0; i < param.readersCount; i++) {
+					Ref<_priv_Sqlite3Connection> reader = _priv_Sqlite3Connection::open(param, sl_true);
+					if (reader.isNull()) {
+						return sl_null;
+					}
+					ret->m_readers.add_NoLock(reader);
 				}
-				::sqlite3_close(db);
 			}
 			return ret;
 		}
-
-		sl_int64 _execute(const String& sql) override
+		
+		void _setError(sqlite3* handle)
 		{
-			ObjectLocker lock(this);
-			if (SQLITE_OK == ::sqlite3_exec(m_db, sql.getData(), 0, 0, sl_null)) {
-				return ::sqlite3_changes(m_db);
+			if (m_readers.isNotNull()) {
+				m_errorMessage = ::sqlite3_errmsg(handle);
 			}
-			return -1;
+		}
+		
+		sl_uint32 _selectReader()
+		{
+			// prefers an idle reader, starting from the next of the last selection
+			sl_uint32 n = (sl_uint32)(m_readers.getCount());
+			Ref<_priv_Sqlite3Connection>* readers = m_readers.getData();
+			sl_uint32 start = ((sl_uint32)(Base::interlockedIncrement32(&m_indexReader))) % n;
+			for (sl_uint32 i = 0; i < n; i++) {
+				sl_uint32 index = (start + i) % n;
+				const Mutex* lock = readers[index]->lock;
+				if (lock->tryLock()) {
+					lock->unlock();
+					return index;
+				}
+			}
+			return start;
 		}
 
-		static HashMap<String, Variant> _getRow(sqlite3_stmt* stmt, String* columns, sl_uint32 nColumns)
+		sl_bool isInTransaction() override
 		{
-			HashMap<String, Variant> row;
-			for (sl_uint32 cIndex = 0; cIndex < nColumns; cIndex++) {
-				String cValue = String::fromUtf8(::sqlite3_column_text(stmt, (int)cIndex));
-				row.put_NoLock(columns[cIndex], cValue);
+			return !(::sqlite3_get_autocommit(m_writer->handle));
+		}
+
+		sl_int64 _execute(const String& sql) override
+		{
+			MutexLocker lock(m_writer->lock);
+			if (m_writer->execute(sql)) {
+				return ::sqlite3_changes(m_writer->handle);
 			}
-			return row;
+			_setError(m_writer->handle);
+			return -1;
 		}
 
 		class _priv_DatabaseCursor : public DatabaseCursor
 		{
 		public:
 			Ref<DatabaseStatement> m_statementObj;
+			Ref<_priv_Sqlite3Connection> m_connection;
 			sqlite3_stmt* m_statement;
 
 			CList<String> m_listColumnNames;
 			sl_uint32 m_nColumnNames;
 			String* m_columnNames;
 			CHashMap<String, sl_int32> m_mapColumnIndexes;
+			sl_bool m_flagEnd;
 
-			_priv_DatabaseCursor(Database* db, DatabaseStatement* statementObj, sqlite3_stmt* statement)
+			_priv_DatabaseCursor(Database* db, DatabaseStatement* statementObj, _priv_Sqlite3Connection* connection, sqlite3_stmt* statement)
 			{
 				m_db = db;
+				m_flagEnd = sl_false;
 				m_statementObj = statementObj;
+				m_connection = connection;
 				m_statement = statement;
 
 				sl_int32 cols = ::sqlite3_column_count(statement);
@@ -125,14 +243,14 @@ namespace slib
 				m_nColumnNames = (sl_uint32)(m_listColumnNames.getCount());
 				m_columnNames = m_listColumnNames.getData();
 
-				db->lock();
+				connection->lock->lock();
 			}
 
 			~_priv_DatabaseCursor()
 			{
 				::sqlite3_reset(m_statement);
 				::sqlite3_clear_bindings(m_statement);
-				m_db->unlock();
+				m_connection->lock->unlock();
 			}
 
 			sl_uint32 getColumnsCount() override
@@ -342,12 +460,40 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_bool getDataView(sl_uint32 index, DatabaseDataView& outView, sl_bool flagText) override
+			{
+				if (index < m_nColumnNames) {
+					if (::sqlite3_column_type(m_statement, index) == SQLITE_NULL) {
+						outView.data = sl_null;
+						outView.size = 0;
+						return sl_true;
+					}
+					if (flagText) {
+						outView.data = ::sqlite3_column_text(m_statement, index);
+					} else {
+						outView.data = ::sqlite3_column_blob(m_statement, index);
+					}
+					outView.size = (sl_size)(::sqlite3_column_bytes(m_statement, index));
+					if (!(outView.data)) {
+						// zero-length blob
+						outView.data = "";
+					}
+					return sl_true;
+				}
+				return sl_false;
+			}
+
 			sl_bool moveNext() override
 			{
+				if (m_flagEnd) {
+					// stepping again would restart the statement
+					return sl_false;
+				}
 				sl_int32 nRet = ::sqlite3_step(m_statement);
 				if (nRet == SQLITE_ROW) {
 					return sl_true;
 				}
+				m_flagEnd = sl_true;
 				return sl_false;
 			}
 
@@ -356,20 +502,54 @@ namespace slib
 		class _priv_DatabaseStatement : public DatabaseStatement
 		{
 		public:
-			sqlite3* m_sqlite;
-			sqlite3_stmt* m_statement;
-			Array<Variant> m_boundParams;
+			class Slot
+			{
+			public:
+				Ref<_priv_Sqlite3Connection> connection;
+				sqlite3_stmt* statement;
+				Array<Variant> boundParams;
+				
+			public:
+				Slot()
+				{
+					statement = sl_null;
+				}
+				
+				~Slot()
+				{
+					::sqlite3_finalize(statement);
+				}
+				
+			};
+			
+			String m_sql;
+			// read-only statement has the slots of the readers followed by the slot of the writer, which are prepared on first use
+			Array<Slot> m_slots;
 
-			_priv_DatabaseStatement(_priv_Sqlite3Database* db, sqlite3_stmt* statement)
+			_priv_DatabaseStatement(_priv_Sqlite3Database* db, const String& sql, sl_bool flagReader)
 			{
 				m_db = db;
-				m_sqlite = db->m_db;
-				m_statement = statement;
+				m_sql = sql;
+				if (flagReader) {
+					sl_uint32 nReaders = (sl_uint32)(db->m_readers.getCount());
+					m_slots = Array<Slot>::create(nReaders + 1);
+					if (m_slots.isNotNull()) {
+						Slot* slots = m_slots.getData();
+						for (sl_uint32 i = 0; i < nReaders; i++) {
+							slots[i].connection = db->m_readers.getValueAt_NoLock(i);
+						}
+						slots[nReaders].connection = db->m_writer;
+					}
+				} else {
+					m_slots = Array<Slot>::create(1);
+					if (m_slots.isNotNull()) {
+						m_slots.getData()->connection = db->m_writer;
+					}
+				}
 			}
 
 			~_priv_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
 			}
 			
 			sl_bool isLoggingErrors()
@@ -380,11 +560,38 @@ namespace slib
 				return sl_false;
 			}
 			
-			sl_bool _execute(const Variant* _params, sl_uint32 nParams)
+			Slot* _selectSlot(_priv_Sqlite3Database* db)
 			{
-				::sqlite3_reset(m_statement);
-				::sqlite3_clear_bindings(m_statement);
-				m_boundParams.setNull();
+				sl_uint32 n = (sl_uint32)(m_slots.getCount());
+				Slot* slots = m_slots.getData();
+				if (n == 1) {
+					return slots;
+				}
+				// reads in a transaction of the writer see its changes, as on a single connection
+				Slot* slotWriter = slots + (n - 1);
+				if (!(::sqlite3_get_autocommit(slotWriter->connection->handle))) {
+					const Mutex* lock = slotWriter->connection->lock;
+					if (lock->tryLock()) {
+						lock->unlock();
+						return slotWriter;
+					}
+				}
+				return slots + db->_selectReader();
+			}
+			
+			sl_bool _prepare(Slot* slot)
+			{
+				if (slot->statement) {
+					return sl_true;
+				}
+				return SQLITE_OK == ::sqlite3_prepare_v2(slot->connection->handle, m_sql.getData(), (int)(m_sql.getLength()), &(slot->statement), sl_null);
+			}
+			
+			sl_bool _execute(Slot* slot, const Variant* _params, sl_uint32 nParams)
+			{
+				::sqlite3_reset(slot->statement);
+				::sqlite3_clear_bindings(slot->statement);
+				slot->boundParams.setNull();
 				
 				if (nParams == 0) {
 					return sl_true;
@@ -394,7 +601,7 @@ namespace slib
 				if (params.isNull()) {
 					return sl_false;
 				}
-				sl_uint32 n = (sl_uint32)(::sqlite3_bind_parameter_count(m_statement));
+				sl_uint32 n = (sl_uint32)(::sqlite3_bind_parameter_count(slot->statement));
 				if (n == nParams) {
 					if (n > 0) {
 						for (sl_uint32 i = 0; i < n; i++) {
@@ -402,34 +609,34 @@ namespace slib
 							Variant& var = (params.getData())[i];
 							switch (var.getType()) {
 							case VariantType::Null:
-								iRet = ::sqlite3_bind_null(m_statement, i+1);
+								iRet = ::sqlite3_bind_null(slot->statement, i+1);
 								break;
 							case VariantType::Boolean:
 							case VariantType::Int32:
-								iRet = ::sqlite3_bind_int(m_statement, i+1, var.getInt32());
+								iRet = ::sqlite3_bind_int(slot->statement, i+1, var.getInt32());
 								break;
 							case VariantType::Uint32:
 							case VariantType::Int64:
 							case VariantType::Uint64:
-								iRet = ::sqlite3_bind_int64(m_statement, i+1, var.getInt64());
+								iRet = ::sqlite3_bind_int64(slot->statement, i+1, var.getInt64());
 								break;
 							case VariantType::Float:
 							case VariantType::Double:
-								iRet = ::sqlite3_bind_double(m_statement, i+1, var.getDouble());
+								iRet = ::sqlite3_bind_double(slot->statement, i+1, var.getDouble());
 								break;
 							default:
 								if (var.isMemory()) {
 									Memory mem = var.getMemory();
 									sl_size size = mem.getSize();
 									if (size > 0x7fffffff) {
-										iRet = ::sqlite3_bind_blob64(m_statement, i+1, mem.getData(), size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob64(slot->statement, i+1, mem.getData(), size, SQLITE_STATIC);
 									} else {
-										iRet = ::sqlite3_bind_blob(m_statement, i+1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob(slot->statement, i+1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
 									}
 								} else {
 									String str = var.getString();
 									var = str;
-									iRet = ::sqlite3_bind_text(m_statement, i+1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
+									iRet = ::sqlite3_bind_text(slot->statement, i+1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
 								}
 							}
 							if (iRet != SQLITE_OK) {
@@ -437,7 +644,7 @@ namespace slib
 							}
 						}
 					}
-					m_boundParams = params;
+					slot->boundParams = params;
 					return sl_true;
 				} else {
 					if (isLoggingErrors()) {
@@ -449,51 +656,84 @@ namespace slib
 
 			sl_int64 executeBy(const Variant* params, sl_uint32 nParams) override
 			{
-				ObjectLocker lock(m_db.get());
-				if (_execute(params, nParams)) {
-					if (::sqlite3_step(m_statement) == SQLITE_DONE) {
-						::sqlite3_reset(m_statement);
-						::sqlite3_clear_bindings(m_statement);
-						return ::sqlite3_changes(m_sqlite);
+				_priv_Sqlite3Database* db = (_priv_Sqlite3Database*)(m_db.get());
+				Slot* slot = _selectSlot(db);
+				MutexLocker lock(slot->connection->lock);
+				if (_prepare(slot)) {
+					if (_execute(slot, params, nParams)) {
+						if (::sqlite3_step(slot->statement) == SQLITE_DONE) {
+							::sqlite3_reset(slot->statement);
+							::sqlite3_clear_bindings(slot->statement);
+							return ::sqlite3_changes(slot->connection->handle);
+						}
 					}
 				}
+				db->_setError(slot->connection->handle);
 				return -1;
 			}
 
 			Ref<DatabaseCursor> queryBy(const Variant* params, sl_uint32 nParams) override
 			{
-				ObjectLocker lock(m_db.get());
+				_priv_Sqlite3Database* db = (_priv_Sqlite3Database*)(m_db.get());
+				Slot* slot = _selectSlot(db);
+				MutexLocker lock(slot->connection->lock);
 				Ref<DatabaseCursor> ret;
-				if (_execute(params, nParams)) {
-					ret = new _priv_DatabaseCursor(m_db.get(), this, m_statement);
-					if (ret.isNotNull()) {
-						return ret;
+				if (_prepare(slot)) {
+					if (_execute(slot, params, nParams)) {
+						ret = new _priv_DatabaseCursor(db, this, slot->connection.get(), slot->statement);
+						if (ret.isNotNull()) {
+							return ret;
+						}
+						::sqlite3_reset(slot->statement);
+						::sqlite3_clear_bindings(slot->statement);
 					}
-					::sqlite3_reset(m_statement);
-					::sqlite3_clear_bindings(m_statement);
 				}
+				db->_setError(slot->connection->handle);
 				return ret;
 			}
 		};
 
 		Ref<DatabaseStatement> prepareStatement(const String& sql) override
 		{
-			ObjectLocker lock(this);
-			Ref<DatabaseStatement> ret;
-			sqlite3_stmt* statement = sl_null;
-			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _priv_DatabaseStatement(this, statement);
-				if (ret.isNotNull()) {
+			if (m_readers.isNotNull()) {
+				sl_uint32 index = _selectReader();
+				Ref<_priv_Sqlite3Connection> reader = m_readers.getValueAt_NoLock(index);
+				sqlite3_stmt* statement = sl_null;
+				{
+					MutexLocker lock(reader->lock);
+					::sqlite3_prepare_v2(reader->handle, sql.getData(), (int)(sql.getLength()), &statement, sl_null);
+				}
+				if (statement) {
+					// statements returning rows without writing are executed on the readers
+					if (::sqlite3_stmt_readonly(statement) && ::sqlite3_column_count(statement) > 0) {
+						Ref<_priv_DatabaseStatement> ret = new _priv_DatabaseStatement(this, sql, sl_true);
+						if (ret.isNotNull() && ret->m_slots.isNotNull()) {
+							ret->m_slots[index].statement = statement;
+							return ret;
+						}
+					}
+					::sqlite3_finalize(statement);
+				}
+			}
+			MutexLocker lock(m_writer->lock);
+			Ref<_priv_DatabaseStatement> ret = new _priv_DatabaseStatement(this, sql, sl_false);
+			if (ret.isNotNull() && ret->m_slots.isNotNull()) {
+				if (ret->_prepare(ret->m_slots.getData())) {
 					return ret;
 				}
-				::sqlite3_finalize(statement);
+				_setError(m_writer->handle);
 			}
-			return ret;
+			return sl_null;
 		}
 
 		String getErrorMessage() override
 		{
-			String error = ::sqlite3_errmsg(m_db);
+			String error;
+			if (m_readers.isNotNull()) {
+				error = m_errorMessage;
+			} else {
+				error = ::sqlite3_errmsg(m_writer->handle);
+			}
 			if (error.isEmpty() || error == "not an error") {
 				return sl_null;
 			}
@@ -501,9 +741,18 @@ namespace slib
 		}
 	};
 	
+	Ref<SQLiteDatabase> SQLiteDatabase::connect(const SQLiteParam& param)
+	{
+		return _priv_Sqlite3Database::connect(param);
+	}
+	
 	Ref<SQLiteDatabase> SQLiteDatabase::connect(const String& path, sl_bool flagCreate, sl_bool flagReadonly)
 	{
-		return _priv_Sqlite3Database::connect(path, flagCreate, flagReadonly);
+		SQLiteParam param;
+		param.path = path;
+		param.flagCreate = flagCreate;
+		param.flagReadonly = flagReadonly;
+		return _priv_Sqlite3Database::connect(param);
 	}
 
 }
@@ -71,6 +71,7 @@ namespace slib
 		m_currentPlaneY = 0;
 		m_currentPlaneX = 0;
 		m_currentPlaneRowHeight = 0;
+		m_flagReusingPlane = sl_false;
 	}
 
 	FontAtlas::~FontAtlas()
@@ -200,6 +201,24 @@ namespace slib
 		return Size::zero();
 	}
 
+	sl_bool FontAtlas::isReusingPlanes(sl_char16 ch)
+	{
+		if (ch == ' ' || ch == '\r' || ch == '\n' || ch == '\t') {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		if (m_countPlanes < m_maxPlanes && !m_flagReusingPlane) {
+			return sl_false;
+		}
+		FontAtlasChar fac;
+		if (m_map.get_NoLock(ch, &fac)) {
+			if (fac.bitmap.isNotNull() || fac.fontWidth <= 0 || fac.fontHeight <= 0) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
 	Size FontAtlas::getFontSize_NoLock(sl_char16 ch)
 	{
 		FontAtlasChar fac;
@@ -348,6 +367,7 @@ namespace slib
 				m_currentPlane = plane;
 				m_currentCanvas = canvas;
 				m_countPlanes++;
+				m_flagReusingPlane = sl_false;
 			}
 			m_currentPlaneX = 0;
 			m_currentPlaneY = 0;
@@ -386,6 +406,7 @@ namespace slib
 		m_currentPlaneX = 0;
 		m_currentPlaneY = 0;
 		m_currentPlaneRowHeight = 0;
+		m_flagReusingPlane = sl_true;
 	}
 
 }
@@ -38,6 +38,29 @@ namespace slib
 	{
 	}
 
+	sl_uint32 AudioEncoder::encode(const AudioData& input, void* output, sl_uint32 sizeOutput)
+	{
+		Memory mem = encode(input);
+		sl_size size = mem.getSize();
+		if (size && size <= sizeOutput) {
+			Base::copyMemory(output, mem.getData(), size);
+			return (sl_uint32)size;
+		}
+		return 0;
+	}
+
+	Memory AudioEncoder::encode(const AudioData& input, MemoryPool* pool)
+	{
+		Memory mem = pool->allocate();
+		if (mem.isNotNull()) {
+			sl_uint32 size = encode(input, mem.getData(), (sl_uint32)(mem.getSize()));
+			if (size) {
+				return mem.sub(0, size);
+			}
+		}
+		return sl_null;
+	}
+
 	sl_uint32 AudioEncoder::getSamplesCountPerSecond() const
 	{
 		return m_nSamplesPerSecond;
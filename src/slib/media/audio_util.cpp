@@ -22,6 +22,19 @@
 
 #include "slib/media/audio_util.h"
 
+#include "slib/core/base.h"
+
+#if defined(SLIB_ARCH_IS_X64)
+#include <xmmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64)
+#include <arm_neon.h>
+#endif
+
+#define PRIV_AUDIO_RESAMPLER_MAX_PHASES 256
+#define PRIV_AUDIO_RESAMPLER_MAX_TAPS 512
+// samples per channel converted at once
+#define PRIV_AUDIO_CHUNK_SAMPLES 1024
+
 #define AUDIO_UTIL_DEF_CONVERT_SAMPLES(TYPE_IN, TYPE_OUT) \
 	void AudioUtil::convertSamples(sl_size count, const TYPE_IN* in, TYPE_OUT* out) \
 	{ \
@@ -63,4 +76,594 @@ namespace slib
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_uint16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, float)
 
+
+	// `n` should be multiple of 8
+	static float _priv_AudioUtil_dot(const float* a, const float* b, sl_uint32 n)
+	{
+#if defined(SLIB_ARCH_IS_X64)
+		__m128 s0 = _mm_setzero_ps();
+		__m128 s1 = _mm_setzero_ps();
+		for (sl_uint32 i = 0; i < n; i += 8) {
+			s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+		}
+		s0 = _mm_add_ps(s0, s1);
+		s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+		s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+		return _mm_cvtss_f32(s0);
+#elif defined(SLIB_ARCH_IS_ARM64)
+		float32x4_t s0 = vdupq_n_f32(0);
+		float32x4_t s1 = vdupq_n_f32(0);
+		for (sl_uint32 i = 0; i < n; i += 8) {
+			s0 = vfmaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+			s1 = vfmaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+		}
+		return vaddvq_f32(vaddq_f32(s0, s1));
+#else
+		float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		for (sl_uint32 i = 0; i < n; i += 4) {
+			s0 += a[i] * b[i];
+			s1 += a[i + 1] * b[i + 1];
+			s2 += a[i + 2] * b[i + 2];
+			s3 += a[i + 3] * b[i + 3];
+		}
+		return (s0 + s1) + (s2 + s3);
+#endif
+	}
+
+	// dst += src * gain
+	static void _priv_AudioUtil_addScaled(float* dst, const float* src, float gain, sl_size n)
+	{
+		sl_size i = 0;
+#if defined(SLIB_ARCH_IS_X64)
+		__m128 g = _mm_set1_ps(gain);
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+		}
+#elif defined(SLIB_ARCH_IS_ARM64)
+		for (; i + 4 <= n; i += 4) {
+			vst1q_f32(dst + i, vfmaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+		}
+#endif
+		for (; i < n; i++) {
+			dst[i] += src[i] * gain;
+		}
+	}
+
+	// dst = a - b
+	static void _priv_AudioUtil_subtract(float* dst, const float* a, const float* b, sl_size n)
+	{
+		sl_size i = 0;
+#if defined(SLIB_ARCH_IS_X64)
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dst + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		}
+#elif defined(SLIB_ARCH_IS_ARM64)
+		for (; i + 4 <= n; i += 4) {
+			vst1q_f32(dst + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+		}
+#endif
+		for (; i < n; i++) {
+			dst[i] = a[i] - b[i];
+		}
+	}
+
+	static float _priv_AudioUtil_getPeak(const float* a, sl_size n)
+	{
+		sl_size i = 0;
+		float peak = 0;
+#if defined(SLIB_ARCH_IS_X64)
+		__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		__m128 m = _mm_setzero_ps();
+		for (; i + 4 <= n; i += 4) {
+			m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(a + i), mask));
+		}
+		m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+		peak = _mm_cvtss_f32(m);
+#elif defined(SLIB_ARCH_IS_ARM64)
+		float32x4_t m = vdupq_n_f32(0);
+		for (; i + 4 <= n; i += 4) {
+			m = vmaxq_f32(m, vabsq_f32(vld1q_f32(a + i)));
+		}
+		peak = vmaxvq_f32(m);
+#endif
+		for (; i < n; i++) {
+			float v = Math::abs(a[i]);
+			if (v > peak) {
+				peak = v;
+			}
+		}
+		return peak;
+	}
+
+	// compresses the samples exceeding `threshold` into (threshold, 1) by tanh curve
+	static void _priv_AudioUtil_applyLimiter(float* a, sl_size n, float threshold)
+	{
+		float range = 1 - threshold;
+		for (sl_size i = 0; i < n; i++) {
+			float v = a[i];
+			float f = Math::abs(v);
+			if (f > threshold) {
+				float x = (f - threshold) / range;
+				float t = 1 - 2 / (Math::exp(2 * x) + 1);
+				f = threshold + range * t;
+				a[i] = v < 0 ? -f : f;
+			}
+		}
+	}
+
+	static void _priv_AudioUtil_setPlanarFloat(AudioData& audio, sl_uint32 nChannels, float* data0, float* data1, sl_size count)
+	{
+		audio.count = count;
+		if (nChannels == 2) {
+			audio.format = AudioFormat::Float_Stereo_NonInterleaved;
+			audio.data = data0;
+			audio.data1 = data1;
+		} else {
+			audio.format = AudioFormat::Float_Mono;
+			audio.data = data0;
+			audio.data1 = sl_null;
+		}
+	}
+
+	static void _priv_AudioUtil_getSubData(const AudioData& audio, sl_size offset, sl_size count, AudioData& _out)
+	{
+		_out.format = audio.format;
+		_out.count = count;
+		sl_size nBytesPerSample = AudioFormats::getBytesPerSample(audio.format);
+		if (AudioFormats::isNonInterleaved(audio.format)) {
+			sl_uint8* data1 = (sl_uint8*)(audio.data1);
+			if (!data1) {
+				data1 = (sl_uint8*)(audio.data) + audio.getSizeForChannel();
+			}
+			_out.data = (sl_uint8*)(audio.data) + offset * nBytesPerSample;
+			_out.data1 = data1 + offset * nBytesPerSample;
+		} else {
+			_out.data = (sl_uint8*)(audio.data) + offset * nBytesPerSample * AudioFormats::getChannelsCount(audio.format);
+			_out.data1 = sl_null;
+		}
+	}
+
+	// converts the samples (and channels) of `src` into the format of `dst`
+	static void _priv_AudioUtil_convertData(const AudioData& src, const AudioData& dst, sl_size count)
+	{
+		src.copySamplesFrom(dst, count);
+	}
+
+	static sl_uint32 _priv_AudioUtil_gcd(sl_uint32 a, sl_uint32 b)
+	{
+		while (b) {
+			sl_uint32 t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+
+	AudioResamplerParam::AudioResamplerParam()
+	{
+		channelsCount = 1;
+		inputSamplesPerSecond = 48000;
+		outputSamplesPerSecond = 48000;
+		quality = AudioResamplerQuality::Medium;
+	}
+
+	AudioResamplerParam::~AudioResamplerParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(AudioResampler, Object)
+
+	AudioResampler::AudioResampler()
+	{
+		m_nChannels = 1;
+		m_nInputSamplesPerSecond = 0;
+		m_nOutputSamplesPerSecond = 0;
+		m_up = 1;
+		m_down = 1;
+		m_nPhases = 1;
+		m_nTaps = 8;
+		m_nInput = 0;
+		m_posInput = 0;
+		m_posPhase = 0;
+	}
+
+	AudioResampler::~AudioResampler()
+	{
+	}
+
+	Ref<AudioResampler> AudioResampler::create(const AudioResamplerParam& param)
+	{
+		sl_uint32 nChannels = param.channelsCount;
+		if (nChannels != 1 && nChannels != 2) {
+			return sl_null;
+		}
+		if (!(param.inputSamplesPerSecond) || !(param.outputSamplesPerSecond)) {
+			return sl_null;
+		}
+		
+		sl_uint32 g = _priv_AudioUtil_gcd(param.inputSamplesPerSecond, param.outputSamplesPerSecond);
+		sl_uint32 up = param.outputSamplesPerSecond / g;
+		sl_uint32 down = param.inputSamplesPerSecond / g;
+		// phases of large ratios (e.g. 44100 => 47999) are quantized
+		sl_uint32 nPhases = up <= PRIV_AUDIO_RESAMPLER_MAX_PHASES ? up : PRIV_AUDIO_RESAMPLER_MAX_PHASES;
+		
+		sl_uint32 nTaps;
+		double passband;
+		switch (param.quality) {
+			case AudioResamplerQuality::Fast:
+				nTaps = 8;
+				passband = 0.8;
+				break;
+			case AudioResamplerQuality::High:
+				nTaps = 32;
+				passband = 0.95;
+				break;
+			default:
+				nTaps = 16;
+				passband = 0.9;
+				break;
+		}
+		// cutoff frequency relative to input sample rate
+		double cutoff = 0.5 * passband;
+		if (down > up) {
+			// the filter should be widened to remove aliases above the output Nyquist frequency
+			cutoff = cutoff * up / down;
+			nTaps = (sl_uint32)(Math::ceil((double)nTaps * down / up));
+		}
+		nTaps = (nTaps + 7) & ~((sl_uint32)7);
+		if (nTaps > PRIV_AUDIO_RESAMPLER_MAX_TAPS) {
+			nTaps = PRIV_AUDIO_RESAMPLER_MAX_TAPS;
+		}
+		
+		Array<float> coefficients = Array<float>::create(nPhases * nTaps);
+		if (coefficients.isNull()) {
+			return sl_null;
+		}
+		sl_size sizeBuffer = nTaps + 2 * PRIV_AUDIO_CHUNK_SAMPLES;
+		Array<float> bufInput[2];
+		Array<float> bufOutput[2];
+		for (sl_uint32 i = 0; i < nChannels; i++) {
+			bufInput[i] = Array<float>::create(sizeBuffer);
+			bufOutput[i] = Array<float>::create(PRIV_AUDIO_CHUNK_SAMPLES * 2 * up / down + 2);
+			if (bufInput[i].isNull() || bufOutput[i].isNull()) {
+				return sl_null;
+			}
+		}
+		
+		// windowed sinc, `y(n) = sum(h(k + phase - nTaps/2) * x(i - k))`
+		float* c = coefficients.getData();
+		double center = nTaps / 2;
+		for (sl_uint32 p = 0; p < nPhases; p++) {
+			double phase = (double)p / nPhases;
+			float* cp = c + p * nTaps;
+			double sum = 0;
+			for (sl_uint32 k = 0; k < nTaps; k++) {
+				double t = k + phase - center;
+				double x = 2 * cutoff * t;
+				double h = 2 * cutoff;
+				if (x < -1e-9 || x > 1e-9) {
+					h = Math::sin(SLIB_PI_LONG * x) / (SLIB_PI_LONG * t);
+				}
+				double w = (k + phase) / nTaps;
+				// Blackman window
+				h *= 0.42 - 0.5 * Math::cos(SLIB_PI_DUAL_LONG * w) + 0.08 * Math::cos(2 * SLIB_PI_DUAL_LONG * w);
+				// reversed order to be multiplied with the forward ordered input
+				cp[nTaps - 1 - k] = (float)h;
+				sum += h;
+			}
+			if (sum > 1e-9) {
+				for (sl_uint32 k = 0; k < nTaps; k++) {
+					cp[k] = (float)(cp[k] / sum);
+				}
+			}
+		}
+		
+		Ref<AudioResampler> ret = new AudioResampler;
+		if (ret.isNotNull()) {
+			ret->m_nChannels = nChannels;
+			ret->m_nInputSamplesPerSecond = param.inputSamplesPerSecond;
+			ret->m_nOutputSamplesPerSecond = param.outputSamplesPerSecond;
+			ret->m_up = up;
+			ret->m_down = down;
+			ret->m_nPhases = nPhases;
+			ret->m_nTaps = nTaps;
+			ret->m_coefficients = coefficients;
+			for (sl_uint32 i = 0; i < nChannels; i++) {
+				ret->m_bufInput[i] = bufInput[i];
+				ret->m_bufOutput[i] = bufOutput[i];
+			}
+			ret->reset();
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_uint32 AudioResampler::getChannelsCount()
+	{
+		return m_nChannels;
+	}
+
+	sl_uint32 AudioResampler::getInputSamplesPerSecond()
+	{
+		return m_nInputSamplesPerSecond;
+	}
+
+	sl_uint32 AudioResampler::getOutputSamplesPerSecond()
+	{
+		return m_nOutputSamplesPerSecond;
+	}
+
+	sl_size AudioResampler::getOutputSamplesCount(sl_size countInput)
+	{
+		ObjectLocker lock(this);
+		return _getPendingOutputsCount(countInput);
+	}
+
+	sl_size AudioResampler::_getPendingOutputsCount(sl_size countInput)
+	{
+		sl_uint64 end = m_nInput + countInput;
+		if (end <= m_posInput) {
+			return 0;
+		}
+		sl_uint64 distance = (end - m_posInput) * m_up - m_posPhase;
+		return (sl_size)((distance + m_down - 1) / m_down);
+	}
+
+	sl_size AudioResampler::resample(const AudioData& input, const AudioData& output)
+	{
+		ObjectLocker lock(this);
+		
+		sl_uint32 nChannels = m_nChannels;
+		sl_uint32 nTaps = m_nTaps;
+		sl_uint32 up = m_up;
+		sl_uint32 down = m_down;
+		sl_uint32 nPhases = m_nPhases;
+		float* coefficients = m_coefficients.getData();
+		float* bufInput[2] = { m_bufInput[0].getData(), m_bufInput[1].getData() };
+		float* bufOutput[2] = { m_bufOutput[0].getData(), m_bufOutput[1].getData() };
+		sl_size sizeInput = m_bufInput[0].getCount();
+		sl_size sizeOutput = m_bufOutput[0].getCount();
+		
+		sl_size nInputTotal = input.format == AudioFormat::None ? 0 : input.count;
+		sl_size nOutputTotal = output.format == AudioFormat::None ? 0 : output.count;
+		sl_size iInput = 0;
+		sl_size iOutput = 0;
+		
+		while (iInput < nInputTotal && iOutput < nOutputTotal) {
+			
+			sl_size n = nInputTotal - iInput;
+			if (n > PRIV_AUDIO_CHUNK_SAMPLES) {
+				n = PRIV_AUDIO_CHUNK_SAMPLES;
+			}
+			if (n > sizeInput - m_nInput) {
+				n = sizeInput - m_nInput;
+			}
+			AudioData src, dst;
+			_priv_AudioUtil_getSubData(input, iInput, n, src);
+			_priv_AudioUtil_setPlanarFloat(dst, nChannels, bufInput[0] + m_nInput, bufInput[1] + m_nInput, n);
+			_priv_AudioUtil_convertData(src, dst, n);
+			m_nInput += n;
+			iInput += n;
+			
+			sl_size nProduced = 0;
+			sl_size nLimit = nOutputTotal - iOutput;
+			if (nLimit > sizeOutput) {
+				nLimit = sizeOutput;
+			}
+			while (m_posInput < m_nInput && nProduced < nLimit) {
+				sl_uint32 phase = m_posPhase;
+				if (nPhases != up) {
+					phase = (sl_uint32)((sl_uint64)phase * nPhases / up);
+				}
+				const float* c = coefficients + phase * nTaps;
+				sl_size start = m_posInput + 1 - nTaps;
+				for (sl_uint32 k = 0; k < nChannels; k++) {
+					bufOutput[k][nProduced] = _priv_AudioUtil_dot(c, bufInput[k] + start, nTaps);
+				}
+				nProduced++;
+				m_posPhase += down;
+				if (m_posPhase >= up) {
+					m_posInput += m_posPhase / up;
+					m_posPhase %= up;
+				}
+			}
+			
+			if (nProduced) {
+				_priv_AudioUtil_setPlanarFloat(src, nChannels, bufOutput[0], bufOutput[1], nProduced);
+				_priv_AudioUtil_getSubData(output, iOutput, nProduced, dst);
+				_priv_AudioUtil_convertData(src, dst, nProduced);
+				iOutput += nProduced;
+			}
+			
+			// keeps the history for the next output
+			sl_size start = m_posInput + 1 - nTaps;
+			if (start > m_nInput) {
+				start = m_nInput;
+			}
+			if (start) {
+				for (sl_uint32 k = 0; k < nChannels; k++) {
+					Base::moveMemory(bufInput[k], bufInput[k] + start, (m_nInput - start) * sizeof(float));
+				}
+				m_nInput -= start;
+				m_posInput -= start;
+			}
+		}
+		return iOutput;
+	}
+
+	void AudioResampler::reset()
+	{
+		ObjectLocker lock(this);
+		// starts with silent history
+		for (sl_uint32 k = 0; k < m_nChannels; k++) {
+			Base::zeroMemory(m_bufInput[k].getData(), m_nTaps * sizeof(float));
+		}
+		m_nInput = m_nTaps - 1;
+		m_posInput = m_nTaps - 1;
+		m_posPhase = 0;
+	}
+
+
+	SLIB_DEFINE_OBJECT(AudioMixer, Object)
+
+	AudioMixer::AudioMixer()
+	{
+		m_nChannels = 1;
+		m_thresholdLimiter = 0.9f;
+		m_nInputs = 0;
+		m_nSamples = 0;
+	}
+
+	AudioMixer::~AudioMixer()
+	{
+	}
+
+	Ref<AudioMixer> AudioMixer::create(sl_uint32 nChannels)
+	{
+		if (nChannels != 1 && nChannels != 2) {
+			return sl_null;
+		}
+		Ref<AudioMixer> ret = new AudioMixer;
+		if (ret.isNotNull()) {
+			ret->m_nChannels = nChannels;
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_uint32 AudioMixer::getChannelsCount()
+	{
+		return m_nChannels;
+	}
+
+	float AudioMixer::getLimiterThreshold()
+	{
+		return m_thresholdLimiter;
+	}
+
+	void AudioMixer::setLimiterThreshold(float threshold)
+	{
+		m_thresholdLimiter = Math::clamp(threshold, 0.0f, 1.0f);
+	}
+
+	void AudioMixer::mix(const AudioData* inputs, const float* gains, sl_uint32 nInputs, sl_size count)
+	{
+		ObjectLocker lock(this);
+		
+		m_nInputs = 0;
+		m_nSamples = 0;
+		
+		sl_uint32 nChannels = m_nChannels;
+		sl_size sizeSum = nChannels * count;
+		sl_size sizeInputs = sizeSum * nInputs;
+		if (m_bufInputs.getCount() < sizeInputs) {
+			m_bufInputs = Array<float>::create(sizeInputs);
+			if (m_bufInputs.isNull()) {
+				return;
+			}
+		}
+		if (m_bufSum.getCount() < sizeSum) {
+			m_bufSum = Array<float>::create(sizeSum);
+			m_bufOutput = Array<float>::create(sizeSum);
+			if (m_bufSum.isNull() || m_bufOutput.isNull()) {
+				return;
+			}
+		}
+		
+		float* sum = m_bufSum.getData();
+		Base::zeroMemory(sum, sizeSum * sizeof(float));
+		
+		for (sl_uint32 i = 0; i < nInputs; i++) {
+			float* buf = m_bufInputs.getData() + i * sizeSum;
+			sl_size n = 0;
+			if (inputs[i].format != AudioFormat::None) {
+				n = Math::min(inputs[i].count, count);
+			}
+			if (n) {
+				AudioData dst;
+				_priv_AudioUtil_setPlanarFloat(dst, nChannels, buf, buf + count, n);
+				_priv_AudioUtil_convertData(inputs[i], dst, n);
+			}
+			float gain = gains ? gains[i] : 1.0f;
+			for (sl_uint32 k = 0; k < nChannels; k++) {
+				float* channel = buf + k * count;
+				if (n < count) {
+					Base::zeroMemory(channel + n, (count - n) * sizeof(float));
+				}
+				if (gain != 1.0f) {
+					for (sl_size j = 0; j < n; j++) {
+						channel[j] *= gain;
+					}
+				}
+				_priv_AudioUtil_addScaled(sum + k * count, channel, 1.0f, n);
+			}
+		}
+		
+		m_nInputs = nInputs;
+		m_nSamples = count;
+	}
+
+	sl_uint32 AudioMixer::getInputsCount()
+	{
+		return m_nInputs;
+	}
+
+	sl_size AudioMixer::getSamplesCount()
+	{
+		return m_nSamples;
+	}
+
+	sl_size AudioMixer::getOutput(const AudioData& output)
+	{
+		ObjectLocker lock(this);
+		return _writeOutput(-1, output);
+	}
+
+	sl_size AudioMixer::getOutputExcept(sl_uint32 indexInput, const AudioData& output)
+	{
+		ObjectLocker lock(this);
+		if (indexInput >= m_nInputs) {
+			return _writeOutput(-1, output);
+		}
+		return _writeOutput((sl_int32)indexInput, output);
+	}
+
+	sl_size AudioMixer::_writeOutput(sl_int32 indexExcept, const AudioData& output)
+	{
+		if (output.format == AudioFormat::None) {
+			return 0;
+		}
+		sl_size count = m_nSamples;
+		sl_size n = Math::min(count, output.count);
+		if (!n) {
+			return 0;
+		}
+		sl_uint32 nChannels = m_nChannels;
+		float* sum = m_bufSum.getData();
+		float* out = m_bufOutput.getData();
+		for (sl_uint32 k = 0; k < nChannels; k++) {
+			float* channel = out + k * count;
+			if (indexExcept >= 0) {
+				// mix-minus: removes the contribution of the excluded input
+				const float* self = m_bufInputs.getData() + (indexExcept * nChannels + k) * count;
+				_priv_AudioUtil_subtract(channel, sum + k * count, self, n);
+			} else {
+				Base::copyMemory(channel, sum + k * count, n * sizeof(float));
+			}
+			if (m_thresholdLimiter < 1.0f) {
+				if (_priv_AudioUtil_getPeak(channel, n) > m_thresholdLimiter) {
+					_priv_AudioUtil_applyLimiter(channel, n, m_thresholdLimiter);
+				}
+			}
+		}
+		AudioData src;
+		_priv_AudioUtil_setPlanarFloat(src, nChannels, out, out + count, n);
+		_priv_AudioUtil_convertData(src, output, n);
+		return n;
+	}
+
 }
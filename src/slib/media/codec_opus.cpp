@@ -162,6 +162,16 @@ namespace slib
 		}
 		
 		Memory encode(const AudioData& input) override
+		{
+			sl_uint8 output[4000]; // opus recommends 4000 bytes for output buffer
+			sl_uint32 size = encode(input, output, sizeof(output));
+			if (size) {
+				return Memory::create(output, size);
+			}
+			return sl_null;
+		}
+		
+		sl_uint32 encode(const AudioData& input, void* output, sl_uint32 sizeOutput) override
 		{
 			sl_uint32 lenMinFrame = m_nSamplesPerSecond / 400; // 2.5 ms
 			if (input.count % lenMinFrame == 0) {
@@ -208,7 +218,7 @@ namespace slib
 					sl_uint32 _samples[5760];
 					if (!(audio.data)) {
 						audio.data = _samples;
-						audio.copySamplesFrom(input);
+						input.copySamplesFrom(audio);
 					}
 					
 					ObjectLocker lock(this);
@@ -224,19 +234,18 @@ namespace slib
 					}
 #endif
 
-					sl_uint8 output[4000]; // opus recommends 4000 bytes for output buffer
 					int ret;
 					if (flagFloat) {
-						ret = ::opus_encode_float(m_encoder, (float*)(audio.data), (int)(audio.count), (unsigned char*)output, sizeof(output));
+						ret = ::opus_encode_float(m_encoder, (float*)(audio.data), (int)(audio.count), (unsigned char*)output, (opus_int32)sizeOutput);
 					} else {
-						ret = ::opus_encode(m_encoder, (opus_int16*)(audio.data), (int)(audio.count), (unsigned char*)output, sizeof(output));
+						ret = ::opus_encode(m_encoder, (opus_int16*)(audio.data), (int)(audio.count), (unsigned char*)output, (opus_int32)sizeOutput);
 					}
 					if (ret > 0) {
-						return Memory::create(output, ret);
+						return (sl_uint32)ret;
 					}
 				}
 			}
-			return sl_null;
+			return 0;
 		}
 
 		void setBitrate(sl_uint32 _bitrate) override
@@ -25,12 +25,15 @@
 #include "slib/core/log.h"
 #include "slib/core/io.h"
 #include "slib/core/scoped.h"
+#include "slib/core/mio.h"
 
 #include "vpx/vp8cx.h"
 #include "vpx/vp8dx.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vpx_decoder.h"
 
+#define PRIV_VPX_MAX_PACKETS_PER_FRAME 16
+
 namespace slib
 {
 
@@ -184,8 +187,10 @@ namespace slib
 			return sl_null;
 		}
 
-		Memory encode(const VideoFrame& input) override
+		// returns the total size of the packets (each packet is prefixed by 64-bit pts and size)
+		sl_uint32 _encode(const VideoFrame& input, const vpx_codec_cx_pkt_t** packets, sl_uint32& nPackets)
 		{
+			nPackets = 0;
 			if (m_nWidth == input.image.width && m_nHeight == input.image.height) {
 				
 				BitmapData dst;
@@ -209,27 +214,65 @@ namespace slib
 				if (res == VPX_CODEC_OK) {
 					vpx_codec_iter_t iter = sl_null;
 					const vpx_codec_cx_pkt_t *pkt = sl_null;
-					MemoryWriter encodeWriter;
-
+					sl_uint32 size = 0;
+					// packet buffers are owned by the codec, and valid until the next call of `vpx_codec_encode`
 					while ((pkt = vpx_codec_get_cx_data(m_codec, &iter)) != sl_null) {
-						if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+						if (pkt->kind == VPX_CODEC_CX_FRAME_PKT && nPackets < PRIV_VPX_MAX_PACKETS_PER_FRAME) {
 							//const int keyframe = (pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
-							encodeWriter.writeInt64(pkt->data.frame.pts);
-							encodeWriter.writeInt64(pkt->data.frame.sz);
-							encodeWriter.write(pkt->data.frame.buf, pkt->data.frame.sz);
+							packets[nPackets++] = pkt;
+							size += 16 + (sl_uint32)(pkt->data.frame.sz);
 						}
 					}
-
-					return encodeWriter.getData();
-					
+					return size;
 				} else {
 					logError("Failed to encode bitmap data.");
 				}
 			} else {
 				logError("VideoFrame size is wrong.");
 			}
+			return 0;
+		}
+		
+		static void _writePackets(sl_uint8* output, const vpx_codec_cx_pkt_t** packets, sl_uint32 nPackets)
+		{
+			for (sl_uint32 i = 0; i < nPackets; i++) {
+				const vpx_codec_cx_pkt_t* pkt = packets[i];
+				MIO::writeInt64LE(output, pkt->data.frame.pts);
+				MIO::writeInt64LE(output + 8, (sl_int64)(pkt->data.frame.sz));
+				Base::copyMemory(output + 16, pkt->data.frame.buf, pkt->data.frame.sz);
+				output += 16 + pkt->data.frame.sz;
+			}
+		}
+
+		Memory encode(const VideoFrame& input) override
+		{
+			const vpx_codec_cx_pkt_t* packets[PRIV_VPX_MAX_PACKETS_PER_FRAME];
+			sl_uint32 nPackets;
+			sl_uint32 size = _encode(input, packets, nPackets);
+			if (size) {
+				Memory mem = Memory::create(size);
+				if (mem.isNotNull()) {
+					_writePackets((sl_uint8*)(mem.getData()), packets, nPackets);
+					return mem;
+				}
+			}
 			return sl_null;
 		}
+		
+		sl_uint32 encode(const VideoFrame& input, void* output, sl_uint32 sizeOutput) override
+		{
+			const vpx_codec_cx_pkt_t* packets[PRIV_VPX_MAX_PACKETS_PER_FRAME];
+			sl_uint32 nPackets;
+			sl_uint32 size = _encode(input, packets, nPackets);
+			if (size) {
+				if (size <= sizeOutput) {
+					_writePackets((sl_uint8*)output, packets, nPackets);
+					return size;
+				}
+				logError("Output buffer is too small.");
+			}
+			return 0;
+		}
 
 		void setBitrate(sl_uint32 _bitrate) override
 		{
@@ -330,13 +373,16 @@ namespace slib
 			}
 		}
 
-		sl_bool decode(const void* input, const sl_uint32& inputSize , VideoFrame& output)
+		sl_bool decode(const void* input, const sl_uint32& inputSize, VideoFrame& output) override
 		{
-			MemoryReader reader(input, inputSize);
-			sl_int64 pts = reader.readInt64();
-			SLIB_UNUSED(pts);
-			sl_int64 size = reader.readInt64();
-
+			if (inputSize < 16) {
+				return sl_false;
+			}
+			sl_int64 size = MIO::readInt64LE((sl_uint8*)input + 8);
+			if (size <= 0 || size > (sl_int64)(inputSize - 16)) {
+				return sl_false;
+			}
+			sl_bool flagDecoded = sl_false;
 			if (!vpx_codec_decode(m_codec, (sl_uint8*)input + 16, (unsigned int)size, NULL, 0)) {
 				
 				vpx_codec_iter_t iter = NULL;
@@ -346,8 +392,8 @@ namespace slib
 				while ((image = vpx_codec_get_frame(m_codec, &iter)) != NULL) {
 					
 					BitmapData src;
-					src.width = image->w;
-					src.height = image->h;
+					src.width = image->d_w;
+					src.height = image->d_h;
 					src.format = BitmapFormat::YUV_I420;
 					src.data = image->planes[0];
 					src.pitch = image->stride[0];
@@ -356,10 +402,16 @@ namespace slib
 					src.data2 = image->planes[2];
 					src.pitch2 = image->stride[2];
 					
-					output.image.copyPixelsFrom(src);				
+					if (output.image.data) {
+						output.image.copyPixelsFrom(src);
+					} else {
+						// refers to the frame buffer of the decoder
+						output.image = src;
+					}
+					flagDecoded = sl_true;
 				}
 			}
-			return sl_false;
+			return flagDecoded;
 		}
 	};
 
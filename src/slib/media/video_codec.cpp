@@ -22,6 +22,19 @@
 
 #include "slib/media/video_codec.h"
 
+#include "slib/core/thread.h"
+#include "slib/core/system.h"
+#include "slib/core/queue.h"
+#include "slib/core/sort.h"
+
+// relative costs of streams, used to balance the workers
+#define PRIV_MEDIA_CODEC_WEIGHT_VIDEO 16
+#define PRIV_MEDIA_CODEC_WEIGHT_AUDIO 1
+// longest Opus frame
+#define PRIV_MEDIA_CODEC_MAX_AUDIO_FRAME_MS 120
+// maximum size of an encoded audio packet, and the room for the packet headers of video encoders
+#define PRIV_MEDIA_CODEC_PACKET_RESERVED_SIZE 4000
+
 namespace slib
 {
 
@@ -39,6 +52,29 @@ namespace slib
 	{
 	}
 
+	sl_uint32 VideoEncoder::encode(const VideoFrame& input, void* output, sl_uint32 sizeOutput)
+	{
+		Memory mem = encode(input);
+		sl_size size = mem.getSize();
+		if (size && size <= sizeOutput) {
+			Base::copyMemory(output, mem.getData(), size);
+			return (sl_uint32)size;
+		}
+		return 0;
+	}
+
+	Memory VideoEncoder::encode(const VideoFrame& input, MemoryPool* pool)
+	{
+		Memory mem = pool->allocate();
+		if (mem.isNotNull()) {
+			sl_uint32 size = encode(input, mem.getData(), (sl_uint32)(mem.getSize()));
+			if (size) {
+				return mem.sub(0, size);
+			}
+		}
+		return sl_null;
+	}
+
 	sl_uint32 VideoEncoder::getBitrate()
 	{
 		return m_bitrate;
@@ -62,5 +98,711 @@ namespace slib
 	{
 	}
 
+
+	MediaCodecSchedulerParam::MediaCodecSchedulerParam()
+	{
+		workersCount = 0;
+		flagPinWorkers = sl_true;
+		tickInterval = 0;
+		maxQueuedFramesCount = 8;
+	}
+
+	MediaCodecSchedulerParam::~MediaCodecSchedulerParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(MediaCodecStream, Object)
+
+	MediaCodecStream::MediaCodecStream()
+	{
+		m_indexWorker = 0;
+		m_priority = 0;
+		m_dropPolicy = MediaCodecDropPolicy::DropLate;
+		
+		m_nProcessedFrames = 0;
+		m_nDroppedFrames = 0;
+		m_latencyLast = 0;
+		m_latencyAverage = 0;
+		m_latencyMax = 0;
+	}
+
+	MediaCodecStream::~MediaCodecStream()
+	{
+	}
+
+	sl_uint32 MediaCodecStream::getWorkerIndex()
+	{
+		return m_indexWorker;
+	}
+
+	sl_int32 MediaCodecStream::getPriority()
+	{
+		return m_priority;
+	}
+
+	void MediaCodecStream::setPriority(sl_int32 priority)
+	{
+		m_priority = priority;
+	}
+
+	MediaCodecDropPolicy MediaCodecStream::getDropPolicy()
+	{
+		return m_dropPolicy;
+	}
+
+	void MediaCodecStream::setDropPolicy(MediaCodecDropPolicy policy)
+	{
+		m_dropPolicy = policy;
+	}
+
+	sl_uint64 MediaCodecStream::getProcessedFramesCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nProcessedFrames, 0));
+	}
+
+	sl_uint64 MediaCodecStream::getDroppedFramesCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nDroppedFrames, 0));
+	}
+
+	sl_uint32 MediaCodecStream::getLastLatency()
+	{
+		return m_latencyLast;
+	}
+
+	sl_uint32 MediaCodecStream::getAverageLatency()
+	{
+		return m_latencyAverage;
+	}
+
+	sl_uint32 MediaCodecStream::getMaxLatency()
+	{
+		return m_latencyMax;
+	}
+
+	void MediaCodecStream::resetMetrics()
+	{
+		m_nProcessedFrames = 0;
+		m_nDroppedFrames = 0;
+		m_latencyLast = 0;
+		m_latencyAverage = 0;
+		m_latencyMax = 0;
+	}
+
+
+	class _priv_MediaCodecFrame
+	{
+	public:
+		VideoFrame video;
+		AudioData audio;
+		Memory packet;
+		sl_uint32 tickPush;
+		sl_uint32 tickDeadline;
+		sl_bool flagDeadline;
+	};
+
+	enum class _priv_MediaCodecStreamType
+	{
+		VideoEncoder,
+		VideoDecoder,
+		AudioEncoder,
+		AudioDecoder
+	};
+
+	class _priv_MediaCodecWorker;
+
+	class _priv_MediaCodecStream : public MediaCodecStream
+	{
+	public:
+		_priv_MediaCodecStreamType m_type;
+		sl_uint32 m_weight;
+		sl_uint32 m_maxQueuedFrames;
+		sl_bool m_flagClosed;
+		WeakRef<_priv_MediaCodecWorker> m_worker;
+		
+		Ref<VideoEncoder> m_videoEncoder;
+		Ref<VideoDecoder> m_videoDecoder;
+		Ref<AudioEncoder> m_audioEncoder;
+		Ref<AudioDecoder> m_audioDecoder;
+		Function<void(MediaCodecStream*, Memory&)> m_onEncode;
+		Function<void(MediaCodecStream*, VideoFrame&)> m_onDecodeVideo;
+		Function<void(MediaCodecStream*, AudioData&)> m_onDecodeAudio;
+		
+		// reused output of audio decoder
+		AudioData m_audioDecoded;
+		
+		// recycled buffers of the queued frames and the encoded packets
+		Ref<MemoryPool> m_poolFrames;
+		Ref<MemoryPool> m_poolPackets;
+		
+		LinkedQueue<_priv_MediaCodecFrame> m_queue;
+		
+	public:
+		_priv_MediaCodecStream()
+		{
+			m_type = _priv_MediaCodecStreamType::VideoEncoder;
+			m_weight = 1;
+			m_maxQueuedFrames = 0;
+			m_flagClosed = sl_false;
+		}
+		
+	public:
+		sl_bool pushVideoFrame(const VideoFrame& frame, sl_uint32 deadline) override
+		{
+			if (m_type != _priv_MediaCodecStreamType::VideoEncoder) {
+				return sl_false;
+			}
+			_priv_MediaCodecFrame item;
+			BitmapData& bd = item.video.image;
+			bd.width = frame.image.width;
+			bd.height = frame.image.height;
+			bd.format = frame.image.format;
+			Memory mem = _allocateFrame(bd.getTotalSize());
+			if (mem.isNull()) {
+				return sl_false;
+			}
+			bd.data = mem.getData();
+			bd.ref = mem.ref;
+			bd.fillDefaultValues();
+			bd.copyPixelsFrom(frame.image);
+			item.video.rotation = frame.rotation;
+			item.video.flip = frame.flip;
+			return _push(item, deadline);
+		}
+		
+		sl_bool pushAudioFrame(const AudioData& data, sl_uint32 deadline) override
+		{
+			if (m_type != _priv_MediaCodecStreamType::AudioEncoder) {
+				return sl_false;
+			}
+			_priv_MediaCodecFrame item;
+			AudioData& audio = item.audio;
+			audio.format = data.format;
+			audio.count = data.count;
+			Memory mem = _allocateFrame(audio.getTotalSize());
+			if (mem.isNull()) {
+				return sl_false;
+			}
+			audio.data = mem.getData();
+			audio.ref = mem.ref;
+			// copies the samples of `data` into `audio`
+			data.copySamplesFrom(audio);
+			return _push(item, deadline);
+		}
+		
+		sl_bool pushPacket(const void* data, sl_uint32 size, sl_uint32 deadline) override
+		{
+			if (m_type != _priv_MediaCodecStreamType::VideoDecoder && m_type != _priv_MediaCodecStreamType::AudioDecoder) {
+				return sl_false;
+			}
+			_priv_MediaCodecFrame item;
+			item.packet = Memory::create(data, size);
+			if (item.packet.isNull()) {
+				return sl_false;
+			}
+			return _push(item, deadline);
+		}
+		
+		void close() override
+		{
+			ObjectLocker lock(&m_queue);
+			m_flagClosed = sl_true;
+			m_queue.removeAll_NoLock();
+		}
+		
+		sl_bool _push(_priv_MediaCodecFrame& item, sl_uint32 deadline);
+		
+		Memory _allocateFrame(sl_size size)
+		{
+			ObjectLocker lock(this);
+			// the pool is recreated when the frame size is changed
+			if (m_poolFrames.isNull() || m_poolFrames->getBlockSize() != size) {
+				// queued frames + the frame being processed
+				m_poolFrames = MemoryPool::create(size, m_maxQueuedFrames + 2);
+				if (m_poolFrames.isNull()) {
+					return sl_null;
+				}
+				if (m_type == _priv_MediaCodecStreamType::VideoEncoder) {
+					// encoded packets are not larger than the raw frame
+					m_poolPackets = MemoryPool::create(size + PRIV_MEDIA_CODEC_PACKET_RESERVED_SIZE, 4);
+				}
+			}
+			return m_poolFrames->allocate(size);
+		}
+		
+		void _setWorker(sl_uint32 index, _priv_MediaCodecWorker* worker)
+		{
+			m_indexWorker = index;
+			m_worker = worker;
+		}
+		
+		// returns the deadline of the front frame
+		sl_bool _getFront(sl_uint32& tickDeadline, sl_bool& flagDeadline)
+		{
+			ObjectLocker lock(&m_queue);
+			Link<_priv_MediaCodecFrame>* link = m_queue.getFront();
+			if (link) {
+				tickDeadline = link->value.tickDeadline;
+				flagDeadline = link->value.flagDeadline;
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+		void _process(_priv_MediaCodecFrame& item)
+		{
+			if (m_dropPolicy == MediaCodecDropPolicy::DropLate && item.flagDeadline) {
+				if ((sl_int32)(System::getTickCount() - item.tickDeadline) > 0) {
+					Base::interlockedIncrement64(&m_nDroppedFrames);
+					return;
+				}
+			}
+			switch (m_type) {
+				case _priv_MediaCodecStreamType::VideoEncoder:
+					{
+						Memory packet;
+						Ref<MemoryPool> pool;
+						{
+							ObjectLocker lock(this);
+							pool = m_poolPackets;
+						}
+						if (pool.isNotNull()) {
+							packet = m_videoEncoder->encode(item.video, pool.get());
+						} else {
+							packet = m_videoEncoder->encode(item.video);
+						}
+						_complete(item);
+						if (packet.isNotNull()) {
+							m_onEncode(this, packet);
+						}
+					}
+					break;
+				case _priv_MediaCodecStreamType::AudioEncoder:
+					{
+						Memory packet = m_audioEncoder->encode(item.audio, m_poolPackets.get());
+						_complete(item);
+						if (packet.isNotNull()) {
+							m_onEncode(this, packet);
+						}
+					}
+					break;
+				case _priv_MediaCodecStreamType::VideoDecoder:
+					{
+						VideoFrame frame;
+						sl_bool flagDecoded = m_videoDecoder->decode(item.packet.getData(), (sl_uint32)(item.packet.getSize()), frame);
+						_complete(item);
+						if (flagDecoded) {
+							m_onDecodeVideo(this, frame);
+						}
+					}
+					break;
+				case _priv_MediaCodecStreamType::AudioDecoder:
+					{
+						AudioData audio = m_audioDecoded;
+						audio.count = m_audioDecoder->decode(item.packet.getData(), (sl_uint32)(item.packet.getSize()), audio);
+						_complete(item);
+						if (audio.count) {
+							m_onDecodeAudio(this, audio);
+						}
+					}
+					break;
+			}
+		}
+		
+		void _complete(_priv_MediaCodecFrame& item)
+		{
+			sl_uint32 latency = System::getTickCount() - item.tickPush;
+			m_latencyLast = latency;
+			if (m_nProcessedFrames) {
+				m_latencyAverage = (sl_uint32)(((sl_uint64)m_latencyAverage * 7 + latency) >> 3);
+			} else {
+				m_latencyAverage = latency;
+			}
+			if (latency > m_latencyMax) {
+				m_latencyMax = latency;
+			}
+			Base::interlockedIncrement64(&m_nProcessedFrames);
+		}
+		
+	};
+
+	class _priv_MediaCodecWorker : public Referable
+	{
+	public:
+		sl_uint32 m_index;
+		sl_int32 m_cpu;
+		sl_uint32 m_tickInterval;
+		Ref<Thread> m_thread;
+		
+		Mutex m_lock;
+		List< Ref<_priv_MediaCodecStream> > m_streams;
+		sl_uint32 m_load;
+		
+	public:
+		_priv_MediaCodecWorker()
+		{
+			m_index = 0;
+			m_cpu = -1;
+			m_tickInterval = 0;
+			m_load = 0;
+		}
+		
+	public:
+		void notify()
+		{
+			if (!m_tickInterval) {
+				Ref<Thread> thread = m_thread;
+				if (thread.isNotNull()) {
+					thread->wakeSelfEvent();
+				}
+			}
+		}
+		
+		void run()
+		{
+			if (m_cpu >= 0) {
+				System::setCurrentThreadAffinity((sl_uint32)m_cpu);
+			}
+			Ref<Thread> thread = Thread::getCurrent();
+			if (thread.isNull()) {
+				return;
+			}
+			while (thread->isNotStopping()) {
+				sl_bool flagProcessed = processBatch();
+				if (m_tickInterval) {
+					thread->wait(m_tickInterval);
+				} else if (!flagProcessed) {
+					thread->wait();
+				}
+			}
+		}
+		
+		struct PendingStream
+		{
+			_priv_MediaCodecStream* stream;
+			sl_int32 priority;
+			sl_uint32 tickDeadline;
+			sl_bool flagDeadline;
+			sl_size nFrames;
+		};
+		
+		class PendingStreamCompare
+		{
+		public:
+			sl_uint32 now;
+			
+		public:
+			sl_int32 operator()(const PendingStream& a, const PendingStream& b) const
+			{
+				if (a.priority != b.priority) {
+					return a.priority > b.priority ? -1 : 1;
+				}
+				if (a.flagDeadline != b.flagDeadline) {
+					return a.flagDeadline ? -1 : 1;
+				}
+				if (a.flagDeadline) {
+					sl_int32 da = (sl_int32)(a.tickDeadline - now);
+					sl_int32 db = (sl_int32)(b.tickDeadline - now);
+					if (da != db) {
+						return da < db ? -1 : 1;
+					}
+				}
+				return 0;
+			}
+		};
+		
+		// processes the frames queued until now, in the order of priority and deadline
+		sl_bool processBatch()
+		{
+			List< Ref<_priv_MediaCodecStream> > streams;
+			{
+				MutexLocker lock(&m_lock);
+				streams = m_streams.duplicate_NoLock();
+			}
+			ListElements< Ref<_priv_MediaCodecStream> > elements(streams);
+			if (!(elements.count)) {
+				return sl_false;
+			}
+			List<PendingStream> listPending;
+			for (sl_size i = 0; i < elements.count; i++) {
+				_priv_MediaCodecStream* stream = elements[i].get();
+				PendingStream ps;
+				if (stream->_getFront(ps.tickDeadline, ps.flagDeadline)) {
+					ps.stream = stream;
+					ps.priority = stream->getPriority();
+					ps.nFrames = stream->m_queue.getCount();
+					listPending.add_NoLock(ps);
+				}
+			}
+			ListElements<PendingStream> pending(listPending);
+			if (!(pending.count)) {
+				return sl_false;
+			}
+			PendingStreamCompare compare;
+			compare.now = System::getTickCount();
+			QuickSort::sortAsc(pending.data, pending.count, compare);
+			for (sl_size i = 0; i < pending.count; i++) {
+				PendingStream& ps = pending[i];
+				for (sl_size k = 0; k < ps.nFrames; k++) {
+					_priv_MediaCodecFrame item;
+					if (!(ps.stream->m_queue.pop(&item))) {
+						break;
+					}
+					ps.stream->_process(item);
+				}
+			}
+			return sl_true;
+		}
+		
+	};
+
+	sl_bool _priv_MediaCodecStream::_push(_priv_MediaCodecFrame& item, sl_uint32 deadline)
+	{
+		item.tickPush = System::getTickCount();
+		item.flagDeadline = deadline != 0;
+		item.tickDeadline = item.tickPush + deadline;
+		{
+			ObjectLocker lock(&m_queue);
+			if (m_flagClosed) {
+				return sl_false;
+			}
+			if (m_maxQueuedFrames && m_dropPolicy != MediaCodecDropPolicy::Never) {
+				// overloaded
+				while (m_queue.getCount() >= m_maxQueuedFrames) {
+					m_queue.popFront_NoLock();
+					Base::interlockedIncrement64(&m_nDroppedFrames);
+				}
+			}
+			m_queue.pushBack_NoLock(item);
+		}
+		Ref<_priv_MediaCodecWorker> worker(m_worker);
+		if (worker.isNotNull()) {
+			worker->notify();
+		}
+		return sl_true;
+	}
+
+
+	SLIB_DEFINE_OBJECT(MediaCodecScheduler, Object)
+
+	MediaCodecScheduler::MediaCodecScheduler()
+	{
+	}
+
+	MediaCodecScheduler::~MediaCodecScheduler()
+	{
+		release();
+	}
+
+	Ref<MediaCodecScheduler> MediaCodecScheduler::create(const MediaCodecSchedulerParam& param)
+	{
+		Ref<MediaCodecScheduler> ret = new MediaCodecScheduler;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->m_param = param;
+		sl_uint32 nCores = System::getCpuCoresCount();
+		sl_uint32 nWorkers = param.workersCount;
+		if (!nWorkers) {
+			nWorkers = nCores;
+		}
+		for (sl_uint32 i = 0; i < nWorkers; i++) {
+			Ref<_priv_MediaCodecWorker> worker = new _priv_MediaCodecWorker;
+			if (worker.isNull()) {
+				return sl_null;
+			}
+			worker->m_index = i;
+			worker->m_tickInterval = param.tickInterval;
+			if (param.flagPinWorkers) {
+				worker->m_cpu = (sl_int32)(i % nCores);
+			}
+			_priv_MediaCodecWorker* w = worker.get();
+			worker->m_thread = Thread::start([w]() {
+				w->run();
+			});
+			if (worker->m_thread.isNull()) {
+				return sl_null;
+			}
+			ret->m_workers.add_NoLock(Ref<Referable>::from(worker));
+		}
+		return ret;
+	}
+
+	sl_uint32 MediaCodecScheduler::_selectWorker(sl_uint32 weight)
+	{
+		ObjectLocker lock(this);
+		ListElements< Ref<Referable> > workers(m_workers);
+		sl_uint32 index = 0;
+		sl_uint32 minLoad = 0;
+		for (sl_size i = 0; i < workers.count; i++) {
+			_priv_MediaCodecWorker* worker = (_priv_MediaCodecWorker*)(workers[i].get());
+			if (!i || worker->m_load < minLoad) {
+				index = (sl_uint32)i;
+				minLoad = worker->m_load;
+			}
+		}
+		if (workers.count) {
+			((_priv_MediaCodecWorker*)(workers[index].get()))->m_load += weight;
+		}
+		return index;
+	}
+
+	static Ref<MediaCodecStream> _priv_MediaCodecScheduler_addStream(const CList< Ref<Referable> >& workers, sl_uint32 indexWorker, const Ref<_priv_MediaCodecStream>& stream)
+	{
+		Ref<Referable> ref;
+		if (!(workers.getAt(indexWorker, &ref))) {
+			return sl_null;
+		}
+		_priv_MediaCodecWorker* worker = (_priv_MediaCodecWorker*)(ref.get());
+		stream->_setWorker(indexWorker, worker);
+		MutexLocker lock(&(worker->m_lock));
+		worker->m_streams.add_NoLock(stream);
+		return stream;
+	}
+
+	Ref<MediaCodecStream> MediaCodecScheduler::addVideoEncoder(const Ref<VideoEncoder>& encoder, const Function<void(MediaCodecStream*, Memory&)>& onEncode, sl_int32 priority)
+	{
+		if (encoder.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_MediaCodecStream> stream = new _priv_MediaCodecStream;
+		if (stream.isNull()) {
+			return sl_null;
+		}
+		stream->m_type = _priv_MediaCodecStreamType::VideoEncoder;
+		stream->m_videoEncoder = encoder;
+		stream->m_onEncode = onEncode;
+		stream->setPriority(priority);
+		stream->m_maxQueuedFrames = m_param.maxQueuedFramesCount;
+		stream->m_weight = PRIV_MEDIA_CODEC_WEIGHT_VIDEO;
+		return _priv_MediaCodecScheduler_addStream(m_workers, _selectWorker(stream->m_weight), stream);
+	}
+
+	Ref<MediaCodecStream> MediaCodecScheduler::addVideoDecoder(const Ref<VideoDecoder>& decoder, const Function<void(MediaCodecStream*, VideoFrame&)>& onDecode, sl_int32 priority)
+	{
+		if (decoder.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_MediaCodecStream> stream = new _priv_MediaCodecStream;
+		if (stream.isNull()) {
+			return sl_null;
+		}
+		stream->m_type = _priv_MediaCodecStreamType::VideoDecoder;
+		stream->m_videoDecoder = decoder;
+		stream->m_onDecodeVideo = onDecode;
+		stream->setPriority(priority);
+		stream->m_maxQueuedFrames = m_param.maxQueuedFramesCount;
+		stream->m_weight = PRIV_MEDIA_CODEC_WEIGHT_VIDEO;
+		return _priv_MediaCodecScheduler_addStream(m_workers, _selectWorker(stream->m_weight), stream);
+	}
+
+	Ref<MediaCodecStream> MediaCodecScheduler::addAudioEncoder(const Ref<AudioEncoder>& encoder, const Function<void(MediaCodecStream*, Memory&)>& onEncode, sl_int32 priority)
+	{
+		if (encoder.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_MediaCodecStream> stream = new _priv_MediaCodecStream;
+		if (stream.isNull()) {
+			return sl_null;
+		}
+		stream->m_poolPackets = MemoryPool::create(PRIV_MEDIA_CODEC_PACKET_RESERVED_SIZE, 4);
+		if (stream->m_poolPackets.isNull()) {
+			return sl_null;
+		}
+		stream->m_type = _priv_MediaCodecStreamType::AudioEncoder;
+		stream->m_audioEncoder = encoder;
+		stream->m_onEncode = onEncode;
+		stream->setPriority(priority);
+		stream->m_maxQueuedFrames = m_param.maxQueuedFramesCount;
+		stream->m_weight = PRIV_MEDIA_CODEC_WEIGHT_AUDIO;
+		return _priv_MediaCodecScheduler_addStream(m_workers, _selectWorker(stream->m_weight), stream);
+	}
+
+	Ref<MediaCodecStream> MediaCodecScheduler::addAudioDecoder(const Ref<AudioDecoder>& decoder, const Function<void(MediaCodecStream*, AudioData&)>& onDecode, sl_int32 priority)
+	{
+		if (decoder.isNull()) {
+			return sl_null;
+		}
+		Ref<_priv_MediaCodecStream> stream = new _priv_MediaCodecStream;
+		if (stream.isNull()) {
+			return sl_null;
+		}
+		sl_uint32 nChannels = decoder->getChannelsCount();
+		sl_uint32 nSamples = decoder->getSamplesCountPerSecond() * PRIV_MEDIA_CODEC_MAX_AUDIO_FRAME_MS / 1000;
+		AudioData& audio = stream->m_audioDecoded;
+		audio.format = nChannels == 2 ? AudioFormat::Int16_Stereo : AudioFormat::Int16_Mono;
+		audio.count = nSamples;
+		Memory mem = Memory::create(audio.getTotalSize());
+		if (mem.isNull()) {
+			return sl_null;
+		}
+		audio.data = mem.getData();
+		audio.ref = mem.ref;
+		stream->m_type = _priv_MediaCodecStreamType::AudioDecoder;
+		stream->m_audioDecoder = decoder;
+		stream->m_onDecodeAudio = onDecode;
+		stream->setPriority(priority);
+		stream->m_maxQueuedFrames = m_param.maxQueuedFramesCount;
+		stream->m_weight = PRIV_MEDIA_CODEC_WEIGHT_AUDIO;
+		return _priv_MediaCodecScheduler_addStream(m_workers, _selectWorker(stream->m_weight), stream);
+	}
+
+	void MediaCodecScheduler::removeStream(MediaCodecStream* _stream)
+	{
+		if (!_stream) {
+			return;
+		}
+		_priv_MediaCodecStream* stream = (_priv_MediaCodecStream*)_stream;
+		stream->close();
+		Ref<_priv_MediaCodecWorker> worker(stream->m_worker);
+		if (worker.isNull()) {
+			return;
+		}
+		{
+			MutexLocker lock(&(worker->m_lock));
+			if (!(worker->m_streams.remove_NoLock(stream))) {
+				return;
+			}
+		}
+		ObjectLocker lock(this);
+		worker->m_load -= stream->m_weight;
+	}
+
+	sl_uint32 MediaCodecScheduler::getWorkersCount()
+	{
+		return (sl_uint32)(m_workers.getCount());
+	}
+
+	sl_uint32 MediaCodecScheduler::getStreamsCount()
+	{
+		sl_uint32 n = 0;
+		ListElements< Ref<Referable> > workers(m_workers);
+		for (sl_size i = 0; i < workers.count; i++) {
+			_priv_MediaCodecWorker* worker = (_priv_MediaCodecWorker*)(workers[i].get());
+			MutexLocker lock(&(worker->m_lock));
+			n += (sl_uint32)(worker->m_streams.getCount());
+		}
+		return n;
+	}
+
+	void MediaCodecScheduler::release()
+	{
+		ObjectLocker lock(this);
+		ListElements< Ref<Referable> > workers(m_workers);
+		for (sl_size i = 0; i < workers.count; i++) {
+			_priv_MediaCodecWorker* worker = (_priv_MediaCodecWorker*)(workers[i].get());
+			if (worker->m_thread.isNotNull()) {
+				worker->m_thread->finish();
+				worker->m_thread->wakeSelfEvent();
+				worker->m_thread->finishAndWait();
+				worker->m_thread.setNull();
+			}
+			MutexLocker lockWorker(&(worker->m_lock));
+			worker->m_streams.removeAll_NoLock();
+		}
+		m_workers.removeAll_NoLock();
+	}
+
 }
 
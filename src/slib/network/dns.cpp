@@ -26,6 +26,15 @@
 #include "slib/core/scoped.h"
 #include "slib/core/mio.h"
 #include "slib/core/log.h"
+#include "slib/core/system.h"
+#include "slib/core/new_helper.h"
+#include "slib/core/math.h"
+#include "slib/core/sort.h"
+#include "slib/core/file.h"
+#include "slib/core/dispatch.h"
+#include "slib/core/thread.h"
+#include "slib/core/safe_static.h"
+#include "slib/network/os.h"
 
 #define PRIV_MAX_NAME SLIB_NETWORK_DNS_NAME_MAX_LENGTH
 
@@ -547,6 +556,7 @@ namespace slib
 	{
 		id = 0;
 		flagQuestion = sl_false;
+		responseCode = DnsResponseCode::NoError;
 	}
 
 	DnsPacket::~DnsPacket()
@@ -568,6 +578,7 @@ namespace slib
 				flagQuestion = sl_false;
 			}
 			id = header->getId();
+			responseCode = header->getResponseCode();
 			
 			sl_uint32 i, n;
 			sl_uint32 offset = sizeof(DnsHeader);
@@ -601,6 +612,7 @@ namespace slib
 					IPv4Address addr = record.parseData_A();
 					if (addr.isNotZero()) {
 						item.address = addr;
+						item.TTL = record.getTTL();
 						addresses.add(item);
 					}
 				} else if (type == DnsRecordType::AAAA) {
@@ -609,12 +621,14 @@ namespace slib
 					IPv6Address addr = record.parseData_AAAA();
 					if (addr.isNotZero()) {
 						item.address = addr;
+						item.TTL = record.getTTL();
 						addresses.add(item);
 					}
 				} else if (type == DnsRecordType::CNAME) {
 					DnsPacket::Alias item;
 					item.name = record.getName();
 					item.alias = record.parseData_CNAME();
+					item.TTL = record.getTTL();
 					if (item.alias.isNotEmpty()) {
 						aliases.add(item);
 					}
@@ -642,7 +656,7 @@ namespace slib
 		return sl_false;
 	}
 
-	Memory DnsPacket::buildQuestionPacket(sl_uint16 id, const String& host)
+	Memory DnsPacket::buildQuestionPacket(sl_uint16 id, const String& host, DnsRecordType type)
 	{
 		char buf[1024];
 		DnsHeader* header = (DnsHeader*)buf;
@@ -654,7 +668,7 @@ namespace slib
 		header->setQuestionsCount(1);
 		DnsQuestionRecord record;
 		record.setName(host);
-		record.setType(DnsRecordType::A);
+		record.setType(type);
 		sl_uint32 size = record.buildRecord(buf, sizeof(DnsHeader), 1024);
 		if (size > 0) {
 			return Memory::create(buf, size);
@@ -662,7 +676,7 @@ namespace slib
 		return sl_null;
 	}
 
-	Memory DnsPacket::buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress)
+	Memory DnsPacket::buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL)
 	{
 		char buf[4096];
 		Base::zeroMemory(buf, sizeof(buf));
@@ -688,6 +702,7 @@ namespace slib
 			if (offset > 0) {
 				DnsResponseRecord recordResponse;
 				recordResponse.setName(hostName);
+				recordResponse.setTTL(TTL);
 				offset = recordResponse.buildRecord_A(buf, offset, 1024, hostAddress);
 				if (offset > 0) {
 					return Memory::create(buf, offset);
@@ -712,7 +727,7 @@ namespace slib
 			recordQuestion.setName(hostName);
 			recordQuestion.setType(DnsRecordType::A);
 			offset = recordQuestion.buildRecord(buf, offset, 1024);
-			if (offset == 0) {
+			if (offset > 0) {
 				return Memory::create(buf, offset);
 			}
 		}
@@ -737,7 +752,8 @@ namespace slib
 
 	DnsClient::DnsClient()
 	{
-		m_idLast = 0;
+		// unpredictable identifiers make the answer spoofing harder
+		m_idLast = (sl_uint16)(Math::randomInt());
 	}
 
 	DnsClient::~DnsClient()
@@ -761,18 +777,19 @@ namespace slib
 		return ret;
 	}
 
-	void DnsClient::sendQuestion(const SocketAddress& serverAddress, const String& hostName)
+	sl_uint16 DnsClient::sendQuestion(const SocketAddress& serverAddress, const String& hostName, DnsRecordType type)
 	{
 		sl_uint16 id = m_idLast++;
-		Memory mem = DnsPacket::buildQuestionPacket(id, hostName);
-		if (mem.isNotNull()) {
+		Memory mem = DnsPacket::buildQuestionPacket(id, hostName, type);
+		if (mem.isNotNull() && m_udp.isNotNull()) {
 			m_udp->sendTo(serverAddress, mem);
 		}
+		return id;
 	}
 
-	void DnsClient::sendQuestion(const IPv4Address& serverIp, const String& hostName)
+	sl_uint16 DnsClient::sendQuestion(const IPv4Address& serverIp, const String& hostName, DnsRecordType type)
 	{
-		sendQuestion(SocketAddress(serverIp, SLIB_NETWORK_DNS_PORT), hostName);
+		return sendQuestion(SocketAddress(serverIp, SLIB_NETWORK_DNS_PORT), hostName, type);
 	}
 
 	void DnsClient::_onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive)
@@ -788,6 +805,316 @@ namespace slib
 		m_onAnswer(this, serverAddress, packet);
 	}
 
+/*************************************************************
+					DnsCache
+*************************************************************/
+	DnsCacheParam::DnsCacheParam()
+	{
+		shardsCount = 16;
+		maximumEntriesCountPerShard = 4096;
+		minimumTTL = 0;
+		maximumTTL = 86400;
+		negativeTTL = 60;
+		prefetchPercent = 10;
+	}
+	
+	DnsCacheParam::~DnsCacheParam()
+	{
+	}
+	
+	DnsCacheItem::DnsCacheItem()
+	{
+		TTL = 0;
+		flagPrefetch = sl_false;
+	}
+	
+	DnsCacheItem::~DnsCacheItem()
+	{
+	}
+	
+	sl_bool DnsCacheItem::isNegative() const
+	{
+		return addresses.isEmpty();
+	}
+	
+	IPv4Address DnsCacheItem::getIPv4Address() const
+	{
+		ListLocker<IPAddress> list(addresses);
+		for (sl_size i = 0; i < list.count; i++) {
+			if (list[i].isIPv4()) {
+				return list[i].getIPv4();
+			}
+		}
+		return IPv4Address::zero();
+	}
+	
+	class _priv_DnsCacheEntry
+	{
+	public:
+		List<IPAddress> addresses;
+		sl_uint32 timeCreated; // tick count
+		sl_uint32 lifetime; // milliseconds
+		sl_bool flagPrefetching;
+	};
+	
+	class _priv_DnsCacheShard
+	{
+	public:
+		SpinLock lock;
+		CHashMap<String, _priv_DnsCacheEntry> map;
+		
+	public:
+		sl_size removeExpiredEntries(sl_uint32 now)
+		{
+			sl_size n = 0;
+			HashMapNode<String, _priv_DnsCacheEntry>* node = map.getFirstNode();
+			while (node) {
+				HashMapNode<String, _priv_DnsCacheEntry>* next = node->next;
+				if ((sl_uint32)(now - node->value.timeCreated) >= node->value.lifetime) {
+					map.removeAt(node);
+					n++;
+				}
+				node = next;
+			}
+			return n;
+		}
+		
+		// removes the entries closest to expiry until no more than `limit` entries are left
+		void removeEarliestExpiring(sl_uint32 now, sl_size limit)
+		{
+			sl_size nTotal = map.getCount();
+			if (nTotal <= limit) {
+				return;
+			}
+			sl_size nRemove = nTotal - limit;
+			SLIB_SCOPED_BUFFER(sl_uint32, 1024, remains, nTotal)
+			if (!remains) {
+				return;
+			}
+			sl_size i = 0;
+			HashMapNode<String, _priv_DnsCacheEntry>* node = map.getFirstNode();
+			while (node && i < nTotal) {
+				remains[i++] = getRemainingLifetime(node->value, now);
+				node = node->next;
+			}
+			QuickSort::sortAsc(remains, i);
+			sl_uint32 threshold = remains[nRemove - 1];
+			node = map.getFirstNode();
+			while (node && nRemove) {
+				HashMapNode<String, _priv_DnsCacheEntry>* next = node->next;
+				if (getRemainingLifetime(node->value, now) <= threshold) {
+					map.removeAt(node);
+					nRemove--;
+				}
+				node = next;
+			}
+		}
+		
+		static sl_uint32 getRemainingLifetime(const _priv_DnsCacheEntry& entry, sl_uint32 now)
+		{
+			sl_uint32 age = now - entry.timeCreated;
+			if (age < entry.lifetime) {
+				return entry.lifetime - age;
+			}
+			return 0;
+		}
+		
+	};
+	
+	// ticks of 32 bits are safe to compare for the lifetime shorter than 24 days
+#define PRIV_DNS_CACHE_MAX_TTL 604800
+	
+	SLIB_DEFINE_OBJECT(DnsCache, Object)
+	
+	DnsCache::DnsCache()
+	{
+		m_shards = sl_null;
+		m_nShards = 0;
+		
+		m_maximumEntriesCountPerShard = 0;
+		m_minimumTTL = 0;
+		m_maximumTTL = 0;
+		m_negativeTTL = 0;
+		m_prefetchPercent = 0;
+		
+		m_nHits = 0;
+		m_nMisses = 0;
+		m_nPrefetches = 0;
+	}
+	
+	DnsCache::~DnsCache()
+	{
+		if (m_shards) {
+			NewHelper<_priv_DnsCacheShard>::free(m_shards, m_nShards);
+		}
+	}
+	
+	Ref<DnsCache> DnsCache::create(const DnsCacheParam& param)
+	{
+		sl_uint32 nShards = param.shardsCount;
+		if (!nShards) {
+			nShards = 1;
+		}
+		_priv_DnsCacheShard* shards = NewHelper<_priv_DnsCacheShard>::create(nShards);
+		if (!shards) {
+			return sl_null;
+		}
+		Ref<DnsCache> ret = new DnsCache;
+		if (ret.isNull()) {
+			NewHelper<_priv_DnsCacheShard>::free(shards, nShards);
+			return sl_null;
+		}
+		ret->m_shards = shards;
+		ret->m_nShards = nShards;
+		ret->m_maximumEntriesCountPerShard = param.maximumEntriesCountPerShard;
+		ret->m_maximumTTL = Math::min(param.maximumTTL, (sl_uint32)PRIV_DNS_CACHE_MAX_TTL);
+		ret->m_minimumTTL = Math::min(param.minimumTTL, ret->m_maximumTTL);
+		ret->m_negativeTTL = Math::min(param.negativeTTL, ret->m_maximumTTL);
+		ret->m_prefetchPercent = Math::min(param.prefetchPercent, (sl_uint32)100);
+		return ret;
+	}
+	
+	Ref<DnsCache> DnsCache::create()
+	{
+		DnsCacheParam param;
+		return create(param);
+	}
+	
+	_priv_DnsCacheShard* DnsCache::_getShard(const String& key)
+	{
+		return m_shards + (Hash<String>()(key) % m_nShards);
+	}
+	
+	sl_bool DnsCache::get(const String& hostName, DnsCacheItem& _out)
+	{
+		String key = hostName.toLower();
+		_priv_DnsCacheShard* shard = _getShard(key);
+		sl_uint32 now = System::getTickCount();
+		{
+			SpinLocker lock(&(shard->lock));
+			HashMapNode<String, _priv_DnsCacheEntry>* node = shard->map.find_NoLock(key);
+			if (node) {
+				_priv_DnsCacheEntry& entry = node->value;
+				sl_uint32 age = now - entry.timeCreated;
+				if (age < entry.lifetime) {
+					sl_uint32 remain = entry.lifetime - age;
+					_out.addresses = entry.addresses;
+					_out.TTL = remain / 1000;
+					_out.flagPrefetch = sl_false;
+					if (m_prefetchPercent && !(entry.flagPrefetching) && entry.addresses.isNotEmpty()) {
+						if ((sl_uint64)remain * 100 < (sl_uint64)(entry.lifetime) * m_prefetchPercent) {
+							entry.flagPrefetching = sl_true;
+							_out.flagPrefetch = sl_true;
+						}
+					}
+				} else {
+					shard->map.removeAt(node);
+					node = sl_null;
+				}
+			}
+			if (node) {
+				lock.unlock();
+				Base::interlockedIncrement64(&m_nHits);
+				if (_out.flagPrefetch) {
+					Base::interlockedIncrement64(&m_nPrefetches);
+				}
+				return sl_true;
+			}
+		}
+		Base::interlockedIncrement64(&m_nMisses);
+		return sl_false;
+	}
+	
+	void DnsCache::put(const String& hostName, const List<IPAddress>& addresses, sl_uint32 TTL)
+	{
+		if (addresses.isEmpty()) {
+			putNegative(hostName);
+			return;
+		}
+		_put(hostName, addresses, Math::clamp(TTL, m_minimumTTL, m_maximumTTL));
+	}
+	
+	void DnsCache::put(const String& hostName, const IPAddress& address, sl_uint32 TTL)
+	{
+		if (address.isNone()) {
+			putNegative(hostName);
+			return;
+		}
+		put(hostName, List<IPAddress>::createFromElement(address), TTL);
+	}
+	
+	void DnsCache::putNegative(const String& hostName)
+	{
+		_put(hostName, sl_null, m_negativeTTL);
+	}
+	
+	void DnsCache::_put(const String& hostName, const List<IPAddress>& addresses, sl_uint32 TTL)
+	{
+		if (!TTL) {
+			remove(hostName);
+			return;
+		}
+		String key = hostName.toLower();
+		_priv_DnsCacheShard* shard = _getShard(key);
+		_priv_DnsCacheEntry entry;
+		entry.addresses = addresses;
+		entry.timeCreated = System::getTickCount();
+		entry.lifetime = TTL * 1000;
+		entry.flagPrefetching = sl_false;
+		SpinLocker lock(&(shard->lock));
+		if (m_maximumEntriesCountPerShard && shard->map.getCount() >= m_maximumEntriesCountPerShard) {
+			shard->removeExpiredEntries(entry.timeCreated);
+			sl_size limit = m_maximumEntriesCountPerShard - (m_maximumEntriesCountPerShard >> 3);
+			if (shard->map.getCount() >= limit) {
+				// evicts down to 7/8 of the capacity so that a full shard is not rescanned on every insertion
+				shard->removeEarliestExpiring(entry.timeCreated, limit ? limit - 1 : 0);
+			}
+		}
+		shard->map.put_NoLock(key, Move(entry));
+	}
+	
+	void DnsCache::remove(const String& hostName)
+	{
+		String key = hostName.toLower();
+		_priv_DnsCacheShard* shard = _getShard(key);
+		SpinLocker lock(&(shard->lock));
+		shard->map.remove_NoLock(key);
+	}
+	
+	void DnsCache::removeAll()
+	{
+		for (sl_uint32 i = 0; i < m_nShards; i++) {
+			SpinLocker lock(&(m_shards[i].lock));
+			m_shards[i].map.removeAll_NoLock();
+		}
+	}
+	
+	sl_size DnsCache::removeExpiredEntries()
+	{
+		sl_uint32 now = System::getTickCount();
+		sl_size n = 0;
+		for (sl_uint32 i = 0; i < m_nShards; i++) {
+			SpinLocker lock(&(m_shards[i].lock));
+			n += m_shards[i].removeExpiredEntries(now);
+		}
+		return n;
+	}
+	
+	sl_uint64 DnsCache::getHitsCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nHits, 0));
+	}
+	
+	sl_uint64 DnsCache::getMissesCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nMisses, 0));
+	}
+	
+	sl_uint64 DnsCache::getPrefetchesCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nPrefetches, 0));
+	}
+
 /*************************************************************
 					DnsServer
 *************************************************************/
@@ -816,6 +1143,8 @@ namespace slib
 		flagEncryptDefaultForward = sl_false;
 
 		flagAutoStart = sl_true;
+		
+		flagCache = sl_false;
 	}
 
 	DnsServerParam::~DnsServerParam()
@@ -833,6 +1162,12 @@ namespace slib
 		IPv4Address defaultForwardAddressIp = IPv4Address(8, 8, 4, 4);
 		defaultForwardAddressIp.parse(conf.getItem("forward_dns").getString());
 		defaultForwardAddress = SocketAddress(defaultForwardAddressIp, SLIB_NETWORK_DNS_PORT);
+		
+		flagCache = conf.getItem("cache").getBoolean(sl_false);
+		cacheParam.maximumEntriesCountPerShard = conf.getItem("cache_max_entries").getUint32(cacheParam.maximumEntriesCountPerShard * cacheParam.shardsCount) / cacheParam.shardsCount;
+		cacheParam.minimumTTL = conf.getItem("cache_min_ttl").getUint32(cacheParam.minimumTTL);
+		cacheParam.maximumTTL = conf.getItem("cache_max_ttl").getUint32(cacheParam.maximumTTL);
+		cacheParam.negativeTTL = conf.getItem("cache_negative_ttl").getUint32(cacheParam.negativeTTL);
 	}
 
 
@@ -896,6 +1231,10 @@ namespace slib
 
 				ret->m_onResolve = param.onResolve;
 				ret->m_onCache = param.onCache;
+				
+				if (param.flagCache) {
+					ret->m_cache = DnsCache::create(param.cacheParam);
+				}
 
 				ret->m_flagInit = sl_true;
 				if (param.flagAutoStart) {
@@ -948,6 +1287,11 @@ namespace slib
 	{
 		return m_flagRunning;
 	}
+	
+	Ref<DnsCache> DnsServer::getCache()
+	{
+		return m_cache;
+	}
 
 	void DnsServer::_processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest)
 	{
@@ -964,30 +1308,96 @@ namespace slib
 			return;
 		}
 		if (rp.forwardAddress.isInvalid()) {
-			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
+			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, 0, flagEncryptedRequest));
 			return;
 		}
 		if (rp.hostAddress.isNotZero()) {
-			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
+			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, 0, flagEncryptedRequest));
+			_forwardQuestion(rp.forwardAddress, rp.flagEncryptForward, hostName, sl_null, sl_false);
+			return;
 		}
 		
-		// forward DNS request
+		// only the answers of the default forward server are cached, so that the routing by `onResolve` is kept
+		sl_bool flagCacheAnswer = m_cache.isNotNull() && rp.forwardAddress == m_defaultForwardAddress && rp.flagEncryptForward == m_flagEncryptDefaultForward;
+		if (flagCacheAnswer) {
+			DnsCacheItem item;
+			if (m_cache->get(hostName, item)) {
+				ListElements<IPAddress> addresses(item.addresses);
+				for (sl_size i = 0; i < addresses.count; i++) {
+					_onCache(hostName, addresses[i]);
+				}
+				_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, item.getIPv4Address(), item.TTL, flagEncryptedRequest));
+				if (item.flagPrefetch) {
+					_forwardQuestion(rp.forwardAddress, rp.flagEncryptForward, hostName, sl_null, sl_true);
+				}
+				return;
+			}
+		}
+		
+		ForwardClient client;
+		client.address = clientAddress;
+		client.requestedId = id;
+		client.flagEncrypted = flagEncryptedRequest;
+		_forwardQuestion(rp.forwardAddress, rp.flagEncryptForward, hostName, &client, flagCacheAnswer);
+	}
+	
+	// identical questions are not coalesced to the forwarded question which is not answered in this duration
+#define PRIV_DNS_FORWARD_COALESCING_TIMEOUT 3000
+
+	void DnsServer::_forwardQuestion(const SocketAddress& forwardAddress, sl_bool flagEncryptForward, const String& hostName, const ForwardClient* client, sl_bool flagCacheAnswer)
+	{
+		sl_uint32 now = System::getTickCount();
+		String questionKey;
+		if (m_cache.isNotNull()) {
+			questionKey = hostName.toLower() + "|" + forwardAddress.toString();
+			if (flagEncryptForward) {
+				questionKey += "|E";
+			}
+		}
+		sl_uint16 idForward;
 		{
-			sl_uint16 idForward = m_lastForwardId++;
+			SpinLocker lock(&m_lockForward);
+			if (questionKey.isNotEmpty()) {
+				sl_uint16 idInFlight;
+				if (m_mapForwardQuestions.get_NoLock(questionKey, &idInFlight)) {
+					HashMapNode<sl_uint16, ForwardElement>* node = m_mapForward.find_NoLock(idInFlight);
+					// the id may be reused by another question after wrapping around
+					if (node && node->value.questionKey == questionKey && (sl_uint32)(now - node->value.timeForward) < PRIV_DNS_FORWARD_COALESCING_TIMEOUT) {
+						if (client) {
+							node->value.coalescedClients.add_NoLock(*client);
+						}
+						return;
+					}
+				}
+			}
+			idForward = m_lastForwardId++;
 			ForwardElement fe;
-			fe.requestedId = id;
-			fe.requestedHostName = hostName;
-			fe.flagEncrypted = flagEncryptedRequest;
-			if (rp.hostAddress.isNotZero()) {
-				fe.clientAddress.ip.setNone();
-				fe.clientAddress.port = 0;
+			if (client) {
+				fe.clientAddress = client->address;
+				fe.requestedId = client->requestedId;
+				fe.flagEncrypted = client->flagEncrypted;
 			} else {
-				fe.clientAddress = clientAddress;
+				fe.clientAddress.setNone();
+				fe.requestedId = 0;
+				fe.flagEncrypted = sl_false;
+			}
+			fe.requestedHostName = hostName;
+			fe.questionKey = questionKey;
+			fe.flagCacheAnswer = flagCacheAnswer;
+			fe.timeForward = now;
+			// releases the stale question occupying the same id
+			HashMapNode<sl_uint16, ForwardElement>* nodeOld = m_mapForward.find_NoLock(idForward);
+			if (nodeOld) {
+				if (nodeOld->value.questionKey.isNotEmpty()) {
+					m_mapForwardQuestions.removeKeyAndValue_NoLock(nodeOld->value.questionKey, idForward);
+				}
+			}
+			m_mapForward.put_NoLock(idForward, fe);
+			if (questionKey.isNotEmpty()) {
+				m_mapForwardQuestions.put_NoLock(questionKey, idForward);
 			}
-			m_mapForward.put(idForward, fe);
-			_sendPacket(rp.flagEncryptForward, rp.forwardAddress, _buildQuestionPacket(idForward, hostName, rp.flagEncryptForward));
 		}
-
+		_sendPacket(flagEncryptForward, forwardAddress, _buildQuestionPacket(idForward, hostName, flagEncryptForward));
 	}
 
 	void DnsServer::_processReceivedDnsAnswer(const DnsPacket& packet)
@@ -996,16 +1406,25 @@ namespace slib
 		sl_uint16 idForward = packet.id;
 
 		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
-
-			m_mapForward.remove(idForward);
+		sl_bool flagFound;
+		{
+			SpinLocker lock(&m_lockForward);
+			flagFound = m_mapForward.remove_NoLock(idForward, &fe);
+			if (flagFound && fe.questionKey.isNotEmpty()) {
+				m_mapForwardQuestions.removeKeyAndValue_NoLock(fe.questionKey, idForward);
+			}
+		}
+		if (flagFound) {
 
 			String reqNameLower = fe.requestedHostName.toLower();
 
 			IPv4Address resolvedAddress;
 			resolvedAddress.setZero();
+			sl_uint32 resolvedTTL = 0;
 
 			CHashMap<String, IPv4Address> aliasAddresses4;
+			// the lifetime of an alias is limited by the records of its chain
+			CHashMap<String, sl_uint32> aliasTTLs4;
 			CHashMap<String, IPv6Address> aliasAddresses6;
 			// address
 			{
@@ -1017,6 +1436,7 @@ namespace slib
 						if (address.address.isIPv4() && address.address.getIPv4().isHost()) {
 							_onCache(address.name, address.address);
 							aliasAddresses4.put_NoLock(address.name.toLower(), address.address.getIPv4());
+							aliasTTLs4.put_NoLock(address.name.toLower(), address.TTL);
 						} else if (address.address.isIPv6()) {
 							_onCache(address.name, address.address);
 							aliasAddresses6.put_NoLock(address.name.toLower(), address.address.getIPv6());
@@ -1024,6 +1444,7 @@ namespace slib
 						if (reqNameLower == address.name.toLower()) {
 							if (resolvedAddress.isZero()) {
 								resolvedAddress = address.address.getIPv4();
+								resolvedTTL = address.TTL;
 							}
 						}
 					}
@@ -1044,11 +1465,14 @@ namespace slib
 						IPv6Address addr6;
 						sl_bool flagAddr = sl_false;
 						if (aliasAddresses4.get_NoLock(alias.alias.toLower(), &addr4)) {
+							sl_uint32 TTL = Math::min(aliasTTLs4.getValue_NoLock(alias.alias.toLower(), 0), alias.TTL);
 							aliasAddresses4.put_NoLock(alias.name.toLower(), addr4);
+							aliasTTLs4.put_NoLock(alias.name.toLower(), TTL);
 							_onCache(alias.name, addr4);
 							if (reqNameLower == alias.name.toLower()) {
 								if (resolvedAddress.isZero()) {
 									resolvedAddress = addr4;
+									resolvedTTL = TTL;
 								}
 							}
 							flagProcess = sl_true;
@@ -1067,8 +1491,21 @@ namespace slib
 					aliasesProcess = aliasesNoProcess;
 				}
 			}
+			if (fe.flagCacheAnswer && m_cache.isNotNull()) {
+				if (resolvedAddress.isNotZero()) {
+					m_cache->put(fe.requestedHostName, resolvedAddress, resolvedTTL);
+				} else if (packet.responseCode == DnsResponseCode::NoError || packet.responseCode == DnsResponseCode::NameError) {
+					// only NXDOMAIN and NODATA are cached negatively; server failures are transient
+					m_cache->putNegative(fe.requestedHostName);
+				}
+			}
 			if (fe.clientAddress.isValid()) {
-				_sendPacket(fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, fe.flagEncrypted));
+				_sendPacket(fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, resolvedTTL, fe.flagEncrypted));
+			}
+			ListElements<ForwardClient> clients(fe.coalescedClients);
+			for (sl_size i = 0; i < clients.count; i++) {
+				ForwardClient& client = clients[i];
+				_sendPacket(client.flagEncrypted, client.address, _buildHostAddressAnswerPacket(client.requestedId, fe.requestedHostName, resolvedAddress, resolvedTTL, client.flagEncrypted));
 			}
 		}
 	}
@@ -1083,6 +1520,8 @@ namespace slib
 		fe.requestedId = header->getId();
 		fe.flagEncrypted = flagEncryptedRequest;
 		fe.clientAddress = clientAddress;
+		fe.flagCacheAnswer = sl_false;
+		fe.timeForward = 0;
 
 		header->setId(idForward);
 		Memory packet = Memory::create(data, size);
@@ -1093,7 +1532,17 @@ namespace slib
 			return;
 		}
 
-		m_mapForward.put(idForward, fe);
+		{
+			SpinLocker lock(&m_lockForward);
+			// releases the stale question occupying the same id
+			HashMapNode<sl_uint16, ForwardElement>* nodeOld = m_mapForward.find_NoLock(idForward);
+			if (nodeOld) {
+				if (nodeOld->value.questionKey.isNotEmpty()) {
+					m_mapForwardQuestions.removeKeyAndValue_NoLock(nodeOld->value.questionKey, idForward);
+				}
+			}
+			m_mapForward.put_NoLock(idForward, fe);
+		}
 
 		_sendPacket(m_flagEncryptDefaultForward, m_defaultForwardAddress, packet);
 
@@ -1104,9 +1553,12 @@ namespace slib
 		DnsHeader* header = (DnsHeader*)data;
 		sl_uint16 idForward = header->getId();
 		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
-
-			m_mapForward.remove(idForward);
+		sl_bool flagFound;
+		{
+			SpinLocker lock(&m_lockForward);
+			flagFound = m_mapForward.remove_NoLock(idForward, &fe);
+		}
+		if (flagFound) {
 
 			header->setId(fe.requestedId);
 			Memory packet = Memory::create(data, size);
@@ -1145,9 +1597,9 @@ namespace slib
 		return mem;
 	}
 
-	Memory DnsServer::_buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt)
+	Memory DnsServer::_buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_uint32 TTL, sl_bool flagEncrypt)
 	{
-		Memory mem = DnsPacket::buildHostAddressAnswerPacket(id, hostName, hostAddress);
+		Memory mem = DnsPacket::buildHostAddressAnswerPacket(id, hostName, hostAddress, TTL);
 		if (flagEncrypt) {
 			return m_encrypt.encrypt_CBC_PKCS7Padding(mem);
 		}
@@ -1205,4 +1657,393 @@ namespace slib
 		m_onCache(this, hostName, hostAddress);
 	}
 
+/*************************************************************
+					DnsResolver
+*************************************************************/
+	DnsResolverParam::DnsResolverParam()
+	{
+		flagLoadHosts = sl_true;
+		flagIPv6 = sl_false;
+		timeout = 3000;
+		attemptsCount = 2;
+	}
+	
+	DnsResolverParam::~DnsResolverParam()
+	{
+	}
+	
+	class _priv_DnsResolveRequest : public Referable
+	{
+	public:
+		// lowercased
+		String hostName;
+		List< Function<void(const List<IPAddress>&)> > callbacks;
+		
+		sl_uint32 attempt;
+		sl_bool flagCompleted;
+		
+		sl_uint16 idA;
+		sl_bool flagAnsweredA;
+		sl_uint16 idAAAA;
+		sl_bool flagAnsweredAAAA;
+		
+		List<IPAddress> addresses4;
+		List<IPAddress> addresses6;
+		sl_uint32 TTL;
+		
+	public:
+		_priv_DnsResolveRequest()
+		{
+			attempt = 0;
+			flagCompleted = sl_false;
+			idA = 0;
+			flagAnsweredA = sl_false;
+			idAAAA = 0;
+			flagAnsweredAAAA = sl_false;
+			TTL = 0xFFFFFFFF;
+		}
+		
+	};
+	
+#if defined(SLIB_PLATFORM_IS_UNIX)
+#	define PRIV_DNS_RESOLV_CONF_PATH "/etc/resolv.conf"
+#	define PRIV_DNS_HOSTS_PATH "/etc/hosts"
+#endif
+	
+#define TAG_RESOLVER "DnsResolver"
+	
+	SLIB_DEFINE_OBJECT(DnsResolver, Object)
+	
+	DnsResolver::DnsResolver()
+	{
+		m_flagIPv6 = sl_false;
+		m_timeout = 0;
+		m_attemptsCount = 0;
+	}
+	
+	DnsResolver::~DnsResolver()
+	{
+	}
+	
+	Ref<DnsResolver> DnsResolver::create(const DnsResolverParam& param)
+	{
+		Ref<DnsResolver> ret = new DnsResolver;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		List<SocketAddress> nameServers = param.nameServers;
+#if defined(PRIV_DNS_RESOLV_CONF_PATH)
+		if (nameServers.isEmpty()) {
+			nameServers = loadNameServers(PRIV_DNS_RESOLV_CONF_PATH);
+		}
+#endif
+		ListElements<SocketAddress> servers(nameServers);
+		for (sl_size i = 0; i < servers.count; i++) {
+			// DnsClient sends questions over IPv4 socket
+			if (servers[i].ip.isIPv4()) {
+				SocketAddress address = servers[i];
+				if (!(address.port)) {
+					address.port = SLIB_NETWORK_DNS_PORT;
+				}
+				ret->m_nameServers.add_NoLock(address);
+			}
+		}
+		if (ret->m_nameServers.isNotEmpty()) {
+			DnsClientParam cp;
+			cp.ioLoop = param.ioLoop;
+			cp.onAnswer = SLIB_FUNCTION_WEAKREF(DnsResolver, _onAnswer, ret);
+			ret->m_client = DnsClient::create(cp);
+			if (ret->m_client.isNull()) {
+				return sl_null;
+			}
+		} else {
+			LogError(TAG_RESOLVER, "No name server is available, host names are resolved by the system");
+		}
+#if defined(PRIV_DNS_HOSTS_PATH)
+		if (param.flagLoadHosts) {
+			ret->m_hosts = loadHosts(PRIV_DNS_HOSTS_PATH);
+		}
+#endif
+		ret->m_cache = DnsCache::create(param.cacheParam);
+		ret->m_flagIPv6 = param.flagIPv6;
+		ret->m_timeout = param.timeout;
+		ret->m_attemptsCount = param.attemptsCount;
+		if (!(ret->m_attemptsCount)) {
+			ret->m_attemptsCount = 1;
+		}
+		return ret;
+	}
+	
+	Ref<DnsResolver> DnsResolver::getDefault()
+	{
+		SLIB_SAFE_STATIC(Ref<DnsResolver>, ret, create(DnsResolverParam()))
+		if (SLIB_SAFE_STATIC_CHECK_FREED(ret)) {
+			return sl_null;
+		}
+		return ret;
+	}
+	
+	List<SocketAddress> DnsResolver::loadNameServers(const String& path)
+	{
+		List<SocketAddress> ret;
+		ListElements<String> lines(File::readAllTextUTF8(path).split("\n"));
+		for (sl_size i = 0; i < lines.count; i++) {
+			String line = lines[i].trim();
+			if (line.startsWith("nameserver")) {
+				String value = line.substring(10);
+				if (value.isNotEmpty() && (value.getData()[0] == ' ' || value.getData()[0] == '\t')) {
+					value = value.trim();
+					sl_reg indexComment = value.indexOf('#');
+					if (indexComment >= 0) {
+						value = value.substring(0, indexComment).trim();
+					}
+					IPAddress ip;
+					if (ip.parse(value)) {
+						ret.add_NoLock(SocketAddress(ip, SLIB_NETWORK_DNS_PORT));
+					}
+				}
+			}
+		}
+		return ret;
+	}
+	
+	HashMap< String, List<IPAddress> > DnsResolver::loadHosts(const String& path)
+	{
+		HashMap< String, List<IPAddress> > ret;
+		ListElements<String> lines(File::readAllTextUTF8(path).split("\n"));
+		for (sl_size i = 0; i < lines.count; i++) {
+			String line = lines[i];
+			sl_reg indexComment = line.indexOf('#');
+			if (indexComment >= 0) {
+				line = line.substring(0, indexComment);
+			}
+			line = line.replaceAll("\t", " ").trim();
+			if (line.isEmpty()) {
+				continue;
+			}
+			ListElements<String> fields(line.split(" "));
+			IPAddress ip;
+			if (fields.count < 2 || !(ip.parse(fields[0]))) {
+				continue;
+			}
+			for (sl_size k = 1; k < fields.count; k++) {
+				if (fields[k].isNotEmpty()) {
+					String name = fields[k].toLower();
+					List<IPAddress> addresses;
+					if (!(ret.get_NoLock(name, &addresses))) {
+						addresses = List<IPAddress>::create();
+						ret.put_NoLock(name, addresses);
+					}
+					if (!(addresses.contains_NoLock(ip))) {
+						// IPv4 addresses first
+						if (ip.isIPv4()) {
+							addresses.insert_NoLock(0, ip);
+						} else {
+							addresses.add_NoLock(ip);
+						}
+					}
+				}
+			}
+		}
+		return ret;
+	}
+	
+	List<SocketAddress> DnsResolver::getNameServers()
+	{
+		return m_nameServers;
+	}
+	
+	Ref<DnsCache> DnsResolver::getCache()
+	{
+		return m_cache;
+	}
+	
+	void DnsResolver::resolve(const String& _hostName, const Function<void(const List<IPAddress>& addresses)>& callback)
+	{
+		String hostName = _hostName.trim();
+		if (hostName.endsWith('.')) {
+			hostName = hostName.substring(0, hostName.getLength() - 1);
+		}
+		if (hostName.isEmpty()) {
+			callback(sl_null);
+			return;
+		}
+		IPAddress ip;
+		if (ip.parse(hostName)) {
+			callback(List<IPAddress>::createFromElement(ip));
+			return;
+		}
+		hostName = hostName.toLower();
+		List<IPAddress> addresses;
+		if (m_hosts.get(hostName, &addresses)) {
+			callback(addresses);
+			return;
+		}
+		sl_bool flagPrefetch = sl_false;
+		if (m_cache.isNotNull()) {
+			DnsCacheItem item;
+			if (m_cache->get(hostName, item)) {
+				callback(item.addresses);
+				if (!(item.flagPrefetch)) {
+					return;
+				}
+				flagPrefetch = sl_true;
+			}
+		}
+		if (m_client.isNull()) {
+			if (!flagPrefetch) {
+				Function<void(const List<IPAddress>&)> _callback = callback;
+				Thread::start([hostName, _callback]() {
+					_callback(Network::getIPAddressesFromHostName(hostName));
+				});
+			}
+			return;
+		}
+		Ref<_priv_DnsResolveRequest> request;
+		{
+			MutexLocker lock(&m_lockRequests);
+			if (m_mapRequestsByName.get_NoLock(hostName, &request)) {
+				// coalesces with the question in flight
+				if (!flagPrefetch) {
+					request->callbacks.add_NoLock(callback);
+				}
+				return;
+			}
+			request = new _priv_DnsResolveRequest;
+			if (request.isNotNull()) {
+				request->hostName = hostName;
+				if (!flagPrefetch) {
+					request->callbacks.add_NoLock(callback);
+				}
+				m_mapRequestsByName.put_NoLock(hostName, request);
+				_sendQuestions(request.get());
+				return;
+			}
+		}
+		if (!flagPrefetch) {
+			callback(sl_null);
+		}
+	}
+	
+	void DnsResolver::_sendQuestions(_priv_DnsResolveRequest* request)
+	{
+		sl_size nServers = m_nameServers.getCount();
+		SocketAddress server = m_nameServers.getValueAt(request->attempt % nServers);
+		Ref<_priv_DnsResolveRequest> refRequest = request;
+		// the ids are not sent yet on the first attempt, and may be already reused by other requests
+		sl_bool flagSent = request->attempt > 0;
+		if (!(request->flagAnsweredA)) {
+			if (flagSent) {
+				m_mapRequestsById.removeKeyAndValue_NoLock(request->idA, refRequest);
+			}
+			request->idA = m_client->sendQuestion(server, request->hostName, DnsRecordType::A);
+			m_mapRequestsById.put_NoLock(request->idA, refRequest);
+		}
+		if (m_flagIPv6 && !(request->flagAnsweredAAAA)) {
+			if (flagSent) {
+				m_mapRequestsById.removeKeyAndValue_NoLock(request->idAAAA, refRequest);
+			}
+			request->idAAAA = m_client->sendQuestion(server, request->hostName, DnsRecordType::AAAA);
+			m_mapRequestsById.put_NoLock(request->idAAAA, refRequest);
+		}
+		Dispatch::setTimeout(SLIB_BIND_WEAKREF(void(), DnsResolver, _onTimeout, this, Ref<_priv_DnsResolveRequest>(request), request->attempt), m_timeout);
+	}
+	
+	void DnsResolver::_onAnswer(DnsClient* client, const SocketAddress& serverAddress, const DnsPacket& packet)
+	{
+		if (packet.flagQuestion) {
+			return;
+		}
+		if (packet.questions.getCount() != 1) {
+			return;
+		}
+		DnsPacket::Question question = packet.questions.getValueAt(0);
+		Ref<_priv_DnsResolveRequest> request;
+		{
+			MutexLocker lock(&m_lockRequests);
+			if (!(m_mapRequestsById.get_NoLock(packet.id, &request))) {
+				return;
+			}
+			if (request->flagCompleted || question.name.toLower() != request->hostName) {
+				return;
+			}
+			sl_bool flagIPv6;
+			if (question.type == DnsRecordType::A && packet.id == request->idA) {
+				flagIPv6 = sl_false;
+				request->flagAnsweredA = sl_true;
+			} else if (question.type == DnsRecordType::AAAA && packet.id == request->idAAAA) {
+				flagIPv6 = sl_true;
+				request->flagAnsweredAAAA = sl_true;
+			} else {
+				return;
+			}
+			m_mapRequestsById.remove_NoLock(packet.id);
+			// the records of the canonical name are also answered for the questions of aliases
+			ListElements<DnsPacket::Address> addresses(packet.addresses);
+			for (sl_size i = 0; i < addresses.count; i++) {
+				DnsPacket::Address& address = addresses[i];
+				if (flagIPv6) {
+					if (address.address.isIPv6()) {
+						request->addresses6.add_NoLock(address.address);
+						request->TTL = Math::min(request->TTL, address.TTL);
+					}
+				} else {
+					if (address.address.isIPv4()) {
+						request->addresses4.add_NoLock(address.address);
+						request->TTL = Math::min(request->TTL, address.TTL);
+					}
+				}
+			}
+			ListElements<DnsPacket::Alias> aliases(packet.aliases);
+			for (sl_size i = 0; i < aliases.count; i++) {
+				request->TTL = Math::min(request->TTL, aliases[i].TTL);
+			}
+			if (!(request->flagAnsweredA) || (m_flagIPv6 && !(request->flagAnsweredAAAA))) {
+				return;
+			}
+			request->flagCompleted = sl_true;
+			m_mapRequestsByName.remove_NoLock(request->hostName);
+		}
+		_completeRequest(request.get());
+	}
+	
+	void DnsResolver::_onTimeout(const Ref<_priv_DnsResolveRequest>& request, sl_uint32 attempt)
+	{
+		{
+			MutexLocker lock(&m_lockRequests);
+			if (request->flagCompleted || request->attempt != attempt) {
+				return;
+			}
+			request->attempt++;
+			if (request->attempt < m_nameServers.getCount() * m_attemptsCount) {
+				_sendQuestions(request.get());
+				return;
+			}
+			request->flagCompleted = sl_true;
+			m_mapRequestsById.removeKeyAndValue_NoLock(request->idA, request);
+			if (m_flagIPv6) {
+				m_mapRequestsById.removeKeyAndValue_NoLock(request->idAAAA, request);
+			}
+			m_mapRequestsByName.remove_NoLock(request->hostName);
+		}
+		_completeRequest(request.get());
+	}
+	
+	void DnsResolver::_completeRequest(_priv_DnsResolveRequest* request)
+	{
+		List<IPAddress> addresses = request->addresses4;
+		addresses.addAll_NoLock(request->addresses6);
+		sl_bool flagAnswered = request->flagAnsweredA && (!m_flagIPv6 || request->flagAnsweredAAAA);
+		if (m_cache.isNotNull()) {
+			// timed out questions are not cached as failures
+			if (flagAnswered || addresses.isNotEmpty()) {
+				m_cache->put(request->hostName, addresses, request->TTL);
+			}
+		}
+		ListElements< Function<void(const List<IPAddress>&)> > callbacks(request->callbacks);
+		for (sl_size i = 0; i < callbacks.count; i++) {
+			callbacks[i](addresses);
+		}
+	}
+	
 }
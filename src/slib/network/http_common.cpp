@@ -151,6 +151,64 @@ namespace slib
 	}
 
 
+	SLIB_STATIC_STRING(_g_sz_http_content_encoding_gzip, "gzip");
+	SLIB_STATIC_STRING(_g_sz_http_content_encoding_deflate, "deflate");
+
+	String HttpContentEncodings::toString(HttpContentEncoding encoding)
+	{
+		switch (encoding) {
+			case HttpContentEncoding::Gzip:
+				return _g_sz_http_content_encoding_gzip;
+			case HttpContentEncoding::Deflate:
+				return _g_sz_http_content_encoding_deflate;
+			default:
+				break;
+		}
+		return sl_null;
+	}
+
+	HttpContentEncoding HttpContentEncodings::negotiate(const String& acceptEncoding)
+	{
+		// 1: accepted, -1: refused by `q=0`, 0: not listed
+		sl_int32 stateGzip = 0;
+		sl_int32 stateDeflate = 0;
+		sl_int32 stateAny = 0;
+		ListElements<String> items(acceptEncoding.split(","));
+		for (sl_size i = 0; i < items.count; i++) {
+			String item = items[i];
+			String coding = item;
+			sl_int32 state = 1;
+			sl_reg indexParams = item.indexOf(';');
+			if (indexParams >= 0) {
+				coding = item.substring(0, indexParams);
+				String params = item.substring(indexParams + 1).trim();
+				if (params.startsWith("q=") || params.startsWith("Q=")) {
+					double q = 1;
+					if (params.substring(2).trim().parseDouble(&q) && q <= 0) {
+						state = -1;
+					}
+				}
+			}
+			coding = coding.trim();
+			if (coding.equalsIgnoreCase(_g_sz_http_content_encoding_gzip)) {
+				stateGzip = state;
+			} else if (coding.equalsIgnoreCase(_g_sz_http_content_encoding_deflate)) {
+				stateDeflate = state;
+			} else if (coding == "*") {
+				stateAny = state;
+			}
+		}
+		// `*` applies only to the codings not listed
+		if (stateGzip > 0 || (!stateGzip && stateAny > 0)) {
+			return HttpContentEncoding::Gzip;
+		}
+		if (stateDeflate > 0 || (!stateDeflate && stateAny > 0)) {
+			return HttpContentEncoding::Deflate;
+		}
+		return HttpContentEncoding::Identity;
+	}
+
+
 #define DEFINE_HTTP_HEADER(name, value) \
 	SLIB_STATIC_STRING(static_##name, value); \
 	const String& HttpHeaders::name = static_##name;
@@ -162,6 +220,7 @@ namespace slib
 	DEFINE_HTTP_HEADER(TransferEncoding, "Transfer-Encoding")
 	DEFINE_HTTP_HEADER(ContentEncoding, "Content-Encoding")
 	DEFINE_HTTP_HEADER(Connection, "Connection")
+	DEFINE_HTTP_HEADER(Vary, "Vary")
 
 	DEFINE_HTTP_HEADER(Range, "Range")
 	DEFINE_HTTP_HEADER(ContentRange, "Content-Range")
@@ -173,43 +232,36 @@ namespace slib
 	DEFINE_HTTP_HEADER(SetCookie, "Set-Cookie")
 	DEFINE_HTTP_HEADER(Cookie, "Cookie")
 
-	sl_reg HttpHeaders::parseHeaders(HttpHeaderMap& map, const void* _data, sl_size size)
+	/*
+		Calls `onField(posName, lengthName, posValue, lengthValue)` for each header line.
+		Line ends and colons are located by `Base::findMemory()` (vectorized `memchr`) instead of byte-by-byte loops.
+	*/
+	template <class FIELD_CALLBACK>
+	static sl_reg _priv_HttpHeaders_scan(const sl_char8* data, sl_size size, const FIELD_CALLBACK& onField)
 	{
-		const sl_char8* data = (const sl_char8*)_data;
 		sl_size posCurrent = 0;
-
-		// headers
 		for (;;) {
+			if (posCurrent >= size) {
+				return 0;
+			}
 			sl_size posStart = posCurrent;
-			sl_size indexSplit = 0;
-			while (posCurrent < size) {
-				sl_char8 ch = data[posCurrent];
-				if (ch == '\r') {
-					break;
-				}
-				if (indexSplit == 0) {
-					if (ch == ':') {
-						indexSplit = posCurrent;
-					}
-				}
-				posCurrent++;
+			const sl_char8* cr = (const sl_char8*)(Base::findMemory(data + posCurrent, '\r', size - posCurrent));
+			if (!cr) {
+				return 0;
 			}
-			if (posCurrent >= size - 1) {
+			posCurrent = cr - data;
+			if (posCurrent + 1 >= size) {
 				return 0;
 			}
 			if (data[posCurrent + 1] != '\n') {
 				return -1;
 			}
-
 			if (posCurrent == posStart) {
-				posCurrent += 2;
-				break;
+				return posCurrent + 2;
 			}
-
-			String name;
-			String value;
-			if (indexSplit != 0) {
-				name = String::fromUtf8(data + posStart, indexSplit - posStart);
+			const sl_char8* colon = (const sl_char8*)(Base::findMemory(data + posStart, ':', posCurrent - posStart));
+			if (colon) {
+				sl_size indexSplit = colon - data;
 				sl_size startValue = indexSplit + 1;
 				sl_size endValue = posCurrent;
 				while (startValue < endValue) {
@@ -224,14 +276,52 @@ namespace slib
 					}
 					endValue--;
 				}
-				value = Url::decodeUriComponentByUTF8(String::fromUtf8(data + startValue, endValue - startValue));
+				onField(posStart, indexSplit - posStart, startValue, endValue - startValue);
 			} else {
-				name = String::fromUtf8(data + posStart, posCurrent - posStart);
+				onField(posStart, posCurrent - posStart, posCurrent, 0);
 			}
-			map.add_NoLock(name, value);
 			posCurrent += 2;
 		}
-		return posCurrent;
+	}
+	
+	static sl_bool _priv_HttpHeaders_equalsName(const sl_char8* s1, const sl_char8* s2, sl_size len)
+	{
+		for (sl_size i = 0; i < len; i++) {
+			sl_char8 c1 = s1[i];
+			sl_char8 c2 = s2[i];
+			if (c1 != c2) {
+				if (c1 >= 'A' && c1 <= 'Z') {
+					c1 += 'a' - 'A';
+				}
+				if (c2 >= 'A' && c2 <= 'Z') {
+					c2 += 'a' - 'A';
+				}
+				if (c1 != c2) {
+					return sl_false;
+				}
+			}
+		}
+		return sl_true;
+	}
+	
+	static String _priv_HttpHeaders_getValue(const sl_char8* value, sl_size length)
+	{
+		if (!length) {
+			return String::getEmpty();
+		}
+		if (Base::findMemory(value, '%', length)) {
+			return Url::decodeUriComponentByUTF8(String::fromUtf8(value, length));
+		} else {
+			return String::fromUtf8(value, length);
+		}
+	}
+
+	sl_reg HttpHeaders::parseHeaders(HttpHeaderMap& map, const void* _data, sl_size size)
+	{
+		const sl_char8* data = (const sl_char8*)_data;
+		return _priv_HttpHeaders_scan(data, size, [&map, data](sl_size posName, sl_size lengthName, sl_size posValue, sl_size lengthValue) {
+			map.add_NoLock(String::fromUtf8(data + posName, lengthName), _priv_HttpHeaders_getValue(data + posValue, lengthValue));
+		});
 	}
 
 
@@ -247,6 +337,8 @@ namespace slib
 		SLIB_STATIC_STRING(s2, "GET");
 		m_methodText = s2;
 		m_methodTextUpper = s2;
+		m_countRequestHeaderFields = 0;
+		m_flagLazyRequestHeaders = sl_false;
 	}
 
 	HttpRequest::~HttpRequest()
@@ -314,41 +406,75 @@ namespace slib
 
 	const HttpHeaderMap& HttpRequest::getRequestHeaders() const
 	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
 		return m_requestHeaders;
 	}
 
 	String HttpRequest::getRequestHeader(String name) const
 	{
+		if (m_flagLazyRequestHeaders) {
+			sl_int32 index = _findLazyRequestHeader(name);
+			if (index >= 0) {
+				return _getLazyRequestHeaderValue(m_requestHeaderFields[index]);
+			}
+			return sl_null;
+		}
 		return m_requestHeaders.getValue_NoLock(name, String::null());
 	}
 
 	List<String> HttpRequest::getRequestHeaderValues(String name) const
 	{
+		if (m_flagLazyRequestHeaders) {
+			List<String> ret;
+			sl_int32 index = _findLazyRequestHeader(name);
+			while (index >= 0) {
+				ret.add_NoLock(_getLazyRequestHeaderValue(m_requestHeaderFields[index]));
+				index = _findLazyRequestHeader(name, index + 1);
+			}
+			return ret;
+		}
 		return m_requestHeaders.getValues_NoLock(name);
 	}
 
 	void HttpRequest::setRequestHeader(String name, String value)
 	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
 		m_requestHeaders.put_NoLock(name, value);
 	}
 
 	void HttpRequest::addRequestHeader(String name, String value)
 	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
 		m_requestHeaders.add_NoLock(name, value);
 	}
 
 	sl_bool HttpRequest::containsRequestHeader(String name) const
 	{
+		if (m_flagLazyRequestHeaders) {
+			return _findLazyRequestHeader(name) >= 0;
+		}
 		return m_requestHeaders.find_NoLock(name) != sl_null;
 	}
 
 	void HttpRequest::removeRequestHeader(String name)
 	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
 		m_requestHeaders.removeItems_NoLock(name);
 	}
 
 	void HttpRequest::clearRequestHeaders()
 	{
+		m_flagLazyRequestHeaders = sl_false;
+		m_countRequestHeaderFields = 0;
+		m_requestPacket.setNull();
 		m_requestHeaders.removeAll_NoLock();
 	}
 
@@ -551,6 +677,9 @@ namespace slib
 
 	void HttpRequest::applyQueryToParameters()
 	{
+		if (m_query.isEmpty()) {
+			return;
+		}
 		HashMap<String, String> params = parseParameters(m_query);
 		m_queryParameters.putAll_NoLock(params);
 		m_parameters.putAll_NoLock(params);
@@ -618,7 +747,7 @@ namespace slib
 		msg.addStatic(strVersion.getData(), strVersion.getLength());
 		msg.addStatic("\r\n", 2);
 
-		for (auto& pair : m_requestHeaders) {
+		for (auto& pair : getRequestHeaders()) {
 			String str = pair.key;
 			msg.addStatic(str.getData(), str.getLength());
 			msg.addStatic(": ", 2);
@@ -631,6 +760,69 @@ namespace slib
 	}
 
 	sl_reg HttpRequest::parseRequestPacket(const void* packet, sl_size size)
+	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
+		sl_reg posHeaders = _parseRequestLine(packet, size);
+		if (posHeaders <= 0) {
+			return posHeaders;
+		}
+		sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, (const sl_char8*)packet + posHeaders, size - posHeaders);
+		if (iRet > 0) {
+			return posHeaders + iRet;
+		} else {
+			return iRet;
+		}
+	}
+
+	sl_reg HttpRequest::parseRequestPacketLazily(const Memory& packet, sl_size size)
+	{
+		if (m_flagLazyRequestHeaders) {
+			_buildRequestHeaders();
+		}
+		if (size > packet.getSize()) {
+			return -1;
+		}
+		const sl_char8* data = (const sl_char8*)(packet.getData());
+		sl_reg posHeaders = _parseRequestLine(data, size);
+		if (posHeaders <= 0) {
+			return posHeaders;
+		}
+		if (m_requestHeaders.isNotEmpty() || size > 0xFFFFFFFF) {
+			// keeps the order of the existing headers
+			sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, data + posHeaders, size - posHeaders);
+			return iRet > 0 ? posHeaders + iRet : iRet;
+		}
+		sl_uint32 nFields = 0;
+		sl_bool flagOverflow = sl_false;
+		HttpHeaderField* fields = m_requestHeaderFields;
+		sl_reg iRet = _priv_HttpHeaders_scan(data + posHeaders, size - posHeaders, [fields, posHeaders, &nFields, &flagOverflow](sl_size posName, sl_size lengthName, sl_size posValue, sl_size lengthValue) {
+			if (nFields < SLIB_HTTP_MAX_LAZY_HEADER_FIELDS) {
+				HttpHeaderField& field = fields[nFields];
+				field.name = (sl_uint32)(posHeaders + posName);
+				field.nameLength = (sl_uint32)lengthName;
+				field.value = (sl_uint32)(posHeaders + posValue);
+				field.valueLength = (sl_uint32)lengthValue;
+				nFields++;
+			} else {
+				flagOverflow = sl_true;
+			}
+		});
+		if (iRet <= 0) {
+			return iRet;
+		}
+		if (flagOverflow) {
+			HttpHeaders::parseHeaders(m_requestHeaders, data + posHeaders, size - posHeaders);
+		} else {
+			m_requestPacket = packet;
+			m_countRequestHeaderFields = nFields;
+			m_flagLazyRequestHeaders = sl_true;
+		}
+		return posHeaders + iRet;
+	}
+
+	sl_reg HttpRequest::_parseRequestLine(const void* packet, sl_size size)
 	{
 		const sl_char8* data = (const sl_char8*)packet;
 		sl_size posCurrent = 0;
@@ -649,9 +841,23 @@ namespace slib
 		if (posCurrent == size) {
 			return 0;
 		}
-		setMethod(String::fromUtf8(data + posStart, posCurrent - posStart));
+		{
+			sl_bool flagFound = sl_false;
+			for (int i = (int)(HttpMethod::GET); i <= (int)(HttpMethod::TRACE); i++) {
+				String method = HttpMethods::toString((HttpMethod)i);
+				if (method.getLength() == posCurrent - posStart && Base::equalsMemory(method.getData(), data + posStart, posCurrent - posStart)) {
+					m_method = (HttpMethod)i;
+					m_methodText = method;
+					m_methodTextUpper = method;
+					flagFound = sl_true;
+					break;
+				}
+			}
+			if (!flagFound) {
+				setMethod(String::fromUtf8(data + posStart, posCurrent - posStart));
+			}
+		}
 		posCurrent++;
-
 		// uri
 		posStart = posCurrent;
 		sl_size posQuery = 0;
@@ -695,15 +901,66 @@ namespace slib
 		if (data[posCurrent + 1] != '\n') {
 			return -1;
 		}
-		setRequestVersion(String::fromUtf8(data + posStart, posCurrent - posStart));
+		{
+			SLIB_STATIC_STRING(s11, "HTTP/1.1");
+			SLIB_STATIC_STRING(s10, "HTTP/1.0");
+			sl_size lenVersion = posCurrent - posStart;
+			if (lenVersion == 8 && Base::equalsMemory(data + posStart, s11.getData(), 8)) {
+				m_requestVersion = s11;
+			} else if (lenVersion == 8 && Base::equalsMemory(data + posStart, s10.getData(), 8)) {
+				m_requestVersion = s10;
+			} else {
+				setRequestVersion(String::fromUtf8(data + posStart, lenVersion));
+			}
+		}
 		posCurrent += 2;
 
-		sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, data + posCurrent, size - posCurrent);
-		if (iRet > 0) {
-			return posCurrent + iRet;
-		} else {
-			return iRet;
+		return posCurrent;
+	}
+
+	void HttpRequest::_resetRequest()
+	{
+		SLIB_STATIC_STRING(s1, "HTTP/1.1");
+		m_requestVersion = s1;
+		m_method = HttpMethod::GET;
+		SLIB_STATIC_STRING(s2, "GET");
+		m_methodText = s2;
+		m_methodTextUpper = s2;
+		m_path.setNull();
+		m_query.setNull();
+		clearRequestHeaders();
+		m_parameters.removeAll_NoLock();
+		m_queryParameters.removeAll_NoLock();
+		m_postParameters.removeAll_NoLock();
+	}
+
+	void HttpRequest::_buildRequestHeaders() const
+	{
+		const sl_char8* data = (const sl_char8*)(m_requestPacket.getData());
+		for (sl_uint32 i = 0; i < m_countRequestHeaderFields; i++) {
+			const HttpHeaderField& field = m_requestHeaderFields[i];
+			m_requestHeaders.add_NoLock(String::fromUtf8(data + field.name, field.nameLength), _priv_HttpHeaders_getValue(data + field.value, field.valueLength));
+		}
+		m_flagLazyRequestHeaders = sl_false;
+	}
+
+	sl_int32 HttpRequest::_findLazyRequestHeader(const String& name, sl_uint32 indexStart) const
+	{
+		const sl_char8* data = (const sl_char8*)(m_requestPacket.getData());
+		const sl_char8* szName = name.getData();
+		sl_size lenName = name.getLength();
+		for (sl_uint32 i = indexStart; i < m_countRequestHeaderFields; i++) {
+			const HttpHeaderField& field = m_requestHeaderFields[i];
+			if (field.nameLength == lenName && _priv_HttpHeaders_equalsName(data + field.name, szName, lenName)) {
+				return (sl_int32)i;
+			}
 		}
+		return -1;
+	}
+
+	String HttpRequest::_getLazyRequestHeaderValue(const HttpHeaderField& field) const
+	{
+		return _priv_HttpHeaders_getValue((const sl_char8*)(m_requestPacket.getData()) + field.value, field.valueLength);
 	}
 
 
@@ -724,6 +981,16 @@ namespace slib
 	{
 	}
 
+	void HttpResponse::_resetResponse()
+	{
+		SLIB_STATIC_STRING(s1, "HTTP/1.1");
+		m_responseVersion = s1;
+		m_responseCode = HttpStatus::OK;
+		SLIB_STATIC_STRING(s2, "OK");
+		m_responseMessage = s2;
+		m_responseHeaders.removeAll_NoLock();
+	}
+
 	HttpStatus HttpResponse::getResponseCode() const
 	{
 		return m_responseCode;
@@ -22,6 +22,8 @@
 
 #include "slib/network/http_io.h"
 
+#include "slib/core/mutex.h"
+
 namespace slib
 {
 
@@ -109,13 +111,11 @@ namespace slib
 			posBody = 3;
 			flagFound = sl_true;
 		}
-		if (size > 3) {
-			for (sl_size i = 0; i <= size - 4; i++) {
-				if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
-					posBody = 4 + i;
-					flagFound = sl_true;
-					break;
-				}
+		if (!flagFound && size > 3) {
+			const sl_uint8* end = Base::findMemory(buf, size, "\r\n\r\n", 4);
+			if (end) {
+				posBody = 4 + (end - buf);
+				flagFound = sl_true;
 			}
 		}
 		if (flagFound) {
@@ -487,4 +487,115 @@ namespace slib
 		}
 	}
 
+/***********************************************************************
+						HttpContentEncoder
+***********************************************************************/
+
+	HttpContentEncoder::HttpContentEncoder()
+	{
+		m_encoding = HttpContentEncoding::Identity;
+		m_flagChunked = sl_false;
+		m_flagFinished = sl_false;
+	}
+
+	HttpContentEncoder::~HttpContentEncoder()
+	{
+	}
+
+	Ref<HttpContentEncoder> HttpContentEncoder::create(const Ref<AsyncStream>& io, HttpContentEncoding encoding, sl_bool flagChunked, sl_int32 compressionLevel)
+	{
+		Ref<HttpContentEncoder> ret = new HttpContentEncoder;
+		if (ret.isNotNull()) {
+			if (encoding == HttpContentEncoding::Gzip) {
+				if (!(ret->m_zlib.startGzip(compressionLevel))) {
+					return sl_null;
+				}
+			} else if (encoding == HttpContentEncoding::Deflate) {
+				if (!(ret->m_zlib.start(compressionLevel))) {
+					return sl_null;
+				}
+			}
+			ret->m_encoding = encoding;
+			ret->m_flagChunked = flagChunked;
+			ret->setSourceStream(io);
+		}
+		return ret;
+	}
+
+	HttpContentEncoding HttpContentEncoder::getEncoding()
+	{
+		return m_encoding;
+	}
+
+	sl_bool HttpContentEncoder::isChunked()
+	{
+		return m_flagChunked;
+	}
+
+	Memory HttpContentEncoder::encode(const void* data, sl_size size, sl_bool flagFinish)
+	{
+		if (m_flagFinished) {
+			return sl_null;
+		}
+		if (!size && !flagFinish) {
+			return sl_null;
+		}
+		Memory content;
+		if (m_encoding == HttpContentEncoding::Identity) {
+			if (size) {
+				content = Memory::create(data, size);
+				if (content.isNull()) {
+					return sl_null;
+				}
+			}
+		} else {
+			if (flagFinish) {
+				content = m_zlib.compress(data, size, sl_true);
+			} else {
+				content = m_zlib.compressAndFlush(data, size);
+			}
+			if (content.isNull()) {
+				return sl_null;
+			}
+		}
+		if (flagFinish) {
+			m_flagFinished = sl_true;
+		}
+		if (!m_flagChunked) {
+			return content;
+		}
+		MemoryBuffer buf;
+		sl_size sizeContent = content.getSize();
+		if (sizeContent) {
+			String header = String::fromUint64(sizeContent, 16, 0, sl_true) + "\r\n";
+			buf.add(header.toMemory());
+			buf.add(content);
+			buf.addStatic("\r\n", 2);
+		}
+		if (flagFinish) {
+			buf.addStatic("0\r\n\r\n", 5);
+		}
+		return buf.merge();
+	}
+
+	sl_bool HttpContentEncoder::finish(const Function<void(AsyncStreamResult*)>& callback)
+	{
+		MutexLocker lock(&m_lockWriting);
+		Ref<AsyncStream> stream = m_stream;
+		if (stream.isNull() || m_flagWritingError || m_flagWritingEnded) {
+			return sl_false;
+		}
+		Memory mem = encode(sl_null, 0, sl_true);
+		m_flagWritingEnded = sl_true;
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		return stream->write(mem.getData(), (sl_uint32)(mem.getSize()), callback, mem.ref.get());
+	}
+
+	Memory HttpContentEncoder::filterWrite(const void* data, sl_uint32 size, Referable* userObject)
+	{
+		return encode(data, size, sl_false);
+	}
+
 }
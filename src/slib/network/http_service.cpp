@@ -43,8 +43,14 @@ namespace slib
 
 	HttpServiceContext::HttpServiceContext()
 	{
+		m_requestHeaderSize = 0;
 		m_requestContentLength = 0;
 		m_flagAsynchronousResponse = sl_false;
+		m_flagChunkedResponse = sl_false;
+		m_sizeEncodingRemain = 0;
+		m_flagEncodingFinish = sl_false;
+		m_flagResponseCompleted = sl_false;
+		m_flagKeepAlive = sl_false;
 
 		setClosingConnection(sl_false);
 		setProcessingByThread(sl_true);
@@ -68,7 +74,11 @@ namespace slib
 
 	Memory HttpServiceContext::getRawRequestHeader() const
 	{
-		return m_requestHeader;
+		Memory header = m_requestHeader;
+		if (header.getSize() > m_requestHeaderSize) {
+			return header.sub(0, m_requestHeaderSize);
+		}
+		return header;
 	}
 
 	sl_uint64 HttpServiceContext::getRequestContentLength() const
@@ -162,17 +172,100 @@ namespace slib
 		}
 	}
 
+	void HttpServiceContext::flushResponse()
+	{
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNotNull()) {
+			connection->_flushResponse(this);
+		}
+	}
+
+	sl_bool HttpServiceContext::isChunkedResponse()
+	{
+		return m_flagChunkedResponse;
+	}
+
+#define SIZE_HEADER_ARENA 0x1000
+
+	void HttpServiceContext::_reset()
+	{
+		_resetRequest();
+		_resetResponse();
+		clearOutput();
+		m_requestHeaderReader.clear();
+		m_requestHeader.setNull();
+		m_requestHeaderSize = 0;
+		m_requestContentLength = 0;
+		m_requestBodyBuffer.clear();
+		m_requestBody.setNull();
+		m_flagAsynchronousResponse = sl_false;
+		m_flagChunkedResponse = sl_false;
+		m_encoderResponse.setNull();
+		m_streamEncoding.setNull();
+		m_sizeEncodingRemain = 0;
+		m_flagEncodingFinish = sl_false;
+		m_responseHeaderPacket.setNull();
+		m_flagResponseCompleted = sl_false;
+		m_flagKeepAlive = sl_false;
+		setClosingConnection(sl_false);
+		// the properties set by the handlers of the previous request
+		clearAllProperties();
+	}
+
+	sl_bool HttpServiceContext::_setRequestHeader(const void* data, sl_size size)
+	{
+		// the arena is overwritten only when no one keeps the header of the previous request
+		if (m_requestHeaderArena.getSize() < size || m_requestHeaderArena.ref->getReferenceCount() > 1) {
+			m_requestHeaderArena = Memory::create(size > SIZE_HEADER_ARENA ? size : SIZE_HEADER_ARENA);
+			if (m_requestHeaderArena.isNull()) {
+				return sl_false;
+			}
+		}
+		Base::copyMemory(m_requestHeaderArena.getData(), data, size);
+		m_requestHeader = m_requestHeaderArena;
+		m_requestHeaderSize = size;
+		return sl_true;
+	}
+
 /******************************************************
 			HttpServiceConnection
 ******************************************************/
 #define SIZE_READ_BUF 0x10000
 #define SIZE_COPY_BUF 0x10000
 
+	// HTTP/1.1 connections are persistent unless `Connection: close`
+	static sl_bool _priv_HttpServiceConnection_isKeepAlive(HttpServiceContext* context)
+	{
+		if (context->isClosingConnection()) {
+			return sl_false;
+		}
+		if (context->getMethod() == HttpMethod::CONNECT) {
+			// tunneling is not supported: the connection is closed after the response
+			return sl_false;
+		}
+		SLIB_STATIC_STRING(strVersion, "HTTP/1.1");
+		if (context->getRequestVersion() == strVersion) {
+			SLIB_STATIC_STRING(strClose, "close");
+			return !(context->getRequestHeader(HttpHeaders::Connection).equalsIgnoreCase(strClose));
+		}
+		return context->isKeepAlive();
+	}
+
+	static sl_uint32 _priv_HttpServiceConnection_getMaxPipelinedRequests(HttpService* service)
+	{
+		sl_uint32 n = service->getParam().maxPipelinedRequestsCount;
+		if (!n) {
+			n = 1;
+		}
+		return n;
+	}
+
 	HttpServiceConnection::HttpServiceConnection()
 	{
 		m_flagClosed = sl_true;
 		m_flagReading = sl_false;
 		m_flagKeepAlive = sl_true;
+		m_flagPausedInput = sl_false;
 	}
 
 	HttpServiceConnection::~HttpServiceConnection()
@@ -213,6 +306,8 @@ namespace slib
 			return;
 		}
 		m_flagClosed = sl_true;
+		m_queueContexts.removeAll_NoLock();
+		m_bufPending.setNull();
 		
 		Ref<HttpService> service = m_service;
 		if (service.isNotNull()) {
@@ -263,113 +358,229 @@ namespace slib
 		}
 	}
 
+	Ref<HttpServiceContext> HttpServiceConnection::_createContext()
+	{
+		Ref<HttpServiceContext> context = m_contextReusable;
+		if (context.isNotNull()) {
+			m_contextReusable.setNull();
+			// reuses the context of the previous request only when no one keeps it
+			if (context->getReferenceCount() == 1) {
+				context->_reset();
+				return context;
+			}
+		}
+		return HttpServiceContext::create(this);
+	}
+
 	void HttpServiceConnection::_processInput(const void* _data, sl_uint32 size)
 	{
 		Ref<HttpService> service = m_service;
 		if (service.isNull()) {
 			return;
 		}
-		if (m_flagClosed) {
-			return;
+		sl_uint32 maxPipelinedRequests = _priv_HttpServiceConnection_getMaxPipelinedRequests(service.get());
+		const sl_uint8* data = (const sl_uint8*)_data;
+		// one read can contain several pipelined requests
+		for (;;) {
+			if (m_flagClosed) {
+				return;
+			}
+			sl_bool flagCompleted = sl_false;
+			sl_reg nUsed = _processRequestInput(service.get(), data, size, flagCompleted);
+			if (nUsed < 0) {
+				// the service took the connection, or no more request is accepted on this connection
+				return;
+			}
+			data += nUsed;
+			size -= (sl_uint32)nUsed;
+			if (!flagCompleted) {
+				_read();
+				return;
+			}
+			ObjectLocker lock(this);
+			if (m_queueContexts.getCount() >= maxPipelinedRequests) {
+				// resumed by `_resumeInput()` when a response is written
+				if (size) {
+					m_bufPending = Memory::create(data, size);
+					if (m_bufPending.isNull()) {
+						lock.unlock();
+						close();
+						return;
+					}
+				}
+				m_flagPausedInput = sl_true;
+				return;
+			}
+			if (!size) {
+				lock.unlock();
+				_read();
+				return;
+			}
 		}
-		
+	}
+
+	sl_reg HttpServiceConnection::_processRequestInput(HttpService* service, const sl_uint8* data, sl_uint32 size, sl_bool& flagCompleted)
+	{
 		const HttpServiceParam& param = service->getParam();
 		sl_uint64 maxRequestHeadersSize = param.maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
 
-		char* data = (char*)_data;
 		Ref<HttpServiceContext> _context = m_contextCurrent;
 		if (_context.isNull()) {
-			_context = HttpServiceContext::create(this);
+			_context = _createContext();
 			if (_context.isNull()) {
-				sendResponse_ServerError();
-				return;
+				close();
+				return -1;
 			}
 			m_contextCurrent = _context;
 			_context->setProcessingByThread(param.flagProcessByThreads);
 		}
 		HttpServiceContext* context = _context.get();
+		sl_uint32 sizeUsed = size;
 		if (context->m_requestHeader.isNull()) {
-			sl_size posBody;
-			if (context->m_requestHeaderReader.add(data, size, posBody)) {
-				context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
-				if (context->m_requestHeader.isNull()) {
-					sendResponse_ServerError();
-					return;
+			sl_size posBody = 0;
+			sl_bool flagHeaderCompleted = sl_false;
+			if (!(context->m_requestHeaderReader.getHeaderSize()) && size >= 4) {
+				// the whole header is in this chunk: copied into the header arena without merging
+				const sl_uint8* endHeader = Base::findMemory(data, size, "\r\n\r\n", 4);
+				if (endHeader) {
+					posBody = (endHeader + 4) - data;
+					if (!(context->_setRequestHeader(data, posBody))) {
+						_processRequestError(context, HttpStatus::InternalServerError);
+						return -1;
+					}
+					flagHeaderCompleted = sl_true;
 				}
-				if (posBody > size) {
-					sendResponse_ServerError();
-					return;
+			}
+			if (!flagHeaderCompleted) {
+				if (context->m_requestHeaderReader.add(data, size, posBody)) {
+					Memory header = context->m_requestHeaderReader.mergeHeader();
+					if (header.isNull()) {
+						_processRequestError(context, HttpStatus::InternalServerError);
+						return -1;
+					}
+					if (posBody > size) {
+						_processRequestError(context, HttpStatus::InternalServerError);
+						return -1;
+					}
+					context->m_requestHeader = header;
+					context->m_requestHeaderSize = header.getSize();
+					context->m_requestHeaderReader.clear();
+					flagHeaderCompleted = sl_true;
+				} else {
+					if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
+						_processRequestError(context, HttpStatus::BadRequest);
+						return -1;
+					}
 				}
-				context->m_requestHeaderReader.clear();
-				Memory header = context->getRawRequestHeader();
-				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
-				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
-					sendResponse_BadRequest();
-					return;
+			}
+			if (flagHeaderCompleted) {
+				Memory header = context->m_requestHeader;
+				sl_reg iRet = context->parseRequestPacketLazily(header, context->m_requestHeaderSize);
+				if (iRet != (sl_reg)(context->m_requestHeaderSize)) {
+					_processRequestError(context, HttpStatus::BadRequest);
+					return -1;
 				}
 				context->m_requestContentLength = context->getRequestContentLengthHeader();
 				if (context->m_requestContentLength > maxRequestBodySize) {
-					sendResponse_BadRequest();
-					return;
+					_processRequestError(context, HttpStatus::BadRequest);
+					return -1;
 				}
-				context->m_requestBody = Memory::create(data + posBody, size - (sl_uint32)posBody);
-				if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
-					sendResponse_ServerError();
-					return;
+				sizeUsed = (sl_uint32)posBody;
+				if (posBody < size && context->m_requestContentLength > 0) {
+					// the rest after the body belongs to the next request
+					sl_uint32 sizeBody = (sl_uint32)(SLIB_MIN(size - posBody, context->m_requestContentLength));
+					context->m_requestBody = Memory::create(data + posBody, sizeBody);
+					if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
+						_processRequestError(context, HttpStatus::InternalServerError);
+						return -1;
+					}
+					sizeUsed += sizeBody;
 				}
 				context->applyQueryToParameters();
 				if (service->preprocessRequest(context)) {
-					return;
+					return -1;
 				}
 			} else {
-				if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
-					sendResponse_BadRequest();
-					return;
-				}
+				return size;
 			}
 		} else {
-			if (!(context->m_requestBodyBuffer.add(Memory::create(data, size)))) {
-				sendResponse_ServerError();
-				return;
+			sl_uint64 sizeRemain = context->m_requestContentLength - context->m_requestBodyBuffer.getSize();
+			if (sizeRemain < size) {
+				sizeUsed = (sl_uint32)sizeRemain;
+			}
+			if (!(context->m_requestBodyBuffer.add(Memory::create(data, sizeUsed)))) {
+				_processRequestError(context, HttpStatus::InternalServerError);
+				return -1;
 			}
 		}
 		
-		if (context->m_requestHeader.isNotNull()) {
-			
-			if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
+		if (context->m_requestBodyBuffer.getSize() < context->m_requestContentLength) {
+			return sizeUsed;
+		}
+		
+		m_contextCurrent.setNull();
 
-				m_contextCurrent.setNull();
+		context->m_requestBody = context->m_requestBodyBuffer.merge();
+		if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
+			_processRequestError(context, HttpStatus::InternalServerError);
+			return -1;
+		}
+		context->m_requestBodyBuffer.clear();
 
-				context->m_requestBody = context->m_requestBodyBuffer.merge();
-				if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
-					sendResponse_ServerError();
-					return;
-				}
-				context->m_requestBodyBuffer.clear();
+		if (context->getMethod() == HttpMethod::POST) {
+			String reqContentType = context->getRequestContentTypeNoParams();
+			if (reqContentType == ContentTypes::WebForm) {
+				Memory body = context->getRequestBody();
+				context->applyPostParameters(body.getData(), body.getSize());
+			}
+		}
+		
+		context->m_flagKeepAlive = _priv_HttpServiceConnection_isKeepAlive(context);
+		{
+			ObjectLocker lock(this);
+			if (!(m_queueContexts.pushBack_NoLock(_context))) {
+				lock.unlock();
+				close();
+				return -1;
+			}
+		}
+		flagCompleted = sl_true;
+		
+		if (context->isProcessingByThread()) {
+			Ref<ThreadPool> threadPool = service->getThreadPool();
+			if (threadPool.isNotNull()) {
+				threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
+			} else {
+				context->m_flagKeepAlive = sl_false;
+				context->setResponseCode(HttpStatus::InternalServerError);
+				_completeResponse(context);
+			}
+		} else {
+			_processContext(context);
+		}
+		if (!(context->m_flagKeepAlive)) {
+			return -1;
+		}
+		return sizeUsed;
+	}
 
-				if (context->getMethod() == HttpMethod::POST) {
-					String reqContentType = context->getRequestContentTypeNoParams();
-					if (reqContentType == ContentTypes::WebForm) {
-						Memory body = context->getRequestBody();
-						context->applyPostParameters(body.getData(), body.getSize());
-					}
-				}
-				
-				if (context->isProcessingByThread()) {
-					Ref<ThreadPool> threadPool = service->getThreadPool();
-					if (threadPool.isNotNull()) {
-						threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
-					} else {
-						sendResponse_ServerError();
-					}
-				} else {
-					_processContext(context);
-				}
+	void HttpServiceConnection::_processRequestError(HttpServiceContext* context, HttpStatus status)
+	{
+		// the position of the next request is unknown: responds in order, and closes the connection
+		m_contextCurrent.setNull();
+		context->m_flagKeepAlive = sl_false;
+		context->setResponseCode(status);
+		context->clearOutput();
+		{
+			ObjectLocker lock(this);
+			if (!(m_queueContexts.pushBack_NoLock(context))) {
+				lock.unlock();
+				close();
 				return;
 			}
 		}
-		_read();
+		_completeResponse(context);
 	}
 
 	void HttpServiceConnection::_processContext(const Ref<HttpServiceContext>& context)
@@ -379,7 +590,12 @@ namespace slib
 			return;
 		}
 		if (context->getMethod() == HttpMethod::CONNECT) {
-			sendConnectResponse_Failed();
+			// responds in order with the other pipelined requests
+			SLIB_STATIC_STRING(strMessage, "Tunneling is not supported");
+			context->clearOutput();
+			context->setResponseCode(HttpStatus::InternalServerError);
+			context->setResponseMessage(strMessage);
+			context->completeResponse();
 			return;
 		}
 		service->processRequest(context.get());
@@ -390,29 +606,331 @@ namespace slib
 
 	void HttpServiceConnection::_completeResponse(HttpServiceContext* context)
 	{
-		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
-		String oldResponseContentType = context->getResponseContentType();
-		if (oldResponseContentType.isEmpty()) {
-			context->setResponseContentType(ContentTypes::TextHtml_Utf8);
+		if (context->isClosingConnection()) {
+			context->m_flagKeepAlive = sl_false;
 		}
-		Memory header = context->makeResponsePacket();
-		if (header.isNull()) {
-			close();
+		if (context->m_flagChunkedResponse) {
+			// only the front of the queue sends chunks
+			MutexLocker lockWrite(&m_lockWrite);
+			if (!(_writeResponseChunk(context, sl_true))) {
+				lockWrite.unlock();
+				close();
+				return;
+			}
+			if (context->m_streamEncoding.isNotNull()) {
+				// the end is written and the response is completed when the stream is read through the encoder
+				context->m_flagEncodingFinish = sl_true;
+				return;
+			}
+		} else {
+			// prepared on the calling thread, and written when all the previous responses are written
+			String oldResponseContentType = context->getResponseContentType();
+			if (oldResponseContentType.isEmpty()) {
+				context->setResponseContentType(ContentTypes::TextHtml_Utf8);
+			}
+			HttpContentEncoding encoding = _getResponseEncoding(context, sl_false);
+			if (encoding != HttpContentEncoding::Identity) {
+				Memory content;
+				if (context->m_bufferOutput.mergeOutput(content)) {
+					Ref<HttpService> service = m_service;
+					sl_int32 level = service.isNotNull() ? service->getParam().compressionLevel : 6;
+					Memory compressed;
+					if (encoding == HttpContentEncoding::Gzip) {
+						compressed = Zlib::compressGzip(content.getData(), content.getSize(), level);
+					} else {
+						compressed = Zlib::compress(content.getData(), content.getSize(), level);
+					}
+					if (compressed.isNotNull() && compressed.getSize() < content.getSize()) {
+						context->setResponseHeader(HttpHeaders::ContentEncoding, HttpContentEncodings::toString(encoding));
+						context->m_bufferOutput.write(compressed);
+					} else {
+						context->m_bufferOutput.write(content);
+					}
+				}
+			}
+			if (!(context->m_flagKeepAlive)) {
+				SLIB_STATIC_STRING(strClose, "close");
+				context->setResponseHeader(HttpHeaders::Connection, strClose);
+			}
+			context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
+			context->m_responseHeaderPacket = context->makeResponsePacket();
+			if (context->m_responseHeaderPacket.isNull()) {
+				close();
+				return;
+			}
+		}
+		_setResponseCompleted(context);
+	}
+
+	void HttpServiceConnection::_setResponseCompleted(HttpServiceContext* context)
+	{
+		{
+			ObjectLocker lock(this);
+			context->m_flagResponseCompleted = sl_true;
+		}
+		_writeCompletedResponses();
+		_resumeInput();
+	}
+
+	void HttpServiceConnection::_writeCompletedResponses()
+	{
+		MutexLocker lockWrite(&m_lockWrite);
+		// the ready responses are queued together, so that small responses are sent by one write
+		sl_bool flagWritten = sl_false;
+		for (;;) {
+			Ref<HttpServiceContext> context;
+			sl_bool flagLast = sl_false;
+			{
+				ObjectLocker lock(this);
+				if (!(m_queueContexts.getFrontValue_NoLock(&context))) {
+					break;
+				}
+				if (!(context->m_flagResponseCompleted)) {
+					break;
+				}
+				m_queueContexts.popFront_NoLock();
+				if (context->m_flagKeepAlive) {
+					m_contextReusable = context;
+				} else {
+					m_queueContexts.removeAll_NoLock();
+					m_contextCurrent.setNull();
+					m_bufPending.setNull();
+					flagLast = sl_true;
+				}
+			}
+			if (!(context->m_flagChunkedResponse)) {
+				if (!(m_output->write(context->m_responseHeaderPacket))) {
+					lockWrite.unlock();
+					close();
+					return;
+				}
+				context->m_responseHeaderPacket.setNull();
+				m_output->mergeBuffer(&(context->m_bufferOutput));
+			}
+			flagWritten = sl_true;
+			if (flagLast) {
+				// cleared after the last response is queued: the end of the previous output must not close the connection before it
+				m_flagKeepAlive = sl_false;
+				break;
+			}
+		}
+		if (flagWritten) {
+			m_output->startWriting();
+		}
+	}
+
+	void HttpServiceConnection::_resumeInput()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagPausedInput || m_flagClosed || !m_flagKeepAlive) {
 			return;
 		}
-		if (!(m_output->write(header))) {
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return;
+		}
+		if (m_queueContexts.getCount() >= _priv_HttpServiceConnection_getMaxPipelinedRequests(service.get())) {
+			return;
+		}
+		m_flagPausedInput = sl_false;
+		Memory pending = m_bufPending;
+		m_bufPending.setNull();
+		lock.unlock();
+		if (pending.isNotNull()) {
+			_processInput(pending.getData(), (sl_uint32)(pending.getSize()));
+		} else {
+			_read();
+		}
+	}
+
+	void HttpServiceConnection::_flushResponse(HttpServiceContext* context)
+	{
+		MutexLocker lockWrite(&m_lockWrite);
+		{
+			ObjectLocker lock(this);
+			Ref<HttpServiceContext> front;
+			if (!(m_queueContexts.getFrontValue_NoLock(&front)) || front.get() != context) {
+				// a previous response is not written yet: the output is sent at completion
+				return;
+			}
+		}
+		if (!(context->m_flagChunkedResponse)) {
+			SLIB_STATIC_STRING(strVersion, "HTTP/1.1");
+			if (context->getRequestVersion() != strVersion) {
+				return;
+			}
+			String oldResponseContentType = context->getResponseContentType();
+			if (oldResponseContentType.isEmpty()) {
+				context->setResponseContentType(ContentTypes::TextHtml_Utf8);
+			}
+			HttpContentEncoding encoding = _getResponseEncoding(context, sl_true);
+			if (encoding != HttpContentEncoding::Identity) {
+				Memory content;
+				if (context->m_bufferOutput.mergeOutput(content)) {
+					Ref<HttpService> service = m_service;
+					sl_int32 level = service.isNotNull() ? service->getParam().compressionLevel : 6;
+					context->m_encoderResponse = HttpContentEncoder::create(sl_null, encoding, sl_true, level);
+					if (context->m_encoderResponse.isNotNull()) {
+						context->setResponseHeader(HttpHeaders::ContentEncoding, HttpContentEncodings::toString(encoding));
+					}
+					context->m_bufferOutput.write(content);
+				}
+			}
+			if (!(context->m_flagKeepAlive)) {
+				SLIB_STATIC_STRING(strClose, "close");
+				context->setResponseHeader(HttpHeaders::Connection, strClose);
+			}
+			SLIB_STATIC_STRING(strChunked, "chunked");
+			context->removeResponseHeader(HttpHeaders::ContentLength);
+			context->setResponseHeader(HttpHeaders::TransferEncoding, strChunked);
+			Memory header = context->makeResponsePacket();
+			if (header.isNull()) {
+				close();
+				return;
+			}
+			if (!(m_output->write(header))) {
+				close();
+				return;
+			}
+			context->m_flagChunkedResponse = sl_true;
+		}
+		if (!(_writeResponseChunk(context, sl_false))) {
 			close();
 			return;
 		}
-		m_output->mergeBuffer(&(context->m_bufferOutput));
-		if (context->isKeepAlive()) {
-			m_output->startWriting();
-			start();
+		m_output->startWriting();
+	}
+
+	sl_bool HttpServiceConnection::_writeResponseChunk(HttpServiceContext* context, sl_bool flagFinish)
+	{
+		if (context->m_encoderResponse.isNotNull()) {
+			return _writeEncodedOutput(context, flagFinish);
+		}
+		SLIB_STATIC_STRING(strCRLF, "\r\n");
+		Memory content;
+		if (context->m_bufferOutput.mergeOutput(content)) {
+			if (content.isNotNull()) {
+				String size = String::fromUint64(content.getSize(), 16, 0, sl_true) + strCRLF;
+				if (!(m_output->write(size.toMemory()) && m_output->write(content) && m_output->write(strCRLF.toMemory()))) {
+					return sl_false;
+				}
+			}
 		} else {
-			m_contextCurrent.setNull();
-			m_flagKeepAlive = sl_false;
-			m_output->startWriting();
+			String size = String::fromUint64(context->getOutputLength(), 16, 0, sl_true) + strCRLF;
+			if (!(m_output->write(size.toMemory()))) {
+				return sl_false;
+			}
+			m_output->mergeBuffer(&(context->m_bufferOutput));
+			context->m_bufferOutput.clearOutput();
+			if (!(m_output->write(strCRLF.toMemory()))) {
+				return sl_false;
+			}
+		}
+		if (flagFinish) {
+			return m_output->write(Memory::createStatic("0\r\n\r\n", 5));
+		}
+		return sl_true;
+	}
+
+	sl_bool HttpServiceConnection::_writeEncodedOutput(HttpServiceContext* context, sl_bool flagFinish)
+	{
+		if (context->m_streamEncoding.isNotNull()) {
+			// the output following the stream is encoded after it
+			return sl_true;
+		}
+		Ref<HttpContentEncoder> encoder = context->m_encoderResponse;
+		for (;;) {
+			Memory data;
+			Ref<AsyncStream> stream;
+			sl_uint64 sizeStream = 0;
+			if (!(context->m_bufferOutput.popFront(data, stream, sizeStream))) {
+				break;
+			}
+			if (stream.isNotNull()) {
+				context->m_streamEncoding = stream;
+				context->m_sizeEncodingRemain = sizeStream;
+				if (!(_readEncodingStream(context))) {
+					return sl_false;
+				}
+				if (context->m_streamEncoding.isNotNull()) {
+					return sl_true;
+				}
+				continue;
+			}
+			Memory chunk = encoder->encode(data.getData(), data.getSize(), sl_false);
+			if (chunk.isNull() || !(m_output->write(chunk))) {
+				return sl_false;
+			}
+		}
+		if (flagFinish) {
+			// ends the compressed data, and appends the last chunk
+			Memory chunk = encoder->encode(sl_null, 0, sl_true);
+			if (chunk.isNull()) {
+				return sl_false;
+			}
+			return m_output->write(chunk);
 		}
+		return sl_true;
+	}
+
+	sl_bool HttpServiceConnection::_readEncodingStream(HttpServiceContext* context)
+	{
+		if (context->m_bufEncoding.isNull()) {
+			context->m_bufEncoding = Memory::create(SIZE_COPY_BUF);
+			if (context->m_bufEncoding.isNull()) {
+				return sl_false;
+			}
+		}
+		sl_uint32 size = (sl_uint32)(Math::min(context->m_sizeEncodingRemain, (sl_uint64)(context->m_bufEncoding.getSize())));
+		return context->m_streamEncoding->read(context->m_bufEncoding.getData(), size, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadEncodingStream, this), context);
+	}
+
+	HttpContentEncoding HttpServiceConnection::_getResponseEncoding(HttpServiceContext* context, sl_bool flagChunked)
+	{
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return HttpContentEncoding::Identity;
+		}
+		const HttpServiceParam& param = service->getParam();
+		if (!(param.flagCompressResponse)) {
+			return HttpContentEncoding::Identity;
+		}
+		if (context->getResponseCode() != HttpStatus::OK || context->getMethod() == HttpMethod::HEAD) {
+			return HttpContentEncoding::Identity;
+		}
+		if (context->containsResponseHeader(HttpHeaders::ContentEncoding) || context->containsResponseHeader(HttpHeaders::ContentRange)) {
+			return HttpContentEncoding::Identity;
+		}
+		if (!flagChunked && context->getOutputLength() < param.minimumCompressionSize) {
+			return HttpContentEncoding::Identity;
+		}
+		String type = context->getResponseContentType();
+		sl_reg indexParams = type.indexOf(';');
+		if (indexParams >= 0) {
+			type = type.substring(0, indexParams);
+		}
+		type = type.trim();
+		sl_bool flagCompressible = sl_false;
+		ListLocker<String> types(param.compressibleContentTypes);
+		for (sl_size i = 0; i < types.count; i++) {
+			String& pattern = types[i];
+			if (pattern.endsWith("/*")) {
+				sl_size len = pattern.getLength() - 1;
+				if (type.getLength() > len && type.substring(0, len).equalsIgnoreCase(pattern.substring(0, len))) {
+					flagCompressible = sl_true;
+					break;
+				}
+			} else if (type.equalsIgnoreCase(pattern)) {
+				flagCompressible = sl_true;
+				break;
+			}
+		}
+		if (!flagCompressible) {
+			return HttpContentEncoding::Identity;
+		}
+		SLIB_STATIC_STRING(strVary, "Accept-Encoding");
+		context->setResponseHeader(HttpHeaders::Vary, strVary);
+		return HttpContentEncodings::negotiate(context->getRequestHeader(HttpHeaders::AcceptEncoding));
 	}
 
 	void HttpServiceConnection::onReadStream(AsyncStreamResult* result)
@@ -427,11 +945,66 @@ namespace slib
 
 	void HttpServiceConnection::onAsyncOutputEnd(AsyncOutput* output, sl_bool flagError)
 	{
+		if (!flagError) {
+			MutexLocker lockWrite(&m_lockWrite);
+			Ref<HttpServiceContext> context = m_contextEncodingWaiting;
+			if (context.isNotNull()) {
+				m_contextEncodingWaiting.setNull();
+				if (!(_readEncodingStream(context.get()))) {
+					lockWrite.unlock();
+					close();
+				}
+				return;
+			}
+		}
 		if (flagError || !m_flagKeepAlive) {
 			close();
 		}
 	}
 
+	void HttpServiceConnection::onReadEncodingStream(AsyncStreamResult* result)
+	{
+		Ref<HttpServiceContext> context = (HttpServiceContext*)(result->userObject);
+		if (context.isNull()) {
+			return;
+		}
+		MutexLocker lockWrite(&m_lockWrite);
+		if (m_flagClosed) {
+			return;
+		}
+		Ref<HttpContentEncoder> encoder = context->m_encoderResponse;
+		sl_bool flagError = result->flagError || !(result->size) || result->size > context->m_sizeEncodingRemain || encoder.isNull();
+		if (!flagError) {
+			Memory chunk = encoder->encode(result->data, result->size, sl_false);
+			flagError = chunk.isNull() || !(m_output->write(chunk));
+		}
+		if (flagError) {
+			lockWrite.unlock();
+			close();
+			return;
+		}
+		context->m_sizeEncodingRemain -= result->size;
+		if (context->m_sizeEncodingRemain) {
+			// the next block is read when the output is drained, so that the stream is not buffered in memory as a whole
+			m_contextEncodingWaiting = context;
+			m_output->startWriting();
+			return;
+		}
+		context->m_streamEncoding.setNull();
+		// the finishing flag is set only when the completion is deferred, not while the stream is read in the middle of writing
+		sl_bool flagFinish = context->m_flagEncodingFinish;
+		if (!(_writeEncodedOutput(context.get(), flagFinish))) {
+			lockWrite.unlock();
+			close();
+			return;
+		}
+		m_output->startWriting();
+		if (flagFinish && context->m_streamEncoding.isNull()) {
+			lockWrite.unlock();
+			_setResponseCompleted(context.get());
+		}
+	}
+
 	void HttpServiceConnection::sendResponse(const Memory& mem)
 	{
 		if (mem.isNotNull()) {
@@ -621,9 +1194,20 @@ namespace slib
 		maxRequestHeadersSize = 0x10000; // 64KB
 		maxRequestBodySize = 0x2000000; // 32MB
 		
+		maxPipelinedRequestsCount = 16;
+		
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
+		flagCompressResponse = sl_false;
+		compressionLevel = 6;
+		minimumCompressionSize = 1024;
+		compressibleContentTypes.add("text/*");
+		compressibleContentTypes.add(ContentTypes::Json);
+		compressibleContentTypes.add("application/javascript");
+		compressibleContentTypes.add("application/xml");
+		compressibleContentTypes.add("image/svg+xml");
+		
 		flagLogDebug = sl_false;
 	}
 
@@ -23,6 +23,9 @@
 #include "slib/network/nat.h"
 
 #include "slib/core/new_helper.h"
+#include "slib/core/system.h"
+
+#define NAT_TABLE_DEFAULT_SHARDS_COUNT 16
 
 namespace slib
 {
@@ -38,11 +41,29 @@ namespace slib
 		udpPortEnd = 60000;
 
 		icmpEchoIdentifier = 30000;
+		
+		// RFC 5382 (REQ-5): established connection idle-timeout must not be less than 2 hours 4 minutes
+		tcpMappingTimeout = 7440000;
+		// RFC 4787 (REQ-5): UDP mapping timer should be 5 minutes or more
+		udpMappingTimeout = 300000;
+		
+		mappingShardsCount = NAT_TABLE_DEFAULT_SHARDS_COUNT;
 	}
 
 	NatTableParam::~NatTableParam()
 	{
 	}
+	
+	NatTablePacket::NatTablePacket()
+	{
+		data = sl_null;
+		length = 0;
+		flagTranslated = sl_false;
+	}
+	
+	NatTablePacket::~NatTablePacket()
+	{
+	}
 
 	NatTable::NatTable()
 	{
@@ -62,55 +83,145 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 		m_param = param;
-		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd);
-		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd);
+		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd, param.mappingShardsCount, param.tcpMappingTimeout);
+		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd, param.mappingShardsCount, param.udpMappingTimeout);
+	}
+	
+	SLIB_INLINE static void _priv_NatTable_translateSourceAddress(IPv4Packet* ipHeader, const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		ipHeader->setSourceAddress(addressNew);
+		ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressOld.getInt(), addressNew.getInt()));
+	}
+	
+	SLIB_INLINE static void _priv_NatTable_translateDestinationAddress(IPv4Packet* ipHeader, const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		ipHeader->setDestinationAddress(addressNew);
+		ipHeader->setChecksum(TCP_IP::adjustChecksum32(ipHeader->getChecksum(), addressOld.getInt(), addressNew.getInt()));
+	}
+	
+	// adjusts the checksum of TCP/UDP for the changes on pseudo-header's address and port
+	SLIB_INLINE static sl_uint16 _priv_NatTable_adjustTransportChecksum(sl_uint16 checksum, const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew)
+	{
+		checksum = TCP_IP::adjustChecksum32(checksum, addressOld.getInt(), addressNew.getInt());
+		return TCP_IP::adjustChecksum(checksum, portOld, portNew);
+	}
+	
+	SLIB_INLINE static void _priv_NatTable_adjustUdpChecksum(UdpDatagram* udp, const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew)
+	{
+		sl_uint16 checksum = udp->getChecksum();
+		if (!checksum) {
+			// checksum is not used
+			return;
+		}
+		checksum = _priv_NatTable_adjustTransportChecksum(checksum, addressOld, addressNew, portOld, portNew);
+		if (!checksum) {
+			checksum = 0xFFFF;
+		}
+		udp->setChecksum(checksum);
 	}
 
 	sl_bool NatTable::translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
+	{
+		return _translateOutgoingPacket(ipHeader, ipContent, sizeContent, System::getTickCount());
+	}
+
+	sl_bool NatTable::translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
+	{
+		return _translateIncomingPacket(ipHeader, ipContent, sizeContent, System::getTickCount());
+	}
+	
+	sl_uint32 NatTable::translateOutgoingPackets(NatTablePacket* packets, sl_uint32 nPackets)
+	{
+		sl_uint32 now = System::getTickCount();
+		sl_uint32 nTranslated = 0;
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			NatTablePacket& packet = packets[i];
+			packet.flagTranslated = sl_false;
+			if (IPv4Packet::check(packet.data, packet.length)) {
+				IPv4Packet* ipHeader = (IPv4Packet*)(packet.data);
+				if (_translateOutgoingPacket(ipHeader, ipHeader->getContent(), ipHeader->getContentSize(), now)) {
+					packet.flagTranslated = sl_true;
+					nTranslated++;
+				}
+			}
+		}
+		return nTranslated;
+	}
+	
+	sl_uint32 NatTable::translateIncomingPackets(NatTablePacket* packets, sl_uint32 nPackets)
+	{
+		sl_uint32 now = System::getTickCount();
+		sl_uint32 nTranslated = 0;
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			NatTablePacket& packet = packets[i];
+			packet.flagTranslated = sl_false;
+			if (IPv4Packet::check(packet.data, packet.length)) {
+				IPv4Packet* ipHeader = (IPv4Packet*)(packet.data);
+				if (_translateIncomingPacket(ipHeader, ipHeader->getContent(), ipHeader->getContentSize(), now)) {
+					packet.flagTranslated = sl_true;
+					nTranslated++;
+				}
+			}
+		}
+		return nTranslated;
+	}
+	
+	sl_size NatTable::removeExpiredMappings()
+	{
+		sl_uint32 now = System::getTickCount();
+		return m_mappingTcp.removeExpiredPorts(now) + m_mappingUdp.removeExpiredPorts(now);
+	}
+
+	sl_bool NatTable::_translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent, sl_uint32 now)
 	{
 		IPv4Address addressTarget = m_param.targetAddress;
 		if (addressTarget.isZero()) {
 			return sl_false;
 		}
+		// Checksums are updated incrementally (RFC 1624), so the corrupted packets keep invalid checksum and will be dropped by the receivers
 		NetworkInternetProtocol protocol = ipHeader->getProtocol();
 		if (protocol == NetworkInternetProtocol::TCP) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = tcp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
+				if (m_mappingTcp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort, now)) {
 					tcp->setSourcePort(targetPort);
-					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->setChecksum(_priv_NatTable_adjustTransportChecksum(tcp->getChecksum(), addressSource, addressTarget, portSource, targetPort));
+					_priv_NatTable_translateSourceAddress(ipHeader, addressSource, addressTarget);
 					return sl_true;
 				}
 			}
 		} else if (protocol == NetworkInternetProtocol::UDP) {
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
-			if (udp->check(ipHeader, sizeContent)) {
+			if (udp->checkSize(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = udp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
+				if (m_mappingUdp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort, now)) {
 					udp->setSourcePort(targetPort);
-					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					_priv_NatTable_adjustUdpChecksum(udp, addressSource, addressTarget, portSource, targetPort);
+					_priv_NatTable_translateSourceAddress(ipHeader, addressSource, addressTarget);
 					return sl_true;
 				}
 			}
 		} else if (protocol == NetworkInternetProtocol::ICMP) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (sizeContent >= sizeof(IcmpHeaderFormat)) {
 				if (icmp->getType() == IcmpType::Echo) {
 					IcmpEchoAddress address;
 					address.ip = ipHeader->getSourceAddress();
 					address.identifier = icmp->getEchoIdentifier();
 					address.sequenceNumber = icmp->getEchoSequenceNumber();
 					sl_uint16 sn = getMappedIcmpEchoSequenceNumber(address);
+					sl_uint16 checksum = icmp->getChecksum();
+					checksum = TCP_IP::adjustChecksum(checksum, address.identifier, m_param.icmpEchoIdentifier);
+					checksum = TCP_IP::adjustChecksum(checksum, address.sequenceNumber, sn);
 					icmp->setEchoIdentifier(m_param.icmpEchoIdentifier);
 					icmp->setEchoSequenceNumber(sn);
-					ipHeader->setSourceAddress(addressTarget);
-					icmp->updateChecksum(sizeContent);
-					ipHeader->updateChecksum();
+					icmp->setChecksum(checksum);
+					_priv_NatTable_translateSourceAddress(ipHeader, address.ip, addressTarget);
 					return sl_true;
 				}
 			}
@@ -118,7 +229,7 @@ namespace slib
 		return sl_false;
 	}
 
-	sl_bool NatTable::translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
+	sl_bool NatTable::_translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent, sl_uint32 now)
 	{
 		IPv4Address addressTarget = m_param.targetAddress;
 		if (addressTarget.isZero()) {
@@ -130,25 +241,27 @@ namespace slib
 		NetworkInternetProtocol protocol = ipHeader->getProtocol();
 		if (protocol == NetworkInternetProtocol::TCP) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
+				sl_uint16 portTarget = tcp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingTcp.mapToInternalAddress(portTarget, addressSource, now)) {
+					IPv4Address ipSource = addressSource.ip.getIPv4();
 					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->setChecksum(_priv_NatTable_adjustTransportChecksum(tcp->getChecksum(), addressTarget, ipSource, portTarget, addressSource.port));
+					_priv_NatTable_translateDestinationAddress(ipHeader, addressTarget, ipSource);
 					return sl_true;
 				}
 			}
 		} else if (protocol == NetworkInternetProtocol::UDP) {
-			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
-			if (udp->check(ipHeader, sizeContent)) {
+			UdpDatagram* udp = (UdpDatagram*)(ipContent);
+			if (udp->checkSize(sizeContent)) {
+				sl_uint16 portTarget = udp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingUdp.mapToInternalAddress(portTarget, addressSource, now)) {
+					IPv4Address ipSource = addressSource.ip.getIPv4();
 					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					_priv_NatTable_adjustUdpChecksum(udp, addressTarget, ipSource, portTarget, addressSource.port);
+					_priv_NatTable_translateDestinationAddress(ipHeader, addressTarget, ipSource);
 					return sl_true;
 				}
 			}
@@ -159,7 +272,12 @@ namespace slib
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
 						IcmpEchoElement element;
-						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
+						sl_bool flagFound;
+						{
+							SpinLocker lock(&m_lockIcmpEcho);
+							flagFound = m_mapIcmpEchoIncoming.get_NoLock(icmp->getEchoSequenceNumber(), &element);
+						}
+						if (flagFound) {
 							ipHeader->setDestinationAddress(element.addressSource.ip);
 							icmp->setEchoIdentifier(element.addressSource.identifier);
 							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
@@ -176,7 +294,7 @@ namespace slib
 						if (protocolOrig == NetworkInternetProtocol::TCP) {
 							TcpSegment* tcp = (TcpSegment*)(ipOrig->getContent());
 							SocketAddress addressSource;
-							if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
+							if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource, now)) {
 								ipOrig->setDestinationAddress(addressSource.ip.getIPv4());
 								tcp->setDestinationPort(addressSource.port);
 								ipOrig->updateChecksum();
@@ -188,7 +306,7 @@ namespace slib
 						} else if (protocolOrig == NetworkInternetProtocol::UDP) {
 							UdpDatagram* udp = (UdpDatagram*)(ipOrig->getContent());
 							SocketAddress addressSource;
-							if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
+							if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource, now)) {
 								ipOrig->setDestinationAddress(addressSource.ip.getIPv4());
 								udp->setDestinationPort(addressSource.port);
 								udp->setChecksum(0);
@@ -208,121 +326,177 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		SpinLocker lock(&m_lockIcmpEcho);
 		IcmpEchoElement element;
-		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
+		if (m_mapIcmpEchoOutgoing.get_NoLock(address, &element)) {
 			return element.sequenceNumberTarget;
 		}
 		sl_uint16 sn = ++ m_icmpEchoSequenceCurrent;
-		if (m_mapIcmpEchoIncoming.get(sn, &element)) {
-			m_mapIcmpEchoOutgoing.removeItems(element.addressSource);
+		if (m_mapIcmpEchoIncoming.get_NoLock(sn, &element)) {
+			m_mapIcmpEchoOutgoing.removeItems_NoLock(element.addressSource);
 		}
 		element.addressSource = address;
 		element.sequenceNumberTarget = sn;
-		m_mapIcmpEchoOutgoing.put(address, element);
-		m_mapIcmpEchoIncoming.put(sn, element);
+		m_mapIcmpEchoOutgoing.put_NoLock(address, element);
+		m_mapIcmpEchoIncoming.put_NoLock(sn, element);
 		return sn;
 	}
 
 	_priv_NatTablePort::_priv_NatTablePort()
 	{
 		flagActive = sl_false;
-		timeLastAccess.setZero();
+		timeLastAccess = 0;
 	}
 
 	_priv_NatTablePort::~_priv_NatTablePort()
 	{
 	}
+	
+	_priv_NatTableMappingShard::_priv_NatTableMappingShard()
+	{
+		ports = sl_null;
+		nPorts = 0;
+		pos = 0;
+		portBegin = 0;
+	}
+	
+	_priv_NatTableMappingShard::~_priv_NatTableMappingShard()
+	{
+		if (ports) {
+			NewHelper<_priv_NatTablePort>::free(ports, nPorts);
+		}
+	}
 
 	_priv_NatTableMapping::_priv_NatTableMapping()
 	{
-		m_ports = sl_null;
-		m_nPorts = 0;
-		m_pos = 0;
+		m_shards = sl_null;
+		m_nShards = 0;
+		m_nPortsPerShard = 0;
 
 		m_portBegin = 0;
 		m_portEnd = 0;
+		
+		m_timeout = 0;
 	}
 
 	_priv_NatTableMapping::~_priv_NatTableMapping()
 	{
-		NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
+		if (m_shards) {
+			NewHelper<_priv_NatTableMappingShard>::free(m_shards, m_nShards);
+		}
 	}
 
-	void _priv_NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd)
+	void _priv_NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeout)
 	{
 		ObjectLocker lock(this);
 
-		m_mapPorts.removeAll_NoLock();
-
-		if (m_ports) {
-			NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
-			m_ports = sl_null;
+		if (m_shards) {
+			NewHelper<_priv_NatTableMappingShard>::free(m_shards, m_nShards);
+			m_shards = sl_null;
 		}
-		m_pos = 0;
-		m_nPorts = 0;
+		m_nShards = 0;
+		m_nPortsPerShard = 0;
 
 		m_portBegin = portBegin;
 		m_portEnd = portEnd;
-		if (portEnd >= portBegin) {
-			m_nPorts = portEnd - portBegin + 1;
-			m_ports = NewHelper<_priv_NatTablePort>::create(m_nPorts);
+		m_timeout = timeout;
+		
+		if (portEnd < portBegin) {
+			return;
+		}
+		sl_uint32 nPorts = (sl_uint32)portEnd - (sl_uint32)portBegin + 1;
+		if (!nShards) {
+			nShards = 1;
+		}
+		if (nShards > nPorts) {
+			nShards = nPorts;
+		}
+		m_shards = NewHelper<_priv_NatTableMappingShard>::create(nShards);
+		if (!m_shards) {
+			return;
+		}
+		sl_uint32 nPortsPerShard = nPorts / nShards;
+		for (sl_uint32 i = 0; i < nShards; i++) {
+			_priv_NatTableMappingShard& shard = m_shards[i];
+			shard.portBegin = (sl_uint16)(portBegin + i * nPortsPerShard);
+			// the last shard takes the remainder
+			shard.nPorts = (i == nShards - 1) ? (nPorts - i * nPortsPerShard) : nPortsPerShard;
+			shard.ports = NewHelper<_priv_NatTablePort>::create(shard.nPorts);
+			if (!(shard.ports)) {
+				shard.nPorts = 0;
+			}
 		}
+		m_nShards = nShards;
+		m_nPortsPerShard = nPortsPerShard;
 	}
-
-	sl_bool _priv_NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
+	
+	SLIB_INLINE sl_bool _priv_NatTableMapping::_isExpired(const _priv_NatTablePort& port, sl_uint32 now)
 	{
-		ObjectLocker lock(this);
+		return m_timeout && (sl_uint32)(now - port.timeLastAccess) >= m_timeout;
+	}
 
-		if (!m_ports) {
+	sl_bool _priv_NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port, sl_uint32 now)
+	{
+		if (!m_nShards) {
 			return sl_false;
 		}
-		sl_uint32 n = m_nPorts;
+		
+		_priv_NatTableMappingShard& shard = m_shards[Hash<SocketAddress>()(address) % m_nShards];
+		sl_uint32 n = shard.nPorts;
 		if (!n) {
 			return sl_false;
 		}
+		_priv_NatTablePort* ports = shard.ports;
+		
+		SpinLocker lock(&(shard.lock));
 
 		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
-			if (port >= m_portBegin && port <= m_portEnd) {
-				m_ports[port - m_portBegin].timeLastAccess = Time::now();
+		if (shard.mapPorts.get_NoLock(address, &port)) {
+			sl_uint32 index = (sl_uint32)(port - shard.portBegin);
+			if (index < n) {
+				ports[index].timeLastAccess = now;
 				_port = port;
 				return sl_true;
 			} else {
-				m_mapPorts.remove_NoLock(address);
+				shard.mapPorts.remove_NoLock(address);
 			}
 		}
 
-		sl_uint16 pos = m_pos;
-		n *= 2;
-		sl_int64 timeAccessMin = 0;
-		sl_int64 timeAccessMax = 0;
-		for (sl_uint32 i = 0; i < n; i++) {
-			if (!(m_ports[pos].flagActive)) {
-				port = pos + m_portBegin;
-				m_ports[pos].flagActive = sl_true;
-				m_ports[pos].addressSource = address;
-				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
+		sl_uint32 pos = shard.pos;
+		sl_uint32 ageMin = 0;
+		sl_uint32 ageMax = 0;
+		for (sl_uint32 i = 0; i < 2 * n; i++) {
+			_priv_NatTablePort& entry = ports[pos];
+			if (!(entry.flagActive) || _isExpired(entry, now)) {
+				if (entry.flagActive) {
+					shard.mapPorts.remove_NoLock(entry.addressSource);
+				}
+				port = (sl_uint16)(pos + shard.portBegin);
+				entry.flagActive = sl_true;
+				entry.addressSource = address;
+				entry.timeLastAccess = now;
+				shard.mapPorts.put_NoLock(address, port);
 				_port = port;
-				m_pos = (pos + 1) % m_nPorts;
+				shard.pos = (pos + 1) % n;
 				return sl_true;
 			} else {
-				sl_int64 t = m_ports[pos].timeLastAccess.toInt();
-				if (t > timeAccessMax) {
-					timeAccessMax = t;
+				sl_uint32 age = now - entry.timeLastAccess;
+				if (age > ageMax) {
+					ageMax = age;
 				}
-				if (timeAccessMin == 0 || t < timeAccessMin) {
-					timeAccessMin = t;
+				if (i == 0 || age < ageMin) {
+					ageMin = age;
 				}
 			}
-			pos = (pos + 1) % m_nPorts;
-			if (i == m_nPorts) {
-				sl_int64 mid = (timeAccessMin + timeAccessMax) / 2;
-				for (sl_uint16 k = 0; k < m_nPorts; k++) {
-					if (m_ports[k].flagActive) {
-						if (m_ports[k].timeLastAccess.toInt() <= mid) {
-							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
+			pos = (pos + 1) % n;
+			if (i == n) {
+				// all ports are in use: releases the older half
+				sl_uint32 mid = (sl_uint32)(((sl_uint64)ageMin + (sl_uint64)ageMax) / 2);
+				for (sl_uint32 k = 0; k < n; k++) {
+					if (ports[k].flagActive) {
+						if ((sl_uint32)(now - ports[k].timeLastAccess) >= mid) {
+							ports[k].flagActive = sl_false;
+							shard.mapPorts.remove_NoLock(ports[k].addressSource);
 						}
 					}
 				}
@@ -331,24 +505,53 @@ namespace slib
 		return sl_false;
 	}
 
-	sl_bool _priv_NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
+	sl_bool _priv_NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address, sl_uint32 now)
 	{
-		ObjectLocker lock(this);
-		if (!m_ports) {
+		if (!m_nShards) {
 			return sl_false;
 		}
-		if (!m_nPorts) {
+		if (port < m_portBegin || port > m_portEnd) {
 			return sl_false;
 		}
-		if (port >= m_portBegin && port <= m_portEnd) {
-			sl_uint32 k = port - m_portBegin;
-			if (m_ports[k].flagActive) {
-				m_ports[k].timeLastAccess = Time::now();
-				address = m_ports[k].addressSource;
-				return sl_true;
-			}
+		sl_uint32 offset = (sl_uint32)(port - m_portBegin);
+		sl_uint32 indexShard = offset / m_nPortsPerShard;
+		if (indexShard >= m_nShards) {
+			indexShard = m_nShards - 1;
+		}
+		_priv_NatTableMappingShard& shard = m_shards[indexShard];
+		sl_uint32 index = (sl_uint32)(port - shard.portBegin);
+		if (index >= shard.nPorts) {
+			return sl_false;
+		}
+		SpinLocker lock(&(shard.lock));
+		_priv_NatTablePort& entry = shard.ports[index];
+		if (entry.flagActive && !(_isExpired(entry, now))) {
+			entry.timeLastAccess = now;
+			address = entry.addressSource;
+			return sl_true;
 		}
 		return sl_false;
 	}
 	
+	sl_size _priv_NatTableMapping::removeExpiredPorts(sl_uint32 now)
+	{
+		if (!m_timeout) {
+			return 0;
+		}
+		sl_size nRemoved = 0;
+		for (sl_uint32 i = 0; i < m_nShards; i++) {
+			_priv_NatTableMappingShard& shard = m_shards[i];
+			SpinLocker lock(&(shard.lock));
+			for (sl_uint32 k = 0; k < shard.nPorts; k++) {
+				_priv_NatTablePort& entry = shard.ports[k];
+				if (entry.flagActive && _isExpired(entry, now)) {
+					entry.flagActive = sl_false;
+					shard.mapPorts.remove_NoLock(entry.addressSource);
+					nRemoved++;
+				}
+			}
+		}
+		return nRemoved;
+	}
+	
 }
@@ -21,6 +21,7 @@
  */
 
 #include "slib/network/async.h"
+#include "slib/network/dns.h"
 
 #include "network_async.h"
 
@@ -212,6 +213,41 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncTcpSocket::connect(const String& hostName, sl_uint16 port)
+	{
+		IPAddress ip;
+		if (ip.parse(hostName)) {
+			return connect(SocketAddress(ip, port));
+		}
+		Ref<DnsResolver> resolver = DnsResolver::getDefault();
+		if (resolver.isNull()) {
+			return sl_false;
+		}
+		Ref<Socket> socket = getSocket();
+		if (socket.isNull()) {
+			return sl_false;
+		}
+		sl_bool flagIPv6 = socket->getType() == SocketType::StreamIPv6;
+		WeakRef<AsyncTcpSocket> weak = this;
+		resolver->resolve(hostName, [weak, port, flagIPv6](const List<IPAddress>& addresses) {
+			Ref<AsyncTcpSocket> socket = weak;
+			if (socket.isNull()) {
+				return;
+			}
+			ListElements<IPAddress> list(addresses);
+			for (sl_size i = 0; i < list.count; i++) {
+				if (list[i].isIPv4() || (flagIPv6 && list[i].isIPv6())) {
+					if (socket->connect(SocketAddress(list[i], port))) {
+						return;
+					}
+					break;
+				}
+			}
+			socket->_onConnect(SocketAddress(), sl_true);
+		});
+		return sl_true;
+	}
+
 	sl_bool AsyncTcpSocket::receive(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
 	{
 		return AsyncStreamBase::read(data, size, callback, userObject);
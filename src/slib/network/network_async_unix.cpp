@@ -76,6 +76,15 @@ namespace slib
 			m_socket.setNull();
 		}
 		
+		sl_bool writev(const List<MemoryData>& slices, const Function<void(AsyncStreamResult*)>& callback) override
+		{
+			Ref<AsyncStreamRequest> request = AsyncStreamRequest::createVectorWrite(slices, callback);
+			if (request.isNotNull()) {
+				return addWriteRequest(request);
+			}
+			return sl_false;
+		}
+		
 		void processRead(sl_bool flagError)
 		{
 			Ref<Socket> socket = m_socket;
@@ -142,9 +151,14 @@ namespace slib
 						return;
 					}
 				}
-				if (request->data && request->size) {
-					sl_uint32 size = request->size - m_sizeWritten;
-					sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				if (request->size && (request->data || request->slices.isNotNull())) {
+					sl_int32 n;
+					if (request->data) {
+						n = socket->send((char*)(request->data) + m_sizeWritten, request->size - m_sizeWritten);
+					} else {
+						ListElements<MemoryData> slices(request->slices);
+						n = socket->sendVector(slices.data, slices.count, m_sizeWritten);
+					}
 					if (n > 0) {
 						m_sizeWritten += n;
 						if (m_sizeWritten >= request->size) {
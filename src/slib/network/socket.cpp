@@ -43,6 +43,7 @@
 #		include <netinet/tcp.h>
 #	endif
 #	include <netinet/in.h>
+#	include <sys/uio.h>
 #	include <signal.h>
 #	include <errno.h>
 typedef int SOCKET;
@@ -577,6 +578,82 @@ namespace slib
 		}
 	}
 
+#define PRIV_SOCKET_MAX_VECTOR_COUNT 64
+#define PRIV_SOCKET_MAX_VECTOR_SIZE 0x40000000
+
+	sl_int32 Socket::sendVector(const MemoryData* slices, sl_size nSlices, sl_size offset)
+	{
+		if (isOpened()) {
+			if (!(isStream())) {
+				_setError(SocketError::SendIsNotSupported);
+				return -1;
+			}
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+			WSABUF bufs[PRIV_SOCKET_MAX_VECTOR_COUNT];
+#else
+			iovec bufs[PRIV_SOCKET_MAX_VECTOR_COUNT];
+#endif
+			sl_uint32 nBufs = 0;
+			sl_size sizeTotal = 0;
+			for (sl_size i = 0; i < nSlices && nBufs < PRIV_SOCKET_MAX_VECTOR_COUNT && sizeTotal < PRIV_SOCKET_MAX_VECTOR_SIZE; i++) {
+				const MemoryData& slice = slices[i];
+				if (offset >= slice.size) {
+					offset -= slice.size;
+					continue;
+				}
+				sl_size size = slice.size - offset;
+				if (size > PRIV_SOCKET_MAX_VECTOR_SIZE - sizeTotal) {
+					size = PRIV_SOCKET_MAX_VECTOR_SIZE - sizeTotal;
+				}
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+				bufs[nBufs].buf = (char*)(slice.data) + offset;
+				bufs[nBufs].len = (ULONG)size;
+#else
+				bufs[nBufs].iov_base = (char*)(slice.data) + offset;
+				bufs[nBufs].iov_len = size;
+#endif
+				offset = 0;
+				sizeTotal += size;
+				nBufs++;
+			}
+			if (!nBufs) {
+				return 0;
+			}
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+			DWORD nSent = 0;
+			sl_int32 ret = -1;
+			if (::WSASend((SOCKET)(m_socket), bufs, nBufs, &nSent, 0, NULL, NULL) == 0) {
+				ret = (sl_int32)nSent;
+			}
+#else
+			msghdr msg;
+			Base::zeroMemory(&msg, sizeof(msg));
+			msg.msg_iov = bufs;
+			msg.msg_iovlen = nBufs;
+#	if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_int32 ret = (sl_int32)(::sendmsg((SOCKET)(m_socket), &msg, MSG_NOSIGNAL));
+#	else
+			sl_int32 ret = (sl_int32)(::sendmsg((SOCKET)(m_socket), &msg, 0));
+#	endif
+#endif
+			if (ret >= 0) {
+				if (ret == 0) {
+					ret = -1;
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::receive(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
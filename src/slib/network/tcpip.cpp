@@ -24,29 +24,101 @@
 
 #include "slib/core/mio.h"
 
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#endif
+
 namespace slib
 {
 
-	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
-	{
-		sl_uint32 sum = add;
-		sl_uint8* p = (sl_uint8*)data;
+	// sums 16-bit words in little-endian order, the folded result is byte-swapped by the caller (RFC 1071 - byte order independence)
+	static sl_uint64 _priv_TCP_IP_sumWordsLE(const sl_uint8* p, sl_size size)
+	{
+		sl_uint64 sum = 0;
+#if defined(SLIB_ARCH_IS_X64)
+		if (size >= 64) {
+			__m128i zero = _mm_setzero_si128();
+			while (size >= 64) {
+				// each 32-bit lane receives at most 8 words per 64 bytes, and is flushed before it can overflow
+				sl_size nBlocks = size >> 6;
+				if (nBlocks > 4096) {
+					nBlocks = 4096;
+				}
+				size -= nBlocks << 6;
+				__m128i acc = zero;
+				for (sl_size i = 0; i < nBlocks; i++) {
+					__m128i v0 = _mm_loadu_si128((const __m128i*)p);
+					__m128i v1 = _mm_loadu_si128((const __m128i*)(p + 16));
+					__m128i v2 = _mm_loadu_si128((const __m128i*)(p + 32));
+					__m128i v3 = _mm_loadu_si128((const __m128i*)(p + 48));
+					acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v0, zero));
+					acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v0, zero));
+					acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v1, zero));
+					acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v1, zero));
+					acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v2, zero));
+					acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v2, zero));
+					acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v3, zero));
+					acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v3, zero));
+					p += 64;
+				}
+				sl_uint32 lanes[4];
+				_mm_storeu_si128((__m128i*)lanes, acc);
+				sum += (sl_uint64)(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+			}
+		}
+#endif
+		while (size >= 8) {
+			sum += MIO::readUint32LE(p);
+			sum += MIO::readUint32LE(p + 4);
+			p += 8;
+			size -= 8;
+		}
 		while (size > 1) {
-			sl_uint16 w = *((sl_uint8*)(p));
-			w = (w << 8) | *((sl_uint8*)(p + 1));
-			sum += w; // can be computed in either byte order
+			sum += MIO::readUint16LE(p);
 			p += 2;
 			size -= 2;
 		}
 		if (size) {
-			sl_uint16 w = *((sl_uint8*)p);
-			w = w << 8;
-			sum += w;
+			sum += *p;
 		}
+		return sum;
+	}
+
+	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
+	{
+		sl_uint64 sum = _priv_TCP_IP_sumWordsLE((const sl_uint8*)data, size);
 		while (sum >> 16) {
 			sum = (sum >> 16) + (sum & 0xffff); // 1's complement sum
 		}
-		return sum;
+		sum = ((sum & 0xff) << 8) | (sum >> 8);
+		sum += add;
+		while (sum >> 16) {
+			sum = (sum >> 16) + (sum & 0xffff);
+		}
+		return (sl_uint16)sum;
+	}
+
+	// Referenced from RFC 1624 (Eqn. 3): HC' = ~(~HC + ~m + m')
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~oldValue);
+		sum += newValue;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum += sum >> 16;
+		return (sl_uint16)(~sum);
+	}
+
+	sl_uint16 TCP_IP::adjustChecksum32(sl_uint16 checksum, sl_uint32 oldValue, sl_uint32 newValue)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~(oldValue >> 16));
+		sum += (sl_uint16)(~oldValue);
+		sum += newValue >> 16;
+		sum += newValue & 0xffff;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum += sum >> 16;
+		return (sl_uint16)(~sum);
 	}
 	
 	// Referenced from RFC 1071
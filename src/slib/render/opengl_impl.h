@@ -363,7 +363,7 @@ namespace slib
 	{
 		if (buffer) {
 			GL_ENTRY(glBindBuffer)(target, buffer);
-			GL_ENTRY(glBufferSubData)(target, buffer, size, data);
+			GL_ENTRY(glBufferSubData)(target, offset, size, data);
 		}
 	}
 	
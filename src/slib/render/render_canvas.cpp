@@ -80,6 +80,8 @@ namespace slib
 	SLIB_RENDER_PROGRAM_STATE_UNIFORM_VECTOR4(RectSrc, u_RectSrc)
 	SLIB_RENDER_PROGRAM_STATE_UNIFORM_MATRIX3_ARRAY(ClipTransform, u_ClipTransform)
 	SLIB_RENDER_PROGRAM_STATE_UNIFORM_VECTOR4_ARRAY(ClipRect, u_ClipRect)
+	// not declared in GLSL (the shader source encodes the clip types), used by the engines shading on CPU
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_INT_ARRAY(ClipType, u_ClipType)
 	
 	SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(position, a_Position)
 	SLIB_RENDER_PROGRAM_STATE_END
@@ -129,10 +131,17 @@ namespace slib
 		{
 			Matrix3 clipTransforms[MAX_SHADER_CLIP + 1];
 			Vector4 clipRects[MAX_SHADER_CLIP + 1];
+			sl_int32 clipTypes[MAX_SHADER_CLIP + 1];
 			for (sl_uint32 i = 0; i < countClips; i++) {
 				RenderCanvasClip* clip = clips[i];
 				Rectangle& r = clip->region;
 				clipRects[i] = Vector4(r.left, r.top, r.right, r.bottom);
+				// 0: Rectangle, 1: Ellipse, 2: Oval (antialiased)
+				if (clip->type == RenderCanvasClipType::Ellipse) {
+					clipTypes[i] = Math::isAlmostZero(r.getWidth() - r.getHeight()) ? 2 : 1;
+				} else {
+					clipTypes[i] = 0;
+				}
 				if (clip->flagTransform) {
 					clipTransforms[i] = transform * clip->transform;
 				} else {
@@ -141,6 +150,7 @@ namespace slib
 			}
 			state->setClipRect(clipRects, countClips);
 			state->setClipTransform(clipTransforms, countClips);
+			state->setClipType(clipTypes, countClips);
 		}
 		
 	private:
@@ -341,11 +351,29 @@ namespace slib
 		
 	};
 	
+	class _priv_RenderCanvas_SolidBatchProgram : public RenderProgram2D_PositionTextureColor
+	{
+	public:
+		String getGLSLFragmentShader(RenderEngine* engine) override
+		{
+			String source = SLIB_STRINGIFY(
+										   varying vec4 v_Color;
+										   void main() {
+											   gl_FragColor = v_Color;
+										   }
+										   );
+			return source;
+		}
+		
+	};
+	
 	class _priv_RenderCanvas_Shared
 	{
 	public:
 		CHashMap< String, Ref<RenderCanvasProgram> > programs;
 		Ref<VertexBuffer> vbRectangle;
+		Ref<RenderProgram2D_PositionTextureColor> programBatchTexture;
+		Ref<RenderProgram2D_PositionTextureColor> programBatchSolid;
 		
 	public:
 		_priv_RenderCanvas_Shared()
@@ -357,6 +385,8 @@ namespace slib
 				, { { 1, 1 } }
 			};
 			vbRectangle = VertexBuffer::create(v, sizeof(v));
+			programBatchTexture = new RenderProgram2D_PositionTextureColor;
+			programBatchSolid = new _priv_RenderCanvas_SolidBatchProgram;
 		}
 		
 		Ref<RenderCanvasProgram> getProgram(const RenderCanvasProgramParam& param)
@@ -388,10 +418,13 @@ namespace slib
 	{
 		m_width = 0;
 		m_height = 0;
+		m_nMaxBatchQuads = 0;
+		m_nBatchQuads = 0;
 	}
 	
 	RenderCanvas::~RenderCanvas()
 	{
+		flush();
 	}
 	
 	Ref<RenderCanvas> RenderCanvas::create(const Ref<RenderEngine>& engine, sl_real width, sl_real height)
@@ -425,6 +458,8 @@ namespace slib
 	
 	const Ref<RenderEngine>& RenderCanvas::getEngine()
 	{
+		// the caller may draw on the engine directly
+		flush();
 		return m_engine;
 	}
 	
@@ -660,18 +695,29 @@ namespace slib
 		pp.prepare(state, !fontItalic);
 		pp.flagUseTexture = sl_true;
 		
+		sl_bool flagBatch = !(pp.countClips) && _prepareBatch();
+		if (!flagBatch) {
+			flush();
+		}
+		
 		RenderProgramScope<RenderCanvasProgramState> scope;
 		sl_bool flagBeginScope = sl_false;
 		Ref<Texture> textureBefore;
 		
 		FontAtlasChar fac;
 		Color4f color = _color;
+		color.w *= getAlpha();
 		sl_real fx = x;
 		
 		for (sl_size i = 0; i < len; i++) {
 			
 			sl_char16 ch = arrChar[i];
 			
+			if (m_nBatchQuads && fa->isReusingPlanes(ch)) {
+				// the pending glyphs may be overwritten by the new char
+				flush();
+			}
+			
 			if (fa->getChar(ch, fac)) {
 				
 				sl_real fw = fac.fontWidth;
@@ -711,12 +757,12 @@ namespace slib
 							sl_real sw = (sl_real)(texture->getWidth());
 							sl_real sh = (sl_real)(texture->getHeight());
 							if (sw > SLIB_EPSILON && sh > SLIB_EPSILON) {
-								if (!flagBeginScope) {
+								if (!flagBatch && !flagBeginScope) {
 									Ref<RenderProgram> program = shared->getProgram(pp);
 									if (!(scope.begin(m_engine.get(), program))) {
 										return;
 									}
-									scope->setColor(Color4f(color.x, color.y, color.z, color.w * getAlpha()));
+									scope->setColor(color);
 									flagBeginScope = sl_true;
 								}
 								
@@ -740,17 +786,23 @@ namespace slib
 									mat.m01 = 0; mat.m11 = rcDst.getHeight(); mat.m21 = rcDst.top;
 									mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
 								}
-								pp.applyToProgramState(scope.getState(), mat);
-								mat *= state->matrix;
-								mat *= m_matViewport;
-								scope->setTransform(mat);
-								Ref<TextureInstance> textureInstance = m_engine->linkTexture(texture);
-								if (textureBefore != texture || (textureInstance.isNotNull() && textureInstance->_isUpdated())) {
-									scope->setTexture(texture);
-									textureBefore = texture;
+								if (flagBatch) {
+									mat *= state->matrix;
+									mat *= m_matViewport;
+									_addQuadToBatch(mat, texture, Vector4(rcSrc.left, rcSrc.top, rcSrc.getWidth(), rcSrc.getHeight()), color);
+								} else {
+									pp.applyToProgramState(scope.getState(), mat);
+									mat *= state->matrix;
+									mat *= m_matViewport;
+									scope->setTransform(mat);
+									Ref<TextureInstance> textureInstance = m_engine->linkTexture(texture);
+									if (textureBefore != texture || (textureInstance.isNotNull() && textureInstance->_isUpdated())) {
+										scope->setTexture(texture);
+										textureBefore = texture;
+									}
+									scope->setRectSrc(Vector4(rcSrc.left, rcSrc.top, rcSrc.getWidth(), rcSrc.getHeight()));
+									m_engine->drawPrimitive(4, shared->vbRectangle, PrimitiveType::TriangleStrip);
 								}
-								scope->setRectSrc(Vector4(rcSrc.left, rcSrc.top, rcSrc.getWidth(), rcSrc.getHeight()));
-								m_engine->drawPrimitive(4, shared->vbRectangle, PrimitiveType::TriangleStrip);
 							}
 						}
 					}
@@ -884,18 +936,27 @@ namespace slib
 		RenderCanvasProgramParam pp;
 		pp.prepare(state, sl_true);
 		
+		Matrix3 mat;
+		mat.m00 = rect.getWidth(); mat.m10 = 0; mat.m20 = rect.left;
+		mat.m01 = 0; mat.m11 = rect.getHeight(); mat.m21 = rect.top;
+		mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
+		Color4f color = _color;
+		color.w *= getAlpha();
+		
+		if (!(pp.countClips)) {
+			if (_addQuadToBatch(mat * state->matrix * m_matViewport, sl_null, Vector4::zero(), color)) {
+				return;
+			}
+		}
+		
+		flush();
+		
 		RenderProgramScope<RenderCanvasProgramState> scope;
 		if (scope.begin(m_engine.get(), shared->getProgram(pp))) {
-			Matrix3 mat;
-			mat.m00 = rect.getWidth(); mat.m10 = 0; mat.m20 = rect.left;
-			mat.m01 = 0; mat.m11 = rect.getHeight(); mat.m21 = rect.top;
-			mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
 			pp.applyToProgramState(scope.getState(), mat);
 			mat *= state->matrix;
 			mat *= m_matViewport;
 			scope->setTransform(mat);
-			Color4f color = _color;
-			color.w *= getAlpha();
 			scope->setColor(color);
 			m_engine->drawPrimitive(4, shared->vbRectangle, PrimitiveType::TriangleStrip);
 		}
@@ -930,6 +991,8 @@ namespace slib
 			clip.region = rect;
 			pp.addFinalClip(&clip);
 			
+			flush();
+			
 			RenderProgramScope<RenderCanvasProgramState> scope;
 			if (scope.begin(m_engine.get(), shared->getProgram(pp))) {
 				Matrix3 mat;
@@ -985,6 +1048,19 @@ namespace slib
 			pp.flagUseColorFilter = sl_true;
 		}
 		
+		if (!(pp.countClips) && !(param.useColorMatrix)) {
+			Color4f colorFinal = color;
+			if (param.useAlpha) {
+				colorFinal.w *= param.alpha;
+			}
+			colorFinal.w *= getAlpha();
+			if (_addQuadToBatch(transform * state->matrix * m_matViewport, texture, Vector4(rectSrc.left, rectSrc.top, rectSrc.getWidth(), rectSrc.getHeight()), colorFinal)) {
+				return;
+			}
+		}
+		
+		flush();
+		
 		RenderProgramScope<RenderCanvasProgramState> scope;
 		if (scope.begin(m_engine.get(), shared->getProgram(pp))) {
 			pp.applyToProgramState(scope.getState(), transform);
@@ -1072,13 +1148,27 @@ namespace slib
 			pp.flagUseColorFilter = sl_true;
 		}
 		
+		Matrix3 mat;
+		mat.m00 = rectDst.getWidth(); mat.m10 = 0; mat.m20 = rectDst.left;
+		mat.m01 = 0; mat.m11 = rectDst.getHeight(); mat.m21 = rectDst.top;
+		mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
+		
+		if (!(pp.countClips) && !(param.useColorMatrix)) {
+			Color4f colorFinal = color;
+			if (param.useAlpha) {
+				colorFinal.w *= param.alpha;
+			}
+			colorFinal.w *= getAlpha();
+			if (_addQuadToBatch(mat * state->matrix * m_matViewport, texture, Vector4(rectSrc.left, rectSrc.top, rectSrc.getWidth(), rectSrc.getHeight()), colorFinal)) {
+				return;
+			}
+		}
+		
+		flush();
+		
 		RenderProgramScope<RenderCanvasProgramState> scope;
 		if (scope.begin(m_engine.get(), shared->getProgram(pp))) {
 			scope->setTexture(texture);
-			Matrix3 mat;
-			mat.m00 = rectDst.getWidth(); mat.m10 = 0; mat.m20 = rectDst.left;
-			mat.m01 = 0; mat.m11 = rectDst.getHeight(); mat.m21 = rectDst.top;
-			mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
 			pp.applyToProgramState(scope.getState(), mat);
 			mat *= state->matrix;
 			mat *= m_matViewport;
@@ -1164,6 +1254,102 @@ namespace slib
 		
 	}
 	
+	void RenderCanvas::flush()
+	{
+		sl_uint32 nQuads = m_nBatchQuads;
+		if (!nQuads) {
+			return;
+		}
+		m_nBatchQuads = 0;
+		Ref<Texture> texture = m_textureBatch;
+		m_textureBatch.setNull();
+		
+		_priv_RenderCanvas_Shared* shared = _priv_RenderCanvas_getShared();
+		if (!shared) {
+			return;
+		}
+		
+		m_vbBatch->update(0, sizeof(RenderVertex2D_PositionTextureColor) * 4 * nQuads);
+		
+		RenderProgramScope<RenderProgramState2D_PositionTextureColor> scope;
+		if (scope.begin(m_engine.get(), texture.isNotNull() ? shared->programBatchTexture : shared->programBatchSolid)) {
+			scope->setTransform(Matrix3::identity());
+			scope->setColor(Color4f(1, 1, 1, 1));
+			if (texture.isNotNull()) {
+				scope->setTexture(texture);
+			}
+			m_engine->drawPrimitive(nQuads * 6, m_vbBatch, m_ibBatch, PrimitiveType::Triangle);
+		}
+	}
+	
+	sl_bool RenderCanvas::_prepareBatch()
+	{
+		if (m_vbBatch.isNotNull()) {
+			return sl_true;
+		}
+		Ref<IndexBuffer> ib = m_engine->getDefaultIndexBufferForBatchQuads2D();
+		if (ib.isNull()) {
+			return sl_false;
+		}
+		sl_uint32 nMaxQuads = m_engine->getMaxQuadsCountOfBatch2D();
+		Ref<VertexBuffer> vb = VertexBuffer::create(Memory::create(sizeof(RenderVertex2D_PositionTextureColor) * 4 * nMaxQuads));
+		if (vb.isNull()) {
+			return sl_false;
+		}
+		vb->setStatic(sl_false);
+		m_ibBatch = ib;
+		m_nMaxBatchQuads = nMaxQuads;
+		m_vbBatch = vb;
+		return sl_true;
+	}
+	
+	sl_bool RenderCanvas::_addQuadToBatch(const Matrix3& transform, const Ref<Texture>& texture, const Vector4& rectSrc, const Color4f& color)
+	{
+		if (!(_prepareBatch())) {
+			return sl_false;
+		}
+		if (m_nBatchQuads) {
+			if (m_nBatchQuads >= m_nMaxBatchQuads || m_textureBatch != texture) {
+				flush();
+			} else if (texture.isNotNull()) {
+				// the pending quads should be drawn with the pixels before the update
+				Ref<TextureInstance> textureInstance = texture->getInstance(m_engine.get());
+				if (textureInstance.isNotNull() && textureInstance->_isUpdated()) {
+					flush();
+				}
+			}
+		}
+		if (!m_nBatchQuads) {
+			m_textureBatch = texture;
+		}
+		RenderVertex2D_PositionTextureColor* v = (RenderVertex2D_PositionTextureColor*)(m_vbBatch->getBuffer()) + (m_nBatchQuads << 2);
+		// corners of the unit square: (0, 0), (1, 0), (0, 1), (1, 1)
+		sl_real x0 = transform.m20;
+		sl_real y0 = transform.m21;
+		v[0].position.x = x0;
+		v[0].position.y = y0;
+		v[1].position.x = x0 + transform.m00;
+		v[1].position.y = y0 + transform.m01;
+		v[2].position.x = x0 + transform.m10;
+		v[2].position.y = y0 + transform.m11;
+		v[3].position.x = v[1].position.x + transform.m10;
+		v[3].position.y = v[1].position.y + transform.m11;
+		sl_real u0 = rectSrc.x;
+		sl_real v0 = rectSrc.y;
+		sl_real u1 = rectSrc.x + rectSrc.z;
+		sl_real v1 = rectSrc.y + rectSrc.w;
+		v[0].texCoord.x = u0; v[0].texCoord.y = v0;
+		v[1].texCoord.x = u1; v[1].texCoord.y = v0;
+		v[2].texCoord.x = u0; v[2].texCoord.y = v1;
+		v[3].texCoord.x = u1; v[3].texCoord.y = v1;
+		v[0].color = color;
+		v[1].color = color;
+		v[2].color = color;
+		v[3].color = color;
+		m_nBatchQuads++;
+		return sl_true;
+	}
+	
 	void RenderCanvas::_drawBitmap(const Rectangle& rectDst, Bitmap* src, const Rectangle& rectSrc, const DrawParam& param)
 	{
 		Ref<Texture> texture = Texture::getBitmapRenderingCache(src);
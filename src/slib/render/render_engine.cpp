@@ -26,6 +26,30 @@
 #include "slib/graphics/canvas.h"
 #include "slib/ui/core.h"
 #include "slib/math/transform3d.h"
+#include "slib/graphics/image.h"
+#include "slib/core/thread_pool.h"
+#include "slib/core/system.h"
+
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64)
+#include <arm_neon.h>
+#endif
+
+// 4 vertices per quad, so the indices fit in 16 bits
+#define PRIV_RENDER_BATCH2D_MAX_QUADS 2048
+
+#define PRIV_SW_RENDER_DEFAULT_TILE_SIZE 64
+#define PRIV_SW_RENDER_MIN_TILE_SIZE 16
+#define PRIV_SW_RENDER_MAX_TILE_SIZE 512
+#define PRIV_SW_RENDER_SPAN_SIZE 64
+// the pending triangles are rasterized when the count reaches this limit
+#define PRIV_SW_RENDER_MAX_TRIANGLES 16384
+#define PRIV_SW_RENDER_MAX_CLIPS 9
+// color (4), texture coordinate (2), clip positions (2 per clip)
+#define PRIV_SW_RENDER_MAX_VARYINGS (6 + 2 * PRIV_SW_RENDER_MAX_CLIPS)
+// the triangles having larger coordinates (in pixels) are discarded
+#define PRIV_SW_RENDER_MAX_COORDINATE 1048576.0f
 
 namespace slib
 {
@@ -129,6 +153,7 @@ namespace slib
 		
 		m_nCountDrawnElementsOnLastScene = 0;
 		m_nCountDrawnPrimitivesOnLastScene = 0;
+		m_nCountDrawCalls = 0;
 		m_timeLastDebugText.setZero();
 	}
 	
@@ -280,6 +305,7 @@ namespace slib
 			_drawPrimitive(&ep);
 			m_nCountDrawnElementsOnLastScene += primitive->countElements;
 			m_nCountDrawnPrimitivesOnLastScene++;
+			m_nCountDrawCalls++;
 		}
 	}
 	
@@ -665,6 +691,39 @@ namespace slib
 		return ret;
 	}
 	
+	Ref<IndexBuffer> RenderEngine::getDefaultIndexBufferForBatchQuads2D()
+	{
+		Ref<IndexBuffer> ret = m_defaultIndexBufferForBatchQuads2D;
+		if (ret.isNull()) {
+			Memory mem = Memory::create(sizeof(sl_uint16) * 6 * PRIV_RENDER_BATCH2D_MAX_QUADS);
+			if (mem.isNull()) {
+				return sl_null;
+			}
+			sl_uint16* indices = (sl_uint16*)(mem.getData());
+			for (sl_uint32 i = 0; i < PRIV_RENDER_BATCH2D_MAX_QUADS; i++) {
+				sl_uint16 v = (sl_uint16)(i << 2);
+				indices[0] = v;
+				indices[1] = v + 1;
+				indices[2] = v + 2;
+				indices[3] = v + 2;
+				indices[4] = v + 1;
+				indices[5] = v + 3;
+				indices += 6;
+			}
+			ret = IndexBuffer::create(mem);
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			m_defaultIndexBufferForBatchQuads2D = ret;
+		}
+		return ret;
+	}
+	
+	sl_uint32 RenderEngine::getMaxQuadsCountOfBatch2D()
+	{
+		return PRIV_RENDER_BATCH2D_MAX_QUADS;
+	}
+	
 #define DEBUG_WIDTH 512
 #define DEBUG_HEIGHT 30
 	
@@ -788,4 +847,1990 @@ namespace slib
 		return m_nCountDrawnPrimitivesOnLastScene;
 	}
 	
+	sl_uint64 RenderEngine::getCountOfDrawCalls()
+	{
+		return m_nCountDrawCalls;
+	}
+	
+	void RenderEngine::resetCountOfDrawCalls()
+	{
+		m_nCountDrawCalls = 0;
+	}
+	
+/*******************************
+	SoftwareRenderEngine
+*******************************/
+	
+	SoftwareRenderEngineParam::SoftwareRenderEngineParam()
+	{
+		width = 0;
+		height = 0;
+		threadsCount = 0;
+		tileSize = PRIV_SW_RENDER_DEFAULT_TILE_SIZE;
+	}
+	
+	SoftwareRenderEngineParam::~SoftwareRenderEngineParam()
+	{
+	}
+	
+	
+	SLIB_DEFINE_OBJECT(SoftwareRenderEngine, RenderEngine)
+	
+	SoftwareRenderEngine::SoftwareRenderEngine()
+	{
+	}
+	
+	SoftwareRenderEngine::~SoftwareRenderEngine()
+	{
+	}
+	
+	
+	class _priv_SwRender_ProgramInstance : public RenderProgramInstance
+	{
+	public:
+		Ref<RenderProgramState> state;
+		
+		// indices of the state items, -1 when the program does not have them
+		sl_int32 uTransform;
+		sl_int32 uColor;
+		sl_int32 uTexture;
+		sl_int32 uTextureTransform;
+		sl_int32 uRectSrc;
+		sl_int32 uAlpha;
+		sl_int32 uDirectionalLight;
+		sl_int32 uDiffuseColor;
+		sl_int32 uAmbientColor;
+		sl_int32 uMatrixModelViewIT;
+		sl_int32 uColorFilter[5];
+		sl_int32 uClipRect;
+		sl_int32 uClipTransform;
+		sl_int32 uClipType;
+		
+		sl_int32 aPosition;
+		sl_int32 aTexCoord;
+		sl_int32 aColor;
+		sl_int32 aNormal;
+		
+		sl_uint32 sizeVertex;
+	
+	public:
+		_priv_SwRender_ProgramInstance()
+		{
+			uTransform = -1;
+			uColor = -1;
+			uTexture = -1;
+			uTextureTransform = -1;
+			uRectSrc = -1;
+			uAlpha = -1;
+			uDirectionalLight = -1;
+			uDiffuseColor = -1;
+			uAmbientColor = -1;
+			uMatrixModelViewIT = -1;
+			for (sl_uint32 i = 0; i < 5; i++) {
+				uColorFilter[i] = -1;
+			}
+			uClipRect = -1;
+			uClipTransform = -1;
+			uClipType = -1;
+			aPosition = -1;
+			aTexCoord = -1;
+			aColor = -1;
+			aNormal = -1;
+			sizeVertex = 0;
+		}
+	
+	public:
+		static Ref<_priv_SwRender_ProgramInstance> create(RenderEngine* engine, RenderProgram* program)
+		{
+			Ref<RenderProgramState> state = program->onCreate(engine);
+			if (state.isNull()) {
+				return sl_null;
+			}
+			if (!(program->onInit(engine, state.get()))) {
+				return sl_null;
+			}
+			// only the states declared by `SLIB_RENDER_PROGRAM_STATE_BEGIN` can be shaded
+			if (state->sw_uniforms.isNull()) {
+				return sl_null;
+			}
+			Ref<_priv_SwRender_ProgramInstance> ret = new _priv_SwRender_ProgramInstance;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			_priv_RenderProgramStateTemplate* st = (_priv_RenderProgramStateTemplate*)(state.get());
+			_priv_RenderProgramStateItem* item = st->items;
+			sl_int32 index = 0;
+			while (item->gl_name) {
+				const char* name = item->gl_name;
+				if (item->type == 1) {
+					if (Base::equalsString(name, "u_Transform")) {
+						ret->uTransform = index;
+					} else if (Base::equalsString(name, "u_Color")) {
+						ret->uColor = index;
+					} else if (Base::equalsString(name, "u_Texture")) {
+						ret->uTexture = index;
+					} else if (Base::equalsString(name, "u_TextureTransform")) {
+						ret->uTextureTransform = index;
+					} else if (Base::equalsString(name, "u_RectSrc")) {
+						ret->uRectSrc = index;
+					} else if (Base::equalsString(name, "u_Alpha")) {
+						ret->uAlpha = index;
+					} else if (Base::equalsString(name, "u_DirectionalLight")) {
+						ret->uDirectionalLight = index;
+					} else if (Base::equalsString(name, "u_DiffuseColor")) {
+						ret->uDiffuseColor = index;
+					} else if (Base::equalsString(name, "u_AmbientColor")) {
+						ret->uAmbientColor = index;
+					} else if (Base::equalsString(name, "u_MatrixModelViewIT")) {
+						ret->uMatrixModelViewIT = index;
+					} else if (Base::equalsString(name, "u_ColorFilterR")) {
+						ret->uColorFilter[0] = index;
+					} else if (Base::equalsString(name, "u_ColorFilterG")) {
+						ret->uColorFilter[1] = index;
+					} else if (Base::equalsString(name, "u_ColorFilterB")) {
+						ret->uColorFilter[2] = index;
+					} else if (Base::equalsString(name, "u_ColorFilterA")) {
+						ret->uColorFilter[3] = index;
+					} else if (Base::equalsString(name, "u_ColorFilterC")) {
+						ret->uColorFilter[4] = index;
+					} else if (Base::equalsString(name, "u_ClipRect")) {
+						ret->uClipRect = index;
+					} else if (Base::equalsString(name, "u_ClipTransform")) {
+						ret->uClipTransform = index;
+					} else if (Base::equalsString(name, "u_ClipType")) {
+						ret->uClipType = index;
+					}
+				} else if (item->type == 2 && item->attrType == 0) {
+					if (Base::equalsString(name, "a_Position")) {
+						if (item->attrCount == 2 || item->attrCount == 3) {
+							ret->aPosition = index;
+						}
+					} else if (Base::equalsString(name, "a_TexCoord")) {
+						if (item->attrCount == 2) {
+							ret->aTexCoord = index;
+						}
+					} else if (Base::equalsString(name, "a_Color")) {
+						if (item->attrCount == 3 || item->attrCount == 4) {
+							ret->aColor = index;
+						}
+					} else if (Base::equalsString(name, "a_Normal")) {
+						if (item->attrCount == 3) {
+							ret->aNormal = index;
+						}
+					}
+				}
+				item++;
+				index++;
+			}
+			if (ret->aPosition < 0) {
+				return sl_null;
+			}
+			ret->sizeVertex = st->_sizeVertexData;
+			ret->state = state;
+			ret->link(engine, program);
+			return ret;
+		}
+		
+		// returns null when the uniform is not set
+		const void* getUniform(sl_int32 index, sl_uint32 size)
+		{
+			if (index < 0) {
+				return sl_null;
+			}
+			RenderUniformValue& value = state->sw_uniforms[index];
+			if (value.size >= size) {
+				return value.data.getData();
+			}
+			return sl_null;
+		}
+		
+		sl_uint32 getUniformSize(sl_int32 index)
+		{
+			if (index < 0) {
+				return 0;
+			}
+			return state->sw_uniforms[index].size;
+		}
+		
+		Ref<Texture> getUniformTexture(sl_int32 index)
+		{
+			if (index < 0) {
+				return sl_null;
+			}
+			return state->sw_uniforms[index].texture;
+		}
+		
+		_priv_RenderProgramStateItem& getItem(sl_int32 index)
+		{
+			return ((_priv_RenderProgramStateTemplate*)(state.get()))->items[index];
+		}
+	
+	};
+	
+	class _priv_SwRender_VertexBufferInstance : public VertexBufferInstance
+	{
+	public:
+		// the vertices are read from the buffer of `VertexBuffer` when they are drawn
+		static Ref<_priv_SwRender_VertexBufferInstance> create(RenderEngine* engine, VertexBuffer* buffer)
+		{
+			Ref<_priv_SwRender_VertexBufferInstance> ret = new _priv_SwRender_VertexBufferInstance;
+			if (ret.isNotNull()) {
+				ret->link(engine, buffer);
+			}
+			return ret;
+		}
+	
+	};
+	
+	class _priv_SwRender_IndexBufferInstance : public IndexBufferInstance
+	{
+	public:
+		static Ref<_priv_SwRender_IndexBufferInstance> create(RenderEngine* engine, IndexBuffer* buffer)
+		{
+			Ref<_priv_SwRender_IndexBufferInstance> ret = new _priv_SwRender_IndexBufferInstance;
+			if (ret.isNotNull()) {
+				ret->link(engine, buffer);
+			}
+			return ret;
+		}
+	
+	};
+	
+	class _priv_SwRender_TextureInstance : public TextureInstance
+	{
+	public:
+		Ref<Image> image;
+		// `image` is the source of the texture itself
+		sl_bool flagShared;
+	
+	public:
+		_priv_SwRender_TextureInstance(): flagShared(sl_false)
+		{
+		}
+	
+	public:
+		static Ref<_priv_SwRender_TextureInstance> create(RenderEngine* engine, Texture* texture)
+		{
+			Ref<_priv_SwRender_TextureInstance> ret = new _priv_SwRender_TextureInstance;
+			if (ret.isNotNull()) {
+				if (ret->_load(texture)) {
+					ret->link(engine, texture);
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+		
+		sl_bool _load(Texture* texture)
+		{
+			Ref<Bitmap> source = texture->getSource();
+			if (source.isNull() || source->isEmpty()) {
+				return sl_false;
+			}
+			if (IsInstanceOf<Image>(source)) {
+				image = Ref<Image>::from(source);
+				flagShared = sl_true;
+			} else {
+				image = Image::create(source);
+				if (image.isNull()) {
+					return sl_false;
+				}
+				flagShared = sl_false;
+			}
+			if (texture->isFreeSourceOnUpdate()) {
+				texture->freeSource();
+			}
+			return sl_true;
+		}
+		
+		void onUpdate(RenderBaseObject* object) override
+		{
+			Texture* texture = (Texture*)object;
+			Ref<Bitmap> source = texture->getSource();
+			if (source.isNull()) {
+				return;
+			}
+			if (source != image && (flagShared || source->getWidth() != image->getWidth() || source->getHeight() != image->getHeight())) {
+				_load(texture);
+				return;
+			}
+			if (!flagShared) {
+				Rectanglei region = m_updatedRegion;
+				if (region.left < 0) {
+					region.left = 0;
+				}
+				if (region.top < 0) {
+					region.top = 0;
+				}
+				if (region.right > (sl_int32)(image->getWidth())) {
+					region.right = image->getWidth();
+				}
+				if (region.bottom > (sl_int32)(image->getHeight())) {
+					region.bottom = image->getHeight();
+				}
+				if (region.right > region.left && region.bottom > region.top) {
+					source->readPixels(region.left, region.top, region.getWidth(), region.getHeight(), image->getColorsAt(region.left, region.top), image->getStride());
+				}
+			}
+			if (texture->isFreeSourceOnUpdate()) {
+				texture->freeSource();
+			}
+		}
+	
+	};
+	
+	class _priv_SwRender_DrawCall : public Referable
+	{
+	public:
+		// 0: no blending, 1: default blending (source over), 2: generic
+		sl_uint32 blendMode;
+		RenderBlendingParam blending;
+		
+		sl_bool flagDepthTest;
+		sl_bool flagDepthWrite;
+		RenderFunctionOperation depthFunction;
+		
+		Ref<Image> texture;
+		sl_bool flagTextureLinear;
+		TextureWrapMode textureWrapX;
+		TextureWrapMode textureWrapY;
+		
+		sl_bool flagColorFilter;
+		float colorFilter[5][4];
+		
+		sl_uint32 nClips;
+		sl_int32 clipTypes[PRIV_SW_RENDER_MAX_CLIPS];
+		float clipRects[PRIV_SW_RENDER_MAX_CLIPS][4];
+		
+		// color (4), texture coordinate (2, optional), clip positions (2 per clip)
+		sl_uint32 nVaryings;
+		sl_uint32 indexClipVaryings;
+		
+		sl_bool flagPerspective;
+	
+	};
+	
+	// after the vertex stage, in clip space
+	struct _priv_SwRender_Vertex
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+		float v[PRIV_SW_RENDER_MAX_VARYINGS];
+	};
+	
+	// in window space (pixels from the top-left of the target), the varyings are divided by `w` for the perspective correction
+	struct _priv_SwRender_ScreenVertex
+	{
+		float x;
+		float y;
+		float z;
+		float q;
+		float v[PRIV_SW_RENDER_MAX_VARYINGS];
+	};
+	
+	struct _priv_SwRender_Triangle
+	{
+		_priv_SwRender_DrawCall* call;
+		
+		// bounds of the covered pixels (inclusive)
+		sl_int32 left;
+		sl_int32 top;
+		sl_int32 right;
+		sl_int32 bottom;
+		
+		// edge functions on the sub-pixel grid, the inside is positive
+		sl_int64 edgeA[3];
+		sl_int64 edgeB[3];
+		sl_int64 edgeC[3];
+		// 0: the pixels on the edge are covered (top-left rule), 1: not covered
+		sl_int64 edgeBias[3];
+		
+		// origin of the planes: value, d/dx, d/dy
+		float x0;
+		float y0;
+		float z[3];
+		float q[3];
+		float v[PRIV_SW_RENDER_MAX_VARYINGS][3];
+		
+		// the fragment color is same on the whole triangle
+		sl_bool flagFlat;
+	
+	};
+	
+	struct _priv_SwRender_Bin
+	{
+		sl_uint32* indices;
+		sl_uint32 count;
+		sl_uint32 capacity;
+	};
+	
+	SLIB_INLINE static sl_int64 _priv_SwRender_floorDiv(sl_int64 a, sl_int64 b)
+	{
+		// b > 0
+		if (a >= 0) {
+			return a / b;
+		} else {
+			return -((-a + b - 1) / b);
+		}
+	}
+	
+	SLIB_INLINE static sl_int64 _priv_SwRender_ceilDiv(sl_int64 a, sl_int64 b)
+	{
+		return -_priv_SwRender_floorDiv(-a, b);
+	}
+	
+	SLIB_INLINE static sl_int32 _priv_SwRender_floor(float f)
+	{
+		sl_int32 n = (sl_int32)f;
+		return n - (f < (float)n);
+	}
+	
+	SLIB_INLINE static float _priv_SwRender_clamp01(float f)
+	{
+		return f < 0 ? 0 : (f > 1 ? 1 : f);
+	}
+	
+	SLIB_INLINE static sl_int32 _priv_SwRender_wrap(sl_int32 i, sl_int32 n, TextureWrapMode mode)
+	{
+		if (mode == TextureWrapMode::Repeat) {
+			i %= n;
+			if (i < 0) {
+				i += n;
+			}
+			return i;
+		} else if (mode == TextureWrapMode::Mirror) {
+			sl_int32 n2 = n << 1;
+			i %= n2;
+			if (i < 0) {
+				i += n2;
+			}
+			if (i >= n) {
+				i = n2 - 1 - i;
+			}
+			return i;
+		} else {
+			return i < 0 ? 0 : (i >= n ? n - 1 : i);
+		}
+	}
+	
+	static void _priv_SwRender_sampleTexture(_priv_SwRender_DrawCall* call, float u, float v, float* output)
+	{
+		Image* image = call->texture.get();
+		sl_int32 w = (sl_int32)(image->getWidth());
+		sl_int32 h = (sl_int32)(image->getHeight());
+		sl_int32 stride = image->getStride();
+		Color* colors = image->getColors();
+		float fx = u * (float)w;
+		float fy = v * (float)h;
+		// keep the coordinates in the range of integers
+		if (!(fx > -16777216.0f)) {
+			fx = -16777216.0f;
+		} else if (fx > 16777216.0f) {
+			fx = 16777216.0f;
+		}
+		if (!(fy > -16777216.0f)) {
+			fy = -16777216.0f;
+		} else if (fy > 16777216.0f) {
+			fy = 16777216.0f;
+		}
+		const float k = 1.0f / 255.0f;
+		if (call->flagTextureLinear) {
+			fx -= 0.5f;
+			fy -= 0.5f;
+			sl_int32 ix = _priv_SwRender_floor(fx);
+			sl_int32 iy = _priv_SwRender_floor(fy);
+			float ax = fx - (float)ix;
+			float ay = fy - (float)iy;
+			sl_int32 x0 = _priv_SwRender_wrap(ix, w, call->textureWrapX);
+			sl_int32 x1 = _priv_SwRender_wrap(ix + 1, w, call->textureWrapX);
+			sl_int32 y0 = _priv_SwRender_wrap(iy, h, call->textureWrapY);
+			sl_int32 y1 = _priv_SwRender_wrap(iy + 1, h, call->textureWrapY);
+			Color& c00 = colors[y0 * stride + x0];
+			Color& c01 = colors[y0 * stride + x1];
+			Color& c10 = colors[y1 * stride + x0];
+			Color& c11 = colors[y1 * stride + x1];
+			float w00 = (1 - ax) * (1 - ay) * k;
+			float w01 = ax * (1 - ay) * k;
+			float w10 = (1 - ax) * ay * k;
+			float w11 = ax * ay * k;
+			output[0] = c00.r * w00 + c01.r * w01 + c10.r * w10 + c11.r * w11;
+			output[1] = c00.g * w00 + c01.g * w01 + c10.g * w10 + c11.g * w11;
+			output[2] = c00.b * w00 + c01.b * w01 + c10.b * w10 + c11.b * w11;
+			output[3] = c00.a * w00 + c01.a * w01 + c10.a * w10 + c11.a * w11;
+		} else {
+			sl_int32 x = _priv_SwRender_wrap(_priv_SwRender_floor(fx), w, call->textureWrapX);
+			sl_int32 y = _priv_SwRender_wrap(_priv_SwRender_floor(fy), h, call->textureWrapY);
+			Color& c = colors[y * stride + x];
+			output[0] = c.r * k;
+			output[1] = c.g * k;
+			output[2] = c.b * k;
+			output[3] = c.a * k;
+		}
+	}
+	
+	// returns sl_false when the fragment is discarded
+	static sl_bool _priv_SwRender_shadeFragment(_priv_SwRender_DrawCall* call, const float* varyings, float* output)
+	{
+		float r = varyings[0];
+		float g = varyings[1];
+		float b = varyings[2];
+		float a = varyings[3];
+		for (sl_uint32 i = 0; i < call->nClips; i++) {
+			const float* pos = varyings + call->indexClipVaryings + (i << 1);
+			const float* rect = call->clipRects[i];
+			if (call->clipTypes[i]) {
+				// ellipse: `pos` is relative to the center
+				float wClip = (rect[2] - rect[0]) / 2;
+				float hClip = (rect[3] - rect[1]) / 2;
+				float xClip = pos[0] / wClip;
+				float yClip = pos[1] / hClip;
+				float lenClip = xClip * xClip + yClip * yClip;
+				if (!(lenClip <= 1.0f)) {
+					return sl_false;
+				}
+				if (call->clipTypes[i] == 2) {
+					// smoothstep(0, 1.5 / sqrt(w * h), 1 - len)
+					float e = 1.5f / Math::sqrt(wClip * hClip);
+					float t = _priv_SwRender_clamp01((1.0f - Math::sqrt(lenClip)) / e);
+					a *= t * t * (3.0f - 2.0f * t);
+				}
+			} else {
+				if (!(rect[0] <= pos[0] && rect[1] <= pos[1] && pos[0] <= rect[2] && pos[1] <= rect[3])) {
+					return sl_false;
+				}
+			}
+		}
+		if (call->texture.isNotNull()) {
+			float t[4];
+			_priv_SwRender_sampleTexture(call, varyings[4], varyings[5], t);
+			if (call->flagColorFilter) {
+				float (*f)[4] = call->colorFilter;
+				float c[4];
+				for (sl_uint32 k = 0; k < 4; k++) {
+					c[k] = t[0] * f[k][0] + t[1] * f[k][1] + t[2] * f[k][2] + t[3] * f[k][3] + f[4][k];
+				}
+				r *= c[0];
+				g *= c[1];
+				b *= c[2];
+				a *= c[3];
+			} else {
+				r *= t[0];
+				g *= t[1];
+				b *= t[2];
+				a *= t[3];
+			}
+		}
+		output[0] = r;
+		output[1] = g;
+		output[2] = b;
+		output[3] = a;
+		return sl_true;
+	}
+	
+	SLIB_INLINE static void _priv_SwRender_getBlendingFactor(RenderBlendingFactor factor, const float* s, const float* d, const Vector4& c, float* f)
+	{
+		switch (factor) {
+			case RenderBlendingFactor::One:
+				f[0] = f[1] = f[2] = f[3] = 1;
+				break;
+			case RenderBlendingFactor::Zero:
+				f[0] = f[1] = f[2] = f[3] = 0;
+				break;
+			case RenderBlendingFactor::SrcAlpha:
+				f[0] = f[1] = f[2] = f[3] = s[3];
+				break;
+			case RenderBlendingFactor::OneMinusSrcAlpha:
+				f[0] = f[1] = f[2] = f[3] = 1 - s[3];
+				break;
+			case RenderBlendingFactor::DstAlpha:
+				f[0] = f[1] = f[2] = f[3] = d[3];
+				break;
+			case RenderBlendingFactor::OneMinusDstAlpha:
+				f[0] = f[1] = f[2] = f[3] = 1 - d[3];
+				break;
+			case RenderBlendingFactor::SrcColor:
+				f[0] = s[0]; f[1] = s[1]; f[2] = s[2]; f[3] = s[3];
+				break;
+			case RenderBlendingFactor::OneMinusSrcColor:
+				f[0] = 1 - s[0]; f[1] = 1 - s[1]; f[2] = 1 - s[2]; f[3] = 1 - s[3];
+				break;
+			case RenderBlendingFactor::DstColor:
+				f[0] = d[0]; f[1] = d[1]; f[2] = d[2]; f[3] = d[3];
+				break;
+			case RenderBlendingFactor::OneMinusDstColor:
+				f[0] = 1 - d[0]; f[1] = 1 - d[1]; f[2] = 1 - d[2]; f[3] = 1 - d[3];
+				break;
+			case RenderBlendingFactor::SrcAlphaSaturate:
+				f[0] = f[1] = f[2] = Math::min(s[3], 1 - d[3]);
+				f[3] = 1;
+				break;
+			case RenderBlendingFactor::Constant:
+				f[0] = (float)(c.x); f[1] = (float)(c.y); f[2] = (float)(c.z); f[3] = (float)(c.w);
+				break;
+			case RenderBlendingFactor::OneMinusConstant:
+				f[0] = 1 - (float)(c.x); f[1] = 1 - (float)(c.y); f[2] = 1 - (float)(c.z); f[3] = 1 - (float)(c.w);
+				break;
+			case RenderBlendingFactor::ConstantAlpha:
+				f[0] = f[1] = f[2] = f[3] = (float)(c.w);
+				break;
+			case RenderBlendingFactor::OneMinusConstantAlpha:
+				f[0] = f[1] = f[2] = f[3] = 1 - (float)(c.w);
+				break;
+		}
+	}
+	
+	SLIB_INLINE static float _priv_SwRender_blendOperation(RenderBlendingOperation op, float s, float d)
+	{
+		switch (op) {
+			case RenderBlendingOperation::Subtract:
+				return s - d;
+			case RenderBlendingOperation::ReverseSubtract:
+				return d - s;
+			default:
+				return s + d;
+		}
+	}
+	
+	SLIB_INLINE static sl_uint8 _priv_SwRender_toByte(float f)
+	{
+		return (sl_uint8)(_priv_SwRender_clamp01(f) * 255.0f + 0.5f);
+	}
+	
+	// writes the shaded span into the target, `mask[i] == 0` for the discarded fragments
+	static void _priv_SwRender_writeSpan(_priv_SwRender_DrawCall* call, Color* dst, const float* src, const sl_uint8* mask, sl_uint32 n)
+	{
+		if (call->blendMode == 1) {
+			// src * srcAlpha + dst * (1 - srcAlpha), alpha: src + dst * (1 - srcAlpha)
+#if defined(SLIB_ARCH_IS_X64)
+			__m128 zero = _mm_setzero_ps();
+			__m128 one = _mm_set1_ps(1.0f);
+			__m128 c255 = _mm_set1_ps(255.0f);
+			__m128 inv255 = _mm_set1_ps(1.0f / 255.0f);
+			__m128 half = _mm_set1_ps(0.5f);
+			__m128i izero = _mm_setzero_si128();
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					__m128 s = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + (i << 2)), zero), one);
+					__m128 a = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+					// (a, a, a, 1)
+					__m128 fs = _mm_shuffle_ps(a, _mm_unpackhi_ps(a, one), _MM_SHUFFLE(1, 0, 1, 0));
+					__m128 fd = _mm_sub_ps(one, a);
+					__m128i di = _mm_cvtsi32_si128(*((sl_int32*)(dst + i)));
+					di = _mm_unpacklo_epi16(_mm_unpacklo_epi8(di, izero), izero);
+					__m128 d = _mm_mul_ps(_mm_cvtepi32_ps(di), inv255);
+					__m128 o = _mm_add_ps(_mm_mul_ps(s, fs), _mm_mul_ps(d, fd));
+					__m128i oi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(o, c255), half));
+					oi = _mm_packs_epi32(oi, oi);
+					oi = _mm_packus_epi16(oi, oi);
+					*((sl_int32*)(dst + i)) = _mm_cvtsi128_si32(oi);
+				}
+			}
+#elif defined(SLIB_ARCH_IS_ARM64)
+			float32x4_t zero = vdupq_n_f32(0.0f);
+			float32x4_t one = vdupq_n_f32(1.0f);
+			float32x4_t c255 = vdupq_n_f32(255.0f);
+			float32x4_t inv255 = vdupq_n_f32(1.0f / 255.0f);
+			float32x4_t half = vdupq_n_f32(0.5f);
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					float32x4_t s = vminq_f32(vmaxq_f32(vld1q_f32(src + (i << 2)), zero), one);
+					float32x4_t a = vdupq_laneq_f32(s, 3);
+					float32x4_t fs = vsetq_lane_f32(1.0f, a, 3);
+					float32x4_t fd = vsubq_f32(one, a);
+					uint16x8_t d16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(*((uint32_t*)(dst + i)))));
+					float32x4_t d = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(d16))), inv255);
+					float32x4_t o = vmlaq_f32(vmulq_f32(s, fs), d, fd);
+					uint16x4_t o16 = vmovn_u32(vcvtq_u32_f32(vmlaq_f32(half, o, c255)));
+					uint8x8_t o8 = vmovn_u16(vcombine_u16(o16, o16));
+					*((uint32_t*)(dst + i)) = vget_lane_u32(vreinterpret_u32_u8(o8), 0);
+				}
+			}
+#else
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					const float* s = src + (i << 2);
+					float a = _priv_SwRender_clamp01(s[3]);
+					float ia = (1 - a) / 255.0f;
+					Color& d = dst[i];
+					d.r = _priv_SwRender_toByte(s[0] * a + d.r * ia);
+					d.g = _priv_SwRender_toByte(s[1] * a + d.g * ia);
+					d.b = _priv_SwRender_toByte(s[2] * a + d.b * ia);
+					d.a = _priv_SwRender_toByte(a + d.a * ia);
+				}
+			}
+#endif
+		} else if (call->blendMode == 0) {
+#if defined(SLIB_ARCH_IS_X64)
+			__m128 zero = _mm_setzero_ps();
+			__m128 one = _mm_set1_ps(1.0f);
+			__m128 c255 = _mm_set1_ps(255.0f);
+			__m128 half = _mm_set1_ps(0.5f);
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					__m128 s = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + (i << 2)), zero), one);
+					__m128i oi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(s, c255), half));
+					oi = _mm_packs_epi32(oi, oi);
+					oi = _mm_packus_epi16(oi, oi);
+					*((sl_int32*)(dst + i)) = _mm_cvtsi128_si32(oi);
+				}
+			}
+#elif defined(SLIB_ARCH_IS_ARM64)
+			float32x4_t zero = vdupq_n_f32(0.0f);
+			float32x4_t one = vdupq_n_f32(1.0f);
+			float32x4_t c255 = vdupq_n_f32(255.0f);
+			float32x4_t half = vdupq_n_f32(0.5f);
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					float32x4_t s = vminq_f32(vmaxq_f32(vld1q_f32(src + (i << 2)), zero), one);
+					uint16x4_t o16 = vmovn_u32(vcvtq_u32_f32(vmlaq_f32(half, s, c255)));
+					uint8x8_t o8 = vmovn_u16(vcombine_u16(o16, o16));
+					*((uint32_t*)(dst + i)) = vget_lane_u32(vreinterpret_u32_u8(o8), 0);
+				}
+			}
+#else
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					const float* s = src + (i << 2);
+					Color& d = dst[i];
+					d.r = _priv_SwRender_toByte(s[0]);
+					d.g = _priv_SwRender_toByte(s[1]);
+					d.b = _priv_SwRender_toByte(s[2]);
+					d.a = _priv_SwRender_toByte(s[3]);
+				}
+			}
+#endif
+		} else {
+			RenderBlendingParam& param = call->blending;
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (mask[i]) {
+					float s[4];
+					s[0] = _priv_SwRender_clamp01(src[i << 2]);
+					s[1] = _priv_SwRender_clamp01(src[(i << 2) + 1]);
+					s[2] = _priv_SwRender_clamp01(src[(i << 2) + 2]);
+					s[3] = _priv_SwRender_clamp01(src[(i << 2) + 3]);
+					Color& c = dst[i];
+					float d[4];
+					d[0] = c.r / 255.0f;
+					d[1] = c.g / 255.0f;
+					d[2] = c.b / 255.0f;
+					d[3] = c.a / 255.0f;
+					float fs[4], fd[4], fsa[4], fda[4];
+					_priv_SwRender_getBlendingFactor(param.blendSrc, s, d, param.blendConstant, fs);
+					_priv_SwRender_getBlendingFactor(param.blendDst, s, d, param.blendConstant, fd);
+					_priv_SwRender_getBlendingFactor(param.blendSrcAlpha, s, d, param.blendConstant, fsa);
+					_priv_SwRender_getBlendingFactor(param.blendDstAlpha, s, d, param.blendConstant, fda);
+					c.r = _priv_SwRender_toByte(_priv_SwRender_blendOperation(param.operation, s[0] * fs[0], d[0] * fd[0]));
+					c.g = _priv_SwRender_toByte(_priv_SwRender_blendOperation(param.operation, s[1] * fs[1], d[1] * fd[1]));
+					c.b = _priv_SwRender_toByte(_priv_SwRender_blendOperation(param.operation, s[2] * fs[2], d[2] * fd[2]));
+					c.a = _priv_SwRender_toByte(_priv_SwRender_blendOperation(param.operationAlpha, s[3] * fsa[3], d[3] * fda[3]));
+				}
+			}
+		}
+	}
+	
+	SLIB_INLINE static sl_bool _priv_SwRender_testDepth(RenderFunctionOperation op, float z, float d)
+	{
+		switch (op) {
+			case RenderFunctionOperation::Never:
+				return sl_false;
+			case RenderFunctionOperation::Always:
+				return sl_true;
+			case RenderFunctionOperation::Equal:
+				return z == d;
+			case RenderFunctionOperation::NotEqual:
+				return z != d;
+			case RenderFunctionOperation::Less:
+				return z < d;
+			case RenderFunctionOperation::LessEqual:
+				return z <= d;
+			case RenderFunctionOperation::Greater:
+				return z > d;
+			case RenderFunctionOperation::GreaterEqual:
+				return z >= d;
+		}
+		return sl_true;
+	}
+	
+	SLIB_INLINE static sl_int64 _priv_SwRender_toSubpixel(float f)
+	{
+		// 16 sub-pixels per pixel
+		f *= 16.0f;
+		if (f >= 0) {
+			return (sl_int64)(f + 0.5f);
+		} else {
+			return -(sl_int64)(0.5f - f);
+		}
+	}
+	
+	class _priv_SoftwareRenderEngineImpl : public SoftwareRenderEngine
+	{
+	public:
+		Ref<Bitmap> m_target;
+		Ref<Image> m_image;
+		// `m_target` is not an `Image`, so the rendered image is written back on `endScene`
+		sl_bool m_flagWriteBack;
+		sl_uint32 m_width;
+		sl_uint32 m_height;
+		Memory m_memDepth;
+		float* m_depth;
+		
+		// OpenGL convention: `y` is measured from the bottom of the target
+		sl_int32 m_viewportX;
+		sl_int32 m_viewportY;
+		sl_int32 m_viewportW;
+		sl_int32 m_viewportH;
+		// inclusive pixel bounds from the top-left of the target
+		sl_int32 m_scissorLeft;
+		sl_int32 m_scissorTop;
+		sl_int32 m_scissorRight;
+		sl_int32 m_scissorBottom;
+		
+		sl_bool m_flagDepthTest;
+		sl_bool m_flagDepthWrite;
+		RenderFunctionOperation m_depthFunction;
+		sl_bool m_flagCullFace;
+		sl_bool m_flagCullCCW;
+		sl_bool m_flagBlending;
+		RenderBlendingParam m_blending;
+		float m_lineWidth;
+		
+		Ref<RenderProgram> m_currentProgram;
+		Ref<_priv_SwRender_ProgramInstance> m_currentProgramInstance;
+		
+		sl_uint32 m_tileSize;
+		sl_uint32 m_countTilesX;
+		sl_uint32 m_countTilesY;
+		_priv_SwRender_Bin* m_bins;
+		
+		_priv_SwRender_Triangle* m_triangles;
+		sl_uint32 m_countTriangles;
+		sl_uint32 m_capacityTriangles;
+		
+		// keeps the states referenced by the pending triangles
+		CList< Ref<_priv_SwRender_DrawCall> > m_calls;
+		Ref<_priv_SwRender_DrawCall> m_currentCall;
+		
+		_priv_SwRender_Vertex* m_vertices;
+		sl_uint32 m_capacityVertices;
+		
+		Ref<ThreadPool> m_threadPool;
+	
+	public:
+		_priv_SoftwareRenderEngineImpl()
+		{
+			m_flagWriteBack = sl_false;
+			m_width = 0;
+			m_height = 0;
+			m_depth = sl_null;
+			
+			m_viewportX = 0;
+			m_viewportY = 0;
+			m_viewportW = 0;
+			m_viewportH = 0;
+			m_scissorLeft = 0;
+			m_scissorTop = 0;
+			m_scissorRight = -1;
+			m_scissorBottom = -1;
+			
+			m_flagDepthTest = sl_false;
+			m_flagDepthWrite = sl_true;
+			m_depthFunction = RenderFunctionOperation::Less;
+			m_flagCullFace = sl_false;
+			m_flagCullCCW = sl_true;
+			m_flagBlending = sl_false;
+			m_lineWidth = 1;
+			
+			m_tileSize = PRIV_SW_RENDER_DEFAULT_TILE_SIZE;
+			m_countTilesX = 0;
+			m_countTilesY = 0;
+			m_bins = sl_null;
+			
+			m_triangles = sl_null;
+			m_countTriangles = 0;
+			m_capacityTriangles = 0;
+			
+			m_vertices = sl_null;
+			m_capacityVertices = 0;
+		}
+		
+		~_priv_SoftwareRenderEngineImpl()
+		{
+			if (m_threadPool.isNotNull()) {
+				m_threadPool->release();
+			}
+			_freeBins();
+			if (m_triangles) {
+				Base::freeMemory(m_triangles);
+			}
+			if (m_vertices) {
+				Base::freeMemory(m_vertices);
+			}
+		}
+	
+	public:
+		static Ref<_priv_SoftwareRenderEngineImpl> create(const SoftwareRenderEngineParam& param)
+		{
+			Ref<Bitmap> target = param.target;
+			if (target.isNull()) {
+				if (!(param.width && param.height)) {
+					return sl_null;
+				}
+				Ref<Image> image = Image::create(param.width, param.height);
+				if (image.isNull()) {
+					return sl_null;
+				}
+				Base::zeroMemory(image->getColors(), (sl_size)(image->getStride()) * image->getHeight() * sizeof(Color));
+				target = image;
+			}
+			Ref<_priv_SoftwareRenderEngineImpl> ret = new _priv_SoftwareRenderEngineImpl;
+			if (ret.isNotNull()) {
+				sl_uint32 tileSize = param.tileSize;
+				if (tileSize < PRIV_SW_RENDER_MIN_TILE_SIZE) {
+					tileSize = PRIV_SW_RENDER_MIN_TILE_SIZE;
+				}
+				if (tileSize > PRIV_SW_RENDER_MAX_TILE_SIZE) {
+					tileSize = PRIV_SW_RENDER_MAX_TILE_SIZE;
+				}
+				ret->m_tileSize = tileSize;
+				sl_uint32 nThreads = param.threadsCount;
+				if (!nThreads) {
+					nThreads = System::getCpuCoresCount();
+				}
+				if (nThreads > 1) {
+					// the calling thread also rasterizes the tiles
+					ret->m_threadPool = ThreadPool::create(0, nThreads - 1);
+				}
+				if (ret->setTarget(target)) {
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+	
+	public:
+		RenderEngineType getEngineType() override
+		{
+			return RenderEngineType::Software;
+		}
+		
+		Ref<Bitmap> getTarget() override
+		{
+			return m_target;
+		}
+		
+		sl_bool setTarget(const Ref<Bitmap>& target) override
+		{
+			if (target.isNull() || target->isEmpty()) {
+				return sl_false;
+			}
+			flush();
+			sl_uint32 width = target->getWidth();
+			sl_uint32 height = target->getHeight();
+			Ref<Image> image;
+			sl_bool flagWriteBack;
+			if (IsInstanceOf<Image>(target)) {
+				image = Ref<Image>::from(target);
+				flagWriteBack = sl_false;
+			} else {
+				image = Image::create(target);
+				if (image.isNull()) {
+					return sl_false;
+				}
+				flagWriteBack = sl_true;
+			}
+			sl_size nPixels = (sl_size)width * height;
+			Memory memDepth = Memory::create(nPixels * sizeof(float));
+			if (memDepth.isNull()) {
+				return sl_false;
+			}
+			float* depth = (float*)(memDepth.getData());
+			for (sl_size i = 0; i < nPixels; i++) {
+				depth[i] = 1.0f;
+			}
+			sl_uint32 nTilesX = (width + m_tileSize - 1) / m_tileSize;
+			sl_uint32 nTilesY = (height + m_tileSize - 1) / m_tileSize;
+			_priv_SwRender_Bin* bins = (_priv_SwRender_Bin*)(Base::createMemory(sizeof(_priv_SwRender_Bin) * nTilesX * nTilesY));
+			if (!bins) {
+				return sl_false;
+			}
+			Base::zeroMemory(bins, sizeof(_priv_SwRender_Bin) * nTilesX * nTilesY);
+			_freeBins();
+			m_bins = bins;
+			m_countTilesX = nTilesX;
+			m_countTilesY = nTilesY;
+			m_target = target;
+			m_image = image;
+			m_flagWriteBack = flagWriteBack;
+			m_width = width;
+			m_height = height;
+			m_memDepth = memDepth;
+			m_depth = depth;
+			setViewport(0, 0, width, height);
+			return sl_true;
+		}
+		
+		void flush() override
+		{
+			if (m_countTriangles) {
+				_runParallel(m_countTilesX * m_countTilesY, [this](sl_uint32 index) {
+					_rasterizeTile(index);
+				});
+				sl_uint32 nTiles = m_countTilesX * m_countTilesY;
+				for (sl_uint32 i = 0; i < nTiles; i++) {
+					m_bins[i].count = 0;
+				}
+				m_countTriangles = 0;
+			}
+			m_calls.removeAll_NoLock();
+		}
+		
+		Ref<RenderProgramInstance> _createProgramInstance(RenderProgram* program) override
+		{
+			return _priv_SwRender_ProgramInstance::create(this, program);
+		}
+		
+		Ref<VertexBufferInstance> _createVertexBufferInstance(VertexBuffer* buffer) override
+		{
+			return _priv_SwRender_VertexBufferInstance::create(this, buffer);
+		}
+		
+		Ref<IndexBufferInstance> _createIndexBufferInstance(IndexBuffer* buffer) override
+		{
+			return _priv_SwRender_IndexBufferInstance::create(this, buffer);
+		}
+		
+		Ref<TextureInstance> _createTextureInstance(Texture* texture) override
+		{
+			return _priv_SwRender_TextureInstance::create(this, texture);
+		}
+		
+		sl_bool _beginScene() override
+		{
+			return m_image.isNotNull();
+		}
+		
+		void _endScene() override
+		{
+			flush();
+			if (m_flagWriteBack) {
+				m_target->writePixels(0, 0, m_width, m_height, m_image->getColors(), m_image->getStride());
+			}
+		}
+		
+		void _setViewport(sl_uint32 x, sl_uint32 y, sl_uint32 width, sl_uint32 height) override
+		{
+			m_viewportX = x;
+			m_viewportY = y;
+			m_viewportW = width;
+			m_viewportH = height;
+			sl_int32 h = (sl_int32)m_height;
+			m_scissorLeft = Math::max(m_viewportX, 0);
+			m_scissorRight = Math::min(m_viewportX + m_viewportW, (sl_int32)m_width) - 1;
+			m_scissorTop = Math::max(h - (m_viewportY + m_viewportH), 0);
+			m_scissorBottom = Math::min(h - m_viewportY, h) - 1;
+		}
+		
+		void _clear(const RenderClearParam& param) override
+		{
+			if (m_image.isNull()) {
+				return;
+			}
+			flush();
+			sl_bool flagColor = param.flagColor;
+			sl_bool flagDepth = param.flagDepth;
+			Color color = param.color;
+			float depth = param.depth;
+			sl_uint32 nRowsPerTask = m_tileSize;
+			_runParallel(m_countTilesY, [this, flagColor, flagDepth, color, depth, nRowsPerTask](sl_uint32 index) {
+				sl_uint32 y1 = index * nRowsPerTask;
+				sl_uint32 y2 = Math::min(y1 + nRowsPerTask, m_height);
+				for (sl_uint32 y = y1; y < y2; y++) {
+					if (flagColor) {
+						Color* row = m_image->getColorsAt(0, y);
+						for (sl_uint32 x = 0; x < m_width; x++) {
+							row[x] = color;
+						}
+					}
+					if (flagDepth) {
+						float* row = m_depth + (sl_size)y * m_width;
+						for (sl_uint32 x = 0; x < m_width; x++) {
+							row[x] = depth;
+						}
+					}
+				}
+			});
+		}
+		
+		void _setDepthTest(sl_bool flagEnableDepthTest) override
+		{
+			m_flagDepthTest = flagEnableDepthTest;
+		}
+		
+		void _setDepthWriteEnabled(sl_bool flagEnableDepthWrite) override
+		{
+			m_flagDepthWrite = flagEnableDepthWrite;
+		}
+		
+		void _setDepthFunction(RenderFunctionOperation op) override
+		{
+			m_depthFunction = op;
+		}
+		
+		void _setCullFace(sl_bool flagEnableCull, sl_bool flagCullCCW) override
+		{
+			m_flagCullFace = flagEnableCull;
+			m_flagCullCCW = flagCullCCW;
+		}
+		
+		void _setBlending(sl_bool flagEnableBlending, const RenderBlendingParam& param) override
+		{
+			m_flagBlending = flagEnableBlending;
+			m_blending = param;
+		}
+		
+		sl_bool _beginProgram(RenderProgram* program, RenderProgramInstance* instance, RenderProgramState** ppState) override
+		{
+			m_currentProgramInstance = (_priv_SwRender_ProgramInstance*)instance;
+			m_currentProgram = program;
+			if (ppState) {
+				*ppState = m_currentProgramInstance->state.get();
+			}
+			return sl_true;
+		}
+		
+		void _endProgram() override
+		{
+		}
+		
+		void _resetCurrentBuffers() override
+		{
+			m_currentProgram.setNull();
+			m_currentProgramInstance.setNull();
+		}
+		
+		void _drawPrimitive(EnginePrimitive* primitive) override
+		{
+			if (m_image.isNull()) {
+				return;
+			}
+			if (m_currentProgram.isNull()) {
+				return;
+			}
+			if (m_currentProgramInstance.isNull()) {
+				return;
+			}
+			RenderProgramState* state = m_currentProgramInstance->state.get();
+			if (!(m_currentProgram->onPreRender(this, state))) {
+				return;
+			}
+			_draw(primitive, m_currentProgramInstance.get());
+			m_currentProgram->onPostRender(this, state);
+		}
+		
+		void _applyTexture(Texture* texture, TextureInstance* instance, sl_reg sampler) override
+		{
+			// textures are resolved from the uniforms of the program state on each draw call
+		}
+		
+		void _setLineWidth(sl_real width) override
+		{
+			m_lineWidth = (float)width;
+		}
+	
+	public:
+		void _runParallel(sl_uint32 nTasks, const Function<void(sl_uint32 index)>& task)
+		{
+			if (m_threadPool.isNotNull()) {
+				m_threadPool->runParallel(nTasks, task);
+			} else {
+				for (sl_uint32 i = 0; i < nTasks; i++) {
+					task(i);
+				}
+			}
+		}
+		
+		void _freeBins()
+		{
+			if (m_bins) {
+				sl_uint32 nTiles = m_countTilesX * m_countTilesY;
+				for (sl_uint32 i = 0; i < nTiles; i++) {
+					if (m_bins[i].indices) {
+						Base::freeMemory(m_bins[i].indices);
+					}
+				}
+				Base::freeMemory(m_bins);
+				m_bins = sl_null;
+			}
+		}
+		
+		Ref<_priv_SwRender_DrawCall> _createDrawCall(_priv_SwRender_ProgramInstance* instance)
+		{
+			Ref<_priv_SwRender_DrawCall> call = new _priv_SwRender_DrawCall;
+			if (call.isNull()) {
+				return sl_null;
+			}
+			
+			if (m_flagBlending) {
+				RenderBlendingParam& b = m_blending;
+				if (b.operation == RenderBlendingOperation::Add && b.operationAlpha == RenderBlendingOperation::Add && b.blendSrc == RenderBlendingFactor::SrcAlpha && b.blendDst == RenderBlendingFactor::OneMinusSrcAlpha && b.blendSrcAlpha == RenderBlendingFactor::One && b.blendDstAlpha == RenderBlendingFactor::OneMinusSrcAlpha) {
+					call->blendMode = 1;
+				} else {
+					call->blendMode = 2;
+				}
+				call->blending = m_blending;
+			} else {
+				call->blendMode = 0;
+			}
+			
+			call->flagDepthTest = m_flagDepthTest;
+			call->flagDepthWrite = m_flagDepthWrite;
+			call->depthFunction = m_depthFunction;
+			
+			call->flagTextureLinear = sl_false;
+			call->textureWrapX = TextureWrapMode::Clamp;
+			call->textureWrapY = TextureWrapMode::Clamp;
+			// the states of some programs declare `u_Texture` without sampling it, so the draw calls without texture are shaded by the colors
+			Ref<Texture> texture = instance->getUniformTexture(instance->uTexture);
+			if (texture.isNotNull()) {
+				Ref<TextureInstance> _textureInstance = linkTexture(texture);
+				if (_textureInstance.isNull()) {
+					return sl_null;
+				}
+				_priv_SwRender_TextureInstance* textureInstance = (_priv_SwRender_TextureInstance*)(_textureInstance.get());
+				if (textureInstance->_isUpdated()) {
+					if (!(textureInstance->flagShared)) {
+						// the pending triangles are sampling the pixels to be overwritten
+						flush();
+					}
+					textureInstance->_update(texture.get());
+				}
+				call->texture = textureInstance->image;
+				if (call->texture.isNull()) {
+					return sl_null;
+				}
+				call->flagTextureLinear = texture->getMagFilter() == TextureFilterMode::Linear;
+				call->textureWrapX = texture->getWrapX();
+				call->textureWrapY = texture->getWrapY();
+			}
+			
+			call->flagColorFilter = sl_false;
+			if (call->texture.isNotNull()) {
+				const void* filters[5];
+				sl_uint32 k;
+				for (k = 0; k < 5; k++) {
+					filters[k] = instance->getUniform(instance->uColorFilter[k], sizeof(float) * 4);
+					if (!(filters[k])) {
+						break;
+					}
+				}
+				if (k == 5) {
+					call->flagColorFilter = sl_true;
+					for (k = 0; k < 5; k++) {
+						Base::copyMemory(call->colorFilter[k], filters[k], sizeof(float) * 4);
+					}
+				}
+			}
+			
+			sl_uint32 nClips = 0;
+			if (instance->uClipRect >= 0 && instance->uClipTransform >= 0) {
+				nClips = Math::min(instance->getUniformSize(instance->uClipRect) / (sizeof(float) * 4), instance->getUniformSize(instance->uClipTransform) / (sizeof(float) * 9));
+				if (nClips > PRIV_SW_RENDER_MAX_CLIPS) {
+					nClips = PRIV_SW_RENDER_MAX_CLIPS;
+				}
+			}
+			call->nClips = nClips;
+			if (nClips) {
+				Base::copyMemory(call->clipRects, instance->getUniform(instance->uClipRect, 0), sizeof(float) * 4 * nClips);
+				sl_uint32 nTypes = instance->getUniformSize(instance->uClipType) / sizeof(sl_int32);
+				const sl_int32* types = (const sl_int32*)(instance->getUniform(instance->uClipType, 0));
+				for (sl_uint32 i = 0; i < nClips; i++) {
+					call->clipTypes[i] = i < nTypes ? types[i] : 0;
+				}
+			}
+			call->indexClipVaryings = call->texture.isNotNull() ? 6 : 4;
+			call->nVaryings = call->indexClipVaryings + (nClips << 1);
+			
+			call->flagPerspective = sl_false;
+			if (instance->getUniformSize(instance->uTransform) >= sizeof(float) * 16) {
+				const float* m = (const float*)(instance->getUniform(instance->uTransform, 0));
+				if (!(m[3] == 0 && m[7] == 0 && m[11] == 0 && m[15] == 1)) {
+					call->flagPerspective = sl_true;
+				}
+			}
+			return call;
+		}
+		
+		void _transformVertex(_priv_SwRender_ProgramInstance* instance, _priv_SwRender_DrawCall* call, const sl_uint8* data, _priv_SwRender_Vertex* output)
+		{
+			_priv_RenderProgramStateItem& itemPosition = instance->getItem(instance->aPosition);
+			const float* position = (const float*)(data + itemPosition.attrOffset);
+			float x = position[0];
+			float y = position[1];
+			float z = itemPosition.attrCount == 3 ? position[2] : 0;
+			
+			// vec4(a_Position, 1.0) * u_Transform
+			sl_uint32 sizeTransform = instance->getUniformSize(instance->uTransform);
+			const float* m = (const float*)(instance->getUniform(instance->uTransform, 0));
+			if (sizeTransform >= sizeof(float) * 16) {
+				output->x = x * m[0] + y * m[4] + z * m[8] + m[12];
+				output->y = x * m[1] + y * m[5] + z * m[9] + m[13];
+				output->z = x * m[2] + y * m[6] + z * m[10] + m[14];
+				output->w = x * m[3] + y * m[7] + z * m[11] + m[15];
+			} else if (sizeTransform >= sizeof(float) * 9) {
+				output->x = x * m[0] + y * m[3] + m[6];
+				output->y = x * m[1] + y * m[4] + m[7];
+				output->z = 0;
+				output->w = 1;
+			} else {
+				output->x = x;
+				output->y = y;
+				output->z = z;
+				output->w = 1;
+			}
+			
+			float* color = output->v;
+			color[0] = 1;
+			color[1] = 1;
+			color[2] = 1;
+			color[3] = 1;
+			const float* alpha = (const float*)(instance->getUniform(instance->uAlpha, sizeof(float)));
+			if (instance->aNormal >= 0 && instance->uDirectionalLight >= 0) {
+				const float* normal = (const float*)(data + instance->getItem(instance->aNormal).attrOffset);
+				const float* L = (const float*)(instance->getUniform(instance->uDirectionalLight, sizeof(float) * 3));
+				const float* M = (const float*)(instance->getUniform(instance->uMatrixModelViewIT, sizeof(float) * 16));
+				const float* diffuseColor = (const float*)(instance->getUniform(instance->uDiffuseColor, sizeof(float) * 3));
+				const float* ambientColor = (const float*)(instance->getUniform(instance->uAmbientColor, sizeof(float) * 3));
+				float diffuse = 0;
+				if (L && M) {
+					// vec4(a_Normal, 0.0) * u_MatrixModelViewIT
+					float nx = normal[0] * M[0] + normal[1] * M[4] + normal[2] * M[8];
+					float ny = normal[0] * M[1] + normal[1] * M[5] + normal[2] * M[9];
+					float nz = normal[0] * M[2] + normal[1] * M[6] + normal[2] * M[10];
+					diffuse = Math::max(nx * L[0] + ny * L[1] + nz * L[2], 0.0f);
+				}
+				for (sl_uint32 k = 0; k < 3; k++) {
+					color[k] = (diffuseColor ? diffuse * diffuseColor[k] : 0) + (ambientColor ? ambientColor[k] : 0);
+				}
+				color[3] = alpha ? *alpha : 1;
+			} else if (alpha) {
+				color[3] = *alpha;
+			}
+			if (instance->aColor >= 0) {
+				_priv_RenderProgramStateItem& itemColor = instance->getItem(instance->aColor);
+				const float* c = (const float*)(data + itemColor.attrOffset);
+				color[0] *= c[0];
+				color[1] *= c[1];
+				color[2] *= c[2];
+				if (itemColor.attrCount == 4) {
+					color[3] *= c[3];
+				}
+			}
+			sl_uint32 sizeColor = instance->getUniformSize(instance->uColor);
+			if (sizeColor >= sizeof(float) * 3) {
+				const float* c = (const float*)(instance->getUniform(instance->uColor, 0));
+				color[0] *= c[0];
+				color[1] *= c[1];
+				color[2] *= c[2];
+				if (sizeColor >= sizeof(float) * 4) {
+					color[3] *= c[3];
+				}
+			}
+			
+			if (call->texture.isNotNull()) {
+				float u = 0, v = 0;
+				if (instance->aTexCoord >= 0) {
+					const float* t = (const float*)(data + instance->getItem(instance->aTexCoord).attrOffset);
+					u = t[0];
+					v = t[1];
+					const float* tm = (const float*)(instance->getUniform(instance->uTextureTransform, sizeof(float) * 9));
+					if (tm) {
+						float tu = u * tm[0] + v * tm[3] + tm[6];
+						float tv = u * tm[1] + v * tm[4] + tm[7];
+						u = tu;
+						v = tv;
+					}
+				} else {
+					// a_Position * u_RectSrc.zw + u_RectSrc.xy
+					const float* r = (const float*)(instance->getUniform(instance->uRectSrc, sizeof(float) * 4));
+					if (r) {
+						u = x * r[2] + r[0];
+						v = y * r[3] + r[1];
+					}
+				}
+				output->v[4] = u;
+				output->v[5] = v;
+			}
+			
+			if (call->nClips) {
+				const float* transforms = (const float*)(instance->getUniform(instance->uClipTransform, 0));
+				float* clip = output->v + call->indexClipVaryings;
+				for (sl_uint32 i = 0; i < call->nClips; i++) {
+					const float* t = transforms + i * 9;
+					float cx = x * t[0] + y * t[3] + t[6];
+					float cy = x * t[1] + y * t[4] + t[7];
+					if (call->clipTypes[i]) {
+						// relative to the center of the ellipse
+						const float* rect = call->clipRects[i];
+						cx -= (rect[0] + rect[2]) / 2;
+						cy -= (rect[1] + rect[3]) / 2;
+					}
+					clip[i << 1] = cx;
+					clip[(i << 1) + 1] = cy;
+				}
+			}
+		}
+		
+		void _draw(EnginePrimitive* primitive, _priv_SwRender_ProgramInstance* instance)
+		{
+			VertexBuffer* vb = primitive->vertexBuffer.get();
+			sl_uint8* dataVertices = vb->getBuffer();
+			sl_uint32 sizeVertex = instance->sizeVertex;
+			if (!dataVertices || !sizeVertex) {
+				return;
+			}
+			sl_uint32 nVertices = (sl_uint32)(vb->getSize() / sizeVertex);
+			sl_uint32 n = primitive->countElements;
+			sl_uint16* indices = sl_null;
+			if (primitive->indexBuffer.isNotNull()) {
+				IndexBuffer* ib = primitive->indexBuffer.get();
+				indices = (sl_uint16*)(ib->getBuffer());
+				if (!indices) {
+					return;
+				}
+				n = Math::min(n, (sl_uint32)(ib->getSize() / sizeof(sl_uint16)));
+			} else {
+				n = Math::min(n, nVertices);
+			}
+			if (!n) {
+				return;
+			}
+			
+			Ref<_priv_SwRender_DrawCall> call = _createDrawCall(instance);
+			if (call.isNull()) {
+				return;
+			}
+			if (n > m_capacityVertices) {
+				_priv_SwRender_Vertex* vertices = (_priv_SwRender_Vertex*)(Base::reallocMemory(m_vertices, sizeof(_priv_SwRender_Vertex) * n));
+				if (!vertices) {
+					return;
+				}
+				m_vertices = vertices;
+				m_capacityVertices = n;
+			}
+			if (!(m_calls.add_NoLock(call))) {
+				return;
+			}
+			m_currentCall = call;
+			
+			_priv_SwRender_Vertex* v = m_vertices;
+			for (sl_uint32 i = 0; i < n; i++) {
+				sl_uint32 index = indices ? indices[i] : i;
+				if (index < nVertices) {
+					_transformVertex(instance, call.get(), dataVertices + (sl_size)index * sizeVertex, v + i);
+				} else {
+					// outside of the near plane, so the primitives using this vertex are discarded
+					v[i].x = 0;
+					v[i].y = 0;
+					v[i].z = 0;
+					v[i].w = -1;
+				}
+			}
+			
+			sl_uint32 i;
+			switch (primitive->type) {
+				case PrimitiveType::Triangle:
+					for (i = 0; i + 2 < n; i += 3) {
+						_addClippedTriangle(v + i, v + i + 1, v + i + 2);
+					}
+					break;
+				case PrimitiveType::TriangleStrip:
+					for (i = 0; i + 2 < n; i++) {
+						if (i & 1) {
+							_addClippedTriangle(v + i + 1, v + i, v + i + 2);
+						} else {
+							_addClippedTriangle(v + i, v + i + 1, v + i + 2);
+						}
+					}
+					break;
+				case PrimitiveType::TriangleFan:
+					for (i = 1; i + 1 < n; i++) {
+						_addClippedTriangle(v, v + i, v + i + 1);
+					}
+					break;
+				case PrimitiveType::Line:
+					for (i = 0; i + 1 < n; i += 2) {
+						_addLine(v + i, v + i + 1);
+					}
+					break;
+				case PrimitiveType::LineStrip:
+				case PrimitiveType::LineLoop:
+					for (i = 0; i + 1 < n; i++) {
+						_addLine(v + i, v + i + 1);
+					}
+					if (primitive->type == PrimitiveType::LineLoop && n > 2) {
+						_addLine(v + n - 1, v);
+					}
+					break;
+				case PrimitiveType::Point:
+					for (i = 0; i < n; i++) {
+						_addPoint(v + i);
+					}
+					break;
+			}
+			
+			m_currentCall.setNull();
+		}
+		
+		void _interpolateVertex(const _priv_SwRender_Vertex* v1, const _priv_SwRender_Vertex* v2, float t, _priv_SwRender_Vertex* output)
+		{
+			output->x = v1->x + (v2->x - v1->x) * t;
+			output->y = v1->y + (v2->y - v1->y) * t;
+			output->z = v1->z + (v2->z - v1->z) * t;
+			output->w = v1->w + (v2->w - v1->w) * t;
+			sl_uint32 nVaryings = m_currentCall->nVaryings;
+			for (sl_uint32 k = 0; k < nVaryings; k++) {
+				output->v[k] = v1->v[k] + (v2->v[k] - v1->v[k]) * t;
+			}
+		}
+		
+		sl_bool _toScreen(const _priv_SwRender_Vertex* v, _priv_SwRender_ScreenVertex* output)
+		{
+			if (!(v->w > 0)) {
+				return sl_false;
+			}
+			float q = 1.0f / v->w;
+			float x = v->x * q;
+			float y = v->y * q;
+			float z = v->z * q;
+			output->x = (float)m_viewportX + (x + 1.0f) * 0.5f * (float)m_viewportW;
+			output->y = (float)((sl_int32)m_height - m_viewportY - m_viewportH) + (1.0f - y) * 0.5f * (float)m_viewportH;
+			output->z = z * 0.5f + 0.5f;
+			_priv_SwRender_DrawCall* call = m_currentCall.get();
+			sl_uint32 nVaryings = call->nVaryings;
+			if (call->flagPerspective) {
+				output->q = q;
+				for (sl_uint32 k = 0; k < nVaryings; k++) {
+					output->v[k] = v->v[k] * q;
+				}
+			} else {
+				output->q = 1;
+				for (sl_uint32 k = 0; k < nVaryings; k++) {
+					output->v[k] = v->v[k];
+				}
+			}
+			return sl_true;
+		}
+		
+		// clips the triangle by the near plane (z + w >= 0)
+		void _addClippedTriangle(const _priv_SwRender_Vertex* v0, const _priv_SwRender_Vertex* v1, const _priv_SwRender_Vertex* v2)
+		{
+			const _priv_SwRender_Vertex* v[3] = {v0, v1, v2};
+			float d[3];
+			sl_uint32 nInside = 0;
+			for (sl_uint32 i = 0; i < 3; i++) {
+				d[i] = v[i]->z + v[i]->w;
+				if (d[i] >= 0) {
+					nInside++;
+				}
+			}
+			if (!nInside) {
+				return;
+			}
+			_priv_SwRender_ScreenVertex s[4];
+			if (nInside == 3) {
+				if (_toScreen(v0, s) && _toScreen(v1, s + 1) && _toScreen(v2, s + 2)) {
+					_addTriangle(s, s + 1, s + 2, sl_true);
+				}
+				return;
+			}
+			_priv_SwRender_Vertex polygon[4];
+			sl_uint32 n = 0;
+			for (sl_uint32 i = 0; i < 3; i++) {
+				sl_uint32 j = (i + 1) % 3;
+				if (d[i] >= 0) {
+					polygon[n++] = *(v[i]);
+				}
+				if ((d[i] >= 0) != (d[j] >= 0)) {
+					_interpolateVertex(v[i], v[j], d[i] / (d[i] - d[j]), polygon + n);
+					n++;
+				}
+			}
+			for (sl_uint32 i = 0; i < n; i++) {
+				if (!(_toScreen(polygon + i, s + i))) {
+					return;
+				}
+			}
+			for (sl_uint32 i = 1; i + 1 < n; i++) {
+				_addTriangle(s, s + i, s + i + 1, sl_true);
+			}
+		}
+		
+		void _addLine(const _priv_SwRender_Vertex* v1, const _priv_SwRender_Vertex* v2)
+		{
+			float d1 = v1->z + v1->w;
+			float d2 = v2->z + v2->w;
+			if (d1 < 0 && d2 < 0) {
+				return;
+			}
+			_priv_SwRender_Vertex clipped;
+			if (d1 < 0) {
+				_interpolateVertex(v2, v1, d2 / (d2 - d1), &clipped);
+				v1 = &clipped;
+			} else if (d2 < 0) {
+				_interpolateVertex(v1, v2, d1 / (d1 - d2), &clipped);
+				v2 = &clipped;
+			}
+			_priv_SwRender_ScreenVertex s[4];
+			if (!(_toScreen(v1, s) && _toScreen(v2, s + 2))) {
+				return;
+			}
+			float dx = s[2].x - s[0].x;
+			float dy = s[2].y - s[0].y;
+			float len = Math::sqrt(dx * dx + dy * dy);
+			if (Math::isAlmostZero(len)) {
+				return;
+			}
+			// expanded to a quad of the line width
+			float r = Math::max(m_lineWidth, 1.0f) * 0.5f / len;
+			float nx = -dy * r;
+			float ny = dx * r;
+			s[1] = s[0];
+			s[3] = s[2];
+			s[0].x += nx;
+			s[0].y += ny;
+			s[1].x -= nx;
+			s[1].y -= ny;
+			s[2].x += nx;
+			s[2].y += ny;
+			s[3].x -= nx;
+			s[3].y -= ny;
+			_addTriangle(s, s + 1, s + 2, sl_false);
+			_addTriangle(s + 1, s + 3, s + 2, sl_false);
+		}
+		
+		void _addPoint(const _priv_SwRender_Vertex* v)
+		{
+			if (v->z + v->w < 0) {
+				return;
+			}
+			_priv_SwRender_ScreenVertex s[4];
+			if (!(_toScreen(v, s))) {
+				return;
+			}
+			// square of 1 pixel
+			s[1] = s[0];
+			s[2] = s[0];
+			s[3] = s[0];
+			s[0].x -= 0.5f;
+			s[0].y -= 0.5f;
+			s[1].x += 0.5f;
+			s[1].y -= 0.5f;
+			s[2].x -= 0.5f;
+			s[2].y += 0.5f;
+			s[3].x += 0.5f;
+			s[3].y += 0.5f;
+			_addTriangle(s, s + 1, s + 2, sl_false);
+			_addTriangle(s + 1, s + 3, s + 2, sl_false);
+		}
+		
+		_priv_SwRender_Triangle* _allocateTriangle()
+		{
+			if (m_countTriangles >= m_capacityTriangles) {
+				if (m_capacityTriangles >= PRIV_SW_RENDER_MAX_TRIANGLES) {
+					flush();
+					m_calls.add_NoLock(m_currentCall);
+				} else {
+					sl_uint32 capacity = m_capacityTriangles ? (m_capacityTriangles << 1) : 256;
+					if (capacity > PRIV_SW_RENDER_MAX_TRIANGLES) {
+						capacity = PRIV_SW_RENDER_MAX_TRIANGLES;
+					}
+					_priv_SwRender_Triangle* triangles = (_priv_SwRender_Triangle*)(Base::reallocMemory(m_triangles, sizeof(_priv_SwRender_Triangle) * capacity));
+					if (!triangles) {
+						return sl_null;
+					}
+					m_triangles = triangles;
+					m_capacityTriangles = capacity;
+				}
+			}
+			return m_triangles + m_countTriangles;
+		}
+		
+		sl_bool _addToBin(_priv_SwRender_Bin& bin, sl_uint32 index)
+		{
+			if (bin.count >= bin.capacity) {
+				sl_uint32 capacity = bin.capacity ? (bin.capacity << 1) : 64;
+				sl_uint32* indices = (sl_uint32*)(Base::reallocMemory(bin.indices, sizeof(sl_uint32) * capacity));
+				if (!indices) {
+					return sl_false;
+				}
+				bin.indices = indices;
+				bin.capacity = capacity;
+			}
+			bin.indices[bin.count++] = index;
+			return sl_true;
+		}
+		
+		void _addTriangle(const _priv_SwRender_ScreenVertex* v0, const _priv_SwRender_ScreenVertex* v1, const _priv_SwRender_ScreenVertex* v2, sl_bool flagCull)
+		{
+			const _priv_SwRender_ScreenVertex* v[3] = {v0, v1, v2};
+			sl_int64 X[3], Y[3];
+			for (sl_uint32 i = 0; i < 3; i++) {
+				// also rejects NaN
+				if (!(v[i]->x > -PRIV_SW_RENDER_MAX_COORDINATE && v[i]->x < PRIV_SW_RENDER_MAX_COORDINATE && v[i]->y > -PRIV_SW_RENDER_MAX_COORDINATE && v[i]->y < PRIV_SW_RENDER_MAX_COORDINATE)) {
+					return;
+				}
+				X[i] = _priv_SwRender_toSubpixel(v[i]->x);
+				Y[i] = _priv_SwRender_toSubpixel(v[i]->y);
+			}
+			sl_int64 area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+			if (!area) {
+				return;
+			}
+			if (flagCull && m_flagCullFace) {
+				// `y` is flipped, so the counter-clockwise triangles on the target have negative area
+				sl_bool flagCCW = area < 0;
+				if (flagCCW == m_flagCullCCW) {
+					return;
+				}
+			}
+			if (area < 0) {
+				Swap(v[1], v[2]);
+				Swap(X[1], X[2]);
+				Swap(Y[1], Y[2]);
+			}
+			
+			sl_int64 minX = Math::min(X[0], Math::min(X[1], X[2]));
+			sl_int64 maxX = Math::max(X[0], Math::max(X[1], X[2]));
+			sl_int64 minY = Math::min(Y[0], Math::min(Y[1], Y[2]));
+			sl_int64 maxY = Math::max(Y[0], Math::max(Y[1], Y[2]));
+			// pixel centers are at (n * 16 + 8)
+			sl_int64 left = Math::max(_priv_SwRender_ceilDiv(minX - 8, 16), (sl_int64)m_scissorLeft);
+			sl_int64 right = Math::min(_priv_SwRender_floorDiv(maxX - 8, 16), (sl_int64)m_scissorRight);
+			sl_int64 top = Math::max(_priv_SwRender_ceilDiv(minY - 8, 16), (sl_int64)m_scissorTop);
+			sl_int64 bottom = Math::min(_priv_SwRender_floorDiv(maxY - 8, 16), (sl_int64)m_scissorBottom);
+			if (left > right || top > bottom) {
+				return;
+			}
+			
+			_priv_SwRender_Triangle* triangle = _allocateTriangle();
+			if (!triangle) {
+				return;
+			}
+			_priv_SwRender_DrawCall* call = m_currentCall.get();
+			triangle->call = call;
+			triangle->left = (sl_int32)left;
+			triangle->top = (sl_int32)top;
+			triangle->right = (sl_int32)right;
+			triangle->bottom = (sl_int32)bottom;
+			
+			for (sl_uint32 i = 0; i < 3; i++) {
+				sl_uint32 j = (i + 1) % 3;
+				sl_int64 A = Y[i] - Y[j];
+				sl_int64 B = X[j] - X[i];
+				triangle->edgeA[i] = A;
+				triangle->edgeB[i] = B;
+				triangle->edgeC[i] = -(A * X[i] + B * Y[i]);
+				// top-left rule
+				triangle->edgeBias[i] = (A > 0 || (A == 0 && B > 0)) ? 0 : 1;
+			}
+			
+			float x0 = (float)X[0] / 16.0f;
+			float y0 = (float)Y[0] / 16.0f;
+			float dx1 = (float)(X[1] - X[0]) / 16.0f;
+			float dy1 = (float)(Y[1] - Y[0]) / 16.0f;
+			float dx2 = (float)(X[2] - X[0]) / 16.0f;
+			float dy2 = (float)(Y[2] - Y[0]) / 16.0f;
+			float invDet = 1.0f / (dx1 * dy2 - dx2 * dy1);
+			triangle->x0 = x0;
+			triangle->y0 = y0;
+	
+#define PRIV_SW_RENDER_SETUP_PLANE(PLANE, A0, A1, A2) \
+			{ \
+				float a0 = A0; \
+				float d1 = A1 - a0; \
+				float d2 = A2 - a0; \
+				PLANE[0] = a0; \
+				PLANE[1] = (d1 * dy2 - d2 * dy1) * invDet; \
+				PLANE[2] = (d2 * dx1 - d1 * dx2) * invDet; \
+			}
+			
+			PRIV_SW_RENDER_SETUP_PLANE(triangle->z, v[0]->z, v[1]->z, v[2]->z)
+			PRIV_SW_RENDER_SETUP_PLANE(triangle->q, v[0]->q, v[1]->q, v[2]->q)
+			sl_uint32 nVaryings = call->nVaryings;
+			for (sl_uint32 k = 0; k < nVaryings; k++) {
+				PRIV_SW_RENDER_SETUP_PLANE(triangle->v[k], v[0]->v[k], v[1]->v[k], v[2]->v[k])
+			}
+	
+#undef PRIV_SW_RENDER_SETUP_PLANE
+			
+			triangle->flagFlat = sl_false;
+			if (call->texture.isNull() && !(call->nClips) && !(call->flagPerspective)) {
+				triangle->flagFlat = sl_true;
+				for (sl_uint32 k = 0; k < 4; k++) {
+					if (v[0]->v[k] != v[1]->v[k] || v[0]->v[k] != v[2]->v[k]) {
+						triangle->flagFlat = sl_false;
+						break;
+					}
+				}
+				if (triangle->flagFlat) {
+					for (sl_uint32 k = 0; k < 4; k++) {
+						triangle->v[k][1] = 0;
+						triangle->v[k][2] = 0;
+					}
+				}
+			}
+			
+			sl_uint32 tx1 = (sl_uint32)left / m_tileSize;
+			sl_uint32 tx2 = (sl_uint32)right / m_tileSize;
+			sl_uint32 ty1 = (sl_uint32)top / m_tileSize;
+			sl_uint32 ty2 = (sl_uint32)bottom / m_tileSize;
+			for (sl_uint32 ty = ty1; ty <= ty2; ty++) {
+				for (sl_uint32 tx = tx1; tx <= tx2; tx++) {
+					_addToBin(m_bins[ty * m_countTilesX + tx], m_countTriangles);
+				}
+			}
+			m_countTriangles++;
+		}
+		
+		void _rasterizeTile(sl_uint32 index)
+		{
+			_priv_SwRender_Bin& bin = m_bins[index];
+			if (!(bin.count)) {
+				return;
+			}
+			sl_int32 tileLeft = (sl_int32)((index % m_countTilesX) * m_tileSize);
+			sl_int32 tileTop = (sl_int32)((index / m_countTilesX) * m_tileSize);
+			sl_int32 tileRight = Math::min(tileLeft + (sl_int32)m_tileSize, (sl_int32)m_width) - 1;
+			sl_int32 tileBottom = Math::min(tileTop + (sl_int32)m_tileSize, (sl_int32)m_height) - 1;
+			for (sl_uint32 i = 0; i < bin.count; i++) {
+				_priv_SwRender_Triangle* triangle = m_triangles + bin.indices[i];
+				sl_int32 left = Math::max(triangle->left, tileLeft);
+				sl_int32 top = Math::max(triangle->top, tileTop);
+				sl_int32 right = Math::min(triangle->right, tileRight);
+				sl_int32 bottom = Math::min(triangle->bottom, tileBottom);
+				if (left <= right && top <= bottom) {
+					_rasterizeTriangle(triangle, left, top, right, bottom);
+				}
+			}
+		}
+		
+		void _rasterizeTriangle(_priv_SwRender_Triangle* triangle, sl_int32 left, sl_int32 top, sl_int32 right, sl_int32 bottom)
+		{
+			_priv_SwRender_DrawCall* call = triangle->call;
+			sl_uint32 nVaryings = call->nVaryings;
+			sl_bool flagDepthTest = call->flagDepthTest;
+			sl_bool flagDepthWrite = flagDepthTest && call->flagDepthWrite;
+			sl_bool flagPerspective = call->flagPerspective;
+			sl_bool flagFlat = triangle->flagFlat;
+			Color* colors = m_image->getColors();
+			sl_int32 stride = m_image->getStride();
+			
+			float rgba[PRIV_SW_RENDER_SPAN_SIZE * 4];
+			sl_uint8 mask[PRIV_SW_RENDER_SPAN_SIZE];
+			float varyings[PRIV_SW_RENDER_MAX_VARYINGS];
+			float interpolated[PRIV_SW_RENDER_MAX_VARYINGS];
+			
+			for (sl_int32 py = top; py <= bottom; py++) {
+				sl_int64 yc = ((sl_int64)py << 4) + 8;
+				sl_int64 xs = left;
+				sl_int64 xe = right;
+				for (sl_uint32 e = 0; e < 3; e++) {
+					// covered when A * xc + K >= bias, where xc = x * 16 + 8
+					sl_int64 A = triangle->edgeA[e];
+					sl_int64 K = triangle->edgeB[e] * yc + triangle->edgeC[e];
+					sl_int64 bias = triangle->edgeBias[e];
+					if (A > 0) {
+						sl_int64 x = _priv_SwRender_ceilDiv(bias - K - 8 * A, 16 * A);
+						if (x > xs) {
+							xs = x;
+						}
+					} else if (A < 0) {
+						sl_int64 D = -A;
+						sl_int64 x = _priv_SwRender_floorDiv(K - bias - 8 * D, 16 * D);
+						if (x < xe) {
+							xe = x;
+						}
+					} else if (K < bias) {
+						xe = xs - 1;
+						break;
+					}
+				}
+				if (xs > xe) {
+					continue;
+				}
+				Color* row = colors + (sl_reg)py * stride;
+				float* rowDepth = m_depth + (sl_size)py * m_width;
+				float fy = (float)py + 0.5f - triangle->y0;
+				for (sl_int32 x1 = (sl_int32)xs; x1 <= (sl_int32)xe; x1 += PRIV_SW_RENDER_SPAN_SIZE) {
+					sl_uint32 n = (sl_uint32)Math::min((sl_int32)xe - x1 + 1, PRIV_SW_RENDER_SPAN_SIZE);
+					float fx = (float)x1 + 0.5f - triangle->x0;
+					float z = triangle->z[0] + triangle->z[1] * fx + triangle->z[2] * fy;
+					float dz = triangle->z[1];
+					float q = triangle->q[0] + triangle->q[1] * fx + triangle->q[2] * fy;
+					float dq = triangle->q[1];
+					for (sl_uint32 k = 0; k < nVaryings; k++) {
+						interpolated[k] = triangle->v[k][0] + triangle->v[k][1] * fx + triangle->v[k][2] * fy;
+					}
+					float* depth = rowDepth + x1;
+					sl_bool flagWrite = sl_false;
+					for (sl_uint32 i = 0; i < n; i++) {
+						mask[i] = 0;
+						if (z >= 0 && z <= 1 && (!flagDepthTest || _priv_SwRender_testDepth(call->depthFunction, z, depth[i]))) {
+							float* output = rgba + (i << 2);
+							sl_bool flagPass;
+							if (flagFlat) {
+								output[0] = interpolated[0];
+								output[1] = interpolated[1];
+								output[2] = interpolated[2];
+								output[3] = interpolated[3];
+								flagPass = sl_true;
+							} else if (flagPerspective) {
+								float w = 1.0f / q;
+								for (sl_uint32 k = 0; k < nVaryings; k++) {
+									varyings[k] = interpolated[k] * w;
+								}
+								flagPass = _priv_SwRender_shadeFragment(call, varyings, output);
+							} else {
+								flagPass = _priv_SwRender_shadeFragment(call, interpolated, output);
+							}
+							if (flagPass) {
+								if (flagDepthWrite) {
+									depth[i] = z;
+								}
+								mask[i] = 1;
+								flagWrite = sl_true;
+							}
+						}
+						z += dz;
+						q += dq;
+						if (!flagFlat) {
+							for (sl_uint32 k = 0; k < nVaryings; k++) {
+								interpolated[k] += triangle->v[k][1];
+							}
+						}
+					}
+					if (flagWrite) {
+						_priv_SwRender_writeSpan(call, row + x1, rgba, mask, n);
+					}
+				}
+			}
+		}
+	
+	};
+	
+	Ref<SoftwareRenderEngine> SoftwareRenderEngine::create(const SoftwareRenderEngineParam& param)
+	{
+		return _priv_SoftwareRenderEngineImpl::create(param);
+	}
+	
+	Ref<SoftwareRenderEngine> SoftwareRenderEngine::create(sl_uint32 width, sl_uint32 height)
+	{
+		SoftwareRenderEngineParam param;
+		param.width = width;
+		param.height = height;
+		return _priv_SoftwareRenderEngineImpl::create(param);
+	}
+	
 }
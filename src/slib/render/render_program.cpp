@@ -88,7 +88,16 @@ namespace slib
  		RenderProgramState
 *******************************/
 	
-	RenderProgramState::RenderProgramState()
+	RenderUniformValue::RenderUniformValue(): size(0)
+	{
+	}
+	
+	RenderUniformValue::~RenderUniformValue()
+	{
+	}
+	
+	
+	RenderProgramState::RenderProgramState(): gl_engine(sl_null), gl_program(0)
 	{
 	}
 	
@@ -98,86 +107,174 @@ namespace slib
 	
 	void RenderProgramState::setUniformFloatValue(sl_int32 uniformLocation, float value)
 	{
-		gl_engine->setUniformFloatValue(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformFloatValue(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(float));
+		}
 	}
 	
 	void RenderProgramState::setUniformFloatArray(sl_int32 uniformLocation, const float *arr, sl_uint32 n)
 	{
-		gl_engine->setUniformFloatArray(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformFloatArray(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(float) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformIntValue(sl_int32 uniformLocation, sl_int32 value)
 	{
-		gl_engine->setUniformIntValue(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformIntValue(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(sl_int32));
+		}
 	}
 	
 	void RenderProgramState::setUniformIntArray(sl_int32 uniformLocation, const sl_int32 *arr, sl_uint32 n)
 	{
-		gl_engine->setUniformIntArray(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformIntArray(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(sl_int32) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat2Value(sl_int32 uniformLocation, const Vector2& value)
 	{
-		gl_engine->setUniformFloat2Value(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformFloat2Value(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(Vector2));
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat2Array(sl_int32 uniformLocation, const Vector2* arr, sl_uint32 n)
 	{
-		gl_engine->setUniformFloat2Array(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformFloat2Array(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(Vector2) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat3Value(sl_int32 uniformLocation, const Vector3& value)
 	{
-		gl_engine->setUniformFloat3Value(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformFloat3Value(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(Vector3));
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat3Array(sl_int32 uniformLocation, const Vector3* arr, sl_uint32 n)
 	{
-		gl_engine->setUniformFloat3Array(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformFloat3Array(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(Vector3) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat4Value(sl_int32 uniformLocation, const Vector4& value)
 	{
-		gl_engine->setUniformFloat4Value(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformFloat4Value(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(Vector4));
+		}
 	}
 	
 	void RenderProgramState::setUniformFloat4Array(sl_int32 uniformLocation, const Vector4* arr, sl_uint32 n)
 	{
-		gl_engine->setUniformFloat4Array(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformFloat4Array(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(Vector4) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformMatrix3Value(sl_int32 uniformLocation, const Matrix3& value)
 	{
-		gl_engine->setUniformMatrix3Value(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformMatrix3Value(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(Matrix3));
+		}
 	}
 	
 	void RenderProgramState::setUniformMatrix3Array(sl_int32 uniformLocation, const Matrix3* arr, sl_uint32 n)
 	{
-		gl_engine->setUniformMatrix3Array(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformMatrix3Array(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(Matrix3) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformMatrix4Value(sl_int32 uniformLocation, const Matrix4& value)
 	{
-		gl_engine->setUniformMatrix4Value(uniformLocation, value);
+		if (gl_engine) {
+			gl_engine->setUniformMatrix4Value(uniformLocation, value);
+		} else {
+			_setSoftwareUniform(uniformLocation, &value, sizeof(Matrix4));
+		}
 	}
 	
 	void RenderProgramState::setUniformMatrix4Array(sl_int32 uniformLocation, const Matrix4* arr, sl_uint32 n)
 	{
-		gl_engine->setUniformMatrix4Array(uniformLocation, arr, n);
+		if (gl_engine) {
+			gl_engine->setUniformMatrix4Array(uniformLocation, arr, n);
+		} else {
+			_setSoftwareUniform(uniformLocation, arr, sizeof(Matrix4) * n);
+		}
 	}
 	
 	void RenderProgramState::setUniformTexture(sl_int32 uniformLocation, const Ref<Texture>& texture, sl_reg sampler)
 	{
-		gl_engine->applyTexture(texture, sampler);
-		gl_engine->setUniformTextureSampler(uniformLocation, (sl_uint32)sampler);
+		if (gl_engine) {
+			gl_engine->applyTexture(texture, sampler);
+			gl_engine->setUniformTextureSampler(uniformLocation, (sl_uint32)sampler);
+		} else {
+			if (uniformLocation >= 0 && (sl_size)uniformLocation < sw_uniforms.getCount()) {
+				sw_uniforms[uniformLocation].texture = texture;
+			}
+		}
 	}
 	
 	void RenderProgramState::setUniformTextureArray(sl_int32 uniformLocation, const Ref<Texture>* textures, const sl_reg* samplers, sl_uint32 n)
 	{
-		for (sl_uint32 i = 0; i < n; i++) {
-			gl_engine->applyTexture(textures[i], samplers[i]);
+		if (gl_engine) {
+			for (sl_uint32 i = 0; i < n; i++) {
+				gl_engine->applyTexture(textures[i], samplers[i]);
+			}
+			gl_engine->setUniformTextureSamplerArray(uniformLocation, samplers, n);
+		} else {
+			// only the first texture is sampled on CPU
+			if (n) {
+				setUniformTexture(uniformLocation, textures[0], samplers[0]);
+			}
+		}
+	}
+	
+	void RenderProgramState::_setSoftwareUniform(sl_int32 uniformLocation, const void* data, sl_uint32 size)
+	{
+		if (uniformLocation < 0 || (sl_size)uniformLocation >= sw_uniforms.getCount()) {
+			return;
+		}
+		RenderUniformValue& value = sw_uniforms[uniformLocation];
+		if (value.data.getSize() < size) {
+			value.data = Memory::create(size);
+			if (value.data.isNull()) {
+				value.size = 0;
+				return;
+			}
+		}
+		if (size) {
+			Base::copyMemory(value.data.getData(), data, size);
 		}
-		gl_engine->setUniformTextureSamplerArray(uniformLocation, samplers, n);
+		value.size = size;
 	}
 	
 /*******************************
@@ -212,6 +309,28 @@ namespace slib
 			return sl_true;
 		}
 		
+		if (type == RenderEngineType::Software) {
+			
+			_priv_RenderProgramStateTemplate* state = (_priv_RenderProgramStateTemplate*)_state;
+			
+			// the location of every item is its index, so the engine can read the values and the attributes directly
+			_priv_RenderProgramStateItem* item = state->items;
+			sl_int32 i = 0;
+			while (item->gl_name) {
+				item->gl_location = i;
+				if (item->type == 2) {
+					if (state->_indexFirstAttribute < 0) {
+						state->_indexFirstAttribute = i;
+					}
+					state->_indexLastAttribute = i;
+				}
+				item++;
+				i++;
+			}
+			state->sw_uniforms = Array<RenderUniformValue>::create(i);
+			return state->sw_uniforms.isNotNull();
+		}
+		
 		return sl_false;
 	}
 	
@@ -254,6 +373,10 @@ namespace slib
 			return sl_true;
 		}
 		
+		if (type == RenderEngineType::Software) {
+			return sl_true;
+		}
+		
 		return sl_false;
 	}
 	
@@ -386,6 +509,43 @@ namespace slib
 		return source;
 	}
 	
+/*******************************
+ RenderProgram2D_PositionTextureColor
+*******************************/
+	String RenderProgram2D_PositionTextureColor::getGLSLVertexShader(RenderEngine* engine)
+	{
+		String source = SLIB_STRINGIFY(
+									   uniform mat3 u_Transform;
+									   uniform vec4 u_Color;
+									   attribute vec2 a_Position;
+									   attribute vec2 a_TexCoord;
+									   attribute vec4 a_Color;
+									   varying vec2 v_TexCoord;
+									   varying vec4 v_Color;
+									   void main() {
+										   vec3 P = vec3(a_Position.x, a_Position.y, 1.0) * u_Transform;
+										   gl_Position = vec4(P.x, P.y, 0.0, 1.0);
+										   v_TexCoord = a_TexCoord;
+										   v_Color = a_Color * u_Color;
+									   }
+									   );
+		return source;
+	}
+	
+	String RenderProgram2D_PositionTextureColor::getGLSLFragmentShader(RenderEngine* engine)
+	{
+		String source = SLIB_STRINGIFY(
+									   uniform sampler2D u_Texture;
+									   varying vec2 v_TexCoord;
+									   varying vec4 v_Color;
+									   void main() {
+										   vec4 colorTexture = texture2D(u_Texture, v_TexCoord);
+										   gl_FragColor = colorTexture * v_Color;
+									   }
+									   );
+		return source;
+	}
+	
 /*******************************
  RenderProgram2D_Position
 *******************************/